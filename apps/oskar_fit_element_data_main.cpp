@@ -39,14 +39,17 @@
 #include <iomanip>
 #include <cmath>
 #include <cstdio>
+#include <vector>
 
 using namespace oskar;
 using std::string;
+using std::vector;
 
 static const char app[] = "oskar_fit_element_data";
 
 static string construct_element_pathname(string output_dir,
         int port, int element_type_index, double frequency_hz);
+static bool fit_is_cached(const vector<string>& outputs, const char* key);
 
 int main(int argc, char** argv)
 {
@@ -123,49 +126,71 @@ int main(int argc, char** argv)
     // Load the CST text file for the correct port, if specified (X=1, Y=2).
     if (!input_cst_file.empty())
     {
-        oskar_log_line(log, 'M', ' ');
-        oskar_log_message(log, 'M', 0, "Loading CST element pattern: %s",
-                input_cst_file.c_str());
-        oskar_element_load_cst(element, port, frequency_hz,
-                input_cst_file.c_str(), average_fractional_error,
-                average_fractional_error_factor_increase,
-                ignore_at_pole, ignore_below_horizon, log, &e);
-
-        // Construct the output file name based on the settings.
-        if (port == 0)
+        // Construct the output file names based on the settings.
+        vector<string> outputs;
+        vector<int> ports;
+        for (int p = (port == 0 ? 1 : port); p <= (port == 0 ? 2 : port); ++p)
         {
-            string output = construct_element_pathname(output_dir, 1,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, output.c_str(), 1,
-                    frequency_hz, log, &e);
-            output = construct_element_pathname(output_dir, 2,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, output.c_str(), 2,
-                    frequency_hz, log, &e);
+            outputs.push_back(construct_element_pathname(output_dir, p,
+                    element_type_index, frequency_hz));
+            ports.push_back(p);
         }
+
+        // Skip the fit if the outputs are from the same input and settings.
+        char* key = oskar_element_fit_key(input_cst_file.c_str(), port,
+                frequency_hz, average_fractional_error,
+                average_fractional_error_factor_increase,
+                ignore_at_pole, ignore_below_horizon);
+        oskar_log_line(log, 'M', ' ');
+        if (fit_is_cached(outputs, key))
+            oskar_log_message(log, 'M', 0, "Using existing fit for CST "
+                    "element pattern: %s", input_cst_file.c_str());
         else
         {
-            string output = construct_element_pathname(output_dir, port,
-                    element_type_index, frequency_hz);
-            oskar_element_write(element, output.c_str(), port,
-                    frequency_hz, log, &e);
+            oskar_log_message(log, 'M', 0, "Loading CST element pattern: %s",
+                    input_cst_file.c_str());
+            oskar_element_load_cst(element, port, frequency_hz,
+                    input_cst_file.c_str(), average_fractional_error,
+                    average_fractional_error_factor_increase,
+                    ignore_at_pole, ignore_below_horizon, log, &e);
+            for (size_t i = 0; i < outputs.size(); ++i)
+            {
+                oskar_element_write(element, outputs[i].c_str(), ports[i],
+                        frequency_hz, log, &e);
+                oskar_element_fit_key_write(outputs[i].c_str(), key, &e);
+            }
         }
+        free(key);
     }
 
     // Load the scalar text file, if specified.
     if (!input_scalar_file.empty())
     {
-        oskar_log_message(log, 'M', 0, "Loading scalar element pattern: %s",
-                input_scalar_file.c_str());
-        oskar_element_load_scalar(element, frequency_hz,
-                input_scalar_file.c_str(), average_fractional_error,
-                average_fractional_error_factor_increase,
-                ignore_at_pole, ignore_below_horizon, log, &e);
-
         // Construct the output file name based on the settings.
-        string output = construct_element_pathname(output_dir, 0,
-                element_type_index, frequency_hz);
-        oskar_element_write(element, output.c_str(), 0, frequency_hz, log, &e);
+        vector<string> outputs(1, construct_element_pathname(output_dir, 0,
+                element_type_index, frequency_hz));
+
+        // Skip the fit if the output is from the same input and settings.
+        char* key = oskar_element_fit_key(input_scalar_file.c_str(), 0,
+                frequency_hz, average_fractional_error,
+                average_fractional_error_factor_increase,
+                ignore_at_pole, ignore_below_horizon);
+        if (fit_is_cached(outputs, key))
+            oskar_log_message(log, 'M', 0, "Using existing fit for scalar "
+                    "element pattern: %s", input_scalar_file.c_str());
+        else
+        {
+            oskar_log_message(log, 'M', 0, "Loading scalar element pattern: "
+                    "%s", input_scalar_file.c_str());
+            oskar_element_load_scalar(element, frequency_hz,
+                    input_scalar_file.c_str(), average_fractional_error,
+                    average_fractional_error_factor_increase,
+                    ignore_at_pole, ignore_below_horizon, log, &e);
+            oskar_element_write(element, outputs[0].c_str(), 0,
+                    frequency_hz, log, &e);
+            oskar_element_fit_key_write(outputs[0].c_str(), key, &e);
+        }
+        free(key);
     }
 
     // Check for errors.
@@ -209,3 +234,12 @@ static string construct_element_pathname(string output_dir,
     return p;
 }
 
+
+
+static bool fit_is_cached(const vector<string>& outputs, const char* key)
+{
+    for (size_t i = 0; i < outputs.size(); ++i)
+        if (!oskar_element_fit_key_matches(outputs[i].c_str(), key))
+            return false;
+    return true;
+}
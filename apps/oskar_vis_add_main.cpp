@@ -27,24 +27,60 @@
  */
 
 #include "settings/oskar_option_parser.h"
+#include "binary/oskar_binary.h"
 #include "vis/oskar_vis.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_thread.h"
 #include "utility/oskar_version_string.h"
 
+#include <algorithm>
 #include <string>
 #include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <cfloat>
 #include <iomanip>
+#include <vector>
 
 using namespace std;
 using namespace oskar;
 
+struct VisAdd
+{
+    int num_inputs;
+    oskar_Binary** h_in;
+    oskar_VisHeader** hdr_in;
+    oskar_Binary* h_out;
+    oskar_VisBlock* out[2];
+    oskar_VisBlock* in;
+    oskar_Barrier* barrier;
+    int status;
+};
+
 // -----------------------------------------------------------------------------
-static bool is_compatible(const oskar_Vis* vis1, const oskar_Vis* vis2);
+static bool is_compatible(const oskar_VisHeader* v1, const oskar_VisHeader* v2);
+static bool is_compatible(const oskar_Vis* v1, const oskar_Vis* v2);
+static bool same_blocks(const oskar_VisHeader* v1, const oskar_VisHeader* v2);
+static bool same_products(const oskar_VisHeader* v1,
+        const oskar_VisHeader* v2);
+static void add_block(oskar_VisBlock* out, const oskar_VisBlock* in,
+        int* status);
+static void add_overlapping(oskar_VisBlock* out, oskar_VisBlock* in,
+        const oskar_VisHeader* hdr, oskar_Binary* h, int* status);
+static void* run_blocks(void* arg);
+static int add_in_memory(int num_in_files, const char* const* in_files,
+        const string& out_path, bool verbose);
 static void print_error(int status, const char* message);
 // -----------------------------------------------------------------------------
 
+struct ThreadArgs
+{
+    VisAdd* h;
+    int thread_id;
+};
+
 int main(int argc, char** argv)
 {
     // Register options =======================================================
@@ -82,7 +118,247 @@ int main(int argc, char** argv)
     }
 
     // Add the data. ==========================================================
+    // The input files are read one visibility block at a time, so memory
+    // use depends only on the block size and not on the size of the files.
+    VisAdd h;
+    h.status = 0;
+    h.num_inputs = num_in_files;
+    vector<oskar_Binary*> h_in(num_in_files, (oskar_Binary*)0);
+    vector<oskar_VisHeader*> hdr_in(num_in_files, (oskar_VisHeader*)0);
+    h.h_in = &h_in[0];
+    h.hdr_in = &hdr_in[0];
+    h.h_out = 0;
+    h.in = h.out[0] = h.out[1] = 0;
+    h.barrier = 0;
+
+    // Open the input files and read the headers.
+    // Files in an older format, or with different correlation products,
+    // cannot be streamed block by block, so are combined in memory instead.
+    bool streamable = true;
+    for (int i = 0; i < num_in_files; ++i)
+    {
+        h_in[i] = oskar_binary_create(in_files[i], 'r', &h.status);
+        hdr_in[i] = oskar_vis_header_read(h_in[i], &h.status);
+        if (h.status == OSKAR_ERR_BINARY_TAG_NOT_FOUND)
+        {
+            h.status = 0;
+            streamable = false;
+            break;
+        }
+        if (h.status)
+        {
+            string msg = string("Failed to read visibility data file ") +
+                    in_files[i];
+            print_error(h.status, msg.c_str());
+            break;
+        }
+        if (i > 0 && !is_compatible(hdr_in[0], hdr_in[i]))
+        {
+            cerr << "ERROR: Input visibility data must match!" << endl;
+            h.status = OSKAR_ERR_TYPE_MISMATCH;
+            break;
+        }
+        if (i > 0 && !same_products(hdr_in[0], hdr_in[i]))
+            streamable = false;
+    }
+    if (!h.status && !streamable)
+    {
+        for (int i = 0; i < num_in_files; ++i)
+        {
+            oskar_vis_header_free(hdr_in[i], &h.status);
+            oskar_binary_free(h_in[i]);
+        }
+        return add_in_memory(num_in_files, in_files, out_path, verbose);
+    }
+
+    // Write the output header, and create the visibility blocks.
+    if (!h.status)
+    {
+        // TODO(BM) write some sort of tag into here to indicate this is an
+        // accumulated visibility data set...
+        oskar_VisHeader* hdr_out =
+                oskar_vis_header_create_copy(hdr_in[0], &h.status);
+        oskar_mem_clear_contents(oskar_vis_header_settings(hdr_out), &h.status);
+        if (verbose)
+            cout << "Writing OSKAR visibility file: " << out_path << endl;
+        h.h_out = oskar_vis_header_write(hdr_out, out_path.c_str(), &h.status);
+        oskar_vis_header_free(hdr_out, &h.status);
+        for (int i = 0; i < 2; ++i)
+            h.out[i] = oskar_vis_block_create_from_header(OSKAR_CPU,
+                    hdr_in[0], &h.status);
+        h.in = oskar_vis_block_create_from_header(OSKAR_CPU,
+                hdr_in[0], &h.status);
+    }
+
+    // Read, combine and write blocks using two threads.
+    // Thread 0 writes the previous block while thread 1 reads the next one.
+    if (!h.status)
+    {
+        const int num_threads = 2;
+        ThreadArgs args[num_threads];
+        oskar_Thread* threads[num_threads];
+        h.barrier = oskar_barrier_create(num_threads);
+        for (int i = 0; i < num_threads; ++i)
+        {
+            args[i].h = &h;
+            args[i].thread_id = i;
+            threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        }
+        for (int i = 0; i < num_threads; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+        oskar_barrier_free(h.barrier);
+        if (h.status)
+            print_error(h.status, "Failed to combine visibility data.");
+    }
+
+    // Free memory and close files.
+    for (int i = 0; i < num_in_files; ++i)
+    {
+        oskar_vis_header_free(hdr_in[i], &h.status);
+        oskar_binary_free(h_in[i]);
+    }
+    oskar_vis_block_free(h.in, &h.status);
+    oskar_vis_block_free(h.out[0], &h.status);
+    oskar_vis_block_free(h.out[1], &h.status);
+    oskar_binary_free(h.h_out);
+
+    return h.status;
+}
+
+static void* run_blocks(void* arg)
+{
+    VisAdd* h = ((ThreadArgs*)arg)->h;
+    const int thread_id = ((ThreadArgs*)arg)->thread_id;
+    int* status = &h->status;
+
+    /* Loop over visibility blocks, reading and writing one block at a time.
+     * Reading and writing are overlapped by using double buffering.
+     *
+     * Thread 0 is used for file writes.
+     * Thread 1 reads and combines the input data.
+     *
+     * No write is launched on the first loop counter (as no data are
+     * ready yet) and no read is performed for the last loop counter. */
+    const int num_blocks = oskar_vis_header_num_blocks(h->hdr_in[0]);
+    for (int b = 0; b < num_blocks + 1; ++b)
+    {
+        if (thread_id == 1 && b < num_blocks)
+        {
+            oskar_VisBlock* out = h->out[b % 2];
+            oskar_vis_block_read(out, h->hdr_in[0], h->h_in[0], b, status);
+            for (int i = 1; i < h->num_inputs; ++i)
+            {
+                if (!same_blocks(h->hdr_in[0], h->hdr_in[i]))
+                {
+                    add_overlapping(out, h->in, h->hdr_in[i], h->h_in[i],
+                            status);
+                    continue;
+                }
+                oskar_vis_block_read(h->in, h->hdr_in[i], h->h_in[i], b,
+                        status);
+                add_block(out, h->in, status);
+            }
+        }
+        if (thread_id == 0 && b > 0)
+            oskar_vis_block_write(h->out[(b - 1) % 2], h->h_out, b - 1,
+                    status);
+
+        /* Synchronise before moving to the next block. */
+        oskar_barrier_wait(h->barrier);
+    }
+    return 0;
+}
+
+static void add_block(oskar_VisBlock* out, const oskar_VisBlock* in,
+        int* status)
+{
+    if (*status) return;
+    if (oskar_vis_block_num_times(out) != oskar_vis_block_num_times(in) ||
+            oskar_vis_block_num_channels(out) !=
+                    oskar_vis_block_num_channels(in))
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_vis_block_has_cross_correlations(out))
+    {
+        oskar_Mem* a = oskar_vis_block_cross_correlations(out);
+        oskar_mem_add(a, a, oskar_vis_block_cross_correlations_const(in),
+                0, 0, 0, oskar_mem_length(a), status);
+    }
+    if (oskar_vis_block_has_auto_correlations(out))
+    {
+        oskar_Mem* a = oskar_vis_block_auto_correlations(out);
+        oskar_mem_add(a, a, oskar_vis_block_auto_correlations_const(in),
+                0, 0, 0, oskar_mem_length(a), status);
+    }
+}
+
+static void add_overlapping(oskar_VisBlock* out, oskar_VisBlock* in,
+        const oskar_VisHeader* hdr, oskar_Binary* h, int* status)
+{
+    // Add the parts of the blocks in an input file that overlap the
+    // output block, for inputs written with different block dimensions.
+    // The data in each block are ordered by time, channel and baseline.
+    const int max_times = oskar_vis_header_max_times_per_block(hdr);
+    const int max_chans = oskar_vis_header_max_channels_per_block(hdr);
+    const int num_blocks_chan = (oskar_vis_header_num_channels_total(hdr) +
+            max_chans - 1) / max_chans;
+    const int out_t0 = oskar_vis_block_start_time_index(out);
+    const int out_c0 = oskar_vis_block_start_channel_index(out);
+    const int out_nt = oskar_vis_block_num_times(out);
+    const int out_nc = oskar_vis_block_num_channels(out);
+    const size_t num_baselines = oskar_vis_block_num_baselines(out);
+    const size_t num_stations = oskar_vis_block_num_stations(out);
+    oskar_Mem* xc_out = oskar_vis_block_cross_correlations(out);
+    oskar_Mem* ac_out = oskar_vis_block_auto_correlations(out);
+    for (int bt = out_t0 / max_times;
+            bt <= (out_t0 + out_nt - 1) / max_times; ++bt)
+    {
+        for (int bc = out_c0 / max_chans;
+                bc <= (out_c0 + out_nc - 1) / max_chans; ++bc)
+        {
+            oskar_vis_block_read(in, hdr, h, bt * num_blocks_chan + bc,
+                    status);
+            if (*status) return;
+            const int in_t0 = oskar_vis_block_start_time_index(in);
+            const int in_c0 = oskar_vis_block_start_channel_index(in);
+            const int in_nc = oskar_vis_block_num_channels(in);
+            const int t_end = min(out_t0 + out_nt,
+                    in_t0 + oskar_vis_block_num_times(in));
+            const int c_end = min(out_c0 + out_nc, in_c0 + in_nc);
+            for (int t = max(out_t0, in_t0); t < t_end; ++t)
+            {
+                for (int c = max(out_c0, in_c0); c < c_end; ++c)
+                {
+                    const size_t i_out = (t - out_t0) * out_nc + c - out_c0;
+                    const size_t i_in = (t - in_t0) * in_nc + c - in_c0;
+                    if (oskar_vis_block_has_cross_correlations(out))
+                        oskar_mem_add(xc_out, xc_out,
+                                oskar_vis_block_cross_correlations_const(in),
+                                i_out * num_baselines, i_out * num_baselines,
+                                i_in * num_baselines, num_baselines, status);
+                    if (oskar_vis_block_has_auto_correlations(out))
+                        oskar_mem_add(ac_out, ac_out,
+                                oskar_vis_block_auto_correlations_const(in),
+                                i_out * num_stations, i_out * num_stations,
+                                i_in * num_stations, num_stations, status);
+                }
+            }
+        }
+    }
+}
+
+static int add_in_memory(int num_in_files, const char* const* in_files,
+        const string& out_path, bool verbose)
+{
     int status = 0;
+    if (verbose)
+        cout << "Input files use an older format or different "
+                "correlation products: combining them in memory." << endl;
 
     // Load the first visibility structure.
     oskar_Binary* h = oskar_binary_create(in_files[0], 'r', &status);
@@ -94,8 +370,6 @@ int main(int argc, char** argv)
         print_error(status, msg.c_str());
     }
     oskar_mem_clear_contents(oskar_vis_settings_path(out), &status);
-    // TODO(BM) write some sort of tag into here to indicate this is an
-    // accumulated visibility data set...
 
     // Loop over other visibility files and combine.
     for (int i = 1; i < num_in_files; ++i)
@@ -124,7 +398,7 @@ int main(int argc, char** argv)
         oskar_vis_free(in, &status);
     }
 
-    // Write output data ======================================================
+    // Write output data.
     if (verbose)
         cout << "Writing OSKAR visibility file: " << out_path << endl;
     oskar_vis_write(out, out_path.c_str(), &status);
@@ -142,6 +416,69 @@ static void print_error(int status, const char* message)
 }
 
 
+static bool is_compatible(const oskar_VisHeader* v1, const oskar_VisHeader* v2)
+{
+    if (oskar_vis_header_num_channels_total(v1) !=
+            oskar_vis_header_num_channels_total(v2))
+        return false;
+    if (oskar_vis_header_num_times_total(v1) !=
+            oskar_vis_header_num_times_total(v2))
+        return false;
+    if (oskar_vis_header_num_stations(v1) !=
+            oskar_vis_header_num_stations(v2))
+        return false;
+    if (fabs(oskar_vis_header_freq_start_hz(v1) -
+            oskar_vis_header_freq_start_hz(v2)) > DBL_EPSILON)
+        return false;
+    if (fabs(oskar_vis_header_freq_inc_hz(v1) -
+            oskar_vis_header_freq_inc_hz(v2)) > DBL_EPSILON)
+        return false;
+    if (fabs(oskar_vis_header_channel_bandwidth_hz(v1) -
+            oskar_vis_header_channel_bandwidth_hz(v2)) > DBL_EPSILON)
+        return false;
+    if (fabs(oskar_vis_header_time_start_mjd_utc(v1) -
+            oskar_vis_header_time_start_mjd_utc(v2)) > DBL_EPSILON)
+        return false;
+    if (fabs(oskar_vis_header_time_inc_sec(v1) -
+            oskar_vis_header_time_inc_sec(v2)) > DBL_EPSILON)
+        return false;
+    if (fabs(oskar_vis_header_phase_centre_ra_deg(v1) -
+            oskar_vis_header_phase_centre_ra_deg(v2)) > DBL_EPSILON)
+        return false;
+    if (fabs(oskar_vis_header_phase_centre_dec_deg(v1) -
+            oskar_vis_header_phase_centre_dec_deg(v2)) > DBL_EPSILON)
+        return false;
+    if (oskar_vis_header_amp_type(v1) != oskar_vis_header_amp_type(v2))
+        return false;
+
+    return true;
+}
+
+static bool same_blocks(const oskar_VisHeader* v1, const oskar_VisHeader* v2)
+{
+    if (oskar_vis_header_max_channels_per_block(v1) !=
+            oskar_vis_header_max_channels_per_block(v2))
+        return false;
+    if (oskar_vis_header_max_times_per_block(v1) !=
+            oskar_vis_header_max_times_per_block(v2))
+        return false;
+
+    return true;
+}
+
+static bool same_products(const oskar_VisHeader* v1,
+        const oskar_VisHeader* v2)
+{
+    if (oskar_vis_header_write_auto_correlations(v1) !=
+            oskar_vis_header_write_auto_correlations(v2))
+        return false;
+    if (oskar_vis_header_write_cross_correlations(v1) !=
+            oskar_vis_header_write_cross_correlations(v2))
+        return false;
+
+    return true;
+}
+
 static bool is_compatible(const oskar_Vis* v1, const oskar_Vis* v2)
 {
     if (oskar_vis_num_channels(v1) != oskar_vis_num_channels(v2))
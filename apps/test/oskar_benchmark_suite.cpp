@@ -0,0 +1,617 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "beam_pattern/oskar_beam_pattern.h"
+#include "binary/oskar_binary.h"
+#include "imager/oskar_imager.h"
+#include "log/oskar_log.h"
+#include "math/oskar_cmath.h"
+#include "mem/oskar_mem.h"
+#include "sky/oskar_sky.h"
+#include "telescope/oskar_telescope.h"
+#include "utility/oskar_dir.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+#ifndef OSKAR_NO_MS
+#include "ms/oskar_measurement_set.h"
+#include "vis/oskar_vis_block_write_ms.h"
+#include "vis/oskar_vis_header_write_ms.h"
+#endif
+#include "oskar_version.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+struct Result
+{
+    string name, unit;
+    double seconds, items, megabytes;
+};
+
+struct Suite
+{
+    int prec, num_stations, num_elements, num_sources;
+    int num_times, num_channels, image_size, dft_image_size, beam_size;
+    int num_w_planes;
+    double freq_hz, ra_deg, dec_deg, lon_deg, lat_deg, mjd;
+    string dir, tel_dir, vis_file, ms_file;
+    vector<Result> results;
+};
+
+static const double time_inc_sec = 60.0;
+static const double freq_inc_hz = 1e6;
+
+static int max_times_per_block(const Suite& s)
+{
+    return s.num_times < 8 ? s.num_times : 8;
+}
+
+static string path(const Suite& s, const char* name)
+{
+    return s.dir + oskar_dir_separator() + name;
+}
+
+static double file_megabytes(const string& filename)
+{
+    std::ifstream f(filename.c_str(), std::ios::binary | std::ios::ate);
+    return f ? f.tellg() / (1024.0 * 1024.0) : 0.0;
+}
+
+static void add_result(Suite& s, const string& name, double seconds,
+        double items, const char* unit, double megabytes)
+{
+    Result r;
+    r.name = name;
+    r.seconds = seconds;
+    r.items = items;
+    r.unit = unit;
+    r.megabytes = megabytes;
+    s.results.push_back(r);
+    printf("%-40s %9.3f s %14.4g %s/s", name.c_str(), seconds,
+            seconds > 0.0 ? items / seconds : 0.0, unit);
+    if (megabytes > 0.0)
+        printf(" %10.2f MB/s", seconds > 0.0 ? megabytes / seconds : 0.0);
+    printf("\n");
+}
+
+
+/* Synthetic inputs. */
+
+// Writes a telescope model directory with randomly placed stations,
+// each containing a randomly placed set of elements.
+static void write_telescope(const Suite& s)
+{
+    oskar_dir_mkpath(s.tel_dir.c_str());
+    const string sep(1, oskar_dir_separator());
+    FILE* f = fopen((s.tel_dir + sep + "position.txt").c_str(), "w");
+    if (!f) return;
+    fprintf(f, "%.6f, %.6f\n", s.lon_deg, s.lat_deg);
+    fclose(f);
+    srand(1);
+    f = fopen((s.tel_dir + sep + "layout.txt").c_str(), "w");
+    if (!f) return;
+    for (int i = 0; i < s.num_stations; ++i)
+        fprintf(f, "%.3f, %.3f\n", 4000.0 * (rand() / (RAND_MAX + 1.0) - 0.5),
+                4000.0 * (rand() / (RAND_MAX + 1.0) - 0.5));
+    fclose(f);
+    for (int i = 0; i < s.num_stations; ++i)
+    {
+        char name[32];
+        sprintf(name, "station%04d", i);
+        const string station_dir = s.tel_dir + sep + name;
+        oskar_dir_mkpath(station_dir.c_str());
+        f = fopen((station_dir + sep + "layout.txt").c_str(), "w");
+        if (!f) return;
+        for (int j = 0; j < s.num_elements; ++j)
+            fprintf(f, "%.3f, %.3f\n",
+                    35.0 * (rand() / (RAND_MAX + 1.0) - 0.5),
+                    35.0 * (rand() / (RAND_MAX + 1.0) - 0.5));
+        fclose(f);
+    }
+}
+
+static oskar_Telescope* load_telescope(const Suite& s, int* status)
+{
+    oskar_Telescope* t = oskar_telescope_create(s.prec, OSKAR_CPU, 0, status);
+    oskar_telescope_set_pol_mode(t, "Full", status);
+    oskar_telescope_set_enable_numerical_patterns(t, 0);
+    oskar_telescope_load(t, s.tel_dir.c_str(), 0, status);
+    oskar_telescope_set_phase_centre(t, OSKAR_SPHERICAL_TYPE_EQUATORIAL,
+            s.ra_deg * M_PI / 180.0, s.dec_deg * M_PI / 180.0);
+    return t;
+}
+
+// Returns a visibility header and a block filled with random amplitudes.
+// Station (u,v,w) coordinates are set for each block by fill_uvw().
+static oskar_VisHeader* create_vis(const Suite& s, const oskar_Telescope* t,
+        oskar_VisBlock** blk, int* status)
+{
+    oskar_VisHeader* hdr = oskar_vis_header_create(
+            s.prec | OSKAR_COMPLEX | OSKAR_MATRIX, s.prec,
+            max_times_per_block(s), s.num_times,
+            s.num_channels, s.num_channels, s.num_stations, 0, 1, status);
+    oskar_vis_header_set_freq_start_hz(hdr, s.freq_hz);
+    oskar_vis_header_set_freq_inc_hz(hdr, freq_inc_hz);
+    oskar_vis_header_set_channel_bandwidth_hz(hdr, freq_inc_hz);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, s.mjd);
+    oskar_vis_header_set_time_inc_sec(hdr, time_inc_sec);
+    oskar_vis_header_set_time_average_sec(hdr, time_inc_sec);
+    oskar_vis_header_set_phase_centre(hdr, 0, s.ra_deg, s.dec_deg);
+    oskar_vis_header_set_telescope_centre(hdr, s.lon_deg, s.lat_deg, 0.0);
+    oskar_mem_copy(oskar_vis_header_station_x_offset_ecef_metres(hdr),
+            oskar_telescope_station_true_offset_ecef_metres_const(t, 0),
+            status);
+    oskar_mem_copy(oskar_vis_header_station_y_offset_ecef_metres(hdr),
+            oskar_telescope_station_true_offset_ecef_metres_const(t, 1),
+            status);
+    oskar_mem_copy(oskar_vis_header_station_z_offset_ecef_metres(hdr),
+            oskar_telescope_station_true_offset_ecef_metres_const(t, 2),
+            status);
+    *blk = oskar_vis_block_create_from_header(OSKAR_CPU, hdr, status);
+    oskar_mem_random_range(oskar_vis_block_cross_correlations(*blk),
+            -1.0, 1.0, status);
+    return hdr;
+}
+
+// Sets station (u,v,w) coordinates for the block, using the local
+// horizontal station offsets as an approximation to the equatorial frame.
+static void fill_uvw(const Suite& s, const oskar_Telescope* t,
+        oskar_VisBlock* blk, int block_index, int* status)
+{
+    const int num_times_block = max_times_per_block(s);
+    const int start_time = block_index * num_times_block;
+    const int num_times = (start_time + num_times_block > s.num_times) ?
+            s.num_times - start_time : num_times_block;
+    oskar_vis_block_set_start_time_index(blk, start_time);
+    oskar_vis_block_set_num_times(blk, num_times, status);
+    oskar_Mem *x = 0, *y = 0, *uvw[3];
+    x = oskar_mem_convert_precision(
+            oskar_telescope_station_true_enu_metres_const(t, 0), OSKAR_DOUBLE,
+            status);
+    y = oskar_mem_convert_precision(
+            oskar_telescope_station_true_enu_metres_const(t, 1), OSKAR_DOUBLE,
+            status);
+    for (int dim = 0; dim < 3; ++dim)
+        uvw[dim] = oskar_vis_block_station_uvw_metres(blk, dim);
+    if (*status)
+    {
+        oskar_mem_free(x, status);
+        oskar_mem_free(y, status);
+        return;
+    }
+    const double* x_ = oskar_mem_double_const(x, status);
+    const double* y_ = oskar_mem_double_const(y, status);
+    const double sin_lat = sin(s.lat_deg * M_PI / 180.0);
+    const double cos_lat = cos(s.lat_deg * M_PI / 180.0);
+    const double sin_dec = sin(s.dec_deg * M_PI / 180.0);
+    const double cos_dec = cos(s.dec_deg * M_PI / 180.0);
+    for (int t_ = 0; t_ < num_times; ++t_)
+    {
+        const double ha = (start_time + t_ - s.num_times / 2) *
+                time_inc_sec * 2.0 * M_PI / 86400.0;
+        const double sin_ha = sin(ha), cos_ha = cos(ha);
+        for (int i = 0; i < s.num_stations; ++i)
+        {
+            const int j = t_ * s.num_stations + i;
+            const double X = -y_[i] * sin_lat, Y = x_[i], Z = y_[i] * cos_lat;
+            const double u = sin_ha * X + cos_ha * Y;
+            const double v = -sin_dec * cos_ha * X + sin_dec * sin_ha * Y +
+                    cos_dec * Z;
+            const double w = cos_dec * cos_ha * X - cos_dec * sin_ha * Y +
+                    sin_dec * Z;
+            if (s.prec == OSKAR_DOUBLE)
+            {
+                oskar_mem_double(uvw[0], status)[j] = u;
+                oskar_mem_double(uvw[1], status)[j] = v;
+                oskar_mem_double(uvw[2], status)[j] = w;
+            }
+            else
+            {
+                oskar_mem_float(uvw[0], status)[j] = (float) u;
+                oskar_mem_float(uvw[1], status)[j] = (float) v;
+                oskar_mem_float(uvw[2], status)[j] = (float) w;
+            }
+        }
+    }
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+}
+
+static double vis_block_megabytes(const oskar_VisBlock* blk)
+{
+    const oskar_Mem* amp = oskar_vis_block_cross_correlations_const(blk);
+    const oskar_Mem* uvw = oskar_vis_block_station_uvw_metres_const(blk, 0);
+    return (oskar_mem_length(amp) *
+            oskar_mem_element_size(oskar_mem_type(amp)) +
+            3 * oskar_mem_length(uvw) *
+            oskar_mem_element_size(oskar_mem_type(uvw))) /
+            (1024.0 * 1024.0);
+}
+
+
+/* Benchmarks. */
+
+static void bench_telescope(Suite& s, oskar_Timer* tmr, int* status)
+{
+    oskar_timer_start(tmr);
+    oskar_Telescope* t = load_telescope(s, status);
+    const double elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, "oskar_telescope_load", elapsed,
+                (double) s.num_stations * s.num_elements, "elements", 0.0);
+    oskar_telescope_free(t, status);
+}
+
+static void bench_sky(Suite& s, oskar_Timer* tmr, int* status)
+{
+    oskar_Sky* sky = oskar_sky_generate_random_power_law(s.prec,
+            s.num_sources, 0.1, 10.0, -2.0, 1, status);
+    const string text_file = path(s, "sky.osm");
+    const string bin_file = path(s, "sky.osmb");
+
+    oskar_timer_start(tmr);
+    oskar_sky_save(text_file.c_str(), sky, status);
+    double elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, "oskar_sky_save (text)", elapsed,
+                s.num_sources, "sources", file_megabytes(text_file));
+    oskar_timer_start(tmr);
+    oskar_sky_write(bin_file.c_str(), sky, status);
+    elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, "oskar_sky_write (binary)", elapsed,
+                s.num_sources, "sources", file_megabytes(bin_file));
+    oskar_sky_free(sky, status);
+
+    oskar_timer_start(tmr);
+    sky = oskar_sky_load(text_file.c_str(), s.prec, status);
+    elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, "oskar_sky_load (text)", elapsed,
+                s.num_sources, "sources", file_megabytes(text_file));
+    oskar_sky_free(sky, status);
+    oskar_timer_start(tmr);
+    sky = oskar_sky_read(bin_file.c_str(), OSKAR_CPU, status);
+    elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, "oskar_sky_read (binary)", elapsed,
+                s.num_sources, "sources", file_megabytes(bin_file));
+    oskar_sky_free(sky, status);
+}
+
+static void bench_vis_binary(Suite& s, const oskar_Telescope* t,
+        oskar_Timer* tmr, int* status)
+{
+    oskar_VisBlock* blk = 0;
+    oskar_VisHeader* hdr = create_vis(s, t, &blk, status);
+    if (*status) return;
+    const int num_blocks = oskar_vis_header_num_blocks(hdr);
+    const double num_vis = (double) s.num_times * s.num_channels *
+            oskar_vis_block_num_baselines(blk);
+    double elapsed = 0.0, megabytes = 0.0;
+
+    // Write, excluding the time taken to generate the coordinates.
+    oskar_Binary* h = oskar_vis_header_write(hdr, s.vis_file.c_str(), status);
+    for (int i = 0; i < num_blocks && !*status; ++i)
+    {
+        fill_uvw(s, t, blk, i, status);
+        oskar_timer_start(tmr);
+        oskar_vis_block_write(blk, h, i, status);
+        elapsed += oskar_timer_elapsed(tmr);
+        megabytes += vis_block_megabytes(blk);
+    }
+    oskar_binary_free(h);
+    if (!*status)
+        add_result(s, "oskar_vis_block_write (binary)", elapsed,
+                num_vis, "vis", megabytes);
+    oskar_vis_block_free(blk, status);
+    oskar_vis_header_free(hdr, status);
+
+    // Read.
+    oskar_timer_start(tmr);
+    h = oskar_binary_create(s.vis_file.c_str(), 'r', status);
+    hdr = oskar_vis_header_read(h, status);
+    blk = oskar_vis_block_create_from_header(OSKAR_CPU, hdr, status);
+    for (int i = 0; i < num_blocks && !*status; ++i)
+        oskar_vis_block_read(blk, hdr, h, i, status);
+    elapsed = oskar_timer_elapsed(tmr);
+    oskar_binary_free(h);
+    if (!*status)
+        add_result(s, "oskar_vis_block_read (binary)", elapsed,
+                num_vis, "vis", file_megabytes(s.vis_file));
+    oskar_vis_block_free(blk, status);
+    oskar_vis_header_free(hdr, status);
+}
+
+static void bench_vis_ms(Suite& s, const oskar_Telescope* t,
+        oskar_Timer* tmr, int* status)
+{
+#ifndef OSKAR_NO_MS
+    oskar_VisBlock* blk = 0;
+    oskar_VisHeader* hdr = create_vis(s, t, &blk, status);
+    if (*status) return;
+    const int num_blocks = oskar_vis_header_num_blocks(hdr);
+    const int num_baselines = oskar_vis_block_num_baselines(blk);
+    const double num_vis = (double) s.num_times * s.num_channels *
+            num_baselines;
+    double elapsed = 0.0, megabytes = 0.0;
+
+    // Write, excluding the time taken to generate the coordinates.
+    oskar_timer_start(tmr);
+    oskar_MeasurementSet* ms = oskar_vis_header_write_ms(hdr,
+            s.ms_file.c_str(), 1, 0, status);
+    elapsed += oskar_timer_elapsed(tmr);
+    for (int i = 0; i < num_blocks && !*status; ++i)
+    {
+        fill_uvw(s, t, blk, i, status);
+        oskar_timer_start(tmr);
+        oskar_vis_block_write_ms(blk, hdr, ms, status);
+        elapsed += oskar_timer_elapsed(tmr);
+        megabytes += vis_block_megabytes(blk);
+    }
+    oskar_timer_start(tmr);
+    oskar_ms_close(ms);
+    elapsed += oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, "oskar_vis_block_write_ms", elapsed,
+                num_vis, "vis", megabytes);
+
+    // Read the visibility amplitudes one time step at a time.
+    oskar_Mem* data = oskar_mem_create(s.prec | OSKAR_COMPLEX | OSKAR_MATRIX,
+            OSKAR_CPU, (size_t) num_baselines * s.num_channels, status);
+    oskar_timer_start(tmr);
+    ms = oskar_ms_open_readonly(s.ms_file.c_str());
+    if (!ms) *status = OSKAR_ERR_FILE_IO;
+    const unsigned int num_rows = ms ? oskar_ms_num_rows(ms) : 0;
+    for (unsigned int r = 0; r < num_rows && !*status; r += num_baselines)
+    {
+        if (s.prec == OSKAR_DOUBLE)
+            oskar_ms_read_vis_d(ms, r, 0, s.num_channels, num_baselines,
+                    "DATA", oskar_mem_double(data, status), status);
+        else
+            oskar_ms_read_vis_f(ms, r, 0, s.num_channels, num_baselines,
+                    "DATA", oskar_mem_float(data, status), status);
+    }
+    if (ms) oskar_ms_close(ms);
+    elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, "oskar_ms_read_vis", elapsed, num_vis, "vis",
+                num_vis * oskar_mem_element_size(oskar_mem_type(data)) /
+                (1024.0 * 1024.0));
+    oskar_mem_free(data, status);
+    oskar_vis_block_free(blk, status);
+    oskar_vis_header_free(hdr, status);
+#else
+    (void) s;
+    (void) t;
+    (void) tmr;
+    (void) status;
+    printf("%-40s skipped (built without casacore)\n", "Measurement Set I/O");
+#endif
+}
+
+static void bench_imager(Suite& s, const char* algorithm,
+        const char* weighting, oskar_Timer* tmr, int* status)
+{
+    const bool dft = !strncmp(algorithm, "DFT", 3);
+    const int size = dft ? s.dft_image_size : s.image_size;
+    const char* files[] = { s.vis_file.c_str() };
+    oskar_Mem* images[] = { 0 };
+    oskar_Imager* h = oskar_imager_create(s.prec, status);
+    oskar_log_set_term_priority(oskar_imager_log(h), OSKAR_LOG_NONE);
+    oskar_imager_set_input_files(h, 1, files, status);
+    oskar_imager_set_algorithm(h, algorithm, status);
+    oskar_imager_set_weighting(h, weighting, status);
+    oskar_imager_set_fov(h, 2.0);
+    oskar_imager_set_image_size(h, size, status);
+    if (!strncmp(algorithm, "W", 1) && s.num_w_planes > 0)
+        oskar_imager_set_num_w_planes(h, s.num_w_planes);
+    oskar_timer_start(tmr);
+    oskar_imager_run(h, 1, images, 0, 0, status);
+    const double elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+    {
+        const double num_vis = (double) s.num_times * s.num_channels *
+                s.num_stations * (s.num_stations - 1) / 2;
+        const string name = string("oskar_imager_run (") + algorithm +
+                ", " + weighting + ")";
+        add_result(s, name, elapsed, num_vis, "vis", 0.0);
+    }
+    oskar_mem_free(images[0], status);
+    oskar_imager_free(h, status);
+}
+
+static void bench_beam_pattern(Suite& s, const oskar_Telescope* t,
+        bool cross, oskar_Timer* tmr, int* status)
+{
+    const int station_ids[] = {0, 1};
+    const string root = path(s, cross ? "beam_cross" : "beam_auto");
+    oskar_BeamPattern* h = oskar_beam_pattern_create(s.prec, status);
+    oskar_log_set_term_priority(oskar_beam_pattern_log(h), OSKAR_LOG_NONE);
+    oskar_beam_pattern_set_observation_time(h, s.mjd, time_inc_sec,
+            s.num_times);
+    oskar_beam_pattern_set_observation_frequency(h, s.freq_hz, freq_inc_hz,
+            s.num_channels);
+    oskar_beam_pattern_set_image_size(h, s.beam_size, s.beam_size);
+    oskar_beam_pattern_set_image_fov(h, 180.0, 180.0);
+    oskar_beam_pattern_set_coordinate_frame(h, 'E');
+    oskar_beam_pattern_set_coordinate_type(h, 'B');
+    oskar_beam_pattern_set_station_ids(h, 2, station_ids);
+    oskar_beam_pattern_set_root_path(h, root.c_str());
+    if (cross)
+    {
+        oskar_beam_pattern_set_cross_power_amp_fits(h, 1);
+        oskar_beam_pattern_set_cross_power_raw_text(h, 1);
+    }
+    else
+    {
+        oskar_beam_pattern_set_auto_power_fits(h, 1);
+        oskar_beam_pattern_set_auto_power_text(h, 1);
+        oskar_beam_pattern_set_voltage_amp_text(h, 1);
+    }
+    oskar_beam_pattern_set_telescope_model(h, t, status);
+    oskar_timer_start(tmr);
+    oskar_beam_pattern_run(h, status);
+    const double elapsed = oskar_timer_elapsed(tmr);
+    if (!*status)
+        add_result(s, cross ? "oskar_beam_pattern_run (cross power)" :
+                "oskar_beam_pattern_run (auto power)", elapsed,
+                2.0 * s.beam_size * s.beam_size * s.num_times *
+                s.num_channels, "pixels", 0.0);
+    oskar_beam_pattern_free(h, status);
+}
+
+
+/* Output. */
+
+static void write_json(const Suite& s, const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if (!f) return;
+    fprintf(f, "{\n  \"version\": \"%s\",\n", OSKAR_VERSION_STR);
+    fprintf(f, "  \"precision\": \"%s\",\n",
+            s.prec == OSKAR_DOUBLE ? "double" : "single");
+    fprintf(f, "  \"num_stations\": %d,\n  \"num_elements\": %d,\n"
+            "  \"num_sources\": %d,\n  \"num_times\": %d,\n"
+            "  \"num_channels\": %d,\n  \"image_size\": %d,\n",
+            s.num_stations, s.num_elements, s.num_sources,
+            s.num_times, s.num_channels, s.image_size);
+    fprintf(f, "  \"results\": [");
+    for (size_t i = 0; i < s.results.size(); ++i)
+    {
+        const Result& r = s.results[i];
+        fprintf(f, "%s\n    {\"name\": \"%s\", \"seconds\": %.6f, "
+                "\"items\": %.0f, \"unit\": \"%s\", "
+                "\"items_per_sec\": %.6g, \"mb_per_sec\": %.6g}",
+                i > 0 ? "," : "", r.name.c_str(), r.seconds, r.items,
+                r.unit.c_str(), r.seconds > 0.0 ? r.items / r.seconds : 0.0,
+                r.seconds > 0.0 ? r.megabytes / r.seconds : 0.0);
+    }
+    fprintf(f, "\n  ]\n}\n");
+    fclose(f);
+}
+
+static void write_csv(const Suite& s, const char* filename)
+{
+    FILE* f = fopen(filename, "w");
+    if (!f) return;
+    fprintf(f, "name,seconds,items,unit,items_per_sec,mb_per_sec\n");
+    for (size_t i = 0; i < s.results.size(); ++i)
+    {
+        const Result& r = s.results[i];
+        fprintf(f, "\"%s\",%.6f,%.0f,%s,%.6g,%.6g\n", r.name.c_str(),
+                r.seconds, r.items, r.unit.c_str(),
+                r.seconds > 0.0 ? r.items / r.seconds : 0.0,
+                r.seconds > 0.0 ? r.megabytes / r.seconds : 0.0);
+    }
+    fclose(f);
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_benchmark_suite", OSKAR_VERSION_STR);
+    opt.set_description("Times the imager, beam pattern simulator and "
+            "file loaders using synthetic inputs.");
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-nst", "Number of stations", 1, "64", false);
+    opt.add_flag("-nel", "Number of elements per station", 1, "64", false);
+    opt.add_flag("-nsrc", "Number of sky model sources", 1, "100000", false);
+    opt.add_flag("-nt", "Number of time steps", 1, "16", false);
+    opt.add_flag("-nc", "Number of frequency channels", 1, "4", false);
+    opt.add_flag("-img", "Image size for FFT and W-projection", 1, "1024",
+            false);
+    opt.add_flag("-dft", "Image size for DFT", 1, "64", false);
+    opt.add_flag("-bp", "Beam pattern image size", 1, "64", false);
+    opt.add_flag("-wp", "Number of W-projection planes (0 = auto)", 1, "0",
+            false);
+    opt.add_flag("-dir", "Directory for synthetic data", 1,
+            "oskar_benchmark_data", false);
+    opt.add_flag("-keep", "Keep synthetic data after the run");
+    opt.add_flag("-json", "Write results to this JSON file", 1, "", false);
+    opt.add_flag("-csv", "Write results to this CSV file", 1, "", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    Suite s;
+    s.prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    s.num_stations = opt.get_int("-nst");
+    s.num_elements = opt.get_int("-nel");
+    s.num_sources = opt.get_int("-nsrc");
+    s.num_times = opt.get_int("-nt");
+    s.num_channels = opt.get_int("-nc");
+    s.image_size = opt.get_int("-img");
+    s.dft_image_size = opt.get_int("-dft");
+    s.beam_size = opt.get_int("-bp");
+    s.num_w_planes = opt.get_int("-wp");
+    s.freq_hz = 100e6;
+    s.ra_deg = 20.0;
+    s.dec_deg = -30.0;
+    s.lon_deg = 21.44;
+    s.lat_deg = -30.7;
+    s.mjd = 58000.0;
+    s.dir = opt.get_string("-dir");
+    s.tel_dir = path(s, "telescope.tm");
+    s.vis_file = path(s, "vis.vis");
+    s.ms_file = path(s, "vis.ms");
+    if (s.num_stations < 2 || s.num_elements < 1 || s.num_sources < 1 ||
+            s.num_times < 1 || s.num_channels < 1)
+    {
+        fprintf(stderr, "ERROR: Invalid benchmark dimensions.\n");
+        return EXIT_FAILURE;
+    }
+    if (oskar_dir_exists(s.dir.c_str()))
+    {
+        fprintf(stderr, "ERROR: Directory '%s' already exists.\n",
+                s.dir.c_str());
+        return EXIT_FAILURE;
+    }
+    oskar_dir_mkpath(s.dir.c_str());
+    printf("OSKAR benchmark suite (%s precision): %d stations, "
+            "%d elements/station, %d sources, %d times, %d channels\n",
+            s.prec == OSKAR_DOUBLE ? "double" : "single", s.num_stations,
+            s.num_elements, s.num_sources, s.num_times, s.num_channels);
+
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    write_telescope(s);
+    bench_telescope(s, tmr, &status);
+    oskar_Telescope* t = load_telescope(s, &status);
+    bench_sky(s, tmr, &status);
+    bench_vis_binary(s, t, tmr, &status);
+    bench_vis_ms(s, t, tmr, &status);
+    const char* algorithms[] = {"FFT", "W-projection", "DFT 2D"};
+    const char* weightings[] = {"Natural", "Uniform"};
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 2; ++j)
+            bench_imager(s, algorithms[i], weightings[j], tmr, &status);
+    bench_beam_pattern(s, t, false, tmr, &status);
+    bench_beam_pattern(s, t, true, tmr, &status);
+    oskar_telescope_free(t, &status);
+    oskar_timer_free(tmr);
+
+    if (strlen(opt.get_string("-json")) > 0)
+        write_json(s, opt.get_string("-json"));
+    if (strlen(opt.get_string("-csv")) > 0)
+        write_csv(s, opt.get_string("-csv"));
+    if (!opt.is_set("-keep"))
+        oskar_dir_remove(s.dir.c_str());
+    if (status)
+    {
+        fprintf(stderr, "ERROR: Benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#!/bin/bash
+
+###############################################################################
+#
+# Description:
+#   Tests the combination of visibility files.
+#
+# Method:
+#   1. Generate two OSKAR visibility binary files of the same observation,
+#      written using different numbers of times and channels per block.
+#   2. Combine the first file with itself, which is done one block at a time.
+#   3. Combine the first file with the second, which have different block
+#      dimensions, so the overlapping parts of each block are combined.
+#   4. Check that both combined files contain the same visibilities.
+#
+###############################################################################
+
+source @OSKAR_BINARY_DIR@/apps/test/test_utility.sh
+
+echo "Running OSKAR test of visibility file combination"
+echo ""
+echo "  * Example data directory = $example_data_dir"
+echo ""
+
+# Move into the example data directory
+cd "${example_data_dir}"
+
+app_sim=${oskar_app_path}/oskar_sim_interferometer
+app_add=${oskar_app_path}/oskar_vis_add
+app_table=${oskar_app_path}/oskar_vis_to_ascii_table
+ini_sim=oskar_sim_interferometer.ini
+set_setting $app_sim $ini_sim sky/oskar_sky_model/file sky.osm
+set_setting $app_sim $ini_sim simulator/keep_log_file false
+set_setting $app_sim $ini_sim simulator/use_gpus false
+set_setting $app_sim $ini_sim telescope/input_directory telescope.tm
+set_setting $app_sim $ini_sim observation/num_time_steps 10
+
+# Run the interferometry simulations.
+echo "Starting interferometry simulations"
+T0="$(date +%s)"
+set_setting $app_sim $ini_sim interferometer/max_time_samples_per_block 4
+set_setting $app_sim $ini_sim interferometer/max_channels_per_block 3
+set_setting $app_sim $ini_sim interferometer/oskar_vis_filename vis_add_a.vis
+run_sim_interferometer -q $ini_sim
+set_setting $app_sim $ini_sim interferometer/max_time_samples_per_block 3
+set_setting $app_sim $ini_sim interferometer/max_channels_per_block 2
+set_setting $app_sim $ini_sim interferometer/oskar_vis_filename vis_add_b.vis
+run_sim_interferometer -q $ini_sim
+echo "  Finished in $(($(date +%s)-T0)) s"
+echo ""
+
+# Combine the files.
+echo "Combining visibility files"
+if ! $app_add -q -o vis_add_aa.vis vis_add_a.vis vis_add_a.vis; then
+    echo "ERROR: Failed to combine files with the same block dimensions."
+    exit_ 1
+fi
+if ! $app_add -q -o vis_add_ab.vis vis_add_a.vis vis_add_b.vis; then
+    echo "ERROR: Failed to combine files with different block dimensions."
+    exit_ 1
+fi
+
+# Compare the combined visibilities and coordinates in every channel.
+# Channels simulated in different blocks can differ by rounding errors.
+for c in 0 1 2; do
+    if ! paste <($app_table -s -c $c vis_add_aa.vis) \
+            <($app_table -s -c $c vis_add_ab.vis) | awk '
+            { for (i = 2; i <= 6; ++i) {
+                d = $i - $(i + 6); a = $i; if (d < 0) d = -d; if (a < 0) a = -a;
+                if (d > 1e-5 * (1 + a)) bad++ } }
+            END { exit (NR == 0 || bad > 0) }'; then
+        echo "ERROR: Combined visibilities differ in channel $c."
+        exit_ 1
+    fi
+done
+
+echo ""
+echo "-------------------------------------------------------------------------"
+echo "Test passed!"
+echo "-------------------------------------------------------------------------"
+echo ""
@@ -77,6 +77,7 @@ oskar_Imager* oskar_settings_to_imager(oskar::SettingsTree* s,
             s->to_int("scale_norm_with_num_input_files", status));
     oskar_imager_set_ms_column(h,
             s->to_string("ms_column", status), status);
+    oskar_imager_set_coords_cache(h, s->to_int("cache_coords", status));
     oskar_imager_set_output_root(h, s->to_string("root_path", status));
 
     // Set remaining imager options.
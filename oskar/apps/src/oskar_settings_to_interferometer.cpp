@@ -100,6 +100,19 @@ oskar_Interferometer* oskar_settings_to_interferometer(oskar::SettingsTree* s,
             s->to_int("num_channels", status));
     s->end_group();
 
+    // Set ionosphere settings.
+    s->begin_group("ionosphere");
+    if (s->to_int("enable", status))
+    {
+        int num_files = 0;
+        const char* const* files =
+                s->to_string_list("TID_file", &num_files, status);
+        oskar_interferometer_set_ionosphere(h, 1,
+                s->to_double("min_elevation_deg", status),
+                s->to_double("TEC0", status), num_files, files, status);
+    }
+    s->end_group();
+
     // Return handle to interferometer simulator.
     s->clear_group();
     return h;
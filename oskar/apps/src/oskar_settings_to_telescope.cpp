@@ -329,6 +329,7 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
     oskar_station_set_normalise_element_pattern(station,
             s->to_int("normalise", status));
     oskar_station_set_swap_xy(station, s->to_int("swap_xy", status));
+    int interpolate_freq = s->to_int("interpolate_frequency", status);
     double dipole_length = s->to_double("dipole_length", status);
     char units = s->first_letter("dipole_length_units", status);
     char functional_type = s->first_letter("functional_type", status);
@@ -343,6 +344,7 @@ void set_station_data(oskar_Station* station, SettingsTree* s, int* status)
         oskar_element_set_taper_type(element, &taper_type, status);
         oskar_element_set_cosine_power(element, cosine_power);
         oskar_element_set_gaussian_fwhm_rad(element, fwhm_rad);
+        oskar_element_set_interpolate_freq(element, interpolate_freq);
     }
 
     /* Recursively set data for child stations. */
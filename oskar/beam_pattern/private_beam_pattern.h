@@ -29,6 +29,7 @@
 #include <log/oskar_log.h>
 #include <mem/oskar_mem.h>
 #include <telescope/oskar_telescope.h>
+#include <utility/oskar_fits_writer.h>
 #include <utility/oskar_timer.h>
 #include <utility/oskar_thread.h>
 
@@ -79,8 +80,10 @@ struct DataProduct
     int i_station;
     int time_average;
     int channel_average;
-    fitsfile* fits_file;
+    oskar_FitsWriter* fits_file;
     FILE* text_file;
+    oskar_Mem* pix; /* Real-valued pixel array to write to file. */
+    oskar_Mem* ctemp; /* Complex-valued array used for reordering. */
 };
 typedef struct DataProduct DataProduct;
 
@@ -121,10 +124,6 @@ struct oskar_BeamPattern
     oskar_Mem *x, *y, *z;
     oskar_Telescope* tel;
 
-    /* Temporary arrays. */
-    oskar_Mem* pix; /* Real-valued pixel array to write to file. */
-    oskar_Mem* ctemp; /* Complex-valued array used for reordering. */
-
     /* Settings log data. */
     char* settings_log;
     size_t settings_log_length;
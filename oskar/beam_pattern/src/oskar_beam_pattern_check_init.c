@@ -110,15 +110,6 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
     /* Work out how many pixel chunks have to be processed. */
     h->num_chunks = (h->num_pixels + h->max_chunk_size - 1) / h->max_chunk_size;
 
-    /* Create scratch arrays for output pixel data. */
-    if (!h->pix)
-    {
-        h->pix = oskar_mem_create(h->prec, OSKAR_CPU,
-                h->max_chunk_size, status);
-        h->ctemp = oskar_mem_create(h->prec | OSKAR_COMPLEX, OSKAR_CPU,
-                h->max_chunk_size, status);
-    }
-
     /* Get the contents of the log at this point so we can write a
      * reasonable file header. Replace newlines with zeros. */
     h->settings_log_length = 0;
@@ -194,6 +185,17 @@ static void set_up_host_data(oskar_BeamPattern* h, int *status)
     else if (h->average_single_axis == 'T')
         create_averaged_products(h, 1, 0, status);
 
+    /* Create scratch arrays for the output pixel data of each product,
+     * so that the products can be written concurrently. */
+    for (i = 0; i < h->num_data_products; ++i)
+    {
+        DataProduct* p = &h->data_products[i];
+        p->pix = oskar_mem_create(h->prec, OSKAR_CPU,
+                h->max_chunk_size, status);
+        p->ctemp = oskar_mem_create(h->prec | OSKAR_COMPLEX, OSKAR_CPU,
+                h->max_chunk_size, status);
+    }
+
     /* Check that at least one output file will be generated. */
     if (h->num_data_products == 0 && !*status)
     {
@@ -482,7 +484,7 @@ static void new_fits_file(oskar_BeamPattern* h, int data_product_type,
     }
     i = data_product_index(h, data_product_type, stokes_in, stokes_out,
             i_station, time_average, channel_average);
-    h->data_products[i].fits_file = f;
+    h->data_products[i].fits_file = oskar_fits_writer_create(&f, status);
     free(name);
 }
 
@@ -33,8 +33,6 @@
 #include <stdlib.h>
 #include <stdio.h>
 
-#include <fitsio.h>
-
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -46,17 +44,16 @@ void oskar_beam_pattern_reset_cache(oskar_BeamPattern* h, int* status)
     oskar_mem_free(h->x, status);
     oskar_mem_free(h->y, status);
     oskar_mem_free(h->z, status);
-    oskar_mem_free(h->pix, status);
-    oskar_mem_free(h->ctemp, status);
-    h->x = h->y = h->z = h->pix = h->ctemp = NULL;
+    h->x = h->y = h->z = NULL;
 
     /* Close files and free data products. */
     for (i = 0; i < h->num_data_products; ++i)
     {
         if (h->data_products[i].text_file)
             fclose(h->data_products[i].text_file);
-        if (h->data_products[i].fits_file)
-            ffclos(h->data_products[i].fits_file, status);
+        oskar_fits_writer_free(h->data_products[i].fits_file, 0, status);
+        oskar_mem_free(h->data_products[i].pix, status);
+        oskar_mem_free(h->data_products[i].ctemp, status);
     }
     free(h->data_products);
     h->data_products = NULL;
@@ -30,7 +30,7 @@
 #include "beam_pattern/private_beam_pattern.h"
 #include "convert/oskar_convert_mjd_to_gast_fast.h"
 #include "correlate/oskar_evaluate_auto_power.h"
-#include "correlate/oskar_evaluate_cross_power.h"
+#include "correlate/oskar_evaluate_cross_power_multi.h"
 #include "telescope/station/oskar_evaluate_station_beam.h"
 #include "math/oskar_cmath.h"
 #include "math/private_cond2_2x2.h"
@@ -43,7 +43,6 @@
 #include <stdlib.h>
 #include <string.h>
 
-#include <fitsio.h>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -61,6 +60,10 @@ static void write_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
 static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
         const oskar_Mem* in, int chunk_desc, int stokes_in, int* status);
+static int convert_pixels(const oskar_BeamPattern* h, DataProduct* p,
+        int num_pix, const oskar_Mem* in, int chunk_desc, int* status);
+static void accumulate_averages(const oskar_Mem* in, oskar_Mem* avg1,
+        oskar_Mem* avg2, oskar_Mem* avg3, int num_elements, int* status);
 static void complex_to_amp(const oskar_Mem* complex_in, const int offset,
         const int stride, const int num_points, oskar_Mem* output, int* status);
 static void complex_to_phase(const oskar_Mem* complex_in, const int offset,
@@ -336,18 +339,23 @@ static void sim_chunks(oskar_BeamPattern* h, int i_chunk_start, int i_time,
                     h->test_source_stokes[3],
                     offset, d->auto_power[1], status);
     }
-    if (d->cross_power[0])
-        oskar_evaluate_cross_power(chunk_size, h->num_active_stations,
-                d->jones_data, 1.0, 0.0, 0.0, 0.0,
-                0, d->cross_power[0], status);
-    if (d->cross_power[1])
-        oskar_evaluate_cross_power(chunk_size, h->num_active_stations,
-                d->jones_data,
-                h->test_source_stokes[0],
-                h->test_source_stokes[1],
-                h->test_source_stokes[2],
-                h->test_source_stokes[3],
-                0, d->cross_power[1], status);
+    if (d->cross_power[0] || d->cross_power[1])
+    {
+        /* Evaluate all required cross-power products together. */
+        int num_sets = 0;
+        oskar_Mem* cross_power[2];
+        double stokes[8] = {1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        if (d->cross_power[0])
+            cross_power[num_sets++] = d->cross_power[0];
+        if (d->cross_power[1])
+        {
+            for (i = 0; i < 4; ++i)
+                stokes[4 * num_sets + i] = h->test_source_stokes[i];
+            cross_power[num_sets++] = d->cross_power[1];
+        }
+        oskar_evaluate_cross_power_multi(chunk_size, h->num_active_stations,
+                d->jones_data, num_sets, stokes, 0, cross_power, status);
+    }
 
     /* Copy the output data into host memory. */
     if (d->jones_data_cpu[i_active])
@@ -412,41 +420,17 @@ static void write_chunks(oskar_BeamPattern* h, int i_chunk_start,
                     d->cross_power_cpu[stokes][!i_active],
                     CROSS_POWER_DATA, stokes, status);
 
-            /* Time-average the data if required. */
-            if (d->auto_power_time_avg[stokes])
-                oskar_mem_add(d->auto_power_time_avg[stokes],
-                        d->auto_power_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_time_avg[stokes])
-                oskar_mem_add(d->cross_power_time_avg[stokes],
-                        d->cross_power_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Channel-average the data if required. */
-            if (d->auto_power_channel_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_avg[stokes],
-                        d->auto_power_channel_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_channel_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_avg[stokes],
-                        d->cross_power_channel_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
-
-            /* Channel- and time-average the data if required. */
-            if (d->auto_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_channel_and_time_avg[stokes],
-                        d->auto_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_size, status);
-            if (d->cross_power_channel_and_time_avg[stokes])
-                oskar_mem_add(d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_channel_and_time_avg[stokes],
-                        d->cross_power_cpu[stokes][!i_active],
-                        0, 0, 0, chunk_sources, status);
+            /* Accumulate all running averages in a single pass. */
+            accumulate_averages(d->auto_power_cpu[stokes][!i_active],
+                    d->auto_power_time_avg[stokes],
+                    d->auto_power_channel_avg[stokes],
+                    d->auto_power_channel_and_time_avg[stokes],
+                    chunk_size, status);
+            accumulate_averages(d->cross_power_cpu[stokes][!i_active],
+                    d->cross_power_time_avg[stokes],
+                    d->cross_power_channel_avg[stokes],
+                    d->cross_power_channel_and_time_avg[stokes],
+                    chunk_sources, status);
 
             /* Write time-averaged data. */
             if (i_time == h->num_time_steps - 1)
@@ -535,120 +519,181 @@ static void write_chunks(oskar_BeamPattern* h, int i_chunk_start,
 }
 
 
+/*
+ * The pixels of each data product are converted into the product's own
+ * buffer, so the FITS files can be written concurrently. The text files
+ * are written afterwards, in the order of the data products.
+ */
 static void write_pixels(oskar_BeamPattern* h, int i_chunk, int i_time,
         int i_channel, int num_pix, int channel_average, int time_average,
         const oskar_Mem* in, int chunk_desc, int stokes_in, int* status)
 {
     int i;
-    if (!in) return;
+    if (!in || *status) return;
+    const int num_products = h->num_data_products;
+    int* product_status = (int*) calloc(num_products, sizeof(int));
+    int* have_pix = (int*) calloc(num_products, sizeof(int));
+
+    /* Convert and write FITS data for all products in parallel. */
+#pragma omp parallel for private(i) schedule(dynamic, 1)
+    for (i = 0; i < num_products; ++i)
+    {
+        DataProduct* p = &h->data_products[i];
+        if (p->time_average != time_average ||
+                p->channel_average != channel_average ||
+                p->stokes_in != stokes_in)
+            continue;
+        have_pix[i] = convert_pixels(h, p, num_pix, in, chunk_desc,
+                &product_status[i]);
+        if (have_pix[i] && p->fits_file && h->width && h->height)
+        {
+            long firstpix[4];
+            firstpix[0] = 1 + (i_chunk * h->max_chunk_size) % h->width;
+            firstpix[1] = 1 + (i_chunk * h->max_chunk_size) / h->width;
+            firstpix[2] = 1 + i_channel;
+            firstpix[3] = 1 + i_time;
+            oskar_fits_writer_write(p->fits_file, firstpix, num_pix, p->pix,
+                    0, &product_status[i]);
+        }
+    }
 
-    /* Loop over data products. */
-    const int num_pol = h->pol_mode == OSKAR_POL_MODE_FULL ? 4 : 1;
-    for (i = 0; i < h->num_data_products; ++i)
-    {
-        fitsfile* f;
-        FILE* t;
-        int dp, stokes_out, i_station, off;
-
-        /* Get data product info. */
-        f          = h->data_products[i].fits_file;
-        t          = h->data_products[i].text_file;
-        dp         = h->data_products[i].type;
-        stokes_out = h->data_products[i].stokes_out;
-        i_station  = h->data_products[i].i_station;
-
-        /* Check averaging mode and polarisation input type. */
-        if (h->data_products[i].time_average != time_average ||
-                h->data_products[i].channel_average != channel_average ||
-                h->data_products[i].stokes_in != stokes_in)
+    /* Write text data in order. */
+    for (i = 0; i < num_products; ++i)
+    {
+        DataProduct* p = &h->data_products[i];
+        if (product_status[i] && !*status) *status = product_status[i];
+        if (!p->text_file || *status ||
+                p->time_average != time_average ||
+                p->channel_average != channel_average ||
+                p->stokes_in != stokes_in)
             continue;
 
         /* Treat raw data output as special case, as it doesn't go via pix. */
-        if (dp == RAW_COMPLEX && chunk_desc == JONES_DATA && t)
+        if (p->type == RAW_COMPLEX && chunk_desc == JONES_DATA)
         {
             oskar_Mem* station_data;
-            station_data = oskar_mem_create_alias(in, i_station * num_pix,
+            station_data = oskar_mem_create_alias(in, p->i_station * num_pix,
                     num_pix, status);
-            oskar_mem_save_ascii(t, 1, 0, num_pix, status, station_data);
+            oskar_mem_save_ascii(p->text_file, 1, 0, num_pix, status,
+                    station_data);
             oskar_mem_free(station_data, status);
-            continue;
-        }
-        if (dp == CROSS_POWER_RAW_COMPLEX &&
-                chunk_desc == CROSS_POWER_DATA && t)
-        {
-            oskar_mem_save_ascii(t, 1, 0, num_pix, status, in);
-            continue;
-        }
-
-        /* Convert complex values to pixel data. */
-        oskar_mem_clear_contents(h->pix, status);
-        if (chunk_desc == JONES_DATA && dp == AMP)
-        {
-            off = i_station * num_pix * num_pol;
-            if (stokes_out == XX || stokes_out == -1)
-                complex_to_amp(in, off, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == XY)
-                complex_to_amp(in, off + 1, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YX)
-                complex_to_amp(in, off + 2, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YY)
-                complex_to_amp(in, off + 3, num_pol, num_pix, h->pix, status);
-            else continue;
         }
-        else if (chunk_desc == JONES_DATA && dp == PHASE)
-        {
-            off = i_station * num_pix * num_pol;
-            if (stokes_out == XX || stokes_out == -1)
-                complex_to_phase(in, off, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == XY)
-                complex_to_phase(in, off + 1, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YX)
-                complex_to_phase(in, off + 2, num_pol, num_pix, h->pix, status);
-            else if (stokes_out == YY)
-                complex_to_phase(in, off + 3, num_pol, num_pix, h->pix, status);
-            else continue;
-        }
-        else if (chunk_desc == JONES_DATA && dp == IXR)
-            jones_to_ixr(in, i_station * num_pix, num_pix, h->pix, status);
-        else if (chunk_desc == AUTO_POWER_DATA ||
+        else if (p->type == CROSS_POWER_RAW_COMPLEX &&
                 chunk_desc == CROSS_POWER_DATA)
+            oskar_mem_save_ascii(p->text_file, 1, 0, num_pix, status, in);
+        else if (have_pix[i])
+            oskar_mem_save_ascii(p->text_file, 1, 0, num_pix, status, p->pix);
+    }
+    free(product_status);
+    free(have_pix);
+}
+
+
+/*
+ * Converts complex values to the pixel data of a product, if required.
+ * Returns 1 if the pixel data were generated, otherwise 0.
+ */
+static int convert_pixels(const oskar_BeamPattern* h, DataProduct* p,
+        int num_pix, const oskar_Mem* in, int chunk_desc, int* status)
+{
+    int off;
+    const int dp = p->type, stokes_out = p->stokes_out;
+    const int i_station = p->i_station;
+    const int num_pol = h->pol_mode == OSKAR_POL_MODE_FULL ? 4 : 1;
+    oskar_Mem* pix = p->pix;
+    if (dp == RAW_COMPLEX || dp == CROSS_POWER_RAW_COMPLEX) return 0;
+    oskar_mem_clear_contents(pix, status);
+    if (chunk_desc == JONES_DATA && dp == AMP)
+    {
+        off = i_station * num_pix * num_pol;
+        if (stokes_out == XX || stokes_out == -1)
+            complex_to_amp(in, off, num_pol, num_pix, pix, status);
+        else if (stokes_out == XY)
+            complex_to_amp(in, off + 1, num_pol, num_pix, pix, status);
+        else if (stokes_out == YX)
+            complex_to_amp(in, off + 2, num_pol, num_pix, pix, status);
+        else if (stokes_out == YY)
+            complex_to_amp(in, off + 3, num_pol, num_pix, pix, status);
+        else return 0;
+    }
+    else if (chunk_desc == JONES_DATA && dp == PHASE)
+    {
+        off = i_station * num_pix * num_pol;
+        if (stokes_out == XX || stokes_out == -1)
+            complex_to_phase(in, off, num_pol, num_pix, pix, status);
+        else if (stokes_out == XY)
+            complex_to_phase(in, off + 1, num_pol, num_pix, pix, status);
+        else if (stokes_out == YX)
+            complex_to_phase(in, off + 2, num_pol, num_pix, pix, status);
+        else if (stokes_out == YY)
+            complex_to_phase(in, off + 3, num_pol, num_pix, pix, status);
+        else return 0;
+    }
+    else if (chunk_desc == JONES_DATA && dp == IXR)
+        jones_to_ixr(in, i_station * num_pix, num_pix, pix, status);
+    else if (chunk_desc == AUTO_POWER_DATA || chunk_desc == CROSS_POWER_DATA)
+    {
+        off = i_station * num_pix; /* Station offset. */
+        if (off < 0 || chunk_desc == CROSS_POWER_DATA) off = 0;
+        if (chunk_desc == CROSS_POWER_DATA && (dp & AUTO_POWER))
+            return 0;
+        if (chunk_desc == AUTO_POWER_DATA && (dp & CROSS_POWER))
+            return 0;
+        if (stokes_out >= I && stokes_out <= V)
+            oskar_convert_linear_to_stokes(num_pix, off, in,
+                    stokes_out, p->ctemp, status);
+        else return 0;
+        if (dp & AMP)
+            complex_to_amp(p->ctemp, 0, 1, num_pix, pix, status);
+        else if (dp & PHASE)
+            complex_to_phase(p->ctemp, 0, 1, num_pix, pix, status);
+        else if (dp & REAL)
+            complex_to_real(p->ctemp, 0, 1, num_pix, pix, status);
+        else if (dp & IMAG)
+            complex_to_imag(p->ctemp, 0, 1, num_pix, pix, status);
+        else return 0;
+    }
+    else return 0;
+    return 1;
+}
+
+
+static void accumulate_averages(const oskar_Mem* in, oskar_Mem* avg1,
+        oskar_Mem* avg2, oskar_Mem* avg3, int num_elements, int* status)
+{
+    int i, j, num_avg = 0;
+    oskar_Mem* avg[3];
+    if (!in || *status) return;
+    if (avg1) avg[num_avg++] = avg1;
+    if (avg2) avg[num_avg++] = avg2;
+    if (avg3) avg[num_avg++] = avg3;
+    if (num_avg == 0) return;
+
+    /* Treat the data as an array of real values. */
+    const int prec = oskar_mem_precision(in);
+    const int num = num_elements * (int) (oskar_mem_element_size(
+            oskar_mem_type(in)) / oskar_mem_element_size(prec));
+    if (prec == OSKAR_SINGLE)
+    {
+        float* out[3];
+        const float* in_ = (const float*) oskar_mem_void_const(in);
+        for (j = 0; j < num_avg; ++j) out[j] = (float*) oskar_mem_void(avg[j]);
+        for (i = 0; i < num; ++i)
         {
-            off = i_station * num_pix; /* Station offset. */
-            if (off < 0 || chunk_desc == CROSS_POWER_DATA) off = 0;
-            if (chunk_desc == CROSS_POWER_DATA && (dp & AUTO_POWER))
-                continue;
-            if (chunk_desc == AUTO_POWER_DATA && (dp & CROSS_POWER))
-                continue;
-            if (stokes_out >= I && stokes_out <= V)
-                oskar_convert_linear_to_stokes(num_pix, off, in,
-                        stokes_out, h->ctemp, status);
-            else continue;
-            if (dp & AMP)
-                complex_to_amp(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & PHASE)
-                complex_to_phase(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & REAL)
-                complex_to_real(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else if (dp & IMAG)
-                complex_to_imag(h->ctemp, 0, 1, num_pix, h->pix, status);
-            else continue;
+            const float val = in_[i];
+            for (j = 0; j < num_avg; ++j) out[j][i] += val;
         }
-        else continue;
-
-        /* Check for FITS file. */
-        if (f && h->width && h->height)
+    }
+    else
+    {
+        double* out[3];
+        const double* in_ = (const double*) oskar_mem_void_const(in);
+        for (j = 0; j < num_avg; ++j) out[j] = (double*) oskar_mem_void(avg[j]);
+        for (i = 0; i < num; ++i)
         {
-            long firstpix[4];
-            firstpix[0] = 1 + (i_chunk * h->max_chunk_size) % h->width;
-            firstpix[1] = 1 + (i_chunk * h->max_chunk_size) / h->width;
-            firstpix[2] = 1 + i_channel;
-            firstpix[3] = 1 + i_time;
-            fits_write_pix(f, (h->prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT),
-                    firstpix, num_pix, oskar_mem_void(h->pix), status);
+            const double val = in_[i];
+            for (j = 0; j < num_avg; ++j) out[j][i] += val;
         }
-
-        /* Check for text file. */
-        if (t) oskar_mem_save_ascii(t, 1, 0, num_pix, status, h->pix);
     }
 }
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "correlate/oskar_evaluate_cross_power.h"
+#include "correlate/oskar_evaluate_cross_power_multi.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_cross_power_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-nst", "Number of stations.", 1, "512", false);
+    opt.add_flag("-npix", "Number of pixels in the beam pattern chunk.",
+            1, "16384", false);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-s", "Use scalar Jones terms (default: matrix/polarised).");
+    opt.add_flag("-n", "Number of iterations", 1, "1", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const int num_stations = opt.get_int("-nst");
+    const int num_pixels = opt.get_int("-npix");
+    const int niter = opt.get_int("-n");
+    int type = (opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE);
+    type |= OSKAR_COMPLEX;
+    if (!opt.is_set("-s"))
+        type |= OSKAR_MATRIX;
+
+    // Station beams for all pixels, with unpolarised and polarised sources,
+    // as used by the beam pattern simulator.
+    const double stokes[] = {1.0, 0.0, 0.0, 0.0, 1.0, 0.2, 0.1, 0.05};
+    oskar_Mem* jones = oskar_mem_create(type, OSKAR_CPU,
+            (size_t) num_stations * num_pixels, &status);
+    oskar_Mem* out[2], *out_ref[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        out[i] = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+        out_ref[i] = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    }
+    srand(2);
+    oskar_mem_random_range(jones, -1.0, 1.0, &status);
+
+    // Time the separate evaluation of each cross-power product.
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(timer);
+    for (int j = 0; j < niter; ++j)
+        for (int i = 0; i < 2; ++i)
+            oskar_evaluate_cross_power(num_pixels, num_stations, jones,
+                    stokes[4 * i], stokes[4 * i + 1],
+                    stokes[4 * i + 2], stokes[4 * i + 3],
+                    0, out_ref[i], &status);
+    const double time_ref = oskar_timer_elapsed(timer) / niter;
+
+    // Time the fused evaluation.
+    oskar_timer_start(timer);
+    for (int j = 0; j < niter; ++j)
+        oskar_evaluate_cross_power_multi(num_pixels, num_stations, jones,
+                2, stokes, 0, out, &status);
+    const double time_multi = oskar_timer_elapsed(timer) / niter;
+
+    // Compare results.
+    double max_rel_error = 0.0;
+    for (int i = 0; i < 2; ++i)
+    {
+        double min_err = 0.0, max_err = 0.0, avg_err = 0.0, std_err = 0.0;
+        oskar_mem_evaluate_relative_error(out[i], out_ref[i],
+                &min_err, &max_err, &avg_err, &std_err, &status);
+        if (max_err > max_rel_error) max_rel_error = max_err;
+    }
+    oskar_timer_free(timer);
+    oskar_mem_free(jones, &status);
+    for (int i = 0; i < 2; ++i)
+    {
+        oskar_mem_free(out[i], &status);
+        oskar_mem_free(out_ref[i], &status);
+    }
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    printf("Stations: %d, pixels: %d\n", num_stations, num_pixels);
+    printf("Separate cross-power products: %.4f sec\n", time_ref);
+    printf("Fused cross-power products:    %.4f sec\n", time_multi);
+    printf("Maximum relative difference:   %.3e\n", max_rel_error);
+    return EXIT_SUCCESS;
+}
@@ -74,6 +74,7 @@ void oskar_convert_enu_directions_to_theta_phi(int offset_in, int num_points,
     else
     {
         size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        static int handle[2]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         const int is_dbl = oskar_mem_is_double(theta);
         if (type == OSKAR_SINGLE)
@@ -85,6 +86,8 @@ void oskar_convert_enu_directions_to_theta_phi(int offset_in, int num_points,
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(
+                &handle[is_dbl], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = oskar_device_global_size(
                 (size_t) num_points, local_size[0]);
@@ -103,7 +106,8 @@ void oskar_convert_enu_directions_to_theta_phi(int offset_in, int num_points,
                 {PTR_SZ, oskar_mem_buffer(phi1)},
                 {PTR_SZ, oskar_mem_buffer(phi2)}
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 }
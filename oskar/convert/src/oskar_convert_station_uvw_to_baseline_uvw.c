@@ -28,25 +28,33 @@
 
 #include "convert/oskar_convert_station_uvw_to_baseline_uvw.h"
 #include "utility/oskar_device.h"
+#include "utility/oskar_kernel_macros.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Each station pair is independent, so the outer loop is run in parallel.
+ * The inner loop is over contiguous memory and can be vectorised. */
 #define CONVERT_STATION_TO_BASELINE(NAME, FP) static void NAME(\
         const int num_stations,\
         const int offset_in, const FP *u, const FP *v, const FP *w,\
         const int offset_out, FP *uu, FP *vv, FP *ww)\
 {\
-    int s1, s2, b;\
-    for (s1 = 0, b = 0; s1 < num_stations; ++s1) {\
-        const int i1 = s1 + offset_in;\
-        for (s2 = s1 + 1; s2 < num_stations; ++s2, ++b) {\
-            const int i2 = s2 + offset_in;\
-            const int out = b + offset_out;\
-            uu[out] = u[i2] - u[i1];\
-            vv[out] = v[i2] - v[i1];\
-            ww[out] = w[i2] - w[i1];\
+    int s1;\
+    DO_PRAGMA(omp parallel for private(s1) schedule(dynamic)) \
+    for (s1 = 0; s1 < num_stations; ++s1) {\
+        int s2;\
+        const FP u1 = u[s1 + offset_in];\
+        const FP v1 = v[s1 + offset_in];\
+        const FP w1 = w[s1 + offset_in];\
+        const FP *u2 = u + offset_in, *v2 = v + offset_in, *w2 = w + offset_in;\
+        const int b0 = s1 * (num_stations - 1) - (s1 - 1) * s1 / 2 - s1 - 1 +\
+                offset_out;\
+        for (s2 = s1 + 1; s2 < num_stations; ++s2) {\
+            uu[b0 + s2] = u2[s2] - u1;\
+            vv[b0 + s2] = v2[s2] - v1;\
+            ww[b0 + s2] = w2[s2] - w1;\
         }\
     }\
 }
@@ -68,6 +68,7 @@ void oskar_convert_theta_phi_to_ludwig3_components(
     else
     {
         size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        static int handle[2]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         if (type == OSKAR_SINGLE)
             k = "convert_theta_phi_to_ludwig3_float";
@@ -78,6 +79,8 @@ void oskar_convert_theta_phi_to_ludwig3_components(
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(
+                &handle[type == OSKAR_DOUBLE], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = oskar_device_global_size(
                 (size_t) num_points, local_size[0]);
@@ -89,7 +92,8 @@ void oskar_convert_theta_phi_to_ludwig3_components(
                 {INT_SZ, &offset},
                 {PTR_SZ, oskar_mem_buffer(jones)}
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 }
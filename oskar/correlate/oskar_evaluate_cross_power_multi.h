@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_EVALUATE_CROSS_POWER_MULTI_H_
+#define OSKAR_EVALUATE_CROSS_POWER_MULTI_H_
+
+/**
+ * @file oskar_evaluate_cross_power_multi.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Function to evaluate the cross-power product for several test sources.
+ *
+ * @details
+ * This function evaluates the average cross-power product from all stations
+ * for each of \p num_sets test sources, writing the result for each source
+ * to the corresponding array in \p out.
+ *
+ * On the CPU, all outputs are produced in one pass through the Jones data,
+ * which is processed in tiles of sources. As the sum over station pairs
+ * (p < q) of J_p B J_q^H is equal to the sum over p of J_p B S_p^H,
+ * where S_p is the sum of J_q for q > p, the cost is linear
+ * (rather than quadratic) in the number of stations.
+ *
+ * Otherwise, oskar_evaluate_cross_power() is called for each output.
+ *
+ * The \p jones block is two dimensional, and the source dimension
+ * is the fastest varying.
+ *
+ * @param[in] num_sources    The number of sources in the input arrays.
+ * @param[in] num_stations   The number of stations in the input arrays.
+ * @param[in] jones          Pointer to Jones matrix block
+ *                           (length \p num_sources * \p num_stations).
+ * @param[in] num_sets       The number of test sources and output arrays.
+ * @param[in] stokes         Test source Stokes I, Q, U, V values
+ *                           (length 4 * \p num_sets).
+ * @param[in] offset_out     Start offset into output arrays.
+ * @param[out] out           Output average cross-power products
+ *                           (\p num_sets arrays of length \p num_sources).
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_cross_power_multi(int num_sources, int num_stations,
+        const oskar_Mem* jones, int num_sets, const double* stokes,
+        int offset_out, oskar_Mem** out, int *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVALUATE_CROSS_POWER_MULTI_H_ */
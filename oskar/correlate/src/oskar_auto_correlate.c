@@ -118,6 +118,7 @@ void oskar_auto_correlate(int num_sources, const oskar_Jones* jones,
     else
     {
         size_t local_size[] = {128, 1, 1}, global_size[] = {1, 1, 1};
+        static int handle[4]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         switch (oskar_mem_type(vis))
         {
@@ -129,6 +130,8 @@ void oskar_auto_correlate(int num_sources, const oskar_Jones* jones,
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(&handle[
+                2 * oskar_mem_is_matrix(vis) + oskar_mem_is_double(vis)], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = num_stations * local_size[0];
         const oskar_Arg args[] = {
@@ -144,7 +147,8 @@ void oskar_auto_correlate(int num_sources, const oskar_Jones* jones,
         const size_t arg_size_local[] = {
                 local_size[0] * oskar_mem_element_size(oskar_mem_type(vis))
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args,
                 1, arg_size_local, status);
     }
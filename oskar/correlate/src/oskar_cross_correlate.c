@@ -507,6 +507,7 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
         size_t local_size[] = {128, 1, 1}, global_size[] = {1, 1, 1};
         const int is_dbl = oskar_mem_is_double(vis);
         const int is_matrix = oskar_mem_is_matrix(vis);
+        static int handle[32]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         const float uv_filter_min_f = (float) uv_filter_min;
         const float uv_filter_max_f = (float) uv_filter_max;
@@ -613,6 +614,9 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
                 return;
             }
         }
+        const int h = oskar_device_kernel_handle_cached(&handle[
+                (use_extended ? 16 : 0) + 8 * is_matrix + 4 * is_dbl +
+                2 * (time_avg != 0.0) + (frac_bandwidth != 0.0)], k);
         const oskar_Arg args[] = {
                 {INT_SZ, &num_sources},
                 {INT_SZ, &num_stations},
@@ -662,7 +666,8 @@ void oskar_cross_correlate(int num_sources,  const oskar_Jones* jones,
         };
         global_size[0] = num_stations * local_size[0];
         global_size[1] = num_stations;
-        oskar_device_launch_kernel(k, location, 2, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 2,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args,
                 1, arg_size_local, status);
     }
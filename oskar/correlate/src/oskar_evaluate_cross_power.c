@@ -108,6 +108,7 @@ void oskar_evaluate_cross_power(int num_sources, int num_stations,
     {
         size_t local_size[] = {128, 1, 1}, global_size[] = {1, 1, 1};
         const int is_dbl = (oskar_type_precision(type) == OSKAR_DOUBLE);
+        static int handle[4]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         switch (type)
         {
@@ -125,6 +126,8 @@ void oskar_evaluate_cross_power(int num_sources, int num_stations,
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(
+                &handle[2 * oskar_type_is_matrix(type) + is_dbl], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = oskar_device_global_size(
                 (size_t) num_sources, local_size[0]);
@@ -145,7 +148,8 @@ void oskar_evaluate_cross_power(int num_sources, int num_stations,
                 {INT_SZ, &offset_out},
                 {PTR_SZ, oskar_mem_buffer(out)}
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 }
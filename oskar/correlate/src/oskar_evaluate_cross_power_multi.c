@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "correlate/define_correlate_utils.h"
+#include "correlate/oskar_evaluate_cross_power.h"
+#include "correlate/oskar_evaluate_cross_power_multi.h"
+#include "math/define_multiply.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of sources processed together by each thread. */
+#define TILE_SIZE 64
+
+/* Maximum number of test sources handled in one sweep. */
+#define MAX_SETS 4
+
+/*
+ * For each tile of sources, stations are visited in reverse order while
+ * keeping a running sum of the Jones matrices already seen (S_p).
+ * Each station then contributes J_p B S_p^H for every test source B.
+ */
+#define OSKAR_CROSS_POWER_MULTI_MATRIX(NAME, FP, FP2, FP4c) \
+static void NAME(const int num_sources, const int num_stations, \
+        const FP4c* RESTRICT jones, const int num_sets, const FP* stokes, \
+        const FP norm, const int offset_out, void* const* out) \
+{ \
+    int t; \
+    const int num_tiles = (num_sources + TILE_SIZE - 1) / TILE_SIZE; \
+    DO_PRAGMA(omp parallel for private(t)) \
+    for (t = 0; t < num_tiles; ++t) \
+    { \
+        FP4c b[MAX_SETS], acc[TILE_SIZE], sum[MAX_SETS * TILE_SIZE]; \
+        int i, k, p; \
+        const int i0 = t * TILE_SIZE; \
+        const int n = (num_sources - i0 < TILE_SIZE) ? \
+                num_sources - i0 : TILE_SIZE; \
+        for (k = 0; k < num_sets; ++k) \
+        { \
+            OSKAR_CLEAR_COMPLEX_MATRIX(FP, b[k]) \
+            OSKAR_CONSTRUCT_B(FP, b[k], stokes[4 * k], stokes[4 * k + 1], \
+                    stokes[4 * k + 2], stokes[4 * k + 3]) \
+        } \
+        for (i = 0; i < n; ++i) OSKAR_CLEAR_COMPLEX_MATRIX(FP, acc[i]) \
+        for (i = 0; i < num_sets * TILE_SIZE; ++i) \
+            OSKAR_CLEAR_COMPLEX_MATRIX(FP, sum[i]) \
+        for (p = num_stations - 1; p >= 0; --p) \
+        { \
+            const FP4c* RESTRICT j_p = jones + (size_t)p * num_sources + i0; \
+            if (p < num_stations - 1) \
+            { \
+                for (k = 0; k < num_sets; ++k) \
+                { \
+                    FP4c* RESTRICT s = sum + k * TILE_SIZE; \
+                    for (i = 0; i < n; ++i) \
+                    { \
+                        FP4c m; \
+                        OSKAR_LOAD_MATRIX(m, j_p[i]) \
+                        OSKAR_MUL_COMPLEX_MATRIX_HERMITIAN_IN_PLACE( \
+                                FP2, m, b[k]) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].a, m.a, acc[i].a) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].a, m.b, acc[i].b) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].b, m.a, acc[i].c) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].b, m.b, acc[i].d) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].c, m.c, acc[i].a) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].c, m.d, acc[i].b) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].d, m.c, acc[i].c) \
+                        OSKAR_MUL_ADD_COMPLEX_CONJUGATE(s[i].d, m.d, acc[i].d) \
+                    } \
+                } \
+            } \
+            for (i = 0; i < n; ++i) \
+            { \
+                acc[i].a.x += j_p[i].a.x; acc[i].a.y += j_p[i].a.y; \
+                acc[i].b.x += j_p[i].b.x; acc[i].b.y += j_p[i].b.y; \
+                acc[i].c.x += j_p[i].c.x; acc[i].c.y += j_p[i].c.y; \
+                acc[i].d.x += j_p[i].d.x; acc[i].d.y += j_p[i].d.y; \
+            } \
+        } \
+        for (k = 0; k < num_sets; ++k) \
+        { \
+            const FP4c* RESTRICT s = sum + k * TILE_SIZE; \
+            FP4c* RESTRICT o = (FP4c*) out[k] + offset_out + i0; \
+            for (i = 0; i < n; ++i) \
+            { \
+                o[i].a.x = norm * s[i].a.x; o[i].a.y = norm * s[i].a.y; \
+                o[i].b.x = norm * s[i].b.x; o[i].b.y = norm * s[i].b.y; \
+                o[i].c.x = norm * s[i].c.x; o[i].c.y = norm * s[i].c.y; \
+                o[i].d.x = norm * s[i].d.x; o[i].d.y = norm * s[i].d.y; \
+            } \
+        } \
+    } \
+}
+
+/* Test source parameters do not apply to scalar Jones data,
+ * so the result is identical for all outputs. */
+#define OSKAR_CROSS_POWER_MULTI_SCALAR(NAME, FP, FP2) \
+static void NAME(const int num_sources, const int num_stations, \
+        const FP2* RESTRICT jones, const int num_sets, \
+        const FP norm, const int offset_out, void* const* out) \
+{ \
+    int t; \
+    const int num_tiles = (num_sources + TILE_SIZE - 1) / TILE_SIZE; \
+    DO_PRAGMA(omp parallel for private(t)) \
+    for (t = 0; t < num_tiles; ++t) \
+    { \
+        FP2 acc[TILE_SIZE], sum[TILE_SIZE]; \
+        int i, k, p; \
+        const int i0 = t * TILE_SIZE; \
+        const int n = (num_sources - i0 < TILE_SIZE) ? \
+                num_sources - i0 : TILE_SIZE; \
+        for (i = 0; i < n; ++i) \
+        { \
+            MAKE_ZERO2(FP, acc[i]); \
+            MAKE_ZERO2(FP, sum[i]); \
+        } \
+        for (p = num_stations - 1; p >= 0; --p) \
+        { \
+            const FP2* RESTRICT j_p = jones + (size_t)p * num_sources + i0; \
+            for (i = 0; i < n; ++i) \
+            { \
+                OSKAR_MUL_ADD_COMPLEX_CONJUGATE(sum[i], j_p[i], acc[i]) \
+                acc[i].x += j_p[i].x; acc[i].y += j_p[i].y; \
+            } \
+        } \
+        for (k = 0; k < num_sets; ++k) \
+        { \
+            FP2* RESTRICT o = (FP2*) out[k] + offset_out + i0; \
+            for (i = 0; i < n; ++i) \
+            { \
+                o[i].x = norm * sum[i].x; o[i].y = norm * sum[i].y; \
+            } \
+        } \
+    } \
+}
+
+OSKAR_CROSS_POWER_MULTI_MATRIX(cross_power_multi_float, float, float2, float4c)
+OSKAR_CROSS_POWER_MULTI_MATRIX(cross_power_multi_double, double, double2, double4c)
+OSKAR_CROSS_POWER_MULTI_SCALAR(cross_power_multi_scalar_float, float, float2)
+OSKAR_CROSS_POWER_MULTI_SCALAR(cross_power_multi_scalar_double, double, double2)
+
+void oskar_evaluate_cross_power_multi(int num_sources, int num_stations,
+        const oskar_Mem* jones, int num_sets, const double* stokes,
+        int offset_out, oskar_Mem** out, int *status)
+{
+    int i, k, start;
+    void* ptr[MAX_SETS];
+    float stokes_f[4 * MAX_SETS];
+    if (*status) return;
+    const int type = oskar_mem_type(jones);
+    const int location = oskar_mem_location(jones);
+    const double norm = 2.0 / (num_stations * (num_stations - 1));
+    for (k = 0; k < num_sets; ++k)
+    {
+        if (type != oskar_mem_type(out[k]))
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        if (location != oskar_mem_location(out[k]))
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+    }
+    if (location != OSKAR_CPU)
+    {
+        for (k = 0; k < num_sets; ++k)
+            oskar_evaluate_cross_power(num_sources, num_stations, jones,
+                    stokes[4 * k], stokes[4 * k + 1],
+                    stokes[4 * k + 2], stokes[4 * k + 3],
+                    offset_out, out[k], status);
+        return;
+    }
+    for (start = 0; start < num_sets; start += MAX_SETS)
+    {
+        const int num = (num_sets - start < MAX_SETS) ?
+                num_sets - start : MAX_SETS;
+        const double* stokes_d = stokes + 4 * start;
+        for (k = 0; k < num; ++k)
+            ptr[k] = oskar_mem_void(out[start + k]);
+        for (i = 0; i < 4 * num; ++i)
+            stokes_f[i] = (float) stokes_d[i];
+        switch (type)
+        {
+        case OSKAR_SINGLE_COMPLEX_MATRIX:
+            cross_power_multi_float(num_sources, num_stations,
+                    oskar_mem_float4c_const(jones, status), num, stokes_f,
+                    (float) norm, offset_out, ptr);
+            break;
+        case OSKAR_DOUBLE_COMPLEX_MATRIX:
+            cross_power_multi_double(num_sources, num_stations,
+                    oskar_mem_double4c_const(jones, status), num, stokes_d,
+                    norm, offset_out, ptr);
+            break;
+        case OSKAR_SINGLE_COMPLEX:
+            cross_power_multi_scalar_float(num_sources, num_stations,
+                    oskar_mem_float2_const(jones, status), num,
+                    (float) norm, offset_out, ptr);
+            break;
+        case OSKAR_DOUBLE_COMPLEX:
+            cross_power_multi_scalar_double(num_sources, num_stations,
+                    oskar_mem_double2_const(jones, status), num,
+                    norm, offset_out, ptr);
+            break;
+        default:
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+            return;
+        }
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -31,6 +31,7 @@
 #include "utility/oskar_timer.h"
 
 #include "correlate/oskar_evaluate_cross_power.h"
+#include "correlate/oskar_evaluate_cross_power_multi.h"
 #include "utility/oskar_get_error_string.h"
 #include <cstdlib>
 
@@ -245,3 +246,69 @@ TEST_F(cross_power, scalar_singleCPU_doubleGPU)
             OSKAR_CPU, OSKAR_GPU, 0);
 }
 #endif
+
+// FUSED VERSIONS.
+
+static void run_multi_test(int type)
+{
+    int status = 0;
+    const int num_sources = 277, num_stations = 13, num_sets = 5;
+    const double stokes[] = {
+            1.0, 0.0, 0.0, 0.0,
+            1.0, 0.3, 0.2, 0.1,
+            2.0, -0.5, 0.0, 0.4,
+            0.5, 0.0, -0.2, 0.0,
+            1.5, 0.1, 0.1, -0.3
+    };
+    oskar_Mem* jones = oskar_mem_create(type, OSKAR_CPU,
+            num_stations * num_sources, &status);
+    srand(0);
+    oskar_mem_random_range(jones, 1.0, 10.0, &status);
+    oskar_Mem* out[num_sets];
+    for (int k = 0; k < num_sets; ++k)
+        out[k] = oskar_mem_create(type, OSKAR_CPU, num_sources + 3, &status);
+    oskar_evaluate_cross_power_multi(num_sources, num_stations, jones,
+            num_sets, stokes, 3, out, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Compare against separate evaluation of each product.
+    oskar_Mem* ref = oskar_mem_create(type, OSKAR_CPU, num_sources + 3,
+            &status);
+    for (int k = 0; k < num_sets; ++k)
+    {
+        oskar_evaluate_cross_power(num_sources, num_stations, jones,
+                stokes[4 * k], stokes[4 * k + 1],
+                stokes[4 * k + 2], stokes[4 * k + 3], 3, ref, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        oskar_Mem *a, *b;
+        a = oskar_mem_create_alias(out[k], 3, num_sources, &status);
+        b = oskar_mem_create_alias(ref, 3, num_sources, &status);
+        check_values(a, b);
+        oskar_mem_free(a, &status);
+        oskar_mem_free(b, &status);
+        oskar_mem_free(out[k], &status);
+    }
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(jones, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(cross_power_multi, matrix_single)
+{
+    run_multi_test(OSKAR_SINGLE_COMPLEX_MATRIX);
+}
+
+TEST(cross_power_multi, matrix_double)
+{
+    run_multi_test(OSKAR_DOUBLE_COMPLEX_MATRIX);
+}
+
+TEST(cross_power_multi, scalar_single)
+{
+    run_multi_test(OSKAR_SINGLE_COMPLEX);
+}
+
+TEST(cross_power_multi, scalar_double)
+{
+    run_multi_test(OSKAR_DOUBLE_COMPLEX);
+}
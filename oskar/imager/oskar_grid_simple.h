@@ -47,6 +47,12 @@ extern "C" {
  * @details
  * Simple gridding function for 1D real convolution kernel.
  *
+ * Calls with 16384 or more visibilities are gridded one tile of the grid
+ * at a time, using multiple threads if available. The result matches the
+ * serial loop used for smaller calls to within floating-point rounding
+ * (only the order of the sums is different), and does not depend on the
+ * number of threads.
+ *
  * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
  * @param[in] oversample    GCF oversample factor, or values per grid cell.
  * @param[in] conv_func     GCF array, length oversample * (support + 1).
@@ -84,6 +90,12 @@ void oskar_grid_simple_d(
  * @details
  * Simple gridding function for 1D real convolution kernel.
  *
+ * Calls with 16384 or more visibilities are gridded one tile of the grid
+ * at a time, using multiple threads if available. The result matches the
+ * serial loop used for smaller calls to within floating-point rounding
+ * (only the order of the sums is different), and does not depend on the
+ * number of threads.
+ *
  * @param[in] support       GCF support size (typ. 3; width = 2 * support + 1).
  * @param[in] oversample    GCF oversample factor, or values per grid cell.
  * @param[in] conv_func     GCF array, length oversample * (support + 1).
@@ -47,6 +47,11 @@ extern "C" {
  * @details
  * Updates gridded weights for the supplied visibility points.
  *
+ * Calls with 16384 or more points are first binned by grid tile, and the
+ * tiles are updated using multiple threads if available. Points in each
+ * grid cell are summed in their original order, so the result is identical
+ * to the serial loop.
+ *
  * @param[in] num_points        Number of data points.
  * @param[in] uu                Baseline uu coordinates, in wavelengths.
  * @param[in] vv                Baseline vv coordinates, in wavelengths.
@@ -71,6 +76,8 @@ void oskar_grid_weights_write_d(const size_t num_points,
  * Re-weights supplied visibilities using gridded weights, for
  * uniform weighting.
  *
+ * Calls with 16384 or more points use multiple threads if available.
+ *
  * @param[in] num_points        Number of data points.
  * @param[in] uu                Baseline uu coordinates, in wavelengths.
  * @param[in] vv                Baseline vv coordinates, in wavelengths.
@@ -94,6 +101,11 @@ void oskar_grid_weights_read_d(const size_t num_points,
  * @details
  * Updates gridded weights for the supplied visibility points.
  *
+ * Calls with 16384 or more points are first binned by grid tile, and the
+ * tiles are updated using multiple threads if available. Points in each
+ * grid cell are summed in their original order, so the result is identical
+ * to the serial loop.
+ *
  * @param[in] num_points        Number of data points.
  * @param[in] uu                Baseline uu coordinates, in wavelengths.
  * @param[in] vv                Baseline vv coordinates, in wavelengths.
@@ -118,6 +130,8 @@ void oskar_grid_weights_write_f(const size_t num_points,
  * Re-weights supplied visibilities using gridded weights, for
  * uniform weighting.
  *
+ * Calls with 16384 or more points use multiple threads if available.
+ *
  * @param[in] num_points        Number of data points.
  * @param[in] uu                Baseline uu coordinates, in wavelengths.
  * @param[in] vv                Baseline vv coordinates, in wavelengths.
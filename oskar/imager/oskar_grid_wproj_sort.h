@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_GRID_WPROJ_SORT_H_
+#define OSKAR_GRID_WPROJ_SORT_H_
+
+/**
+ * @file oskar_grid_wproj_sort.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Finds a cache-friendly order in which to grid visibilities with
+ * W-projection (double precision).
+ *
+ * @details
+ * Returns the order of the visibilities sorted by W-projection plane,
+ * and then by the square tile of the grid containing each visibility.
+ * Gridding the visibilities in this order keeps both the current
+ * W-kernel and the current region of the grid in cache.
+ *
+ * The sort is stable, so the gridded result differs from that in input
+ * order only by the order of floating-point additions.
+ *
+ * @param[in] num_w_planes   Number of W-projection planes.
+ * @param[in] num_points     Number of visibility points.
+ * @param[in] uu             Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv             Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] ww             Visibility baseline ww coordinates, in wavelengths.
+ * @param[in] cell_size_rad  Cell size, in radians.
+ * @param[in] w_scale        Scaling factor used to find W-plane index.
+ * @param[in] grid_size      Side length of grid.
+ * @param[out] order         Index of each visibility in the sorted order.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_grid_wproj_sort_d(
+        const size_t num_w_planes,
+        const size_t num_points,
+        const double* RESTRICT uu,
+        const double* RESTRICT vv,
+        const double* RESTRICT ww,
+        const double cell_size_rad,
+        const double w_scale,
+        const int grid_size,
+        size_t* RESTRICT order,
+        int* status);
+
+/**
+ * @brief
+ * Finds a cache-friendly order in which to grid visibilities with
+ * W-projection (single precision).
+ *
+ * @details
+ * Single precision version of oskar_grid_wproj_sort_d().
+ *
+ * @param[in] num_w_planes   Number of W-projection planes.
+ * @param[in] num_points     Number of visibility points.
+ * @param[in] uu             Visibility baseline uu coordinates, in wavelengths.
+ * @param[in] vv             Visibility baseline vv coordinates, in wavelengths.
+ * @param[in] ww             Visibility baseline ww coordinates, in wavelengths.
+ * @param[in] cell_size_rad  Cell size, in radians.
+ * @param[in] w_scale        Scaling factor used to find W-plane index.
+ * @param[in] grid_size      Side length of grid.
+ * @param[out] order         Index of each visibility in the sorted order.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_grid_wproj_sort_f(
+        const size_t num_w_planes,
+        const size_t num_points,
+        const float* RESTRICT uu,
+        const float* RESTRICT vv,
+        const float* RESTRICT ww,
+        const float cell_size_rad,
+        const float w_scale,
+        const int grid_size,
+        size_t* RESTRICT order,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_GRID_WPROJ_SORT_H_ */
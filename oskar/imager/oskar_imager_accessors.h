@@ -76,6 +76,18 @@ double oskar_imager_cellsize(const oskar_Imager* h);
 OSKAR_EXPORT
 int oskar_imager_channel_snapshots(const oskar_Imager* h);
 
+/**
+ * @brief
+ * Returns the flag specifying whether to cache baseline coordinates.
+ *
+ * @details
+ * Returns the flag specifying whether to cache baseline coordinates.
+ *
+ * @param[in] h  Handle to imager.
+ */
+OSKAR_EXPORT
+int oskar_imager_coords_cache(const oskar_Imager* h);
+
 /**
  * @brief
  * Returns the flag specifying whether the imager is in coordinate-only mode.
@@ -274,7 +286,8 @@ const char* oskar_imager_output_root(const oskar_Imager* h);
  *
  * @details
  * Returns the grid size required by the algorithm.
- * This will be different to the image size when using W-projection.
+ * This will be different to the image size when using W-projection
+ * or W-stacking.
  */
 OSKAR_EXPORT
 int oskar_imager_plane_size(oskar_Imager* h);
@@ -319,6 +332,8 @@ int oskar_imager_scale_norm_with_num_input_files(const oskar_Imager* h);
  * The \p type string can be:
  * - "FFT" to use standard gridding followed by a FFT.
  * - "W-projection" to use W-projection gridding followed by a FFT.
+ * - "W-stacking" to grid onto W-layers using a spheroidal kernel,
+ *   followed by a FFT and a W-phase correction for each layer.
  * - "DFT 2D" to use a 2D Direct Fourier Transform, without gridding.
  * - "DFT 3D" to use a 3D Direct Fourier Transform, without gridding.
  *
@@ -361,12 +376,33 @@ void oskar_imager_set_cellsize(oskar_Imager* h, double cellsize_arcsec);
 OSKAR_EXPORT
 void oskar_imager_set_channel_snapshots(oskar_Imager* h, int value);
 
+/**
+ * @brief
+ * Sets the flag specifying whether to cache baseline coordinates.
+ *
+ * @details
+ * If set, the baseline coordinates and weights read from each input file
+ * in the coordinate pass of oskar_imager_run() are saved, after selection,
+ * scaling and filtering, to a cache file next to the input file, with the
+ * suffix ".oskar_coord_cache".
+ *
+ * The next time the same file is imaged, the cache is used instead of
+ * reading the coordinates again, if the size and modification time of the
+ * input file, and all settings the coordinates depend on, are unchanged.
+ * The image size, cell size and weighting type can all be changed.
+ *
+ * @param[in,out] h          Handle to imager.
+ * @param[in]     value      If true, use and write coordinate cache files.
+ */
+OSKAR_EXPORT
+void oskar_imager_set_coords_cache(oskar_Imager* h, int value);
+
 /**
  * @brief
  * Sets the imager to ignore visibility data and only update weights grids.
  *
  * @details
- * Use this method with uniform weighting or W-projection.
+ * Use this method with uniform weighting, W-projection or W-stacking.
  * The grids of weights can only be used once they are fully populated,
  * so this method puts the imager into a mode where it only updates its
  * internal weights grids when calling oskar_imager_update().
@@ -781,7 +817,8 @@ void oskar_imager_set_vis_phase_centre(oskar_Imager* h,
  * Sets the number of W planes to use.
  *
  * @details
- * Sets the number of W planes, used only for W-projection.
+ * Sets the number of W planes, used only for W-projection,
+ * or the number of W-layers, used only for W-stacking.
  * A value of 0 or less means 'automatic'.
  *
  * @param[in,out] h            Handle to imager.
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_GRID_BINS_H_
+#define OSKAR_PRIVATE_GRID_BINS_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Sorts points by bin using a parallel counting sort, so that a grid
+ * can be updated one bin (tile) at a time.
+ *
+ * Bin indices must be less than num_bins. Points with a negative bin index
+ * are left out of the sort.
+ *
+ * On return, order[bin_start[b]] to order[bin_start[b + 1] - 1] are the
+ * indices of the points in bin b, in their original order, so the result
+ * does not depend on the number of threads. The number of points sorted
+ * is bin_start[num_bins].
+ *
+ * The bin_start array must have num_bins + 1 elements,
+ * and the order array must have num_points elements.
+ *
+ * Returns 1 if the work arrays could not be allocated, otherwise 0.
+ */
+int oskar_grid_bins_sort(size_t num_points, const int* bin, int num_bins,
+        size_t* bin_start, size_t* order);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -56,6 +56,15 @@ struct DeviceData
 };
 typedef struct DeviceData DeviceData;
 
+/* Visibility data buffered for each plane by the W-stacking imager. */
+struct WStackData
+{
+    oskar_Mem* plane; /* The plane the visibilities belong to. */
+    size_t num_vis;
+    oskar_Mem *uu, *vv, *ww, *vis, *weight;
+};
+typedef struct WStackData WStackData;
+
 struct oskar_Imager
 {
     char* output_name[4];
@@ -86,6 +95,8 @@ struct oskar_Imager
     /* State. */
     int init, status, i_block;
     int coords_only; /* Set if doing a first pass for uniform weighting. */
+    int coords_cache; /* Set to cache coordinates next to the input. */
+    struct CoordsCacheWriter* coords_cache_writer;
     oskar_Mutex* mutex;
     oskar_Log* log;
     size_t num_vis_processed;
@@ -99,6 +110,7 @@ struct oskar_Imager
 
     /* DFT imager data. */
     oskar_Mem *l, *m, *n;
+    oskar_Mem *l_axis, *m_axis, *dft_block, *dft_work; /* Separable DFT. */
 
     /* FFT imager data. */
     oskar_FFT* fft;
@@ -111,6 +123,11 @@ struct oskar_Imager
     double w_scale, ww_min, ww_max, ww_rms;
     oskar_Mem *w_support, *w_kernels_compact, *w_kernel_start;
 
+    /* W-stacking imager data. */
+    int num_w_layers, num_ws_planes;
+    double w_layer_inc;
+    WStackData* ws;
+
     /* Memory allocated per GPU (array of DeviceData structures). */
     DeviceData* d;
 };
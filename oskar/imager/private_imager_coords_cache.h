@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_COORDS_CACHE_H_
+#define OSKAR_IMAGER_COORDS_CACHE_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns the name of the coordinate cache file for the input file.
+ * The string must be freed using free(). */
+char* oskar_imager_coords_cache_name(const char* filename);
+
+/* Uses the coordinate cache for the input file in place of reading its
+ * coordinates, if the cache is valid. Returns true if it was used. */
+int oskar_imager_coords_cache_load(oskar_Imager* h, const char* filename,
+        int* status);
+
+/* Starts writing the coordinate cache for the input file. */
+void oskar_imager_coords_cache_begin(oskar_Imager* h, const char* filename,
+        int* status);
+
+/* Writes the coordinates used to update one image plane to the cache. */
+void oskar_imager_coords_cache_write(oskar_Imager* h, int i_plane,
+        size_t num_vis, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, const oskar_Mem* weight, int* status);
+
+/* Finishes writing the coordinate cache. The file is kept only if
+ * status is zero. */
+void oskar_imager_coords_cache_end(oskar_Imager* h, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_COORDS_CACHE_H_ */
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_FINALISE_WSTACK_H_
+#define OSKAR_IMAGER_FINALISE_WSTACK_H_
+
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_flush_wstack(oskar_Imager* h, WStackData* ws, int* status);
+
+void oskar_imager_finalise_wstack(oskar_Imager* h, oskar_Mem* plane,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_FINALISE_WSTACK_H_ */
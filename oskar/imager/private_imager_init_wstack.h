@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_INIT_WSTACK_H_
+#define OSKAR_IMAGER_INIT_WSTACK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_init_wstack(oskar_Imager* h, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_INIT_WSTACK_H_ */
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_UPDATE_PLANES_FFT_H_
+#define OSKAR_IMAGER_UPDATE_PLANES_FFT_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Returns true if all image planes can be gridded in one pass. */
+int oskar_imager_update_planes_fft_supported(const oskar_Imager* h);
+
+void oskar_imager_update_planes_fft(oskar_Imager* h, size_t num_rows,
+        int start_chan, int end_chan, int num_pols, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* amps, const oskar_Mem* weight,
+        size_t* num_skipped, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_UPDATE_PLANES_FFT_H_ */
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_IMAGER_UPDATE_WEIGHTS_GRID_H_
+#define OSKAR_IMAGER_UPDATE_WEIGHTS_GRID_H_
+
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Updates the uniform weights grid, and the baseline W statistics
+ * unless ww is NULL. */
+void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* weight, oskar_Mem* weights_grid, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_IMAGER_UPDATE_WEIGHTS_GRID_H_ */
@@ -27,6 +27,9 @@
  */
 
 #include "imager/oskar_grid_simple.h"
+#include "imager/private_grid_bins.h"
+#include "mem/private_mem_loop.h"
+#include "utility/oskar_kernel_macros.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -37,6 +40,147 @@ extern "C" {
 #define D_SUPPORT 3
 #define D_OVERSAMPLE 100
 
+/* Minimum side length of a grid tile used by the tiled gridder,
+ * the minimum number of visibilities for which it is used,
+ * and the largest support size it handles. */
+#define TILE_SIZE 32
+#define MIN_POINTS_TILED 16384
+#define MAX_SUPPORT_TILED 16
+
+/*
+ * Tiled gridder, which can use multiple threads.
+ *
+ * Visibilities are first sorted by the grid tile containing their centre
+ * (see oskar_grid_bins_sort()), and copied in that order into a contiguous
+ * buffer. Tiles are at least
+ * 2 * support cells wide, so the footprints of visibilities in tiles two
+ * apart in u and v never overlap. The tiles are then processed in four
+ * passes over a 2x2 pattern, with the tiles in each pass shared between
+ * threads, so each grid cell is updated by only one thread at a time.
+ *
+ * The contribution of each visibility is computed in the same way as the
+ * serial loops, and visibilities within a tile are gridded in their
+ * original order, so only the order of the sums is different.
+ * The result does not depend on the number of threads.
+ *
+ * Returns 1 if the buffers could not be allocated, otherwise 0.
+ */
+#define GRID_SIMPLE_TILED(NAME, FP, ROUND) static int NAME(\
+        const int support, const int oversample,\
+        const FP* RESTRICT conv_func, const size_t num_points,\
+        const FP* RESTRICT uu, const FP* RESTRICT vv,\
+        const FP* RESTRICT vis, const FP* RESTRICT weight,\
+        const FP cell_size_rad, const int grid_size,\
+        size_t* RESTRICT num_skipped, double* RESTRICT norm,\
+        FP* RESTRICT grid)\
+{\
+    int colour, t;\
+    const int grid_centre = grid_size / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    const int tile_size = 2 * support > TILE_SIZE ? 2 * support : TILE_SIZE;\
+    const int num_tiles_u = (grid_size + tile_size - 1) / tile_size;\
+    const int num_tiles = num_tiles_u * num_tiles_u;\
+    int* tile = (int*) malloc(num_points * sizeof(int));\
+    size_t* order = (size_t*) malloc(num_points * sizeof(size_t));\
+    FP* sorted = (FP*) malloc(5 * num_points * sizeof(FP));\
+    size_t* tile_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));\
+    double* tile_norm = (double*) calloc(num_tiles, sizeof(double));\
+    if (!tile || !order || !sorted || !tile_start || !tile_norm) {\
+        free(tile); free(order); free(sorted);\
+        free(tile_start); free(tile_norm);\
+        return 1;\
+    }\
+    /* Find the tile for each visibility, or -1 if it is off the grid. */\
+    OSKAR_MEM_LOOP_CHUNKS(num_points, start, end)\
+    size_t i;\
+    for (i = start; i < end; ++i) {\
+        const int grid_u = (int)ROUND(-uu[i] * grid_scale) + grid_centre;\
+        const int grid_v = (int)ROUND(vv[i] * grid_scale) + grid_centre;\
+        tile[i] = (grid_u + support >= grid_size || grid_u - support < 0 ||\
+                grid_v + support >= grid_size || grid_v - support < 0) ?\
+                -1 : (grid_v / tile_size) * num_tiles_u + grid_u / tile_size;\
+    }\
+    OSKAR_MEM_LOOP_CHUNKS_END\
+    if (oskar_grid_bins_sort(num_points, tile, num_tiles,\
+            tile_start, order)) {\
+        free(tile); free(order); free(sorted);\
+        free(tile_start); free(tile_norm);\
+        return 1;\
+    }\
+    /* Copy the visibility data into tile order. */\
+    OSKAR_MEM_LOOP_CHUNKS(tile_start[num_tiles], start, end)\
+    size_t m;\
+    for (m = start; m < end; ++m) {\
+        const size_t i = order[m];\
+        FP* p = sorted + 5 * m;\
+        p[0] = uu[i];\
+        p[1] = vv[i];\
+        p[2] = vis[2 * i];\
+        p[3] = vis[2 * i + 1];\
+        p[4] = weight[i];\
+    }\
+    OSKAR_MEM_LOOP_CHUNKS_END\
+    /* Grid the visibilities in each set of non-adjacent tiles. */\
+    for (colour = 0; colour < 4; ++colour) {\
+        DO_PRAGMA(omp parallel for private(t) schedule(dynamic)) \
+        for (t = 0; t < num_tiles; ++t) {\
+            size_t m;\
+            double norm_sum = 0.0;\
+            FP cu[2 * MAX_SUPPORT_TILED + 1], cv[2 * MAX_SUPPORT_TILED + 1];\
+            const int tile_u = t % num_tiles_u, tile_v = t / num_tiles_u;\
+            if (((tile_v & 1) << 1 | (tile_u & 1)) != colour) continue;\
+            for (m = tile_start[t]; m < tile_start[t + 1]; ++m) {\
+                int j, k;\
+                double sum_u = 0.0, sum_v = 0.0;\
+                const FP* p = sorted + 5 * m;\
+                const FP pos_u = -p[0] * grid_scale;\
+                const FP pos_v = p[1] * grid_scale;\
+                const int grid_u = (int)ROUND(pos_u) + grid_centre;\
+                const int grid_v = (int)ROUND(pos_v) + grid_centre;\
+                const FP weight_i = p[4];\
+                const FP v_re = weight_i * p[2];\
+                const FP v_im = weight_i * p[3];\
+                const int off_u =\
+                        (int)ROUND((ROUND(pos_u) - pos_u) * oversample);\
+                const int off_v =\
+                        (int)ROUND((ROUND(pos_v) - pos_v) * oversample);\
+                /* Look up the convolution function once for each axis. */\
+                for (k = 0; k <= 2 * support; ++k) {\
+                    cu[k] = conv_func[abs(off_u + (k - support) * oversample)];\
+                    cv[k] = conv_func[abs(off_v + (k - support) * oversample)];\
+                    sum_u += cu[k];\
+                    sum_v += cv[k];\
+                }\
+                /* Each row of the footprint is contiguous in the grid. */\
+                for (j = 0; j <= 2 * support; ++j) {\
+                    const FP c1 = cv[j];\
+                    FP* RESTRICT row = grid + (((size_t) (grid_v + j - support)\
+                            * grid_size + grid_u - support) << 1);\
+                    for (k = 0; k <= 2 * support; ++k) {\
+                        const FP c = cu[k] * c1;\
+                        row[2 * k]     += v_re * c;\
+                        row[2 * k + 1] += v_im * c;\
+                    }\
+                }\
+                norm_sum += sum_u * sum_v * weight_i;\
+            }\
+            tile_norm[t] = norm_sum;\
+        }\
+    }\
+    /* Sum the normalisation in a fixed order. */\
+    for (t = 0; t < num_tiles; ++t) *norm += tile_norm[t];\
+    *num_skipped = num_points - tile_start[num_tiles];\
+    free(tile);\
+    free(order);\
+    free(sorted);\
+    free(tile_start);\
+    free(tile_norm);\
+    return 0;\
+}
+
+GRID_SIMPLE_TILED(oskar_grid_simple_tiled_d, double, round)
+GRID_SIMPLE_TILED(oskar_grid_simple_tiled_f, float, roundf)
+
 static void oskar_grid_simple_default_d(
         const double* RESTRICT conv_func,
         const size_t num_points,
@@ -194,6 +338,13 @@ void oskar_grid_simple_d(
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+    /* Use the tiled gridder for larger numbers of visibilities. */
+    if (num_points >= MIN_POINTS_TILED && support <= MAX_SUPPORT_TILED &&
+            !oskar_grid_simple_tiled_d(support, oversample, conv_func,
+                    num_points, uu, vv, vis, weight, cell_size_rad,
+                    grid_size, num_skipped, norm, grid))
+        return;
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -273,6 +424,13 @@ void oskar_grid_simple_f(
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+    /* Use the tiled gridder for larger numbers of visibilities. */
+    if (num_points >= MIN_POINTS_TILED && support <= MAX_SUPPORT_TILED &&
+            !oskar_grid_simple_tiled_f(support, oversample, conv_func,
+                    num_points, uu, vv, vis, weight, cell_size_rad,
+                    grid_size, num_skipped, norm, grid))
+        return;
+
     /* Use slightly more efficient version for default parameters. */
     if (support == D_SUPPORT && oversample == D_OVERSAMPLE)
     {
@@ -27,6 +27,9 @@
  */
 
 #include "imager/oskar_grid_weights.h"
+#include "imager/private_grid_bins.h"
+#include "mem/private_mem_loop.h"
+#include "utility/oskar_kernel_macros.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +38,125 @@
 extern "C" {
 #endif
 
+/* Side length of a grid tile used to bin the weights,
+ * and the minimum number of points for which the parallel versions are used. */
+#define TILE_SIZE 64
+#define MIN_POINTS_PARALLEL 16384
+
+/*
+ * Binned weights gridder, which can use multiple threads.
+ *
+ * Points are first binned by the grid tile containing them, using
+ * oskar_grid_bins_sort(), and the grid index of each point is stored so
+ * it is found only once. Each tile is then updated by one thread, so the
+ * grid is accessed one small block at a time and no partial grids need
+ * to be merged.
+ *
+ * Points within a tile keep their original order, so the weights in each
+ * grid cell are summed in the same order as the serial loop, and the
+ * result is identical to it for any number of threads.
+ *
+ * Returns 1 if the buffers could not be allocated, otherwise 0.
+ */
+#define GRID_WEIGHTS_WRITE_BINNED(NAME, FP, ROUND) static int NAME(\
+        const size_t num_points, const FP* RESTRICT uu,\
+        const FP* RESTRICT vv, const FP* RESTRICT weight,\
+        const FP cell_size_rad, const int grid_size,\
+        size_t* RESTRICT num_skipped, FP* RESTRICT grid)\
+{\
+    int t;\
+    const int grid_centre = grid_size / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    const int num_tiles_u = (grid_size + TILE_SIZE - 1) / TILE_SIZE;\
+    const int num_tiles = num_tiles_u * num_tiles_u;\
+    int* tile = (int*) malloc(num_points * sizeof(int));\
+    size_t* cell = (size_t*) malloc(num_points * sizeof(size_t));\
+    size_t* order = (size_t*) malloc(num_points * sizeof(size_t));\
+    size_t* tile_start = (size_t*) malloc((num_tiles + 1) * sizeof(size_t));\
+    if (!tile || !cell || !order || !tile_start) {\
+        free(tile); free(cell); free(order); free(tile_start);\
+        return 1;\
+    }\
+    /* Find the tile for each point, or -1 if it is off the grid. */\
+    OSKAR_MEM_LOOP_CHUNKS(num_points, start, end)\
+    size_t i;\
+    for (i = start; i < end; ++i) {\
+        const int grid_u = (int)ROUND(-uu[i] * grid_scale) + grid_centre;\
+        const int grid_v = (int)ROUND(vv[i] * grid_scale) + grid_centre;\
+        if (grid_u >= grid_size || grid_u < 0 ||\
+                grid_v >= grid_size || grid_v < 0) {\
+            tile[i] = -1;\
+            continue;\
+        }\
+        tile[i] = (grid_v / TILE_SIZE) * num_tiles_u + grid_u / TILE_SIZE;\
+        cell[i] = (size_t) grid_v * grid_size + grid_u;\
+    }\
+    OSKAR_MEM_LOOP_CHUNKS_END\
+    if (oskar_grid_bins_sort(num_points, tile, num_tiles,\
+            tile_start, order)) {\
+        free(tile); free(cell); free(order); free(tile_start);\
+        return 1;\
+    }\
+    /* Add the weights to the grid, one tile per thread. */\
+    DO_PRAGMA(omp parallel for private(t) schedule(dynamic, 16)) \
+    for (t = 0; t < num_tiles; ++t) {\
+        size_t m;\
+        for (m = tile_start[t]; m < tile_start[t + 1]; ++m)\
+            grid[cell[order[m]]] += weight[order[m]];\
+    }\
+    *num_skipped = num_points - tile_start[num_tiles];\
+    free(tile);\
+    free(cell);\
+    free(order);\
+    free(tile_start);\
+    return 0;\
+}
+
+/*
+ * Parallel weights lookup. Each point is independent, so the points are
+ * simply shared between threads in fixed-size chunks.
+ * This reads each grid cell only once per point, so it is not worth
+ * binning the points first.
+ */
+#define GRID_WEIGHTS_READ_PARALLEL(NAME, FP, ROUND) static void NAME(\
+        const size_t num_points, const FP* RESTRICT uu,\
+        const FP* RESTRICT vv, const FP* RESTRICT weight_in,\
+        FP* RESTRICT weight_out, const FP cell_size_rad,\
+        const int grid_size, size_t* RESTRICT num_skipped,\
+        const FP* RESTRICT grid)\
+{\
+    int c;\
+    size_t skipped = 0;\
+    const int grid_centre = grid_size / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    const int num_chunks = OSKAR_MEM_NUM_CHUNKS(num_points);\
+    DO_PRAGMA(omp parallel for private(c) reduction(+:skipped)) \
+    for (c = 0; c < num_chunks; ++c) {\
+        size_t i;\
+        const size_t start = (size_t) c * OSKAR_MEM_CHUNK_SIZE;\
+        const size_t end = (start + OSKAR_MEM_CHUNK_SIZE < num_points) ?\
+                start + OSKAR_MEM_CHUNK_SIZE : num_points;\
+        for (i = start; i < end; ++i) {\
+            size_t t;\
+            const int grid_u = (int)ROUND(-uu[i] * grid_scale) + grid_centre;\
+            const int grid_v = (int)ROUND(vv[i] * grid_scale) + grid_centre;\
+            if (grid_u >= grid_size || grid_u < 0 ||\
+                    grid_v >= grid_size || grid_v < 0) {\
+                skipped++;\
+                continue;\
+            }\
+            t = (size_t) grid_v * grid_size + grid_u;\
+            weight_out[i] = (grid[t] != (FP) 0) ? weight_in[i] / grid[t] : 0;\
+        }\
+    }\
+    *num_skipped = skipped;\
+}
+
+GRID_WEIGHTS_WRITE_BINNED(oskar_grid_weights_write_binned_d, double, round)
+GRID_WEIGHTS_WRITE_BINNED(oskar_grid_weights_write_binned_f, float, roundf)
+GRID_WEIGHTS_READ_PARALLEL(oskar_grid_weights_read_parallel_d, double, round)
+GRID_WEIGHTS_READ_PARALLEL(oskar_grid_weights_read_parallel_f, float, roundf)
+
 void oskar_grid_weights_write_d(const size_t num_points,
         const double* RESTRICT uu, const double* RESTRICT vv,
         const double* RESTRICT weight, const double cell_size_rad,
@@ -45,6 +167,12 @@ void oskar_grid_weights_write_d(const size_t num_points,
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+    /* Bin the points by grid tile for larger numbers of points. */
+    if (num_points >= MIN_POINTS_PARALLEL &&
+            !oskar_grid_weights_write_binned_d(num_points, uu, vv, weight,
+                    cell_size_rad, grid_size, num_skipped, grid))
+        return;
+
     /* Grid the existing weights. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -79,6 +207,14 @@ void oskar_grid_weights_read_d(const size_t num_points,
     const int grid_centre = grid_size / 2;
     const double grid_scale = grid_size * cell_size_rad;
 
+    /* Use multiple threads for larger numbers of points. */
+    if (num_points >= MIN_POINTS_PARALLEL)
+    {
+        oskar_grid_weights_read_parallel_d(num_points, uu, vv, weight_in,
+                weight_out, cell_size_rad, grid_size, num_skipped, grid);
+        return;
+    }
+
     /* Look up gridded weight density at each point location. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -113,6 +249,12 @@ void oskar_grid_weights_write_f(const size_t num_points,
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+    /* Bin the points by grid tile for larger numbers of points. */
+    if (num_points >= MIN_POINTS_PARALLEL &&
+            !oskar_grid_weights_write_binned_f(num_points, uu, vv, weight,
+                    cell_size_rad, grid_size, num_skipped, grid))
+        return;
+
     /* Grid the existing weights. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -147,6 +289,14 @@ void oskar_grid_weights_read_f(const size_t num_points,
     const int grid_centre = grid_size / 2;
     const float grid_scale = grid_size * cell_size_rad;
 
+    /* Use multiple threads for larger numbers of points. */
+    if (num_points >= MIN_POINTS_PARALLEL)
+    {
+        oskar_grid_weights_read_parallel_f(num_points, uu, vv, weight_in,
+                weight_out, cell_size_rad, grid_size, num_skipped, grid);
+        return;
+    }
+
     /* Look up gridded weight density at each point location. */
     *num_skipped = 0;
     for (i = 0; i < num_points; ++i)
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/oskar_grid_wproj_sort.h"
+#include "math/oskar_radix_sort.h"
+#include "mem/private_mem_loop.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Side length of a grid tile. 64 x 64 double-precision complex cells
+ * fit in a typical 64 kB L1/L2 working set alongside one W-kernel. */
+#define TILE_SIZE 64
+
+/*
+ * The key of each visibility is its W-plane index and then the index of
+ * its grid tile, in the same way that the gridder finds them. The tiles
+ * are made larger if needed to fit the key into 32 bits. Visibilities off
+ * the grid are given the key of the nearest tile: they are skipped by the
+ * gridder, so their position in the order does not matter.
+ */
+#define GRID_WPROJ_SORT(NAME, FP, ROUND, SQRT, FABS) void NAME(\
+        const size_t num_w_planes, const size_t num_points,\
+        const FP* RESTRICT uu, const FP* RESTRICT vv, const FP* RESTRICT ww,\
+        const FP cell_size_rad, const FP w_scale, const int grid_size,\
+        size_t* RESTRICT order, int* status)\
+{\
+    int tile_size = TILE_SIZE, num_tiles_u;\
+    unsigned int* keys = 0;\
+    const int grid_centre = grid_size / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    const size_t num_planes = num_w_planes > 0 ? num_w_planes : 1;\
+    if (*status || num_points == 0) return;\
+    for (;;) {\
+        num_tiles_u = (grid_size + tile_size - 1) / tile_size;\
+        if (num_planes * num_tiles_u * num_tiles_u <= UINT_MAX) break;\
+        tile_size *= 2;\
+    }\
+    keys = (unsigned int*) malloc(num_points * sizeof(unsigned int));\
+    if (!keys) {\
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;\
+        return;\
+    }\
+    OSKAR_MEM_LOOP_CHUNKS(num_points, start, end)\
+    size_t i;\
+    for (i = start; i < end; ++i) {\
+        size_t grid_w = (size_t)ROUND(SQRT(FABS(ww[i] * w_scale)));\
+        int grid_u = (int)ROUND(-uu[i] * grid_scale) + grid_centre;\
+        int grid_v = (int)ROUND(vv[i] * grid_scale) + grid_centre;\
+        if (grid_w >= num_planes) grid_w = num_planes - 1;\
+        if (grid_u < 0) grid_u = 0;\
+        if (grid_u >= grid_size) grid_u = grid_size - 1;\
+        if (grid_v < 0) grid_v = 0;\
+        if (grid_v >= grid_size) grid_v = grid_size - 1;\
+        keys[i] = (unsigned int) ((grid_w * num_tiles_u +\
+                grid_v / tile_size) * num_tiles_u + grid_u / tile_size);\
+    }\
+    OSKAR_MEM_LOOP_CHUNKS_END\
+    oskar_radix_sort(num_points, keys, order, status);\
+    free(keys);\
+}
+
+GRID_WPROJ_SORT(oskar_grid_wproj_sort_d, double, round, sqrt, fabs)
+GRID_WPROJ_SORT(oskar_grid_wproj_sort_f, float, roundf, sqrtf, fabsf)
+
+#ifdef __cplusplus
+}
+#endif
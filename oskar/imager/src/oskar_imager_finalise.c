@@ -32,13 +32,16 @@
 #include "imager/oskar_grid_correction.h"
 #include "imager/oskar_grid_functions_pillbox.h"
 #include "imager/oskar_grid_functions_spheroidal.h"
+#include "imager/private_imager_finalise_wstack.h"
 #include "imager/private_imager_free_device_data.h"
 #include "math/oskar_fft.h"
 #include "math/oskar_fftphase.h"
 #include "mem/oskar_mem.h"
 #include "utility/oskar_device.h"
+#include "utility/oskar_fits_writer.h"
 #include "utility/oskar_get_error_string.h"
 #include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_kernel_macros.h"
 #include "utility/oskar_timer.h"
 
 #include <fitsio.h>
@@ -46,19 +49,91 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-static void write_plane(oskar_Imager* h, oskar_Mem* plane,
-        int c, int p, int* status);
+static void write_planes(oskar_Imager* h, int* status);
+static void finalise_images_cpu(oskar_Imager* h, int* status);
+static void update_corr_func(oskar_Imager* h, int size, int* status);
+
+/*
+ * The FFT of a grid multiplied by (-1)^(x + y) is the FFT of the grid,
+ * circularly shifted by half the (even) grid size in each dimension.
+ * The functions below therefore skip the phase flip before the FFT, and
+ * read the unshifted FFT output at shifted indices instead. The phase flip
+ * after the FFT, the grid correction and the normalisation (including the
+ * FFT normalisation) are applied in the same pass.
+ */
+
+/* Finalises an FFT output grid in place, keeping it complex. */
+#define FINALISE_GRID(NAME, FP) static void NAME(const int size,\
+        const FP scale, const FP* RESTRICT corr_func, FP* RESTRICT grid)\
+{\
+    int y;\
+    const int half = size / 2;\
+    DO_PRAGMA(omp parallel for private(y)) \
+    for (y = 0; y < half; ++y) {\
+        int x;\
+        const FP c_y = ((y & 1) ? -scale : scale) * corr_func[y];\
+        const FP c_y2 = ((y & 1) ? -scale : scale) * corr_func[y + half];\
+        FP* RESTRICT row = grid + 2 * (size_t) y * size;\
+        FP* RESTRICT row2 = grid + 2 * (size_t) (y + half) * size;\
+        for (x = 0; x < size; ++x) {\
+            /* Swap cells (y, x) and (y + half, x2) and apply the factors.\
+             * Both cells have the same sign of (-1)^(x + y). */\
+            const int x2 = x < half ? x + half : x - half;\
+            const FP a_re = row[2 * x], a_im = row[2 * x + 1];\
+            const FP f = (x & 1) ? -corr_func[x] : corr_func[x];\
+            const FP f2 = (x & 1) ? -corr_func[x2] : corr_func[x2];\
+            row[2 * x]      = row2[2 * x2] * f * c_y;\
+            row[2 * x + 1]  = row2[2 * x2 + 1] * f * c_y;\
+            row2[2 * x2]     = a_re * f2 * c_y2;\
+            row2[2 * x2 + 1] = a_im * f2 * c_y2;\
+        }\
+    }\
+}
+
+/* Writes the real part of the trimmed image from an FFT output grid. */
+#define FINALISE_IMAGE(NAME, FP) static void NAME(const int parallel,\
+        const int size, const int image_size, const FP scale,\
+        const FP* RESTRICT corr_func, const FP* RESTRICT grid,\
+        FP* RESTRICT image)\
+{\
+    int j;\
+    const int half = size / 2, offset = (size - image_size) / 2;\
+    DO_PRAGMA(omp parallel for private(j) if(parallel)) \
+    for (j = 0; j < image_size; ++j) {\
+        int x;\
+        const int y = j + offset;\
+        const FP c_y = ((y & 1) ? -scale : scale) * corr_func[y];\
+        const FP* RESTRICT in = grid +\
+                2 * (size_t) (y < half ? y + half : y - half) * size;\
+        FP* RESTRICT out = image + (size_t) j * image_size - offset;\
+        for (x = offset; x < half; ++x)\
+            out[x] = in[2 * (x + half)] * c_y *\
+                    ((x & 1) ? -corr_func[x] : corr_func[x]);\
+        for (x = half; x < offset + image_size; ++x)\
+            out[x] = in[2 * (x - half)] * c_y *\
+                    ((x & 1) ? -corr_func[x] : corr_func[x]);\
+    }\
+}
+
+FINALISE_GRID(finalise_grid_d, double)
+FINALISE_GRID(finalise_grid_f, float)
+FINALISE_IMAGE(finalise_image_d, double)
+FINALISE_IMAGE(finalise_image_f, float)
 
 
 void oskar_imager_finalise(oskar_Imager* h,
         int num_output_images, oskar_Mem** output_images,
         int num_output_grids, oskar_Mem** output_grids, int* status)
 {
-    int c, p, i;
+    int i;
     size_t j, log_size = 0, length = 0;
     char* log_data;
 
@@ -92,34 +167,61 @@ void oskar_imager_finalise(oskar_Imager* h,
             h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
             h->algorithm == OSKAR_ALGORITHM_DFT_3D))
     {
+        int d, num_temp = h->num_gpus - 1;
+        size_t free_mem;
         const size_t plane_size = (size_t) oskar_imager_plane_size(h);
         const size_t num_cells = plane_size * plane_size;
-        oskar_Mem* temp = oskar_mem_create(oskar_imager_plane_type(h),
-                OSKAR_CPU, num_cells, status);
-        oskar_log_message(h->log, 'M', 0,
-                "Stacking %d grid(s) from %d devices...",
-                h->num_planes, h->num_gpus);
-        oskar_timer_resume(h->tmr_grid_finalise);
-        for (i = 0; i < h->num_planes; ++i)
+        const size_t plane_bytes = num_cells * oskar_mem_element_size(
+                oskar_imager_plane_type(h));
+
+        /* Copy as many device grids to the host at once as memory allows,
+         * so that each host grid is updated in as few passes as possible. */
+        free_mem = oskar_get_free_physical_memory();
+        if (free_mem > 0 && (size_t) num_temp * plane_bytes > free_mem / 2)
+            num_temp = (int) (free_mem / 2 / plane_bytes);
+        if (num_temp < 1) num_temp = 1;
+        oskar_Mem** temp = (oskar_Mem**) calloc(num_temp, sizeof(oskar_Mem*));
+        const oskar_Mem** in = (const oskar_Mem**) calloc(num_temp + 1,
+                sizeof(oskar_Mem*));
+        if (!temp || !in)
+            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        else
         {
-            int d;
-            for (d = 0; d < h->num_gpus; ++d)
+            for (d = 0; d < num_temp; ++d)
+                temp[d] = oskar_mem_create(oskar_imager_plane_type(h),
+                        OSKAR_CPU, num_cells, status);
+            oskar_log_message(h->log, 'M', 0,
+                    "Stacking %d grid(s) from %d devices...",
+                    h->num_planes, h->num_gpus);
+            oskar_timer_resume(h->tmr_grid_finalise);
+            for (i = 0; i < h->num_planes; ++i)
             {
-                oskar_device_set(h->dev_loc, h->gpu_ids[d], status);
-                if (d == 0)
-                    oskar_mem_copy(h->planes[i], h->d[d].planes[i], status);
-                else
+                oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
+                oskar_mem_copy(h->planes[i], h->d[0].planes[i], status);
+                in[0] = h->planes[i];
+                for (d = 1; d < h->num_gpus; d += num_temp)
                 {
-                    oskar_mem_copy(temp, h->d[d].planes[i], status);
-                    oskar_mem_add(h->planes[i], h->planes[i], temp,
-                            0, 0, 0, num_cells, status);
+                    int t;
+                    const int num_batch = (h->num_gpus - d < num_temp) ?
+                            h->num_gpus - d : num_temp;
+                    for (t = 0; t < num_batch; ++t)
+                    {
+                        oskar_device_set(h->dev_loc, h->gpu_ids[d + t], status);
+                        oskar_mem_copy(temp[t], h->d[d + t].planes[i], status);
+                        in[t + 1] = temp[t];
+                    }
+                    oskar_mem_sum(h->planes[i], num_batch + 1, in,
+                            num_cells, status);
                 }
+                oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
+                oskar_mem_copy(h->d[0].planes[i], h->planes[i], status);
             }
-            oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
-            oskar_mem_copy(h->d[0].planes[i], h->planes[i], status);
+            oskar_timer_pause(h->tmr_grid_finalise);
+            for (d = 0; d < num_temp; ++d)
+                oskar_mem_free(temp[d], status);
         }
-        oskar_timer_pause(h->tmr_grid_finalise);
-        oskar_mem_free(temp, status);
+        free(temp);
+        free(in);
     }
 
     /* Copy grids to output grid planes if given. */
@@ -143,7 +245,12 @@ void oskar_imager_finalise(oskar_Imager* h,
     if (h->fits_file[0] || output_images)
     {
         /* Finalise all the planes. */
-        for (i = 0; i < h->num_planes; ++i)
+        if (h->algorithm != OSKAR_ALGORITHM_DFT_2D &&
+                h->algorithm != OSKAR_ALGORITHM_DFT_3D &&
+                !(h->grid_on_gpu && h->num_gpus > 0) &&
+                !(h->fft_on_gpu && h->num_gpus > 0))
+            finalise_images_cpu(h, status);
+        else for (i = 0; i < h->num_planes; ++i)
         {
             oskar_Mem *plane = h->planes[i];
             if (h->grid_on_gpu && h->num_gpus > 0 && !(
@@ -171,9 +278,7 @@ void oskar_imager_finalise(oskar_Imager* h,
 
         /* Write to files if required. */
         oskar_timer_resume(h->tmr_write);
-        for (c = 0, i = 0; c < h->num_im_channels; ++c)
-            for (p = 0; p < h->num_im_pols; ++p, ++i)
-                write_plane(h, h->planes[i], c, p, status);
+        write_planes(h, status);
         oskar_timer_pause(h->tmr_write);
     }
 
@@ -235,9 +340,12 @@ void oskar_imager_finalise(oskar_Imager* h,
             oskar_log_value(h->log, 'M', 0,
                     "Visibilities processed", "%lu",
                     (unsigned long) (h->num_vis_processed));
-        if (h->num_w_planes > 0)
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ && h->num_w_planes > 0)
             oskar_log_value(h->log, 'M', 0,
                     "W-projection planes", "%d", h->num_w_planes);
+        if (h->algorithm == OSKAR_ALGORITHM_WSTACK && h->num_w_layers > 0)
+            oskar_log_value(h->log, 'M', 0,
+                    "W-stacking layers", "%d", h->num_w_layers);
         if (h->fov_deg > 0.1)
             oskar_log_value(h->log, 'M', 0,
                     "Field of view [deg]", "%.1f", h->fov_deg);
@@ -308,19 +416,19 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
 {
     if (*status) return;
 
-    /* Apply normalisation. */
-    if (plane_norm > 0.0 || plane_norm < 0.0)
-    {
-        oskar_timer_resume(h->tmr_grid_finalise);
-        oskar_mem_scale_real(plane, 1.0 / plane_norm,
-                0, oskar_mem_length(plane), status);
-        oskar_timer_pause(h->tmr_grid_finalise);
-    }
-
-    /* If algorithm if DFT, we've finished here. */
+    /* If algorithm if DFT, apply normalisation and we've finished here. */
     if (h->algorithm == OSKAR_ALGORITHM_DFT_2D ||
             h->algorithm == OSKAR_ALGORITHM_DFT_3D)
+    {
+        if (plane_norm > 0.0 || plane_norm < 0.0)
+        {
+            oskar_timer_resume(h->tmr_grid_finalise);
+            oskar_mem_scale_real(plane, 1.0 / plane_norm,
+                    0, oskar_mem_length(plane), status);
+            oskar_timer_pause(h->tmr_grid_finalise);
+        }
         return;
+    }
 
     /* Check plane is complex type, as plane must be gridded visibilities. */
     if (!oskar_mem_is_complex(plane))
@@ -337,10 +445,48 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
         return;
     }
 
-    /* Perform FFT shift of the input grid. */
+    /* On the CPU, use the FFT followed by a single pass over the grid.
+     * W-stacking replaces the FFT of the plane with its stacked layers. */
     oskar_timer_resume(h->tmr_grid_finalise);
     const int fft_loc = (h->fft_on_gpu && h->num_gpus > 0) ?
             h->dev_loc : OSKAR_CPU;
+    if (h->algorithm == OSKAR_ALGORITHM_WSTACK || (fft_loc == OSKAR_CPU &&
+            oskar_mem_location(plane) == OSKAR_CPU && size % 2 == 0))
+    {
+        if (h->algorithm == OSKAR_ALGORITHM_WSTACK)
+            oskar_imager_finalise_wstack(h, plane, status);
+        else
+        {
+            if (!h->fft)
+                h->fft = oskar_fft_create(h->imager_prec, OSKAR_CPU, 2, size,
+                        0, status);
+            oskar_fft_set_ensure_consistent_norm(h->fft, 0);
+            oskar_fft_exec(h->fft, plane, status);
+        }
+        update_corr_func(h, size, status);
+        if (!*status)
+        {
+            double scale = (double) size * (double) size;
+            if (plane_norm > 0.0 || plane_norm < 0.0) scale /= plane_norm;
+            if (oskar_mem_precision(plane) == OSKAR_DOUBLE)
+                finalise_grid_d(size, scale,
+                        oskar_mem_double_const(h->corr_func, status),
+                        oskar_mem_double(plane, status));
+            else
+                finalise_grid_f(size, (float) scale,
+                        oskar_mem_float_const(h->corr_func, status),
+                        oskar_mem_float(plane, status));
+        }
+        oskar_timer_pause(h->tmr_grid_finalise);
+        return;
+    }
+
+    /* Apply normalisation. */
+    if (plane_norm > 0.0 || plane_norm < 0.0)
+        oskar_mem_scale_real(plane, 1.0 / plane_norm,
+                0, oskar_mem_length(plane), status);
+
+    /* Perform FFT shift of the input grid. */
     if (fft_loc != OSKAR_CPU)
         oskar_device_set(h->dev_loc, h->gpu_ids[0], status);
     oskar_fftphase(size, size, plane, status);
@@ -348,14 +494,25 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
     /* Call FFT. */
     if (!h->fft)
         h->fft = oskar_fft_create(h->imager_prec, fft_loc, 2, size, 0, status);
+    oskar_fft_set_ensure_consistent_norm(h->fft, 1);
     oskar_fft_exec(h->fft, plane, status);
 
+    /* FFT shift again, and apply grid correction. */
+    update_corr_func(h, size, status);
+    oskar_fftphase(size, size, plane, status);
+    oskar_grid_correction(size, h->corr_func, plane, status);
+    oskar_timer_pause(h->tmr_grid_finalise);
+}
+
+
+static void update_corr_func(oskar_Imager* h, int size, int* status)
+{
     /* Generate grid correction function if required. */
     if (!h->corr_func)
     {
         oskar_Mem* corr_func = 0;
         corr_func = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, size, status);
-        if (h->algorithm != OSKAR_ALGORITHM_FFT)
+        if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
             oskar_grid_correction_function_spheroidal(size, h->oversample,
                     oskar_mem_double(corr_func, status));
         else
@@ -369,11 +526,116 @@ void oskar_imager_finalise_plane(oskar_Imager* h,
         }
         h->corr_func = oskar_mem_convert_precision(corr_func,
                 h->imager_prec, status);
+        oskar_mem_free(corr_func, status);
     }
+}
 
-    /* FFT shift again, and apply grid correction. */
-    oskar_fftphase(size, size, plane, status);
-    oskar_grid_correction(size, h->corr_func, plane, status);
+
+static void finalise_images_cpu(oskar_Imager* h, int* status)
+{
+    int i, num_threads = 1;
+    const int size = oskar_imager_plane_size(h);
+    const int num_planes = h->num_planes;
+    const size_t num_pix = (size_t)h->image_size * (size_t)h->image_size;
+    const size_t element_size = oskar_mem_element_size(h->imager_prec);
+    if (*status) return;
+
+    /* Fall back to the general version for odd plane sizes. */
+    if (size % 2 != 0)
+    {
+        for (i = 0; i < num_planes; ++i)
+        {
+            oskar_imager_finalise_plane(h, h->planes[i], h->plane_norm[i],
+                    status);
+            oskar_imager_trim_image(h, h->planes[i], size, h->image_size,
+                    status);
+        }
+        return;
+    }
+
+    /* Independent planes are finalised concurrently, each thread using
+     * its own FFT plan and work space. With a single plane, the final pass
+     * over the grid uses all threads instead. W-stacking uses the threads
+     * for the layers of each plane instead. */
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+#endif
+    if (num_threads > num_planes) num_threads = num_planes;
+    if (h->algorithm == OSKAR_ALGORITHM_WSTACK) num_threads = 1;
+    oskar_timer_resume(h->tmr_grid_finalise);
+    update_corr_func(h, size, status);
+    oskar_FFT** fft = (oskar_FFT**) calloc(num_threads, sizeof(oskar_FFT*));
+    oskar_Mem** image = (oskar_Mem**) calloc(num_threads, sizeof(oskar_Mem*));
+    int* plane_status = (int*) calloc(num_planes, sizeof(int));
+    if (!fft || !image || !plane_status)
+    {
+        free(fft);
+        free(image);
+        free(plane_status);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        oskar_timer_pause(h->tmr_grid_finalise);
+        return;
+    }
+    for (i = 0; i < num_threads; ++i)
+    {
+        /* W-stacking creates its own FFT plans for the layers. */
+        if (h->algorithm != OSKAR_ALGORITHM_WSTACK)
+        {
+            fft[i] = oskar_fft_create(h->imager_prec, OSKAR_CPU, 2, size, 0,
+                    status);
+            oskar_fft_set_ensure_consistent_norm(fft[i], 0);
+        }
+        image[i] = oskar_mem_create(h->imager_prec, OSKAR_CPU, num_pix,
+                status);
+    }
+    if (!*status)
+    {
+        DO_PRAGMA(omp parallel for private(i) schedule(dynamic, 1) \
+                num_threads(num_threads))
+        for (i = 0; i < num_planes; ++i)
+        {
+            int thread = 0;
+            oskar_Mem* plane = h->planes[i];
+            double scale = (double) size * (double) size;
+            const double plane_norm = h->plane_norm[i];
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+#endif
+            if (plane_norm > 0.0 || plane_norm < 0.0) scale /= plane_norm;
+            if (!oskar_mem_is_complex(plane))
+                plane_status[i] = OSKAR_ERR_BAD_DATA_TYPE;
+            else if (oskar_mem_length(plane) != (size_t)size * (size_t)size)
+                plane_status[i] = OSKAR_ERR_DIMENSION_MISMATCH;
+            if (h->algorithm == OSKAR_ALGORITHM_WSTACK)
+                oskar_imager_finalise_wstack(h, plane, &plane_status[i]);
+            else
+                oskar_fft_exec(fft[thread], plane, &plane_status[i]);
+            if (plane_status[i]) continue;
+            if (h->imager_prec == OSKAR_DOUBLE)
+                finalise_image_d(num_threads == 1, size, h->image_size, scale,
+                        oskar_mem_double_const(h->corr_func, &plane_status[i]),
+                        oskar_mem_double_const(plane, &plane_status[i]),
+                        oskar_mem_double(image[thread], &plane_status[i]));
+            else
+                finalise_image_f(num_threads == 1, size, h->image_size,
+                        (float) scale,
+                        oskar_mem_float_const(h->corr_func, &plane_status[i]),
+                        oskar_mem_float_const(plane, &plane_status[i]),
+                        oskar_mem_float(image[thread], &plane_status[i]));
+            memcpy(oskar_mem_void(plane), oskar_mem_void_const(image[thread]),
+                    num_pix * element_size);
+        }
+        for (i = 0; i < num_planes; ++i)
+            if (plane_status[i] && !*status) *status = plane_status[i];
+    }
+    for (i = 0; i < num_threads; ++i)
+    {
+        oskar_fft_free(fft[i]);
+        oskar_mem_free(image[i], status);
+    }
+    free(fft);
+    free(image);
+    free(plane_status);
     oskar_timer_pause(h->tmr_grid_finalise);
 }
 
@@ -424,19 +686,44 @@ void oskar_imager_trim_image(oskar_Imager* h, oskar_Mem* plane,
 }
 
 
-void write_plane(oskar_Imager* h, oskar_Mem* plane,
-        int c, int p, int* status)
+/*
+ * The image planes are written straight to their place in each file,
+ * in parallel, rather than one at a time through CFITSIO.
+ * The CFITSIO handles are reopened afterwards to write the history.
+ */
+static void write_planes(oskar_Imager* h, int* status)
 {
-    long firstpix[3];
+    int i, p;
+    oskar_FitsWriter* writer[4] = {0, 0, 0, 0};
     if (*status) return;
-    if (!h->fits_file[p]) return;
-    const int datatype = (oskar_mem_is_double(plane) ? TDOUBLE : TFLOAT);
-    firstpix[0] = 1;
-    firstpix[1] = 1;
-    firstpix[2] = 1 + c;
-    const int num_pixels = h->image_size * h->image_size;
-    fits_write_pix(h->fits_file[p], datatype, firstpix, num_pixels,
-            oskar_mem_void(plane), status);
+    for (p = 0; p < h->num_im_pols; ++p)
+        if (h->fits_file[p])
+            writer[p] = oskar_fits_writer_create(&h->fits_file[p], status);
+    const int num_planes = h->num_im_channels * h->num_im_pols;
+    const size_t num_pixels = (size_t)h->image_size * (size_t)h->image_size;
+    int* plane_status = (int*) calloc(num_planes, sizeof(int));
+    if (!plane_status && !*status)
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+    if (!*status)
+    {
+        DO_PRAGMA(omp parallel for private(i) schedule(dynamic, 1))
+        for (i = 0; i < num_planes; ++i)
+        {
+            long firstpix[3];
+            const int pol = i % h->num_im_pols;
+            if (!writer[pol]) continue;
+            firstpix[0] = 1;
+            firstpix[1] = 1;
+            firstpix[2] = 1 + i / h->num_im_pols;
+            oskar_fits_writer_write(writer[pol], firstpix, num_pixels,
+                    h->planes[i], 0, &plane_status[i]);
+        }
+        for (i = 0; i < num_planes; ++i)
+            if (plane_status[i] && !*status) *status = plane_status[i];
+    }
+    free(plane_status);
+    for (p = 0; p < h->num_im_pols; ++p)
+        oskar_fits_writer_free(writer[p], &h->fits_file[p], status);
 }
 
 
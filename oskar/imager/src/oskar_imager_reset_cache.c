@@ -60,10 +60,24 @@ void oskar_imager_reset_cache(oskar_Imager* h, int* status)
     oskar_mem_free(h->l, status); h->l = 0;
     oskar_mem_free(h->m, status); h->m = 0;
     oskar_mem_free(h->n, status); h->n = 0;
+    oskar_mem_free(h->l_axis, status); h->l_axis = 0;
+    oskar_mem_free(h->m_axis, status); h->m_axis = 0;
+    oskar_mem_free(h->dft_block, status); h->dft_block = 0;
+    oskar_mem_free(h->dft_work, status); h->dft_work = 0;
     oskar_mem_free(h->conv_func, status); h->conv_func = 0;
     oskar_mem_free(h->w_support, status); h->w_support = 0;
     oskar_mem_free(h->w_kernels_compact, status); h->w_kernels_compact = 0;
     oskar_mem_free(h->w_kernel_start, status); h->w_kernel_start = 0;
+    for (i = 0; i < h->num_ws_planes; ++i)
+    {
+        oskar_mem_free(h->ws[i].uu, status);
+        oskar_mem_free(h->ws[i].vv, status);
+        oskar_mem_free(h->ws[i].ww, status);
+        oskar_mem_free(h->ws[i].vis, status);
+        oskar_mem_free(h->ws[i].weight, status);
+    }
+    free(h->ws); h->ws = 0;
+    h->num_ws_planes = 0;
 
     /* Free the image planes. */
     if (h->planes)
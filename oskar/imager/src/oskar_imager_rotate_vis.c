@@ -27,8 +27,10 @@
  */
 
 #include "math/oskar_cmath.h"
+#include "math/oskar_sincos.h"
 #include "imager/private_imager.h"
 #include "imager/oskar_imager.h"
+#include "utility/oskar_kernel_macros.h"
 
 #include <stddef.h>
 
@@ -36,67 +38,64 @@
 extern "C" {
 #endif
 
+#define ROTATE_BLOCK 256
+
+/* The phases for each block of visibilities are evaluated together,
+ * so that their sines and cosines can be vectorised. */
+#define ROTATE_VIS(NAME, FP, FP2) static void NAME(const int num_blocks,\
+        const size_t num, const FP* RESTRICT u, const FP* RESTRICT v,\
+        const FP* RESTRICT w, const double delta_l, const double delta_m,\
+        const double delta_n, FP2* RESTRICT a)\
+{\
+    int b;\
+    const double twopi = 2.0 * M_PI;\
+    DO_PRAGMA(omp parallel for private(b))\
+    for (b = 0; b < num_blocks; ++b) {\
+        size_t i;\
+        double arg[ROTATE_BLOCK];\
+        double phase_re[ROTATE_BLOCK], phase_im[ROTATE_BLOCK];\
+        const size_t start = (size_t) b * ROTATE_BLOCK;\
+        const size_t n = (start + ROTATE_BLOCK < num) ?\
+                ROTATE_BLOCK : num - start;\
+        for (i = 0; i < n; ++i) {\
+            const size_t j = start + i;\
+            arg[i] = twopi * (u[j] * delta_l + v[j] * delta_m +\
+                    w[j] * delta_n);\
+        }\
+        oskar_sincos_array_d(n, arg, phase_im, phase_re);\
+        for (i = 0; i < n; ++i) {\
+            const size_t j = start + i;\
+            const double re = a[j].x * phase_re[i] - a[j].y * phase_im[i];\
+            const double im = a[j].x * phase_im[i] + a[j].y * phase_re[i];\
+            a[j].x = (FP) re;\
+            a[j].y = (FP) im;\
+        }\
+    }\
+}
+
+ROTATE_VIS(rotate_vis_d, double, double2)
+ROTATE_VIS(rotate_vis_f, float, float2)
+
 void oskar_imager_rotate_vis(oskar_Imager* h, size_t num_vis,
         const oskar_Mem* uu_in, const oskar_Mem* vv_in, const oskar_Mem* ww_in,
         oskar_Mem* amps)
 {
-#ifdef OSKAR_OS_WIN
-    int i;
-    const int num = (const int) num_vis;
-#else
-    size_t i;
-    const size_t num = num_vis;
-#endif
-    const double delta_l = h->delta_l;
-    const double delta_m = h->delta_m;
-    const double delta_n = h->delta_n;
-    const double twopi = 2.0 * M_PI;
-
+    const int num_blocks = (int) ((num_vis + ROTATE_BLOCK - 1) / ROTATE_BLOCK);
     oskar_timer_resume(h->tmr_rotate);
     if (oskar_mem_precision(amps) == OSKAR_DOUBLE)
-    {
-        const double *u, *v, *w;
-        double2* a;
-        u = (const double*)oskar_mem_void_const(uu_in);
-        v = (const double*)oskar_mem_void_const(vv_in);
-        w = (const double*)oskar_mem_void_const(ww_in);
-        a = (double2*)oskar_mem_void(amps);
-
-#pragma omp parallel for private(i)
-        for (i = 0; i < num; ++i)
-        {
-            double arg, phase_re, phase_im, re, im;
-            arg = twopi * (u[i] * delta_l + v[i] * delta_m + w[i] * delta_n);
-            phase_re = cos(arg);
-            phase_im = sin(arg);
-            re = a[i].x * phase_re - a[i].y * phase_im;
-            im = a[i].x * phase_im + a[i].y * phase_re;
-            a[i].x = re;
-            a[i].y = im;
-        }
-    }
+        rotate_vis_d(num_blocks, num_vis,
+                (const double*)oskar_mem_void_const(uu_in),
+                (const double*)oskar_mem_void_const(vv_in),
+                (const double*)oskar_mem_void_const(ww_in),
+                h->delta_l, h->delta_m, h->delta_n,
+                (double2*)oskar_mem_void(amps));
     else
-    {
-        const float *u, *v, *w;
-        float2* a;
-        u = (const float*)oskar_mem_void_const(uu_in);
-        v = (const float*)oskar_mem_void_const(vv_in);
-        w = (const float*)oskar_mem_void_const(ww_in);
-        a = (float2*)oskar_mem_void(amps);
-
-#pragma omp parallel for private(i)
-        for (i = 0; i < num; ++i)
-        {
-            double arg, phase_re, phase_im, re, im;
-            arg = twopi * (u[i] * delta_l + v[i] * delta_m + w[i] * delta_n);
-            phase_re = cos(arg);
-            phase_im = sin(arg);
-            re = a[i].x * phase_re - a[i].y * phase_im;
-            im = a[i].x * phase_im + a[i].y * phase_re;
-            a[i].x = (float) re;
-            a[i].y = (float) im;
-        }
-    }
+        rotate_vis_f(num_blocks, num_vis,
+                (const float*)oskar_mem_void_const(uu_in),
+                (const float*)oskar_mem_void_const(vv_in),
+                (const float*)oskar_mem_void_const(ww_in),
+                h->delta_l, h->delta_m, h->delta_n,
+                (float2*)oskar_mem_void(amps));
     oskar_timer_pause(h->tmr_rotate);
 }
 
@@ -27,11 +27,13 @@
  */
 
 #include "imager/private_imager.h"
+#include "imager/private_imager_coords_cache.h"
 #include "imager/private_imager_read_coords.h"
 #include "imager/private_imager_read_data.h"
 #include "imager/private_imager_read_dims.h"
 #include "imager/oskar_imager.h"
 #include "utility/oskar_get_error_string.h"
+#include "utility/oskar_trace.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -41,6 +43,7 @@ extern "C" {
 #endif
 
 static int oskar_imager_is_ms(const char* filename);
+static void write_trace(oskar_Imager* h, const char* filename);
 
 void oskar_imager_run(oskar_Imager* h,
         int num_output_images, oskar_Mem** output_images,
@@ -62,6 +65,10 @@ void oskar_imager_run(oskar_Imager* h,
     /* Clear imager cache. */
     oskar_imager_reset_cache(h, status);
 
+    /* Record trace events if required. */
+    const char* trace_file = getenv("OSKAR_TRACE_FILE");
+    if (trace_file && strlen(trace_file) > 0) oskar_trace_start();
+
     /* Read dimension sizes. */
     for (i = 0; i < num_files; ++i)
     {
@@ -78,6 +85,7 @@ void oskar_imager_run(oskar_Imager* h,
     /* Check for errors. */
     if (*status)
     {
+        write_trace(h, trace_file);
         oskar_imager_reset_cache(h, status);
         return;
     }
@@ -87,13 +95,18 @@ void oskar_imager_run(oskar_Imager* h,
     {
         oskar_log_error(h->log, "No data selected.");
         *status = OSKAR_ERR_OUT_OF_RANGE;
+        write_trace(h, trace_file);
         oskar_imager_reset_cache(h, status);
         return;
     }
 
+    /* Reuse temporary arrays allocated for each block of data. */
+    oskar_mem_pool_scope_begin();
+
     /* Read baseline coordinates and weights if required. */
     if (h->weighting == OSKAR_WEIGHTING_UNIFORM ||
-            h->algorithm == OSKAR_ALGORITHM_WPROJ)
+            h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK)
     {
         oskar_imager_set_coords_only(h, 1);
         oskar_log_section(h->log, 'M', "Reading coordinates...");
@@ -104,12 +117,18 @@ void oskar_imager_run(oskar_Imager* h,
             /* Read coordinates and weights. */
             if (*status) break;
             filename = h->input_files[i];
+            if (h->coords_cache &&
+                    oskar_imager_coords_cache_load(h, filename, status))
+                continue;
+            if (h->coords_cache)
+                oskar_imager_coords_cache_begin(h, filename, status);
             if (oskar_imager_is_ms(filename))
                 oskar_imager_read_coords_ms(h, filename, i, num_files,
                         &percent_done, &percent_next, status);
             else
                 oskar_imager_read_coords_vis(h, filename, i, num_files,
                         &percent_done, &percent_next, status);
+            oskar_imager_coords_cache_end(h, status);
         }
         oskar_imager_set_coords_only(h, 0);
     }
@@ -117,6 +136,8 @@ void oskar_imager_run(oskar_Imager* h,
     /* Check for errors. */
     if (*status)
     {
+        oskar_mem_pool_scope_end();
+        write_trace(h, trace_file);
         oskar_imager_reset_cache(h, status);
         return;
     }
@@ -140,10 +161,12 @@ void oskar_imager_run(oskar_Imager* h,
             oskar_imager_read_data_vis(h, filename, i, num_files,
                     &percent_done, &percent_next, status);
     }
+    oskar_mem_pool_scope_end();
 
     /* Check for errors. */
     if (*status)
     {
+        write_trace(h, trace_file);
         oskar_imager_reset_cache(h, status);
         return;
     }
@@ -151,6 +174,22 @@ void oskar_imager_run(oskar_Imager* h,
     /* Finalise. */
     oskar_imager_finalise(h, num_output_images, output_images,
             num_output_grids, output_grids, status);
+    write_trace(h, trace_file);
+}
+
+
+/* Failure to write the trace file does not fail the imaging run. */
+static void write_trace(oskar_Imager* h, const char* filename)
+{
+    int trace_status = 0;
+    if (!oskar_trace_enabled()) return;
+    oskar_trace_stop();
+    oskar_trace_write(filename, &trace_status);
+    if (trace_status)
+        oskar_log_warning(h->log, "Unable to write trace file '%s'.",
+                filename);
+    else
+        oskar_log_message(h->log, 'M', 0, "Trace written to '%s'.", filename);
 }
 
 
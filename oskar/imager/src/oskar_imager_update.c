@@ -28,8 +28,8 @@
 
 #include "imager/private_imager.h"
 
-#include "imager/oskar_grid_weights.h"
 #include "imager/oskar_imager.h"
+#include "imager/private_imager_coords_cache.h"
 #include "imager/private_imager_create_fits_files.h"
 #include "imager/private_imager_filter_time.h"
 #include "imager/private_imager_filter_uv.h"
@@ -38,6 +38,9 @@
 #include "imager/private_imager_update_plane_dft.h"
 #include "imager/private_imager_update_plane_fft.h"
 #include "imager/private_imager_update_plane_wproj.h"
+#include "imager/private_imager_update_plane_wstack.h"
+#include "imager/private_imager_update_planes_fft.h"
+#include "imager/private_imager_update_weights_grid.h"
 #include "imager/private_imager_weight_radial.h"
 #include "imager/private_imager_weight_uniform.h"
 #include "log/oskar_log.h"
@@ -52,10 +55,6 @@ extern "C" {
 #endif
 
 static void oskar_imager_allocate_planes(oskar_Imager* h, int *status);
-static void oskar_imager_update_weights_grid(oskar_Imager* h,
-        size_t num_points, const oskar_Mem* uu, const oskar_Mem* vv,
-        const oskar_Mem* ww, const oskar_Mem* weight, oskar_Mem* weights_grid,
-        int* status);
 
 void oskar_imager_update_from_block(oskar_Imager* h,
         const oskar_VisHeader* hdr, const oskar_VisBlock* block,
@@ -167,119 +166,6 @@ void oskar_imager_update_from_block(oskar_Imager* h,
     oskar_mem_free(time_centroid, status);
 }
 
-#if 0
-static int compare_f(const void *p0, const void *p1)
-{
-    float w0 = fabs(**(const float* const*)p0);
-    float w1 = fabs(**(const float* const*)p1);
-    if (w0 > w1) return 1;
-    if (w0 < w1) return -1;
-    return 0;
-}
-
-static int compare_d(const void *p0, const void *p1)
-{
-    double w0 = fabs(**(const double* const*)p0);
-    double w1 = fabs(**(const double* const*)p1);
-    if (w0 > w1) return 1;
-    if (w0 < w1) return -1;
-    return 0;
-}
-
-static void oskar_imager_sort_by_abs_w(size_t num_vis,
-        oskar_Mem* uu, oskar_Mem* vv, oskar_Mem* ww, oskar_Mem* amps,
-        oskar_Mem* weight, int* status)
-{
-    if (*status || num_vis == 0) return;
-    /* Based on:
-     * https://stackoverflow.com/questions/32948281/c-sort-two-arrays-the-same-way */
-    if (oskar_mem_precision(weight) == OSKAR_SINGLE)
-    {
-        size_t i;
-        float** ptr_w = (float**) calloc(num_vis, sizeof(float*));
-        float* uu_ = oskar_mem_float(uu, status);
-        float* vv_ = oskar_mem_float(vv, status);
-        float* ww_ = oskar_mem_float(ww, status);
-        float2* vis_ = oskar_mem_float2(amps, status);
-        float* weight_ = oskar_mem_float(weight, status);
-        for (i = 0; i < num_vis; ++i) ptr_w[i] = &ww_[i];
-        qsort(ptr_w, num_vis, sizeof(void*), compare_f);
-        for (i = 0; i < num_vis; ++i)
-        {
-            if (i != (size_t) (ptr_w[i] - ww_))
-            {
-                size_t j, k;
-                const float temp_u = uu_[i];
-                const float temp_v = vv_[i];
-                const float temp_w = ww_[i];
-                const float2 temp_vis = vis_[i];
-                const float temp_weight = weight_[i];
-                k = i;
-                while (i != (j = (size_t) (ptr_w[k] - ww_)))
-                {
-                    uu_[k] = uu_[j];
-                    vv_[k] = vv_[j];
-                    ww_[k] = ww_[j];
-                    vis_[k] = vis_[j];
-                    weight_[k] = weight_[j];
-                    ptr_w[k] = &ww_[k];
-                    k = j;
-                }
-                uu_[k] = temp_u;
-                vv_[k] = temp_v;
-                ww_[k] = temp_w;
-                vis_[k] = temp_vis;
-                weight_[k] = temp_weight;
-                ptr_w[k] = &ww_[k];
-            }
-        }
-        free(ptr_w);
-    }
-    else
-    {
-        size_t i;
-        double** ptr_w = (double**) calloc(num_vis, sizeof(double*));
-        double* uu_ = oskar_mem_double(uu, status);
-        double* vv_ = oskar_mem_double(vv, status);
-        double* ww_ = oskar_mem_double(ww, status);
-        double2* vis_ = oskar_mem_double2(amps, status);
-        double* weight_ = oskar_mem_double(weight, status);
-        for (i = 0; i < num_vis; ++i) ptr_w[i] = &ww_[i];
-        qsort(ptr_w, num_vis, sizeof(void*), compare_d);
-        for (i = 0; i < num_vis; ++i)
-        {
-            if (i != (size_t) (ptr_w[i] - ww_))
-            {
-                size_t j, k;
-                const double temp_u = uu_[i];
-                const double temp_v = vv_[i];
-                const double temp_w = ww_[i];
-                const double2 temp_vis = vis_[i];
-                const double temp_weight = weight_[i];
-                k = i;
-                while (i != (j = (size_t) (ptr_w[k] - ww_)))
-                {
-                    uu_[k] = uu_[j];
-                    vv_[k] = vv_[j];
-                    ww_[k] = ww_[j];
-                    vis_[k] = vis_[j];
-                    weight_[k] = weight_[j];
-                    ptr_w[k] = &ww_[k];
-                    k = j;
-                }
-                uu_[k] = temp_u;
-                vv_[k] = temp_v;
-                ww_[k] = temp_w;
-                vis_[k] = temp_vis;
-                weight_[k] = temp_weight;
-                ptr_w[k] = &ww_[k];
-            }
-        }
-        free(ptr_w);
-    }
-}
-#endif
-
 void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         int end_chan, int num_pols, const oskar_Mem* uu, const oskar_Mem* vv,
         const oskar_Mem* ww, const oskar_Mem* amps, const oskar_Mem* weight,
@@ -365,6 +251,27 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
         weight_in = th;
     }
 
+    /* Grid all the image planes in one pass over the rows if possible. */
+    if (!h->coords_only && oskar_imager_update_planes_fft_supported(h) &&
+            oskar_mem_location(u_in) == OSKAR_CPU &&
+            oskar_mem_location(amp_in) == OSKAR_CPU)
+    {
+        size_t num_skipped = 0;
+        oskar_timer_resume(h->tmr_grid_update);
+        oskar_imager_update_planes_fft(h, num_rows, start_chan, end_chan,
+                num_pols, u_in, v_in, amp_in, weight_in, &num_skipped, status);
+        oskar_timer_pause(h->tmr_grid_update);
+        if (num_skipped > 0)
+            oskar_log_warning(h->log, "Skipped %lu visibility points.",
+                    (unsigned long) num_skipped);
+        oskar_mem_free(tu, status);
+        oskar_mem_free(tv, status);
+        oskar_mem_free(tw, status);
+        oskar_mem_free(ta, status);
+        oskar_mem_free(th, status);
+        return;
+    }
+
     /* Ensure work arrays are large enough. */
     max_num_vis = num_rows;
     if (!h->chan_snaps) max_num_vis *= (1 + end_chan - start_chan);
@@ -431,15 +338,13 @@ void oskar_imager_update(oskar_Imager* h, size_t num_rows, int start_chan,
             oskar_imager_filter_uv(h, &num_vis, h->uu_im, h->vv_im,
                     h->ww_im, h->vis_im, h->weight_im, status);
 
-#if 0
-            /* Sort visibility data by w coordinate. */
-            if (h->algorithm == OSKAR_ALGORITHM_WPROJ && !h->coords_only)
-                oskar_imager_sort_by_abs_w(num_vis, h->uu_im, h->vv_im,
-                        h->ww_im, h->vis_im, h->weight_im, status);
-#endif
+            /* Record the coordinates for this plane if required. */
+            i_plane = h->num_im_pols * c + p;
+            if (h->coords_only && h->coords_cache_writer)
+                oskar_imager_coords_cache_write(h, i_plane, num_vis,
+                        h->uu_im, h->vv_im, h->ww_im, h->weight_im, status);
 
             /* Update this image plane with the visibilities. */
-            i_plane = h->num_im_pols * c + p;
             oskar_imager_update_plane(h, num_vis, h->uu_im, h->vv_im,
                     h->ww_im, (h->coords_only ? 0 : h->vis_im), h->weight_im,
                     i_plane, 0, 0, h->weights_grids[i_plane], status);
@@ -568,6 +473,10 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
             oskar_imager_update_plane_wproj(h, num_vis, pu, pv, pw, pa, ph,
                     i_plane, plane, plane_norm_ptr, &num_skipped, status);
             break;
+        case OSKAR_ALGORITHM_WSTACK:
+            oskar_imager_update_plane_wstack(h, num_vis, pu, pv, pw, pa, ph,
+                    i_plane, plane, plane_norm_ptr, &num_skipped, status);
+            break;
         default:
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
             break;
@@ -588,75 +497,6 @@ void oskar_imager_update_plane(oskar_Imager* h, size_t num_vis,
 }
 
 
-void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
-        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
-        const oskar_Mem* weight, oskar_Mem* weights_grid, int* status)
-{
-    if (*status) return;
-
-    /* Update the weights grid. */
-    if (h->weighting == OSKAR_WEIGHTING_UNIFORM)
-    {
-        size_t num_skipped = 0;
-
-        /* Resize the grid of weights if needed. */
-        const int grid_size = oskar_imager_plane_size(h);
-        oskar_mem_ensure(weights_grid, (size_t) grid_size * grid_size, status);
-        if (*status) return;
-
-        oskar_timer_resume(h->tmr_weights_grid);
-        if (oskar_mem_precision(weights_grid) == OSKAR_DOUBLE)
-            oskar_grid_weights_write_d(num_points,
-                    oskar_mem_double_const(uu, status),
-                    oskar_mem_double_const(vv, status),
-                    oskar_mem_double_const(weight, status),
-                    h->cellsize_rad, grid_size, &num_skipped,
-                    oskar_mem_double(weights_grid, status));
-        else
-            oskar_grid_weights_write_f(num_points,
-                    oskar_mem_float_const(uu, status),
-                    oskar_mem_float_const(vv, status),
-                    oskar_mem_float_const(weight, status),
-                    (float) (h->cellsize_rad), grid_size, &num_skipped,
-                    oskar_mem_float(weights_grid, status));
-        if (num_skipped > 0)
-            oskar_log_warning(h->log, "Skipped %lu visibility weights.",
-                    (unsigned long) num_skipped);
-        oskar_timer_pause(h->tmr_weights_grid);
-    }
-
-    /* Update baseline W minimum, maximum and RMS. */
-    if (h->algorithm == OSKAR_ALGORITHM_WPROJ)
-    {
-        size_t j;
-        oskar_timer_resume(h->tmr_coord_scan);
-        if (oskar_mem_precision(ww) == OSKAR_DOUBLE)
-        {
-            const double *p = oskar_mem_double_const(ww, status);
-            for (j = 0; j < num_points; ++j)
-            {
-                const double val = fabs(p[j]);
-                h->ww_rms += (val * val);
-                if (val < h->ww_min) h->ww_min = val;
-                if (val > h->ww_max) h->ww_max = val;
-            }
-        }
-        else
-        {
-            const float *p = oskar_mem_float_const(ww, status);
-            for (j = 0; j < num_points; ++j)
-            {
-                const double val = fabs((double) (p[j]));
-                h->ww_rms += (val * val);
-                if (val < h->ww_min) h->ww_min = val;
-                if (val > h->ww_max) h->ww_max = val;
-            }
-        }
-        h->ww_points += num_points;
-        oskar_timer_pause(h->tmr_coord_scan);
-    }
-}
-
 void oskar_imager_allocate_planes(oskar_Imager* h, int *status)
 {
     int i;
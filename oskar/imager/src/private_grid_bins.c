@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_grid_bins.h"
+#include "utility/oskar_kernel_macros.h"
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int oskar_grid_bins_sort(size_t num_points, const int* RESTRICT bin,
+        int num_bins, size_t* RESTRICT bin_start, size_t* RESTRICT order)
+{
+    int b, c;
+    size_t offset = 0;
+#ifdef _OPENMP
+    const int num_chunks = omp_get_max_threads();
+#else
+    const int num_chunks = 1;
+#endif
+    /* One row of counts for each chunk of input. */
+    size_t* counts = (size_t*) calloc(
+            (size_t) num_chunks * num_bins, sizeof(size_t));
+    if (!counts) return 1;
+
+    /* Count the points in each bin for each chunk of input. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < num_chunks; ++c)
+    {
+        size_t i;
+        size_t* RESTRICT count = counts + (size_t) c * num_bins;
+        const size_t end = num_points * (c + 1) / num_chunks;
+        for (i = num_points * c / num_chunks; i < end; ++i)
+            if (bin[i] >= 0) count[bin[i]]++;
+    }
+
+    /* Convert the counts to output positions, in input order per bin. */
+    for (b = 0; b < num_bins; ++b)
+    {
+        bin_start[b] = offset;
+        for (c = 0; c < num_chunks; ++c)
+        {
+            const size_t n = counts[(size_t) c * num_bins + b];
+            counts[(size_t) c * num_bins + b] = offset;
+            offset += n;
+        }
+    }
+    bin_start[num_bins] = offset;
+
+    /* Write the index of each point at its position. */
+#pragma omp parallel for private(c)
+    for (c = 0; c < num_chunks; ++c)
+    {
+        size_t i;
+        size_t* RESTRICT pos = counts + (size_t) c * num_bins;
+        const size_t end = num_points * (c + 1) / num_chunks;
+        for (i = num_points * c / num_chunks; i < end; ++i)
+            if (bin[i] >= 0) order[pos[bin[i]]++] = i;
+    }
+    free(counts);
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,449 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_coords_cache.h"
+#include "imager/private_imager_set_num_planes.h"
+#include "imager/private_imager_update_weights_grid.h"
+#include "utility/oskar_file_map.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The cache holds the baseline coordinates and weights used to update each
+ * image plane in the coordinate pass, after selection, scaling to
+ * wavelengths, rotation and filtering, in the precision of the imager.
+ * These depend only on the input file and on the settings in the key, so
+ * the weights grids and W statistics can be rebuilt from the cache for any
+ * image size and cell size.
+ *
+ * Layout (native byte order; all blocks are multiples of 8 bytes):
+ *   CacheHeader, settings key (padded);
+ *   for each record: CacheRecord, then uu, vv, ww (unless the same as
+ *     those of the previous record) and weight, each padded;
+ *   CacheFooter.
+ */
+#define CACHE_MAGIC     "OSKARCC1"
+#define CACHE_END_MAGIC "OSKARCCE"
+#define CACHE_VERSION   1
+#define CACHE_SUFFIX    ".oskar_coord_cache"
+
+typedef struct
+{
+    char magic[8];
+    int32_t version, precision, num_planes, key_bytes;
+    uint64_t input_size;
+    double input_mtime;
+} CacheHeader;
+
+typedef struct
+{
+    int32_t i_plane, same_coords;
+    uint64_t num_vis;
+} CacheRecord;
+
+typedef struct
+{
+    double ww_min, ww_max, ww_sumsq;
+    uint64_t ww_points, num_records;
+    char magic[8];
+} CacheFooter;
+
+struct CoordsCacheWriter
+{
+    FILE* file;
+    char *name, *tmp_name;
+    oskar_Mem *uu, *vv, *ww; /* Coordinates of the last record written. */
+    size_t num_prev;
+    CacheFooter footer;
+};
+
+static size_t padded(size_t bytes)
+{
+    return (bytes + 7) & ~((size_t) 7);
+}
+
+
+/* Returns a string describing the settings the cached coordinates
+ * depend on, padded with zeros to a multiple of 8 bytes. */
+static char* settings_key(const oskar_Imager* h, size_t* key_bytes)
+{
+    int i;
+    size_t len;
+    const size_t max_len = 512 + 32 * (size_t) h->num_sel_freqs;
+    char* key = (char*) calloc(max_len, 1);
+    if (!key) return 0;
+    len = (size_t) sprintf(key, "prec=%d snaps=%d type=%d pol=%d,%d "
+            "dir=%c centre=%.17g,%.17g time=%.17g,%.17g uv=%.17g,%.17g "
+            "freq=%.17g,%.17g vis_freq=%.17g,%.17g sel=",
+            h->imager_prec, h->chan_snaps, h->im_type, h->num_im_pols,
+            h->pol_offset, h->direction_type ? h->direction_type : '-',
+            h->im_centre_deg[0], h->im_centre_deg[1],
+            h->time_min_utc, h->time_max_utc,
+            h->uv_filter_min, h->uv_filter_max,
+            h->freq_min_hz, h->freq_max_hz,
+            h->vis_freq_start_hz, h->freq_inc_hz);
+    for (i = 0; i < h->num_sel_freqs; ++i)
+        len += (size_t) sprintf(key + len, "%.17g,", h->sel_freqs[i]);
+    *key_bytes = padded(len + 1);
+    return key;
+}
+
+
+static void update_stats(CacheFooter* f, size_t num, const oskar_Mem* ww,
+        int* status)
+{
+    size_t j;
+    if (oskar_mem_precision(ww) == OSKAR_DOUBLE)
+    {
+        const double *p = oskar_mem_double_const(ww, status);
+        for (j = 0; j < num; ++j)
+        {
+            const double val = fabs(p[j]);
+            f->ww_sumsq += (val * val);
+            if (val < f->ww_min) f->ww_min = val;
+            if (val > f->ww_max) f->ww_max = val;
+        }
+    }
+    else
+    {
+        const float *p = oskar_mem_float_const(ww, status);
+        for (j = 0; j < num; ++j)
+        {
+            const double val = fabs((double) (p[j]));
+            f->ww_sumsq += (val * val);
+            if (val < f->ww_min) f->ww_min = val;
+            if (val > f->ww_max) f->ww_max = val;
+        }
+    }
+    f->ww_points += num;
+}
+
+
+static int write_block(FILE* file, const void* data, size_t bytes)
+{
+    static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    const size_t pad = padded(bytes) - bytes;
+    if (bytes > 0 && fwrite(data, 1, bytes, file) != bytes) return 0;
+    if (pad > 0 && fwrite(zeros, 1, pad, file) != pad) return 0;
+    return 1;
+}
+
+
+static void close_writer(oskar_Imager* h, int keep, int* status)
+{
+    struct CoordsCacheWriter* cc = h->coords_cache_writer;
+    if (!cc) return;
+    if (cc->file)
+    {
+        if (keep)
+        {
+            memcpy(cc->footer.magic, CACHE_END_MAGIC, 8);
+            keep = write_block(cc->file, &cc->footer, sizeof(CacheFooter));
+        }
+        if (fclose(cc->file)) keep = 0;
+        if (keep)
+        {
+            /* Replace any old cache only once the new one is complete. */
+            (void) remove(cc->name);
+            keep = !rename(cc->tmp_name, cc->name);
+        }
+        if (!keep)
+        {
+            (void) remove(cc->tmp_name);
+            if (!*status)
+                oskar_log_warning(h->log,
+                        "Unable to write coordinate cache '%s'.", cc->name);
+        }
+    }
+    oskar_mem_free(cc->uu, status);
+    oskar_mem_free(cc->vv, status);
+    oskar_mem_free(cc->ww, status);
+    free(cc->name);
+    free(cc->tmp_name);
+    free(cc);
+    h->coords_cache_writer = 0;
+}
+
+
+char* oskar_imager_coords_cache_name(const char* filename)
+{
+    char* name = (char*) calloc(strlen(filename) + sizeof(CACHE_SUFFIX), 1);
+    if (name) sprintf(name, "%s%s", filename, CACHE_SUFFIX);
+    return name;
+}
+
+
+/* Returns the offset of the footer if the cache is valid, or 0 if not. */
+static size_t check_cache(const oskar_Imager* h, const char* data,
+        size_t size, const char* filename)
+{
+    size_t input_size = 0, key_bytes = 0, offset;
+    double input_mtime = 0.0;
+    CacheHeader hdr;
+    CacheFooter ftr;
+    CacheRecord rec;
+    uint64_t r;
+    int same_allowed = 0;
+    if (size < sizeof(CacheHeader) + sizeof(CacheFooter)) return 0;
+    const size_t end = size - sizeof(CacheFooter);
+    memcpy(&hdr, data, sizeof(CacheHeader));
+    memcpy(&ftr, data + end, sizeof(CacheFooter));
+    if (memcmp(hdr.magic, CACHE_MAGIC, 8) ||
+            memcmp(ftr.magic, CACHE_END_MAGIC, 8) ||
+            hdr.version != CACHE_VERSION ||
+            hdr.precision != h->imager_prec ||
+            hdr.num_planes != h->num_planes)
+        return 0;
+
+    /* Check the input file has not changed since the cache was written. */
+    if (!oskar_file_stat(filename, &input_size, &input_mtime) ||
+            hdr.input_size != (uint64_t) input_size ||
+            hdr.input_mtime != input_mtime)
+        return 0;
+
+    /* Check the settings that the coordinates depend on. */
+    char* key = settings_key(h, &key_bytes);
+    if (!key || hdr.key_bytes != (int32_t) key_bytes ||
+            key_bytes > end - sizeof(CacheHeader) ||
+            memcmp(key, data + sizeof(CacheHeader), key_bytes))
+    {
+        free(key);
+        return 0;
+    }
+    free(key);
+
+    /* Check the records fit exactly between the header and the footer. */
+    const size_t element_size = oskar_mem_element_size(h->imager_prec);
+    offset = sizeof(CacheHeader) + key_bytes;
+    for (r = 0; r < ftr.num_records; ++r)
+    {
+        if (end - offset < sizeof(CacheRecord)) return 0;
+        memcpy(&rec, data + offset, sizeof(CacheRecord));
+        offset += sizeof(CacheRecord);
+        if (rec.i_plane < 0 || rec.i_plane >= h->num_planes ||
+                rec.num_vis > size / element_size ||
+                (rec.same_coords && !same_allowed))
+            return 0;
+        const size_t bytes = padded((size_t) rec.num_vis * element_size);
+        const size_t num_arrays = rec.same_coords ? 1 : 4;
+        if ((end - offset) / num_arrays < bytes) return 0;
+        offset += num_arrays * bytes;
+        same_allowed = 1;
+    }
+    return (offset == end) ? end : 0;
+}
+
+
+int oskar_imager_coords_cache_load(oskar_Imager* h, const char* filename,
+        int* status)
+{
+    size_t size = 0, offset, end;
+    uint64_t r;
+    CacheHeader hdr;
+    CacheFooter ftr;
+    char *uu = 0, *vv = 0;
+    if (*status) return 0;
+    char* name = oskar_imager_coords_cache_name(filename);
+    char* data = (char*) oskar_file_map(name, &size);
+    if (!data)
+    {
+        free(name);
+        return 0;
+    }
+
+    /* The cache must match the image planes being made. */
+    oskar_imager_set_num_planes(h, status);
+    oskar_imager_check_init(h, status);
+    end = *status ? 0 : check_cache(h, data, size, filename);
+    if (!end)
+    {
+        if (!*status)
+            oskar_log_message(h->log, 'M', 0,
+                    "Coordinate cache '%s' is out of date.", name);
+        oskar_file_unmap(data, size);
+        free(name);
+        return 0;
+    }
+    oskar_log_message(h->log, 'M', 0, "Using coordinate cache '%s'", name);
+    free(name);
+    memcpy(&hdr, data, sizeof(CacheHeader));
+    memcpy(&ftr, data + end, sizeof(CacheFooter));
+
+    /* Rebuild the weights grids from the cached coordinates. */
+    const size_t element_size = oskar_mem_element_size(h->imager_prec);
+    offset = sizeof(CacheHeader) + (size_t) hdr.key_bytes;
+    for (r = 0; r < ftr.num_records && !*status; ++r)
+    {
+        CacheRecord rec;
+        memcpy(&rec, data + offset, sizeof(CacheRecord));
+        offset += sizeof(CacheRecord);
+        const size_t num = (size_t) rec.num_vis;
+        const size_t bytes = padded(num * element_size);
+        if (!rec.same_coords)
+        {
+            uu = data + offset;
+            vv = data + offset + bytes;
+            offset += 3 * bytes;
+        }
+        char* weight = data + offset;
+        offset += bytes;
+        if (h->weighting == OSKAR_WEIGHTING_UNIFORM && num > 0)
+        {
+            oskar_Mem *uu_, *vv_, *weight_;
+            uu_ = oskar_mem_create_alias_from_raw(uu,
+                    h->imager_prec, OSKAR_CPU, num, status);
+            vv_ = oskar_mem_create_alias_from_raw(vv,
+                    h->imager_prec, OSKAR_CPU, num, status);
+            weight_ = oskar_mem_create_alias_from_raw(weight,
+                    h->imager_prec, OSKAR_CPU, num, status);
+            oskar_imager_update_weights_grid(h, num, uu_, vv_, 0, weight_,
+                    h->weights_grids[rec.i_plane], status);
+            oskar_mem_free(uu_, status);
+            oskar_mem_free(vv_, status);
+            oskar_mem_free(weight_, status);
+        }
+    }
+    oskar_file_unmap(data, size);
+
+    /* Merge the cached W statistics. */
+    if (h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK)
+    {
+        if (ftr.ww_min < h->ww_min) h->ww_min = ftr.ww_min;
+        if (ftr.ww_max > h->ww_max) h->ww_max = ftr.ww_max;
+        h->ww_rms += ftr.ww_sumsq;
+        h->ww_points += (size_t) ftr.ww_points;
+    }
+    return !*status;
+}
+
+
+void oskar_imager_coords_cache_begin(oskar_Imager* h, const char* filename,
+        int* status)
+{
+    size_t input_size = 0, key_bytes = 0;
+    double input_mtime = 0.0;
+    CacheHeader hdr;
+    struct CoordsCacheWriter* cc;
+    if (*status || h->coords_cache_writer) return;
+    oskar_imager_set_num_planes(h, status);
+    if (*status || !oskar_file_stat(filename, &input_size, &input_mtime)) return;
+    char* key = settings_key(h, &key_bytes);
+    if (!key) return;
+    cc = (struct CoordsCacheWriter*) calloc(1,
+            sizeof(struct CoordsCacheWriter));
+    if (!cc)
+    {
+        free(key);
+        return;
+    }
+    h->coords_cache_writer = cc;
+    cc->name = oskar_imager_coords_cache_name(filename);
+    if (cc->name) cc->tmp_name = (char*) calloc(strlen(cc->name) + 5, 1);
+    if (!cc->tmp_name)
+    {
+        close_writer(h, 0, status);
+        free(key);
+        return;
+    }
+    sprintf(cc->tmp_name, "%s.tmp", cc->name);
+    cc->uu = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    cc->vv = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    cc->ww = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    cc->footer.ww_min = DBL_MAX;
+    cc->footer.ww_max = -DBL_MAX;
+    cc->file = fopen(cc->tmp_name, "wb");
+    if (!cc->file)
+    {
+        oskar_log_warning(h->log, "Unable to write coordinate cache '%s'.",
+                cc->name);
+        close_writer(h, 0, status);
+        free(key);
+        return;
+    }
+    oskar_log_message(h->log, 'M', 0, "Writing coordinate cache '%s'",
+            cc->name);
+
+    /* Write the header. */
+    memset(&hdr, 0, sizeof(CacheHeader));
+    memcpy(hdr.magic, CACHE_MAGIC, 8);
+    hdr.version = CACHE_VERSION;
+    hdr.precision = h->imager_prec;
+    hdr.num_planes = h->num_planes;
+    hdr.key_bytes = (int32_t) key_bytes;
+    hdr.input_size = (uint64_t) input_size;
+    hdr.input_mtime = input_mtime;
+    if (!write_block(cc->file, &hdr, sizeof(CacheHeader)) ||
+            !write_block(cc->file, key, key_bytes))
+        close_writer(h, 0, status);
+    free(key);
+}
+
+
+void oskar_imager_coords_cache_write(oskar_Imager* h, int i_plane,
+        size_t num_vis, const oskar_Mem* uu, const oskar_Mem* vv,
+        const oskar_Mem* ww, const oskar_Mem* weight, int* status)
+{
+    CacheRecord rec;
+    struct CoordsCacheWriter* cc = h->coords_cache_writer;
+    if (*status || !cc || !cc->file || num_vis == 0) return;
+    const size_t bytes = num_vis * oskar_mem_element_size(h->imager_prec);
+
+    /* Polarisations of the same channel usually share coordinates. */
+    rec.i_plane = i_plane;
+    rec.num_vis = (uint64_t) num_vis;
+    rec.same_coords = (cc->footer.num_records > 0 &&
+            num_vis == cc->num_prev &&
+            !memcmp(oskar_mem_void_const(uu),
+                    oskar_mem_void_const(cc->uu), bytes) &&
+            !memcmp(oskar_mem_void_const(vv),
+                    oskar_mem_void_const(cc->vv), bytes) &&
+            !memcmp(oskar_mem_void_const(ww),
+                    oskar_mem_void_const(cc->ww), bytes));
+    if (!write_block(cc->file, &rec, sizeof(CacheRecord)) ||
+            (!rec.same_coords && (
+            !write_block(cc->file, oskar_mem_void_const(uu), bytes) ||
+            !write_block(cc->file, oskar_mem_void_const(vv), bytes) ||
+            !write_block(cc->file, oskar_mem_void_const(ww), bytes))) ||
+            !write_block(cc->file, oskar_mem_void_const(weight), bytes))
+    {
+        close_writer(h, 0, status);
+        return;
+    }
+    if (!rec.same_coords)
+    {
+        oskar_mem_ensure(cc->uu, num_vis, status);
+        oskar_mem_ensure(cc->vv, num_vis, status);
+        oskar_mem_ensure(cc->ww, num_vis, status);
+        oskar_mem_copy_contents(cc->uu, uu, 0, 0, num_vis, status);
+        oskar_mem_copy_contents(cc->vv, vv, 0, 0, num_vis, status);
+        oskar_mem_copy_contents(cc->ww, ww, 0, 0, num_vis, status);
+        cc->num_prev = num_vis;
+    }
+    update_stats(&cc->footer, num_vis, ww, status);
+    cc->footer.num_records++;
+}
+
+
+void oskar_imager_coords_cache_end(oskar_Imager* h, int* status)
+{
+    close_writer(h, !*status, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
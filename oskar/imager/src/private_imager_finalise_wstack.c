@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/oskar_grid_simple.h"
+#include "imager/private_imager_finalise_wstack.h"
+#include "imager/private_imager_generate_w_phase_screen.h"
+#include "math/oskar_fft.h"
+#include "utility/oskar_get_memory_usage.h"
+#include "utility/oskar_kernel_macros.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Work space used to process one W-layer. */
+struct WStackSlot
+{
+    oskar_FFT* fft;
+    oskar_Mem *grid, *screen, *uu, *vv, *vis, *weight;
+    int status;
+};
+typedef struct WStackSlot WStackSlot;
+
+static void process_layer(const oskar_Imager* h, const WStackData* ws,
+        const size_t* order, size_t start, size_t end, int size, double w,
+        double sampling, const oskar_Mem* taper, WStackSlot* slot);
+
+/* Gathers the visibilities in one layer into contiguous arrays. */
+#define WSTACK_GATHER(NAME, FP) static void NAME(const size_t num,\
+        const size_t* RESTRICT order, const FP* RESTRICT uu,\
+        const FP* RESTRICT vv, const FP* RESTRICT vis,\
+        const FP* RESTRICT weight, FP* RESTRICT out_uu, FP* RESTRICT out_vv,\
+        FP* RESTRICT out_vis, FP* RESTRICT out_weight)\
+{\
+    size_t i;\
+    for (i = 0; i < num; ++i) {\
+        const size_t j = order[i];\
+        out_uu[i] = uu[j];\
+        out_vv[i] = vv[j];\
+        out_vis[2 * i] = vis[2 * j];\
+        out_vis[2 * i + 1] = vis[2 * j + 1];\
+        out_weight[i] = weight[j];\
+    }\
+}
+
+WSTACK_GATHER(wstack_gather_d, double)
+WSTACK_GATHER(wstack_gather_f, float)
+
+/*
+ * The visibilities buffered for the plane are assigned to the nearest
+ * W-layer, and each layer is gridded and transformed separately. The
+ * layer image is multiplied by the W phase screen for the layer, and
+ * accumulated into the plane, which is left in the same state as the
+ * raw (unshifted and unnormalised) FFT output of the FFT algorithm.
+ * The buffer is then emptied, so it can be flushed again later.
+ *
+ * Each layer needs its own grid and phase screen, so several layers are
+ * processed concurrently only if there is enough free memory for them.
+ */
+void oskar_imager_flush_wstack(oskar_Imager* h, WStackData* ws, int* status)
+{
+    int i, k, num_layers = 0, num_slots = 1, num_active = 0;
+    size_t j;
+    oskar_Mem* plane = ws->plane;
+    if (*status) return;
+    const int size = oskar_imager_plane_size(h);
+    const size_t num_cells = (size_t) size * (size_t) size;
+    const size_t num_vis = ws->num_vis;
+    oskar_mem_ensure(plane, num_cells, status);
+    if (*status || num_vis == 0) return;
+
+    /* Find the nearest layer to each visibility. Layers are added beyond
+     * the expected range if needed, rather than clamping large W values. */
+    int* layer = (int*) malloc(num_vis * sizeof(int));
+    if (!layer)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    {
+        const double inv_inc = h->w_layer_inc > 0.0 ?
+                1.0 / h->w_layer_inc : 0.0;
+        const int is_dbl = (h->imager_prec == OSKAR_DOUBLE);
+        const double* w_d = 0;
+        const float* w_f = 0;
+        if (is_dbl)
+            w_d = oskar_mem_double_const(ws->ww, status);
+        else
+            w_f = oskar_mem_float_const(ws->ww, status);
+        num_layers = h->num_w_layers > 0 ? h->num_w_layers : 1;
+        for (j = 0; j < num_vis; ++j)
+        {
+            const double w = is_dbl ? w_d[j] : (double) w_f[j];
+            int l = (int) floor(w * inv_inc + 0.5);
+            if (l < 0) l = 0;
+            if (l >= num_layers) num_layers = l + 1;
+            layer[j] = l;
+        }
+    }
+
+    /* Sort the visibilities by layer, keeping the input order in each. */
+    size_t* layer_start = (size_t*) calloc(num_layers + 1, sizeof(size_t));
+    size_t* order = (size_t*) malloc(num_vis * sizeof(size_t));
+    int* active = (int*) malloc(num_layers * sizeof(int));
+    if (!layer_start || !order || !active)
+    {
+        free(layer_start);
+        free(order);
+        free(layer);
+        free(active);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (j = 0; j < num_vis; ++j) layer_start[layer[j] + 1]++;
+    for (k = 0; k < num_layers; ++k)
+    {
+        if (layer_start[k + 1] > 0) active[num_active++] = k;
+        layer_start[k + 1] += layer_start[k];
+    }
+    for (j = 0; j < num_vis; ++j)
+        order[layer_start[layer[j]]++] = j;
+    for (k = num_layers; k > 0; --k)
+        layer_start[k] = layer_start[k - 1];
+    layer_start[0] = 0;
+    free(layer);
+
+    /* Work out how many layers can be processed at once. */
+    {
+        size_t max_count = 0, free_mem;
+        for (k = 0; k < num_layers; ++k)
+            if (layer_start[k + 1] - layer_start[k] > max_count)
+                max_count = layer_start[k + 1] - layer_start[k];
+        /* Each slot has a complex grid and phase screen, the FFT work
+         * arrays, and a copy of the visibilities in its layer. */
+        const size_t fp_size = oskar_mem_element_size(h->imager_prec);
+        /* The FFT trigonometric table is shorter than 4 * size + 72. */
+        const size_t fft_mem = 2 * num_cells + 4 * (size_t) size + 72;
+        const size_t slot_mem = fp_size *
+                (4 * num_cells + fft_mem + 5 * max_count);
+#ifdef _OPENMP
+        num_slots = omp_get_max_threads();
+#endif
+        if (num_slots > num_active) num_slots = num_active;
+        free_mem = oskar_get_free_physical_memory();
+        if (free_mem > 0 && (size_t) num_slots * slot_mem > free_mem / 2)
+            num_slots = (int) (free_mem / 2 / slot_mem);
+        if (num_slots < 1) num_slots = 1;
+    }
+
+    /* Create the work space for each slot, and a flat taper function. */
+    const double sampling = fabs(h->cellsize_rad);
+    oskar_Mem* taper = oskar_mem_create(h->imager_prec, OSKAR_CPU, size,
+            status);
+    oskar_mem_set_value_real(taper, 1.0, 0, size, status);
+    WStackSlot* slots = (WStackSlot*) calloc(num_slots, sizeof(WStackSlot));
+    const oskar_Mem** layer_ptr = (const oskar_Mem**) calloc(num_slots + 1,
+            sizeof(oskar_Mem*));
+    if (!slots || !layer_ptr)
+    {
+        oskar_mem_free(taper, status);
+        free(slots);
+        free(layer_ptr);
+        free(layer_start);
+        free(order);
+        free(active);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    layer_ptr[0] = plane;
+    for (i = 0; i < num_slots; ++i)
+    {
+        const int type = h->imager_prec;
+        WStackSlot* s = &slots[i];
+        s->fft = oskar_fft_create(type, OSKAR_CPU, 2, size, 0, status);
+        oskar_fft_set_ensure_consistent_norm(s->fft, 0);
+        s->grid = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+                num_cells, status);
+        s->screen = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+                num_cells, status);
+        s->uu = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        s->vv = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        s->vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, 0, status);
+        s->weight = oskar_mem_create(type, OSKAR_CPU, 0, status);
+    }
+
+    /* Process the layers in batches of one layer per slot. */
+    for (k = 0; k < num_active && !*status; k += num_slots)
+    {
+        const int num_batch = (num_active - k < num_slots) ?
+                num_active - k : num_slots;
+#pragma omp parallel for schedule(dynamic, 1) if(num_batch > 1) \
+        num_threads(num_batch)
+        for (i = 0; i < num_batch; ++i)
+        {
+            const int l = active[k + i];
+            process_layer(h, ws, order, layer_start[l], layer_start[l + 1],
+                    size, l * h->w_layer_inc, sampling, taper, &slots[i]);
+        }
+        for (i = 0; i < num_batch; ++i)
+            if (slots[i].status && !*status) *status = slots[i].status;
+        if (*status) break;
+
+        /* Add the layer images to the plane, always in layer order. */
+        for (i = 0; i < num_batch; ++i) layer_ptr[i + 1] = slots[i].grid;
+        oskar_mem_sum(plane, num_batch + 1, layer_ptr, num_cells, status);
+    }
+
+    /* Clean up. */
+    for (i = 0; i < num_slots; ++i)
+    {
+        WStackSlot* s = &slots[i];
+        oskar_fft_free(s->fft);
+        oskar_mem_free(s->grid, status);
+        oskar_mem_free(s->screen, status);
+        oskar_mem_free(s->uu, status);
+        oskar_mem_free(s->vv, status);
+        oskar_mem_free(s->vis, status);
+        oskar_mem_free(s->weight, status);
+    }
+    oskar_mem_free(taper, status);
+    free(slots);
+    free(layer_ptr);
+    free(layer_start);
+    free(order);
+    free(active);
+    ws->num_vis = 0;
+}
+
+
+void oskar_imager_finalise_wstack(oskar_Imager* h, oskar_Mem* plane,
+        int* status)
+{
+    int i;
+    if (*status) return;
+
+    /* Flush any visibilities still buffered for the plane. */
+    for (i = 0; i < h->num_ws_planes; ++i)
+        if (h->ws[i].plane == plane)
+            oskar_imager_flush_wstack(h, &h->ws[i], status);
+    const int size = oskar_imager_plane_size(h);
+    oskar_mem_ensure(plane, (size_t) size * (size_t) size, status);
+}
+
+
+static void process_layer(const oskar_Imager* h, const WStackData* ws,
+        const size_t* order, size_t start, size_t end, int size, double w,
+        double sampling, const oskar_Mem* taper, WStackSlot* slot)
+{
+    double norm = 0.0;
+    size_t num_skipped = 0;
+    int* status = &slot->status;
+    const size_t num = end - start;
+    const size_t num_cells = (size_t) size * (size_t) size;
+
+    /* Grid the visibilities in the layer. */
+    oskar_mem_ensure(slot->uu, num, status);
+    oskar_mem_ensure(slot->vv, num, status);
+    oskar_mem_ensure(slot->vis, num, status);
+    oskar_mem_ensure(slot->weight, num, status);
+    oskar_mem_clear_contents(slot->grid, status);
+    if (*status) return;
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        wstack_gather_d(num, order + start,
+                oskar_mem_double_const(ws->uu, status),
+                oskar_mem_double_const(ws->vv, status),
+                oskar_mem_double_const(ws->vis, status),
+                oskar_mem_double_const(ws->weight, status),
+                oskar_mem_double(slot->uu, status),
+                oskar_mem_double(slot->vv, status),
+                oskar_mem_double(slot->vis, status),
+                oskar_mem_double(slot->weight, status));
+        oskar_grid_simple_d(h->support, h->oversample,
+                oskar_mem_double_const(h->conv_func, status), num,
+                oskar_mem_double_const(slot->uu, status),
+                oskar_mem_double_const(slot->vv, status),
+                oskar_mem_double_const(slot->vis, status),
+                oskar_mem_double_const(slot->weight, status),
+                h->cellsize_rad, size, &num_skipped, &norm,
+                oskar_mem_double(slot->grid, status));
+    }
+    else
+    {
+        wstack_gather_f(num, order + start,
+                oskar_mem_float_const(ws->uu, status),
+                oskar_mem_float_const(ws->vv, status),
+                oskar_mem_float_const(ws->vis, status),
+                oskar_mem_float_const(ws->weight, status),
+                oskar_mem_float(slot->uu, status),
+                oskar_mem_float(slot->vv, status),
+                oskar_mem_float(slot->vis, status),
+                oskar_mem_float(slot->weight, status));
+        oskar_grid_simple_f(h->support, h->oversample,
+                oskar_mem_float_const(h->conv_func, status), num,
+                oskar_mem_float_const(slot->uu, status),
+                oskar_mem_float_const(slot->vv, status),
+                oskar_mem_float_const(slot->vis, status),
+                oskar_mem_float_const(slot->weight, status),
+                (float) (h->cellsize_rad), size, &num_skipped, &norm,
+                oskar_mem_float(slot->grid, status));
+    }
+
+    /* Transform the layer and apply its W phase screen.
+     * The visibilities contain the phase 2 pi w (n - 1), so the conjugate
+     * screen is needed: with iw = 1, a W-scale of -1/w gives this. */
+    oskar_fft_exec(slot->fft, slot->grid, status);
+    if (w > 0.0)
+    {
+        oskar_imager_generate_w_phase_screen(1, size, size, sampling,
+                -1.0 / w, taper, slot->screen, status);
+        oskar_mem_multiply(slot->grid, slot->grid, slot->screen,
+                0, 0, 0, num_cells, status);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
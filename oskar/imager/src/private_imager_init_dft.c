@@ -48,6 +48,10 @@ void oskar_imager_init_dft(oskar_Imager* h, int* status)
     oskar_mem_free(h->l, status);
     oskar_mem_free(h->m, status);
     oskar_mem_free(h->n, status);
+    oskar_mem_free(h->l_axis, status); h->l_axis = 0;
+    oskar_mem_free(h->m_axis, status); h->m_axis = 0;
+    oskar_mem_free(h->dft_block, status); h->dft_block = 0;
+    oskar_mem_free(h->dft_work, status); h->dft_work = 0;
     h->l = oskar_mem_create(h->imager_prec, OSKAR_CPU, num_pixels, status);
     h->m = oskar_mem_create(h->imager_prec, OSKAR_CPU, num_pixels, status);
     h->n = oskar_mem_create(h->imager_prec, OSKAR_CPU, num_pixels, status);
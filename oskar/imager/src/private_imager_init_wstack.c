@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_init_fft.h"
+#include "imager/private_imager_init_wstack.h"
+#include "math/oskar_cmath.h"
+
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_init_wstack(oskar_Imager* h, int* status)
+{
+    double max_w = 0.0;
+    if (*status) return;
+
+    /* W-stacking is only implemented on the CPU. */
+    if (h->grid_on_gpu || h->fft_on_gpu)
+    {
+        oskar_log_warning(h->log, "W-stacking uses the CPU only.");
+        h->grid_on_gpu = 0;
+        h->fft_on_gpu = 0;
+    }
+
+    /* Each layer is gridded with the FFT convolution function. */
+    oskar_imager_init_fft(h, status);
+
+    /* Get the range of (folded, non-negative) W values to cover.
+     * Without a coordinate scan, the range is only a guess: layers are
+     * then added as needed when the visibilities are gridded. */
+    if (h->ww_max > 0.0)
+        max_w = h->ww_max;
+    else
+    {
+        max_w = 0.25 / fabs(h->cellsize_rad);
+        oskar_log_warning(h->log, "W range not known: coordinates were "
+                "not scanned before W-stacking.");
+    }
+
+    /* Use the number of layers if set. Otherwise, space the layers so that
+     * the W phase error at the corner of the image is at most 0.5 rad. */
+    h->num_w_layers = h->num_w_planes;
+    if (h->num_w_layers < 1)
+    {
+        const double l_max = sin(0.5 * h->fov_deg * M_PI / 180.0);
+        const double r2 = 2.0 * l_max * l_max;
+        const double max_dn = 1.0 - (r2 < 1.0 ? sqrt(1.0 - r2) : 0.0);
+        h->num_w_layers = 1 + (int) ceil(2.0 * M_PI * max_w * max_dn);
+    }
+    if (h->num_w_layers < 2) h->num_w_layers = 2;
+    h->w_layer_inc = max_w / (h->num_w_layers - 1);
+
+    /* Record data about the layers. */
+    oskar_log_message(h->log, 'M', 0, "Baseline W values (wavelengths)");
+    oskar_log_message(h->log, 'M', 1, "Min: %.12e", h->ww_min);
+    oskar_log_message(h->log, 'M', 1, "Max: %.12e", h->ww_max);
+    oskar_log_message(h->log, 'M', 1, "RMS: %.12e", h->ww_rms);
+    oskar_log_message(h->log, 'M', 0, "Using %d W-stacking layers, "
+            "separated by %.3e wavelengths.", h->num_w_layers, h->w_layer_inc);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -33,8 +33,10 @@
 #include "imager/oskar_imager.h"
 #include "math/oskar_cmath.h"
 #include "math/oskar_dft_c2r.h"
+#include "math/oskar_dft_c2r_separable.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_trace.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -45,6 +47,9 @@ extern "C" {
 #endif
 
 static void* run_blocks(void* arg);
+static void update_plane_dft_2d_separable(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* amps,
+        const oskar_Mem* weight, oskar_Mem* plane, int* status);
 
 struct ThreadArgs
 {
@@ -87,42 +92,51 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     oskar_mem_ensure(plane_ptr, num_pixels, status);
     if (*status) return;
 
-    /* Set up worker threads. */
-    const size_t num_threads = (size_t) (h->num_devices);
-    threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
-    args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
-    for (i = 0; i < num_threads; ++i)
+    if (h->algorithm == OSKAR_ALGORITHM_DFT_2D && h->num_gpus == 0)
     {
-        args[i].h = h;
-        args[i].thread_id = (int) i;
-        args[i].num_vis = (int) num_vis;
-        args[i].uu = uu;
-        args[i].vv = vv;
-        args[i].ww = ww;
-        args[i].amp = amps;
-        args[i].weight = weight;
-        args[i].plane = plane_ptr;
+        /* Use the separable form of the 2D DFT on the CPU. */
+        update_plane_dft_2d_separable(h, num_vis, uu, vv, amps, weight,
+                plane_ptr, status);
     }
+    else
+    {
+        /* Set up worker threads. */
+        const size_t num_threads = (size_t) (h->num_devices);
+        threads = (oskar_Thread**) calloc(num_threads, sizeof(oskar_Thread*));
+        args = (ThreadArgs*) calloc(num_threads, sizeof(ThreadArgs));
+        for (i = 0; i < num_threads; ++i)
+        {
+            args[i].h = h;
+            args[i].thread_id = (int) i;
+            args[i].num_vis = (int) num_vis;
+            args[i].uu = uu;
+            args[i].vv = vv;
+            args[i].ww = ww;
+            args[i].amp = amps;
+            args[i].weight = weight;
+            args[i].plane = plane_ptr;
+        }
 
-    /* Set status code. */
-    h->status = *status;
+        /* Set status code. */
+        h->status = *status;
 
-    /* Start the worker threads. */
-    h->i_block = 0;
-    for (i = 0; i < num_threads; ++i)
-        threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
+        /* Start the worker threads. */
+        h->i_block = 0;
+        for (i = 0; i < num_threads; ++i)
+            threads[i] = oskar_thread_create(run_blocks, (void*)&args[i], 0);
 
-    /* Wait for worker threads to finish. */
-    for (i = 0; i < num_threads; ++i)
-    {
-        oskar_thread_join(threads[i]);
-        oskar_thread_free(threads[i]);
-    }
-    free(threads);
-    free(args);
+        /* Wait for worker threads to finish. */
+        for (i = 0; i < num_threads; ++i)
+        {
+            oskar_thread_join(threads[i]);
+            oskar_thread_free(threads[i]);
+        }
+        free(threads);
+        free(args);
 
-    /* Get status code. */
-    *status = h->status;
+        /* Get status code. */
+        *status = h->status;
+    }
 
     /* Update normalisation. */
     if (oskar_mem_precision(weight) == OSKAR_DOUBLE)
@@ -137,6 +151,58 @@ void oskar_imager_update_plane_dft(oskar_Imager* h, size_t num_vis,
     }
 }
 
+static void update_plane_dft_2d_separable(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* amps,
+        const oskar_Mem* weight, oskar_Mem* plane, int* status)
+{
+    int i;
+    oskar_Mem* block;
+    const int size = h->image_size, type = h->imager_prec;
+    const size_t num_pixels = (size_t) size * (size_t) size;
+
+    /* The pixel grid is regular, so take its axes from the centre row and
+     * column. Pixels outside the unit circle are set to NaN afterwards.
+     * The axes and work arrays are kept for the next block. */
+    if (!h->l_axis)
+    {
+        h->l_axis = oskar_mem_create(type, OSKAR_CPU, (size_t) size, status);
+        h->m_axis = oskar_mem_create(type, OSKAR_CPU, (size_t) size, status);
+        h->dft_block = oskar_mem_create(type, OSKAR_CPU, num_pixels, status);
+        h->dft_work = oskar_mem_create(type, OSKAR_CPU, 0, status);
+        for (i = 0; i < size; ++i)
+        {
+            oskar_mem_copy_contents(h->l_axis, h->l, (size_t) i,
+                    (size_t) (size / 2) * size + i, 1, status);
+            oskar_mem_copy_contents(h->m_axis, h->m, (size_t) i,
+                    (size_t) i * size + size / 2, 1, status);
+        }
+    }
+    block = h->dft_block;
+    oskar_dft_c2r_separable((int) num_vis, 2.0 * M_PI, uu, vv, amps, weight,
+            size, h->l_axis, size, h->m_axis, block, h->dft_work, status);
+    if (!*status)
+    {
+        size_t j;
+        if (type == OSKAR_DOUBLE)
+        {
+            double* b = oskar_mem_double(block, status);
+            const double* l = oskar_mem_double_const(h->l, status);
+            for (j = 0; j < num_pixels; ++j)
+                if (l[j] != l[j]) b[j] = l[j];
+        }
+        else
+        {
+            float* b = oskar_mem_float(block, status);
+            const float* l = oskar_mem_float_const(h->l, status);
+            for (j = 0; j < num_pixels; ++j)
+                if (l[j] != l[j]) b[j] = l[j];
+        }
+    }
+
+    /* Add data to existing pixels. */
+    oskar_mem_add(plane, plane, block, 0, 0, 0, num_pixels, status);
+}
+
 static void* run_blocks(void* arg)
 {
     oskar_Imager* h;
@@ -172,6 +238,8 @@ static void* run_blocks(void* arg)
     omp_set_nested(0);
     omp_set_num_threads(1);
 #endif
+    oskar_trace_set_thread(thread_id,
+            thread_id < h->num_gpus ? thread_id : -1);
 
     /* Calculate the maximum pixel block size, and number of blocks. */
     const size_t num_pixels = (size_t)h->image_size * (size_t)h->image_size;
@@ -32,18 +32,52 @@
 #include "imager/define_grid_tile_grid.h"
 #include "imager/private_imager_update_plane_wproj.h"
 #include "imager/oskar_grid_wproj2.h"
+#include "imager/oskar_grid_wproj_sort.h"
 #include "math/oskar_prefix_sum.h"
 #include "math/oskar_round_robin.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_thread.h"
 
 #include <assert.h>
+#include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Minimum number of visibilities that are sorted before gridding on the CPU.
+ * Smaller blocks touch little of the grid and kernels, so are gridded in
+ * input order. */
+#define MIN_POINTS_SORTED 16384
+
 static void* run_subset(void* arg);
+static void sort_vis(const oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, int grid_size,
+        oskar_Mem* s_uu, oskar_Mem* s_vv, oskar_Mem* s_ww, oskar_Mem* s_vis,
+        oskar_Mem* s_wt, int* status);
+
+/* Gathers the visibilities into contiguous arrays in the given order. */
+#define WPROJ_GATHER(NAME, FP) static void NAME(const size_t num,\
+        const size_t* RESTRICT order, const FP* RESTRICT uu,\
+        const FP* RESTRICT vv, const FP* RESTRICT ww, const FP* RESTRICT vis,\
+        const FP* RESTRICT weight, FP* RESTRICT out_uu, FP* RESTRICT out_vv,\
+        FP* RESTRICT out_ww, FP* RESTRICT out_vis, FP* RESTRICT out_weight)\
+{\
+    size_t i;\
+    for (i = 0; i < num; ++i) {\
+        const size_t j = order[i];\
+        out_uu[i] = uu[j];\
+        out_vv[i] = vv[j];\
+        out_ww[i] = ww[j];\
+        out_vis[2 * i] = vis[2 * j];\
+        out_vis[2 * i + 1] = vis[2 * j + 1];\
+        out_weight[i] = weight[j];\
+    }\
+}
+
+WPROJ_GATHER(wproj_gather_d, double)
+WPROJ_GATHER(wproj_gather_f, float)
 
 struct ThreadArgs
 {
@@ -89,7 +123,28 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
         const size_t num_cells = ((size_t) grid_size) * ((size_t) grid_size);
         oskar_mem_ensure(plane_ptr, num_cells, status);
         if (*status) return;
-        if (h->imager_prec == OSKAR_DOUBLE)
+
+        /* Sort the visibilities by W-plane and grid tile, so that
+         * consecutive visibilities use the same W-kernel and grid region. */
+        const int type = h->imager_prec;
+        oskar_Mem *s_uu = 0, *s_vv = 0, *s_ww = 0, *s_vis = 0, *s_wt = 0;
+        if (num_vis >= MIN_POINTS_SORTED)
+        {
+            s_uu = oskar_mem_create(type, OSKAR_CPU, num_vis, status);
+            s_vv = oskar_mem_create(type, OSKAR_CPU, num_vis, status);
+            s_ww = oskar_mem_create(type, OSKAR_CPU, num_vis, status);
+            s_vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+                    num_vis, status);
+            s_wt = oskar_mem_create(type, OSKAR_CPU, num_vis, status);
+            sort_vis(h, num_vis, uu, vv, ww, amps, weight, grid_size,
+                    s_uu, s_vv, s_ww, s_vis, s_wt, status);
+            uu = s_uu;
+            vv = s_vv;
+            ww = s_ww;
+            amps = s_vis;
+            weight = s_wt;
+        }
+        if (!*status && type == OSKAR_DOUBLE)
             oskar_grid_wproj2_d(h->num_w_planes,
                     oskar_mem_int_const(h->w_support, status),
                     h->oversample,
@@ -103,7 +158,7 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
                     h->cellsize_rad, h->w_scale,
                     grid_size, num_skipped, plane_norm,
                     oskar_mem_double(plane_ptr, status));
-        else
+        else if (!*status)
             oskar_grid_wproj2_f(h->num_w_planes,
                     oskar_mem_int_const(h->w_support, status),
                     h->oversample,
@@ -117,6 +172,11 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
                     h->cellsize_rad, h->w_scale,
                     grid_size, num_skipped, plane_norm,
                     oskar_mem_float(plane_ptr, status));
+        oskar_mem_free(s_uu, status);
+        oskar_mem_free(s_vv, status);
+        oskar_mem_free(s_ww, status);
+        oskar_mem_free(s_vis, status);
+        oskar_mem_free(s_wt, status);
     }
     else
     {
@@ -166,6 +226,64 @@ void oskar_imager_update_plane_wproj(oskar_Imager* h, size_t num_vis,
 }
 
 
+static void sort_vis(const oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, int grid_size,
+        oskar_Mem* s_uu, oskar_Mem* s_vv, oskar_Mem* s_ww, oskar_Mem* s_vis,
+        oskar_Mem* s_wt, int* status)
+{
+    if (*status || num_vis == 0) return;
+    size_t* order = (size_t*) malloc(num_vis * sizeof(size_t));
+    if (!order)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    if (h->imager_prec == OSKAR_DOUBLE)
+    {
+        oskar_grid_wproj_sort_d(h->num_w_planes, num_vis,
+                oskar_mem_double_const(uu, status),
+                oskar_mem_double_const(vv, status),
+                oskar_mem_double_const(ww, status),
+                h->cellsize_rad, h->w_scale, grid_size, order, status);
+        if (!*status)
+            wproj_gather_d(num_vis, order,
+                    oskar_mem_double_const(uu, status),
+                    oskar_mem_double_const(vv, status),
+                    oskar_mem_double_const(ww, status),
+                    oskar_mem_double_const(amps, status),
+                    oskar_mem_double_const(weight, status),
+                    oskar_mem_double(s_uu, status),
+                    oskar_mem_double(s_vv, status),
+                    oskar_mem_double(s_ww, status),
+                    oskar_mem_double(s_vis, status),
+                    oskar_mem_double(s_wt, status));
+    }
+    else
+    {
+        oskar_grid_wproj_sort_f(h->num_w_planes, num_vis,
+                oskar_mem_float_const(uu, status),
+                oskar_mem_float_const(vv, status),
+                oskar_mem_float_const(ww, status),
+                (float) (h->cellsize_rad), (float) (h->w_scale),
+                grid_size, order, status);
+        if (!*status)
+            wproj_gather_f(num_vis, order,
+                    oskar_mem_float_const(uu, status),
+                    oskar_mem_float_const(vv, status),
+                    oskar_mem_float_const(ww, status),
+                    oskar_mem_float_const(amps, status),
+                    oskar_mem_float_const(weight, status),
+                    oskar_mem_float(s_uu, status),
+                    oskar_mem_float(s_vv, status),
+                    oskar_mem_float(s_ww, status),
+                    oskar_mem_float(s_vis, status),
+                    oskar_mem_float(s_wt, status));
+    }
+    free(order);
+}
+
+
 static void* run_subset(void* arg)
 {
     oskar_Imager* h;
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_finalise_wstack.h"
+#include "imager/private_imager_update_plane_wstack.h"
+#include "utility/oskar_kernel_macros.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Visibilities are buffered here, because the layers can only be
+ * gridded one (or a few) at a time. Points with negative W are replaced by
+ * their Hermitian conjugates, so that only non-negative W needs layers.
+ * The normalisation and skipped points match those of the FFT gridder,
+ * as the same convolution function is used for each layer.
+ */
+#define WSTACK_APPEND(NAME, FP, ROUND) static size_t NAME(const int support,\
+        const int oversample, const FP* RESTRICT conv_func,\
+        const size_t num_vis, const FP* RESTRICT uu, const FP* RESTRICT vv,\
+        const FP* RESTRICT ww, const FP* RESTRICT vis,\
+        const FP* RESTRICT weight, const FP cell_size_rad,\
+        const int grid_size, size_t* RESTRICT num_skipped,\
+        double* RESTRICT norm, FP* RESTRICT out_uu, FP* RESTRICT out_vv,\
+        FP* RESTRICT out_ww, FP* RESTRICT out_vis, FP* RESTRICT out_weight)\
+{\
+    size_t i, n = 0;\
+    const int grid_centre = grid_size / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    for (i = 0; i < num_vis; ++i) {\
+        int j;\
+        double sum_u = 0.0, sum_v = 0.0;\
+        const FP s = ww[i] < (FP)0 ? (FP)-1 : (FP)1;\
+        const FP pos_u = -s * uu[i] * grid_scale;\
+        const FP pos_v = s * vv[i] * grid_scale;\
+        const int grid_u = (int)ROUND(pos_u) + grid_centre;\
+        const int grid_v = (int)ROUND(pos_v) + grid_centre;\
+        if (grid_u + support >= grid_size || grid_u - support < 0 ||\
+                grid_v + support >= grid_size || grid_v - support < 0) {\
+            (*num_skipped)++;\
+            continue;\
+        }\
+        const int off_u = (int)ROUND((ROUND(pos_u) - pos_u) * oversample);\
+        const int off_v = (int)ROUND((ROUND(pos_v) - pos_v) * oversample);\
+        for (j = -support; j <= support; ++j) {\
+            sum_u += conv_func[abs(off_u + j * oversample)];\
+            sum_v += conv_func[abs(off_v + j * oversample)];\
+        }\
+        *norm += sum_u * sum_v * weight[i];\
+        out_uu[n] = s * uu[i];\
+        out_vv[n] = s * vv[i];\
+        out_ww[n] = s * ww[i];\
+        out_vis[2 * n] = vis[2 * i];\
+        out_vis[2 * n + 1] = s * vis[2 * i + 1];\
+        out_weight[n] = weight[i];\
+        n++;\
+    }\
+    return n;\
+}
+
+WSTACK_APPEND(wstack_append_d, double, round)
+WSTACK_APPEND(wstack_append_f, float, roundf)
+
+/* Returns the buffer for the given plane, creating it if necessary. */
+static WStackData* wstack_data(oskar_Imager* h, oskar_Mem* plane,
+        int* status)
+{
+    int i;
+    WStackData* ws = 0;
+    for (i = 0; i < h->num_ws_planes; ++i)
+        if (h->ws[i].plane == plane) return &h->ws[i];
+    ws = (WStackData*) realloc(h->ws,
+            (h->num_ws_planes + 1) * sizeof(WStackData));
+    if (!ws)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return 0;
+    }
+    h->ws = ws;
+    ws = &h->ws[h->num_ws_planes++];
+    memset(ws, 0, sizeof(WStackData));
+    ws->plane = plane;
+    ws->uu = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    ws->vv = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    ws->ww = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    ws->vis = oskar_mem_create(h->imager_prec | OSKAR_COMPLEX, OSKAR_CPU,
+            0, status);
+    ws->weight = oskar_mem_create(h->imager_prec, OSKAR_CPU, 0, status);
+    return ws;
+}
+
+void oskar_imager_update_plane_wstack(oskar_Imager* h, size_t num_vis,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* amps, const oskar_Mem* weight, int i_plane,
+        oskar_Mem* plane, double* plane_norm, size_t* num_skipped, int* status)
+{
+    WStackData* ws = 0;
+    oskar_Mem* plane_ptr = plane;
+    if (*status) return;
+    if (!plane_ptr)
+    {
+        if (h->planes)
+            plane_ptr = h->planes[i_plane];
+        else
+        {
+            *status = OSKAR_ERR_MEMORY_NOT_ALLOCATED;
+            return;
+        }
+    }
+    if (oskar_mem_location(plane_ptr) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+    if (oskar_mem_precision(plane_ptr) != h->imager_prec)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+
+    /* Grow the buffers geometrically to limit the number of copies. */
+    ws = wstack_data(h, plane_ptr, status);
+    if (*status) return;
+    const size_t required = ws->num_vis + num_vis;
+    if (oskar_mem_length(ws->uu) < required)
+    {
+        size_t capacity = 2 * oskar_mem_length(ws->uu);
+        if (capacity < required) capacity = required;
+        oskar_mem_realloc(ws->uu, capacity, status);
+        oskar_mem_realloc(ws->vv, capacity, status);
+        oskar_mem_realloc(ws->ww, capacity, status);
+        oskar_mem_realloc(ws->vis, capacity, status);
+        oskar_mem_realloc(ws->weight, capacity, status);
+        if (*status) return;
+    }
+
+    /* Append the visibilities that are on the grid. */
+    const size_t start = ws->num_vis;
+    const int grid_size = oskar_imager_plane_size(h);
+    const size_t num_cells = (size_t) grid_size * (size_t) grid_size;
+    if (h->imager_prec == OSKAR_DOUBLE)
+        ws->num_vis += wstack_append_d(h->support, h->oversample,
+                oskar_mem_double_const(h->conv_func, status), num_vis,
+                oskar_mem_double_const(uu, status),
+                oskar_mem_double_const(vv, status),
+                oskar_mem_double_const(ww, status),
+                oskar_mem_double_const(amps, status),
+                oskar_mem_double_const(weight, status),
+                h->cellsize_rad, grid_size, num_skipped, plane_norm,
+                oskar_mem_double(ws->uu, status) + start,
+                oskar_mem_double(ws->vv, status) + start,
+                oskar_mem_double(ws->ww, status) + start,
+                oskar_mem_double(ws->vis, status) + 2 * start,
+                oskar_mem_double(ws->weight, status) + start);
+    else
+        ws->num_vis += wstack_append_f(h->support, h->oversample,
+                oskar_mem_float_const(h->conv_func, status), num_vis,
+                oskar_mem_float_const(uu, status),
+                oskar_mem_float_const(vv, status),
+                oskar_mem_float_const(ww, status),
+                oskar_mem_float_const(amps, status),
+                oskar_mem_float_const(weight, status),
+                (float) (h->cellsize_rad), grid_size, num_skipped, plane_norm,
+                oskar_mem_float(ws->uu, status) + start,
+                oskar_mem_float(ws->vv, status) + start,
+                oskar_mem_float(ws->ww, status) + start,
+                oskar_mem_float(ws->vis, status) + 2 * start,
+                oskar_mem_float(ws->weight, status) + start);
+
+    /* Flush the buffer into the plane once it holds as many visibilities
+     * as there are grid cells. This keeps the buffer to a few times the
+     * size of the plane, however much data there is, while the cost of
+     * transforming the layers is spread over at least as many points. */
+    if (ws->num_vis >= num_cells)
+        oskar_imager_flush_wstack(h, ws, status);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/private_imager_update_planes_fft.h"
+#include "utility/oskar_kernel_macros.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define C0 299792458.0
+
+/*
+ * Grids all the polarisations of one image channel in a single pass over
+ * the visibility rows. The coordinates of each row are scaled to
+ * wavelengths for each selected channel as they are used, and the
+ * convolution weights are evaluated once for all the polarisations.
+ * The arithmetic for each plane is the same as in oskar_grid_simple().
+ */
+#define GRID_PLANES(NAME, FP, ROUND) static void NAME(const int support,\
+        const int oversample, const FP* RESTRICT conv_func,\
+        const size_t num_rows, const int num_channels, const int num_pols,\
+        const FP* RESTRICT uu, const FP* RESTRICT vv,\
+        const FP* RESTRICT vis, const FP* RESTRICT weight,\
+        const int num_sel, const int* RESTRICT sel_chan,\
+        const FP* RESTRICT sel_scale, const int num_planes,\
+        const int* RESTRICT pol, const int is_psf, const int filter,\
+        const double uv_min_sq, const double uv_max_sq,\
+        const FP cell_size_rad, const int grid_size,\
+        size_t* RESTRICT num_used, size_t* RESTRICT num_skipped,\
+        double* RESTRICT norm, FP* const* RESTRICT grids)\
+{\
+    size_t r;\
+    const int grid_centre = grid_size / 2;\
+    const FP grid_scale = grid_size * cell_size_rad;\
+    for (r = 0; r < num_rows; ++r) {\
+        int s;\
+        for (s = 0; s < num_sel; ++s) {\
+            int j, k, q;\
+            double sum = 0.0;\
+            FP v_re[4], v_im[4];\
+            const FP u = uu[r] * sel_scale[s], v = vv[r] * sel_scale[s];\
+            if (filter) {\
+                const double r2 = u * u + v * v;\
+                if (r2 < uv_min_sq || r2 > uv_max_sq) continue;\
+            }\
+            (*num_used)++;\
+            const FP pos_u = -u * grid_scale;\
+            const FP pos_v = v * grid_scale;\
+            const int grid_u = (int)ROUND(pos_u) + grid_centre;\
+            const int grid_v = (int)ROUND(pos_v) + grid_centre;\
+            if (grid_u + support >= grid_size || grid_u - support < 0 ||\
+                    grid_v + support >= grid_size || grid_v - support < 0) {\
+                *num_skipped += num_planes;\
+                continue;\
+            }\
+            const int off_u = (int)ROUND((ROUND(pos_u) - pos_u) * oversample);\
+            const int off_v = (int)ROUND((ROUND(pos_v) - pos_v) * oversample);\
+            for (q = 0; q < num_planes; ++q) {\
+                const FP w = weight[num_pols * r + pol[q]];\
+                const size_t i = 2 * (num_pols *\
+                        (num_channels * r + sel_chan[s]) + pol[q]);\
+                v_re[q] = w * (is_psf ? (FP)1 : vis[i]);\
+                v_im[q] = w * (is_psf ? (FP)0 : vis[i + 1]);\
+            }\
+            for (j = -support; j <= support; ++j) {\
+                const FP c1 = conv_func[abs(off_v + j * oversample)];\
+                const size_t p1 = (size_t)(grid_v + j) * grid_size + grid_u;\
+                for (k = -support; k <= support; ++k) {\
+                    const size_t p = (p1 + k) << 1;\
+                    const FP c = conv_func[abs(off_u + k * oversample)] * c1;\
+                    for (q = 0; q < num_planes; ++q) {\
+                        grids[q][p]     += v_re[q] * c;\
+                        grids[q][p + 1] += v_im[q] * c;\
+                    }\
+                    sum += c;\
+                }\
+            }\
+            for (q = 0; q < num_planes; ++q)\
+                norm[q] += sum * weight[num_pols * r + pol[q]];\
+        }\
+    }\
+}
+
+GRID_PLANES(grid_planes_d, double, round)
+GRID_PLANES(grid_planes_f, float, roundf)
+
+/* Returns the channel index for the given frequency, or -1 if none. */
+static int select_channel(const oskar_Imager* h, double freq_hz,
+        int start_chan, int end_chan)
+{
+    const double df = h->freq_inc_hz != 0.0 ? h->freq_inc_hz : 1.0;
+    const double f0 = h->vis_freq_start_hz;
+    const int c = (int) round((freq_hz - f0) / df);
+    if (c < start_chan || c > end_chan) return -1;
+    if (fabs((freq_hz - f0) - c * df) > 0.05 * df) return -1;
+    return c;
+}
+
+
+int oskar_imager_update_planes_fft_supported(const oskar_Imager* h)
+{
+    int max_threads = 1;
+#ifdef _OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+    if (h->coords_only || h->algorithm != OSKAR_ALGORITHM_FFT ||
+            (h->grid_on_gpu && h->num_gpus > 0) ||
+            h->weighting != OSKAR_WEIGHTING_NATURAL ||
+            h->direction_type == 'R' ||
+            h->time_min_utc > 0.0 || h->time_max_utc > 0.0 ||
+            h->num_planes < 2 || h->num_im_pols > 4)
+        return 0;
+
+    /* Image channels are gridded concurrently, but each channel is
+     * gridded serially, so prefer the tiled gridder unless there are
+     * enough channels to keep all the threads busy. */
+    return (h->num_im_channels >= max_threads);
+}
+
+
+void oskar_imager_update_planes_fft(oskar_Imager* h, size_t num_rows,
+        int start_chan, int end_chan, int num_pols, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* amps, const oskar_Mem* weight,
+        size_t* num_skipped, int* status)
+{
+    int c, p, pol[4];
+    int* plane_status = 0;
+    size_t* plane_used = 0, *plane_skipped = 0;
+    if (*status) return;
+
+    /* Get the input polarisation for each image polarisation. */
+    for (p = 0; p < h->num_im_pols; ++p)
+    {
+        pol[p] = h->pol_offset;
+        if (h->im_type == OSKAR_IMAGE_TYPE_STOKES ||
+                h->im_type == OSKAR_IMAGE_TYPE_LINEAR)
+            pol[p] = p;
+        if (num_pols == 1) pol[p] = 0;
+    }
+
+    /* Get the UV baseline length filter range, as in filter_uv(). */
+    const int filter = !(h->uv_filter_min <= 0.0 &&
+            (h->uv_filter_max < 0.0 || h->uv_filter_max > FLT_MAX));
+    const double uv_min = h->uv_filter_min;
+    const double uv_max = (h->uv_filter_max < 0.0) ?
+            (double) FLT_MAX : h->uv_filter_max;
+    const int grid_size = oskar_imager_plane_size(h);
+    const size_t num_cells = (size_t) grid_size * (size_t) grid_size;
+    const int num_channels = 1 + end_chan - start_chan;
+    const int num_im_channels = h->num_im_channels;
+    const int is_psf = (h->im_type == OSKAR_IMAGE_TYPE_PSF);
+    for (c = 0; c < h->num_planes; ++c)
+        oskar_mem_ensure(h->planes[c], num_cells, status);
+    if (*status) return;
+
+    /* Grid each image channel using a different thread. */
+    plane_status = (int*) calloc(num_im_channels, sizeof(int));
+    plane_used = (size_t*) calloc(num_im_channels, sizeof(size_t));
+    plane_skipped = (size_t*) calloc(num_im_channels, sizeof(size_t));
+    if (!plane_status || !plane_used || !plane_skipped)
+    {
+        free(plane_status);
+        free(plane_used);
+        free(plane_skipped);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+#pragma omp parallel for schedule(dynamic, 1)
+    for (c = 0; c < num_im_channels; ++c)
+    {
+        int i, num_sel = 0;
+        int* sel_chan = (int*) calloc(num_channels, sizeof(int));
+        double* sel_scale = (double*) calloc(num_channels, sizeof(double));
+        float* sel_scale_f = (float*) calloc(num_channels, sizeof(float));
+        void* grids[4];
+        int* st = &plane_status[c];
+        const double df = h->freq_inc_hz != 0.0 ? h->freq_inc_hz : 1.0;
+        if (!sel_chan || !sel_scale || !sel_scale_f)
+        {
+            free(sel_chan);
+            free(sel_scale);
+            free(sel_scale_f);
+            *st = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+            continue;
+        }
+
+        /* Select the channels to grid for this image channel. */
+        if (h->chan_snaps)
+        {
+            const int ch = select_channel(h, h->im_freqs[c],
+                    start_chan, end_chan);
+            if (ch >= 0) sel_chan[num_sel++] = ch;
+        }
+        else
+        {
+            for (i = 0; i < h->num_sel_freqs; ++i)
+            {
+                const int ch = select_channel(h, h->sel_freqs[i],
+                        start_chan, end_chan);
+                if (ch >= 0) sel_chan[num_sel++] = ch;
+            }
+        }
+        for (i = 0; i < num_sel; ++i)
+        {
+            sel_scale[i] = (h->vis_freq_start_hz + sel_chan[i] * df) / C0;
+            sel_scale_f[i] = (float) sel_scale[i];
+            sel_chan[i] -= start_chan;
+        }
+
+        /* Grid all polarisations for the selected channels. */
+        for (i = 0; i < h->num_im_pols; ++i)
+            grids[i] = oskar_mem_void(h->planes[c * h->num_im_pols + i]);
+        if (num_sel > 0 && h->imager_prec == OSKAR_DOUBLE)
+            grid_planes_d(h->support, h->oversample,
+                    oskar_mem_double_const(h->conv_func, st),
+                    num_rows, num_channels, num_pols,
+                    oskar_mem_double_const(uu, st),
+                    oskar_mem_double_const(vv, st),
+                    oskar_mem_double_const(amps, st),
+                    oskar_mem_double_const(weight, st),
+                    num_sel, sel_chan, sel_scale, h->num_im_pols, pol,
+                    is_psf, filter, uv_min * uv_min, uv_max * uv_max,
+                    h->cellsize_rad, grid_size, &plane_used[c],
+                    &plane_skipped[c], &h->plane_norm[c * h->num_im_pols],
+                    (double* const*) grids);
+        else if (num_sel > 0)
+            grid_planes_f(h->support, h->oversample,
+                    oskar_mem_float_const(h->conv_func, st),
+                    num_rows, num_channels, num_pols,
+                    oskar_mem_float_const(uu, st),
+                    oskar_mem_float_const(vv, st),
+                    oskar_mem_float_const(amps, st),
+                    oskar_mem_float_const(weight, st),
+                    num_sel, sel_chan, sel_scale_f, h->num_im_pols, pol,
+                    is_psf, filter, uv_min * uv_min, uv_max * uv_max,
+                    (float) (h->cellsize_rad), grid_size, &plane_used[c],
+                    &plane_skipped[c], &h->plane_norm[c * h->num_im_pols],
+                    (float* const*) grids);
+        free(sel_chan);
+        free(sel_scale);
+        free(sel_scale_f);
+    }
+
+    /* Record the number of visibilities used by all the planes. */
+    for (c = 0; c < num_im_channels; ++c)
+    {
+        if (plane_status[c] && !*status) *status = plane_status[c];
+        h->num_vis_processed += plane_used[c] * h->num_im_pols;
+        h->num_vis_processed -= plane_skipped[c];
+        *num_skipped += plane_skipped[c];
+    }
+    free(plane_status);
+    free(plane_used);
+    free(plane_skipped);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "imager/private_imager.h"
+#include "imager/oskar_imager.h"
+
+#include "imager/oskar_grid_weights.h"
+#include "imager/private_imager_update_weights_grid.h"
+
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void oskar_imager_update_weights_grid(oskar_Imager* h, size_t num_points,
+        const oskar_Mem* uu, const oskar_Mem* vv, const oskar_Mem* ww,
+        const oskar_Mem* weight, oskar_Mem* weights_grid, int* status)
+{
+    if (*status) return;
+
+    /* Update the weights grid. */
+    if (h->weighting == OSKAR_WEIGHTING_UNIFORM)
+    {
+        size_t num_skipped = 0;
+
+        /* Resize the grid of weights if needed. */
+        const int grid_size = oskar_imager_plane_size(h);
+        oskar_mem_ensure(weights_grid, (size_t) grid_size * grid_size, status);
+        if (*status) return;
+
+        oskar_timer_resume(h->tmr_weights_grid);
+        if (oskar_mem_precision(weights_grid) == OSKAR_DOUBLE)
+            oskar_grid_weights_write_d(num_points,
+                    oskar_mem_double_const(uu, status),
+                    oskar_mem_double_const(vv, status),
+                    oskar_mem_double_const(weight, status),
+                    h->cellsize_rad, grid_size, &num_skipped,
+                    oskar_mem_double(weights_grid, status));
+        else
+            oskar_grid_weights_write_f(num_points,
+                    oskar_mem_float_const(uu, status),
+                    oskar_mem_float_const(vv, status),
+                    oskar_mem_float_const(weight, status),
+                    (float) (h->cellsize_rad), grid_size, &num_skipped,
+                    oskar_mem_float(weights_grid, status));
+        if (num_skipped > 0)
+            oskar_log_warning(h->log, "Skipped %lu visibility weights.",
+                    (unsigned long) num_skipped);
+        oskar_timer_pause(h->tmr_weights_grid);
+    }
+
+    /* Update baseline W minimum, maximum and RMS. */
+    if (ww && (h->algorithm == OSKAR_ALGORITHM_WPROJ ||
+            h->algorithm == OSKAR_ALGORITHM_WSTACK))
+    {
+        size_t j;
+        oskar_timer_resume(h->tmr_coord_scan);
+        if (oskar_mem_precision(ww) == OSKAR_DOUBLE)
+        {
+            const double *p = oskar_mem_double_const(ww, status);
+            for (j = 0; j < num_points; ++j)
+            {
+                const double val = fabs(p[j]);
+                h->ww_rms += (val * val);
+                if (val < h->ww_min) h->ww_min = val;
+                if (val > h->ww_max) h->ww_max = val;
+            }
+        }
+        else
+        {
+            const float *p = oskar_mem_float_const(ww, status);
+            for (j = 0; j < num_points; ++j)
+            {
+                const double val = fabs((double) (p[j]));
+                h->ww_rms += (val * val);
+                if (val < h->ww_min) h->ww_min = val;
+                if (val > h->ww_max) h->ww_max = val;
+            }
+        }
+        h->ww_points += num_points;
+        oskar_timer_pause(h->tmr_coord_scan);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
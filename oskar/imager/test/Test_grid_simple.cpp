@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_grid_functions_spheroidal.h"
+#include "imager/oskar_grid_simple.h"
+#include "imager/test/grid_test_points.h"
+
+#include <vector>
+
+// Grids one chunk of the test points.
+template <typename FP>
+struct GridSimpleChunk
+{
+    const GridTestPoints* p;
+    int support, oversample;
+    const FP* conv_func;
+    double* norm;
+    FP* grid;
+
+    void operator()(size_t start, size_t n, size_t* skipped)
+    {
+        int status = 0;
+        if (sizeof(FP) == sizeof(double))
+            oskar_grid_simple_d(support, oversample,
+                    (const double*) conv_func, n,
+                    oskar_mem_double_const(p->uu, &status) + start,
+                    oskar_mem_double_const(p->vv, &status) + start,
+                    oskar_mem_double_const(p->vis, &status) + 2 * start,
+                    oskar_mem_double_const(p->weight, &status) + start,
+                    p->cell_size_rad, GridTestPoints::GRID_SIZE, skipped,
+                    norm, (double*) grid);
+        else
+            oskar_grid_simple_f(support, oversample,
+                    (const float*) conv_func, n,
+                    oskar_mem_float_const(p->uu, &status) + start,
+                    oskar_mem_float_const(p->vv, &status) + start,
+                    oskar_mem_float_const(p->vis, &status) + 2 * start,
+                    oskar_mem_float_const(p->weight, &status) + start,
+                    (float) p->cell_size_rad, GridTestPoints::GRID_SIZE,
+                    skipped, norm, (float*) grid);
+    }
+};
+
+// Grids the test visibilities using the given number of threads.
+template <typename FP>
+static void grid(int num_threads, size_t chunk_size, int support,
+        int oversample, std::vector<FP>& grid_data, double* norm,
+        size_t* num_skipped)
+{
+    int status = 0;
+    const int grid_size = GridTestPoints::GRID_SIZE;
+    const int prec = sizeof(FP) == sizeof(double) ? OSKAR_DOUBLE : OSKAR_SINGLE;
+    std::vector<double> conv_func_d(oversample * (support + 1));
+    oskar_grid_convolution_function_spheroidal(support, oversample,
+            &conv_func_d[0]);
+    std::vector<FP> conv_func(conv_func_d.begin(), conv_func_d.end());
+    GridTestPoints points(prec, &status);
+    ASSERT_EQ(0, status);
+    grid_data.assign(2 * grid_size * grid_size, (FP) 0);
+    *norm = 0.0;
+    GridSimpleChunk<FP> chunk = {
+        &points, support, oversample, &conv_func[0], norm, &grid_data[0]
+    };
+    *num_skipped = grid_test_run_chunks(num_threads, chunk_size, chunk);
+}
+
+template <typename FP>
+static void compare(int support, int oversample, double tol)
+{
+    std::vector<FP> grid_serial, grid_1, grid_4;
+    double norm_serial = 0.0, norm_1 = 0.0, norm_4 = 0.0;
+    size_t skipped_serial = 0, skipped_1 = 0, skipped_4 = 0;
+    grid<FP>(1, 4096, support, oversample, grid_serial, &norm_serial,
+            &skipped_serial);
+    grid<FP>(1, 0, support, oversample, grid_1, &norm_1, &skipped_1);
+    grid<FP>(4, 0, support, oversample, grid_4, &norm_4, &skipped_4);
+
+    // Check the tiled gridder against the serial loop.
+    EXPECT_GT(skipped_serial, 0u);
+    EXPECT_EQ(skipped_serial, skipped_1);
+    EXPECT_NEAR(norm_serial, norm_1, tol * norm_serial);
+    double max_abs = 0.0, max_diff = 0.0;
+    for (size_t i = 0; i < grid_serial.size(); ++i)
+    {
+        const double diff = fabs(grid_serial[i] - grid_1[i]);
+        if (fabs(grid_serial[i]) > max_abs) max_abs = fabs(grid_serial[i]);
+        if (diff > max_diff) max_diff = diff;
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LE(max_diff, tol * max_abs);
+
+    // The result must not depend on the number of threads.
+    EXPECT_EQ(skipped_1, skipped_4);
+    EXPECT_EQ(norm_1, norm_4);
+    EXPECT_TRUE(grid_1 == grid_4);
+}
+
+TEST(grid_simple, tiled_matches_serial_double)
+{
+    compare<double>(3, 100, 1e-12);
+    compare<double>(4, 63, 1e-12);
+}
+
+TEST(grid_simple, tiled_matches_serial_float)
+{
+    compare<float>(3, 100, 1e-5);
+    compare<float>(4, 63, 1e-5);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_grid_weights.h"
+#include "imager/test/grid_test_points.h"
+
+#include <vector>
+
+// Writes or reads the weights for one chunk of the test points.
+template <typename FP>
+struct GridWeightsChunk
+{
+    const GridTestPoints* p;
+    int read;
+    FP* grid;
+    FP* weight_out;
+
+    void operator()(size_t start, size_t n, size_t* skipped)
+    {
+        int status = 0;
+        if (sizeof(FP) == sizeof(double))
+        {
+            const double* u_ = oskar_mem_double_const(p->uu, &status);
+            const double* v_ = oskar_mem_double_const(p->vv, &status);
+            const double* w_ = oskar_mem_double_const(p->weight, &status);
+            if (!read)
+                oskar_grid_weights_write_d(n, u_ + start, v_ + start,
+                        w_ + start, p->cell_size_rad,
+                        GridTestPoints::GRID_SIZE, skipped, (double*) grid);
+            else
+                oskar_grid_weights_read_d(n, u_ + start, v_ + start,
+                        w_ + start, (double*) weight_out + start,
+                        p->cell_size_rad, GridTestPoints::GRID_SIZE,
+                        skipped, (const double*) grid);
+        }
+        else
+        {
+            const float* u_ = oskar_mem_float_const(p->uu, &status);
+            const float* v_ = oskar_mem_float_const(p->vv, &status);
+            const float* w_ = oskar_mem_float_const(p->weight, &status);
+            if (!read)
+                oskar_grid_weights_write_f(n, u_ + start, v_ + start,
+                        w_ + start, (float) p->cell_size_rad,
+                        GridTestPoints::GRID_SIZE, skipped, (float*) grid);
+            else
+                oskar_grid_weights_read_f(n, u_ + start, v_ + start,
+                        w_ + start, (float*) weight_out + start,
+                        (float) p->cell_size_rad, GridTestPoints::GRID_SIZE,
+                        skipped, (const float*) grid);
+        }
+    }
+};
+
+// Grids the test weights and looks them up again using the given number
+// of threads.
+template <typename FP>
+static void weights(int num_threads, size_t chunk_size,
+        std::vector<FP>& grid, std::vector<FP>& weight_out,
+        size_t* num_skipped_write, size_t* num_skipped_read)
+{
+    int status = 0;
+    const int grid_size = GridTestPoints::GRID_SIZE;
+    const int prec = sizeof(FP) == sizeof(double) ? OSKAR_DOUBLE : OSKAR_SINGLE;
+    GridTestPoints points(prec, &status);
+    ASSERT_EQ(0, status);
+    grid.assign(grid_size * grid_size, (FP) 0);
+    weight_out.assign(GridTestPoints::NUM_POINTS, (FP) -1);
+    GridWeightsChunk<FP> chunk = { &points, 0, &grid[0], &weight_out[0] };
+    *num_skipped_write = grid_test_run_chunks(num_threads, chunk_size, chunk);
+    chunk.read = 1;
+    *num_skipped_read = grid_test_run_chunks(num_threads, chunk_size, chunk);
+}
+
+template <typename FP>
+static void compare()
+{
+    std::vector<FP> grid_serial, grid_1, grid_4, out_serial, out_1, out_4;
+    size_t write_serial = 0, write_1 = 0, write_4 = 0;
+    size_t read_serial = 0, read_1 = 0, read_4 = 0;
+    weights<FP>(1, 4096, grid_serial, out_serial, &write_serial, &read_serial);
+    weights<FP>(1, 0, grid_1, out_1, &write_1, &read_1);
+    weights<FP>(4, 0, grid_4, out_4, &write_4, &read_4);
+
+    // The weights in each cell are summed in the same order,
+    // so the results must match the serial loops exactly.
+    EXPECT_GT(write_serial, 0u);
+    EXPECT_EQ(write_serial, read_serial);
+    EXPECT_EQ(write_serial, write_1);
+    EXPECT_EQ(write_serial, write_4);
+    EXPECT_EQ(read_serial, read_1);
+    EXPECT_EQ(read_serial, read_4);
+    EXPECT_TRUE(grid_serial == grid_1);
+    EXPECT_TRUE(grid_serial == grid_4);
+    EXPECT_TRUE(out_serial == out_1);
+    EXPECT_TRUE(out_serial == out_4);
+}
+
+TEST(grid_weights, binned_matches_serial_double)
+{
+    compare<double>();
+}
+
+TEST(grid_weights, binned_matches_serial_float)
+{
+    compare<float>();
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "imager/oskar_grid_wproj2.h"
+#include "imager/oskar_grid_wproj_sort.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+static const int num_w_planes = 8;
+static const int oversample = 4;
+static const int grid_size = 256;
+static const size_t num_points = 50000;
+static const double cell_size_rad = 4.0 * M_PI / 180.0 / grid_size;
+static const double w_max = 1000.0;
+
+// Creates W-kernels with the layout of the compact kernels used by
+// oskar_grid_wproj2, filled with random values.
+template <typename FP>
+static void create_kernels(std::vector<int>& support,
+        std::vector<int>& kernel_start, std::vector<FP>& kernels)
+{
+    const int oversample_h = oversample / 2;
+    size_t size = 0;
+    support.resize(num_w_planes);
+    kernel_start.resize(num_w_planes);
+    for (int w = 0; w < num_w_planes; ++w)
+    {
+        const int conv_len = 2 * (3 + w) + 1;
+        const int width = (oversample_h * conv_len + 1) * conv_len;
+        support[w] = 3 + w;
+        kernel_start[w] = (int) size;
+        size += (size_t) (oversample_h + 1) * width;
+    }
+    kernels.resize(2 * size);
+    srand(2);
+    for (size_t i = 0; i < kernels.size(); ++i)
+        kernels[i] = (FP) (rand() / (double) RAND_MAX);
+}
+
+template <typename FP>
+static void check_sort(double tol)
+{
+    int status = 0;
+    const int type = (sizeof(FP) == sizeof(double)) ? OSKAR_DOUBLE :
+            OSKAR_SINGLE;
+    const double w_scale = pow(num_w_planes - 1, 2) / w_max;
+    std::vector<int> support, kernel_start;
+    std::vector<FP> kernels;
+    create_kernels(support, kernel_start, kernels);
+
+    // Create visibility data, some of which lies off the grid.
+    oskar_Mem* uu = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* vv = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* ww = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_Mem* vis = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* weight = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 700.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 700.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 400.0, &status);
+    oskar_mem_random_gaussian(vis, 12, 13, 14, 15, 1.0, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_points, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const FP* u = (const FP*) oskar_mem_void_const(uu);
+    const FP* v = (const FP*) oskar_mem_void_const(vv);
+    const FP* w = (const FP*) oskar_mem_void_const(ww);
+    const FP* a = (const FP*) oskar_mem_void_const(vis);
+    const FP* wt = (const FP*) oskar_mem_void_const(weight);
+
+    // Find the sorted order and gather the data.
+    std::vector<size_t> order(num_points);
+    if (type == OSKAR_DOUBLE)
+        oskar_grid_wproj_sort_d(num_w_planes, num_points,
+                (const double*) u, (const double*) v, (const double*) w,
+                cell_size_rad, w_scale, grid_size, &order[0], &status);
+    else
+        oskar_grid_wproj_sort_f(num_w_planes, num_points,
+                (const float*) u, (const float*) v, (const float*) w,
+                (float) cell_size_rad, (float) w_scale, grid_size,
+                &order[0], &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    std::vector<int> seen(num_points, 0);
+    std::vector<FP> s_u(num_points), s_v(num_points), s_w(num_points);
+    std::vector<FP> s_a(2 * num_points), s_wt(num_points);
+    size_t last_plane = 0;
+    for (size_t i = 0; i < num_points; ++i)
+    {
+        const size_t j = order[i];
+        ASSERT_LT(j, num_points);
+        seen[j]++;
+        s_u[i] = u[j];
+        s_v[i] = v[j];
+        s_w[i] = w[j];
+        s_a[2 * i] = a[2 * j];
+        s_a[2 * i + 1] = a[2 * j + 1];
+        s_wt[i] = wt[j];
+
+        // Check the W-planes are in order.
+        size_t plane = (size_t) std::round(
+                std::sqrt(std::fabs(w[j] * (FP) w_scale)));
+        if (plane >= (size_t) num_w_planes) plane = num_w_planes - 1;
+        EXPECT_GE(plane, last_plane);
+        last_plane = plane;
+    }
+    for (size_t i = 0; i < num_points; ++i) ASSERT_EQ(1, seen[i]);
+
+    // Grid in input order and in sorted order.
+    size_t num_skipped[2] = {0, 0};
+    double norm[2] = {0.0, 0.0};
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    std::vector<FP> grid0(2 * num_cells, 0), grid1(2 * num_cells, 0);
+    if (type == OSKAR_DOUBLE)
+    {
+        oskar_grid_wproj2_d(num_w_planes, &support[0], oversample,
+                &kernel_start[0], (const double*) &kernels[0], num_points,
+                (const double*) u, (const double*) v, (const double*) w,
+                (const double*) a, (const double*) wt, cell_size_rad,
+                w_scale, grid_size, &num_skipped[0], &norm[0],
+                (double*) &grid0[0]);
+        oskar_grid_wproj2_d(num_w_planes, &support[0], oversample,
+                &kernel_start[0], (const double*) &kernels[0], num_points,
+                (const double*) &s_u[0], (const double*) &s_v[0],
+                (const double*) &s_w[0], (const double*) &s_a[0],
+                (const double*) &s_wt[0], cell_size_rad,
+                w_scale, grid_size, &num_skipped[1], &norm[1],
+                (double*) &grid1[0]);
+    }
+    else
+    {
+        oskar_grid_wproj2_f(num_w_planes, &support[0], oversample,
+                &kernel_start[0], (const float*) &kernels[0], num_points,
+                (const float*) u, (const float*) v, (const float*) w,
+                (const float*) a, (const float*) wt, (float) cell_size_rad,
+                (float) w_scale, grid_size, &num_skipped[0], &norm[0],
+                (float*) &grid0[0]);
+        oskar_grid_wproj2_f(num_w_planes, &support[0], oversample,
+                &kernel_start[0], (const float*) &kernels[0], num_points,
+                (const float*) &s_u[0], (const float*) &s_v[0],
+                (const float*) &s_w[0], (const float*) &s_a[0],
+                (const float*) &s_wt[0], (float) cell_size_rad,
+                (float) w_scale, grid_size, &num_skipped[1], &norm[1],
+                (float*) &grid1[0]);
+    }
+    EXPECT_GT(num_skipped[0], 0u);
+    EXPECT_EQ(num_skipped[0], num_skipped[1]);
+    EXPECT_NEAR(1.0, norm[1] / norm[0], tol);
+    double max_abs = 0.0, max_diff = 0.0;
+    for (size_t i = 0; i < 2 * num_cells; ++i)
+    {
+        const double diff = fabs((double) grid1[i] - (double) grid0[i]);
+        if (fabs((double) grid0[i]) > max_abs) max_abs = fabs(grid0[i]);
+        if (diff > max_diff) max_diff = diff;
+    }
+    EXPECT_GT(max_abs, 0.0);
+    EXPECT_LT(max_diff / max_abs, tol);
+
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+}
+
+TEST(grid_wproj_sort, double_precision)
+{
+    check_sort<double>(1e-12);
+}
+
+TEST(grid_wproj_sort, single_precision)
+{
+    check_sort<float>(1e-4);
+}
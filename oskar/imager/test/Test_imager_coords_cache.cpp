@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "binary/oskar_binary.h"
+#include "imager/oskar_imager.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_file_exists.h"
+#include "utility/oskar_get_error_string.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef OSKAR_OS_LINUX
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+static const char* vis_file = "temp_test_coords_cache.vis";
+
+// Writes a visibility file with pseudo-random station coordinates.
+static void write_vis(unsigned int seed, int num_times)
+{
+    int status = 0;
+    const int num_channels = 3, num_stations = 30, max_times = 4;
+    const int num_blocks = (num_times + max_times - 1) / max_times;
+    const int type = OSKAR_DOUBLE | OSKAR_COMPLEX | OSKAR_MATRIX;
+    oskar_VisHeader* hdr = oskar_vis_header_create(type, OSKAR_DOUBLE,
+            max_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, 51544.5);
+    oskar_vis_header_set_time_inc_sec(hdr, 10.0);
+    oskar_vis_header_set_phase_centre(hdr, 0, 20.0, -30.0);
+    oskar_Binary* h = oskar_vis_header_write(hdr, vis_file, &status);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    for (int i = 0; i < num_blocks; ++i)
+    {
+        const unsigned int key = seed + 100 * i;
+        oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(blk, 0),
+                key, 1, 2, 3, 150.0, &status);
+        oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(blk, 1),
+                key, 4, 5, 6, 150.0, &status);
+        oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(blk, 2),
+                key, 7, 8, 9, 40.0, &status);
+        oskar_mem_random_gaussian(oskar_vis_block_cross_correlations(blk),
+                key, 10, 11, 12, 1.0, &status);
+        oskar_vis_block_write(blk, h, i, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_binary_free(h);
+}
+
+static std::vector<double> make_image(int cache, int size,
+        const char* algorithm, const char* weighting, double uv_max = -1.0)
+{
+    int status = 0;
+    oskar_Mem* image = 0;
+    oskar_Imager* h = oskar_imager_create(OSKAR_DOUBLE, &status);
+    oskar_imager_set_gpus(h, 0, 0, &status);
+    oskar_imager_set_input_files(h, 1, &vis_file, &status);
+    oskar_imager_set_algorithm(h, algorithm, &status);
+    oskar_imager_set_weighting(h, weighting, &status);
+    oskar_imager_set_image_type(h, "I", &status);
+    oskar_imager_set_fov(h, 4.0);
+    oskar_imager_set_size(h, size, &status);
+    oskar_imager_set_uv_filter_max(h, uv_max);
+    oskar_imager_set_coords_cache(h, cache);
+    oskar_imager_run(h, 1, &image, 0, 0, &status);
+    EXPECT_EQ(0, status) << oskar_get_error_string(status);
+    std::vector<double> out;
+    if (!status)
+    {
+        const double* p = oskar_mem_double_const(image, &status);
+        out.assign(p, p + (size_t) size * size);
+    }
+    oskar_mem_free(image, &status);
+    oskar_imager_free(h, &status);
+    return out;
+}
+
+static std::string cache_file()
+{
+    return std::string(vis_file) + ".oskar_coord_cache";
+}
+
+static void check_cache(const char* algorithm, const char* weighting)
+{
+    (void) remove(cache_file().c_str());
+    write_vis(1, 10);
+    const std::vector<double> ref = make_image(0, 64, algorithm, weighting);
+    EXPECT_FALSE(oskar_file_exists(cache_file().c_str()));
+
+    // Write the cache, then use it.
+    EXPECT_TRUE(ref == make_image(1, 64, algorithm, weighting));
+    EXPECT_TRUE(oskar_file_exists(cache_file().c_str()));
+    EXPECT_TRUE(ref == make_image(1, 64, algorithm, weighting));
+
+    // The cache does not depend on the image size.
+    EXPECT_TRUE(make_image(0, 96, algorithm, weighting) ==
+            make_image(1, 96, algorithm, weighting));
+
+    // It is not used if the selection changes.
+    EXPECT_TRUE(make_image(0, 64, algorithm, weighting, 300.0) ==
+            make_image(1, 64, algorithm, weighting, 300.0));
+    EXPECT_TRUE(ref == make_image(1, 64, algorithm, weighting));
+
+    // It is not used if the input file changes.
+    write_vis(2, 11);
+    const std::vector<double> ref2 = make_image(0, 64, algorithm, weighting);
+    EXPECT_FALSE(ref == ref2);
+    EXPECT_TRUE(ref2 == make_image(1, 64, algorithm, weighting));
+    (void) remove(cache_file().c_str());
+    (void) remove(vis_file);
+}
+
+TEST(imager_coords_cache, uniform_fft)
+{
+    check_cache("FFT", "Uniform");
+}
+
+TEST(imager_coords_cache, natural_wstack)
+{
+    check_cache("W-stacking", "Natural");
+}
+
+#ifdef OSKAR_OS_LINUX
+TEST(imager_coords_cache, input_modified)
+{
+    // Check that the cache really is used in place of the input coordinates,
+    // by changing the input without changing its size or modification time.
+    struct stat s;
+    (void) remove(cache_file().c_str());
+    write_vis(1, 10);
+    const std::vector<double> ref = make_image(1, 64, "FFT", "Uniform");
+    ASSERT_EQ(0, stat(vis_file, &s));
+    write_vis(3, 10);
+    const std::vector<double> changed = make_image(0, 64, "FFT", "Uniform");
+    EXPECT_FALSE(ref == changed);
+    struct timespec times[2];
+    times[0] = s.st_atim;
+    times[1] = s.st_mtim;
+    ASSERT_EQ(0, utimensat(AT_FDCWD, vis_file, times, 0));
+    const std::vector<double> cached = make_image(1, 64, "FFT", "Uniform");
+    EXPECT_FALSE(changed == cached);
+
+    // The cache is replaced once the modification time changes.
+    write_vis(3, 10);
+    EXPECT_TRUE(changed == make_image(1, 64, "FFT", "Uniform"));
+    (void) remove(cache_file().c_str());
+    (void) remove(vis_file);
+}
+#endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_grid_correction.h"
+#include "imager/oskar_grid_functions_spheroidal.h"
+#include "imager/oskar_imager.h"
+#include "math/oskar_fft.h"
+#include "math/oskar_fftphase.h"
+#include "mem/oskar_mem.h"
+
+#include <fitsio.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Finalises a plane using the separate steps, for reference.
+static void reference_plane(int size, int oversample, double plane_norm,
+        oskar_Mem* plane, int* status)
+{
+    const int prec = oskar_mem_precision(plane);
+    std::vector<double> fn(size);
+    oskar_grid_correction_function_spheroidal(size, oversample, &fn[0]);
+    oskar_Mem* corr_func_d = oskar_mem_create_alias_from_raw(&fn[0],
+            OSKAR_DOUBLE, OSKAR_CPU, size, status);
+    oskar_Mem* corr_func = oskar_mem_convert_precision(corr_func_d, prec,
+            status);
+    oskar_FFT* fft = oskar_fft_create(prec, OSKAR_CPU, 2, size, 0, status);
+    oskar_mem_scale_real(plane, 1.0 / plane_norm,
+            0, oskar_mem_length(plane), status);
+    oskar_fftphase(size, size, plane, status);
+    oskar_fft_exec(fft, plane, status);
+    oskar_fftphase(size, size, plane, status);
+    oskar_grid_correction(size, corr_func, plane, status);
+    oskar_fft_free(fft);
+    oskar_mem_free(corr_func, status);
+    oskar_mem_free(corr_func_d, status);
+}
+
+static void check_finalise_plane(int prec, int size,
+        double max_tol, double avg_tol)
+{
+    int status = 0;
+    const double plane_norm = 123.0;
+    oskar_Imager* im = oskar_imager_create(prec, &status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, size, &status);
+    oskar_Mem* plane = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            size * size, &status);
+    oskar_mem_random_gaussian(plane, 0, 1, 2, 3, 1.0, &status);
+    oskar_Mem* ref = oskar_mem_create_copy(plane, OSKAR_CPU, &status);
+    ASSERT_EQ(0, status);
+
+    oskar_imager_finalise_plane(im, plane, plane_norm, &status);
+    reference_plane(size, 0, plane_norm, ref, &status);
+    ASSERT_EQ(0, status);
+
+    // View the complex planes as real arrays, so that both real and
+    // imaginary parts are checked.
+    oskar_Mem* plane_re = oskar_mem_create_alias_from_raw(
+            oskar_mem_void(plane), prec, OSKAR_CPU, 2 * size * size, &status);
+    oskar_Mem* ref_re = oskar_mem_create_alias_from_raw(
+            oskar_mem_void(ref), prec, OSKAR_CPU, 2 * size * size, &status);
+    double max_err = 0.0, avg_err = 0.0;
+    oskar_mem_evaluate_relative_error(plane_re, ref_re, 0, &max_err, &avg_err,
+            0, &status);
+    EXPECT_LT(max_err, max_tol);
+    EXPECT_LT(avg_err, avg_tol);
+    oskar_mem_free(plane_re, &status);
+    oskar_mem_free(ref_re, &status);
+    oskar_mem_free(plane, &status);
+    oskar_mem_free(ref, &status);
+    oskar_imager_free(im, &status);
+}
+
+TEST(imager_finalise, plane_double)
+{
+    check_finalise_plane(OSKAR_DOUBLE, 256, 1e-10, 1e-14);
+}
+
+TEST(imager_finalise, plane_single)
+{
+    check_finalise_plane(OSKAR_SINGLE, 256, 1e-2, 1e-5);
+}
+
+// The phase flips depend on the parity of half the plane size,
+// so also check a size that is not a multiple of 4.
+TEST(imager_finalise, plane_double_size_2_mod_4)
+{
+    check_finalise_plane(OSKAR_DOUBLE, 250, 1e-10, 1e-14);
+}
+
+TEST(imager_finalise, plane_single_size_2_mod_4)
+{
+    check_finalise_plane(OSKAR_SINGLE, 250, 1e-2, 1e-5);
+}
+
+static void check_finalise_images(int prec, double tol, int num_threads)
+{
+    int status = 0;
+    const int image_size = 128, oversample = 4, num_rows = 2000;
+    const int num_pols = 4, num_planes = 4;
+    oskar_Imager* im = oskar_imager_create(prec, &status);
+    oskar_imager_set_algorithm(im, "W-projection", &status);
+    oskar_imager_set_oversample(im, oversample);
+    oskar_imager_set_image_type(im, "Linear", &status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, image_size, &status);
+    oskar_imager_set_vis_frequency(im, 100e6, 0.0, 1);
+    oskar_imager_set_vis_phase_centre(im, 0.0, 60.0);
+    oskar_imager_set_output_root(im, "temp_test_imager_finalise");
+    const int plane_size = oskar_imager_plane_size(im);
+    ASSERT_GT(plane_size, image_size);
+
+    // Grid random visibilities onto all four polarisation planes.
+    oskar_Mem* uu = oskar_mem_create(prec, OSKAR_CPU, num_rows, &status);
+    oskar_Mem* vv = oskar_mem_create(prec, OSKAR_CPU, num_rows, &status);
+    oskar_Mem* ww = oskar_mem_create(prec, OSKAR_CPU, num_rows, &status);
+    oskar_Mem* amps = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_rows * num_pols, &status);
+    oskar_Mem* weight = oskar_mem_create(prec, OSKAR_CPU,
+            num_rows * num_pols, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 100.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 100.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 10.0, &status);
+    oskar_mem_random_gaussian(amps, 12, 13, 14, 15, 1.0, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_rows * num_pols, &status);
+    oskar_imager_set_coords_only(im, 1);
+    oskar_imager_update(im, num_rows, 0, 0, num_pols, uu, vv, ww, amps,
+            weight, 0, &status);
+    oskar_imager_set_coords_only(im, 0);
+    oskar_imager_update(im, num_rows, 0, 0, num_pols, uu, vv, ww, amps,
+            weight, 0, &status);
+    ASSERT_EQ(0, status);
+
+    // Finalise, returning the normalised grids as well as the images.
+    oskar_Mem* images[num_planes] = {0, 0, 0, 0};
+    oskar_Mem* grids[num_planes] = {0, 0, 0, 0};
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_imager_finalise(im, num_planes, images, num_planes, grids, &status);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    ASSERT_EQ(0, status);
+
+    // Check each image against the trimmed real part of the reference,
+    // and check the image written to the FITS file is the same.
+    const char* pols[] = {"XX", "XY", "YX", "YY"};
+    const int offset = (plane_size - image_size) / 2;
+    for (int i = 0; i < num_planes; ++i)
+    {
+        char name[64];
+        fitsfile* f = 0;
+        int fits_status = 0, num_keys = 0;
+        long firstpix[] = {1, 1, 1};
+        oskar_Mem* image_file = oskar_mem_create(prec, OSKAR_CPU,
+                image_size * image_size, &status);
+        sprintf(name, "temp_test_imager_finalise_%s.fits", pols[i]);
+        fits_open_file(&f, name, READONLY, &fits_status);
+        fits_read_pix(f, prec == OSKAR_DOUBLE ? TDOUBLE : TFLOAT, firstpix,
+                image_size * image_size, 0, oskar_mem_void(image_file), 0,
+                &fits_status);
+        fits_get_hdrspace(f, &num_keys, 0, &fits_status);
+        fits_close_file(f, &fits_status);
+        remove(name);
+        ASSERT_EQ(0, fits_status);
+        EXPECT_GT(num_keys, 10);
+        EXPECT_EQ(0, memcmp(oskar_mem_void_const(images[i]),
+                oskar_mem_void_const(image_file), image_size * image_size *
+                oskar_mem_element_size(prec)));
+        oskar_mem_free(image_file, &status);
+        reference_plane(plane_size, oversample, 1.0, grids[i], &status);
+        oskar_Mem* ref = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                image_size * image_size, &status);
+        oskar_Mem* grid_d = oskar_mem_convert_precision(grids[i],
+                OSKAR_DOUBLE, &status);
+        const double* g = oskar_mem_double_const(grid_d, &status);
+        double* r = oskar_mem_double(ref, &status);
+        for (int y = 0; y < image_size; ++y)
+            for (int x = 0; x < image_size; ++x)
+                r[y * image_size + x] = g[2 * ((size_t) (y + offset) *
+                        plane_size + x + offset)];
+        double max_err = 0.0, avg_err = 0.0;
+        oskar_mem_evaluate_relative_error(images[i], ref, 0, &max_err,
+                &avg_err, 0, &status);
+        EXPECT_LT(max_err, tol);
+        oskar_mem_free(ref, &status);
+        oskar_mem_free(grid_d, &status);
+        oskar_mem_free(images[i], &status);
+        oskar_mem_free(grids[i], &status);
+    }
+    ASSERT_EQ(0, status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amps, &status);
+    oskar_mem_free(weight, &status);
+    oskar_imager_free(im, &status);
+}
+
+TEST(imager_finalise, images_double)
+{
+    check_finalise_images(OSKAR_DOUBLE, 1e-12, 1);
+    check_finalise_images(OSKAR_DOUBLE, 1e-12, 4);
+}
+
+TEST(imager_finalise, images_single)
+{
+    check_finalise_images(OSKAR_SINGLE, 1e-5, 1);
+    check_finalise_images(OSKAR_SINGLE, 1e-5, 4);
+}
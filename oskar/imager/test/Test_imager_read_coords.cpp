@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "binary/oskar_binary.h"
+#include "imager/oskar_imager.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "vis/oskar_vis_block.h"
+#include "vis/oskar_vis_header.h"
+
+#include <cmath>
+#include <cstdio>
+
+static const char* vis_file = "temp_test_imager_read_coords.vis";
+
+// Writes a file with station coordinates, using several blocks of
+// several times each, so every block has more rows than one time step.
+static void write_vis(int num_times, int max_times)
+{
+    int status = 0;
+    const int num_channels = 2, num_stations = 20;
+    const int num_blocks = (num_times + max_times - 1) / max_times;
+    const int type = OSKAR_DOUBLE | OSKAR_COMPLEX | OSKAR_MATRIX;
+    oskar_VisHeader* hdr = oskar_vis_header_create(type, OSKAR_DOUBLE,
+            max_times, num_times, num_channels, num_channels,
+            num_stations, 0, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 1e6);
+    oskar_vis_header_set_time_start_mjd_utc(hdr, 51544.5);
+    oskar_vis_header_set_time_inc_sec(hdr, 10.0);
+    oskar_vis_header_set_phase_centre(hdr, 0, 20.0, -30.0);
+    oskar_Binary* h = oskar_vis_header_write(hdr, vis_file, &status);
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, &status);
+    for (int i = 0; i < num_blocks; ++i)
+    {
+        const unsigned int key = 10 * i;
+        oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(blk, 0),
+                key, 1, 2, 3, 150.0, &status);
+        oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(blk, 1),
+                key, 4, 5, 6, 150.0, &status);
+        oskar_mem_random_gaussian(oskar_vis_block_station_uvw_metres(blk, 2),
+                key, 7, 8, 9, 40.0, &status);
+        oskar_mem_random_gaussian(oskar_vis_block_cross_correlations(blk),
+                key, 10, 11, 12, 1.0, &status);
+        oskar_vis_block_write(blk, h, i, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_vis_block_free(blk, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_binary_free(h);
+}
+
+// Both of these need a first pass over the coordinates in the file.
+static void check_image(const char* algorithm, const char* weighting)
+{
+    int status = 0;
+    const int size = 64;
+    oskar_Mem* image = 0;
+    write_vis(11, 4);
+    oskar_Imager* h = oskar_imager_create(OSKAR_SINGLE, &status);
+    oskar_imager_set_gpus(h, 0, 0, &status);
+    oskar_imager_set_input_files(h, 1, &vis_file, &status);
+    oskar_imager_set_algorithm(h, algorithm, &status);
+    oskar_imager_set_weighting(h, weighting, &status);
+    oskar_imager_set_image_type(h, "I", &status);
+    oskar_imager_set_fov(h, 4.0);
+    oskar_imager_set_size(h, size, &status);
+    oskar_imager_run(h, 1, &image, 0, 0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const float* p = oskar_mem_float_const(image, &status);
+    double sum_sq = 0.0;
+    for (int i = 0; i < size * size; ++i) sum_sq += p[i] * p[i];
+    EXPECT_TRUE(std::isfinite(sum_sq));
+    EXPECT_GT(sum_sq, 0.0);
+    oskar_mem_free(image, &status);
+    oskar_imager_free(h, &status);
+    (void) remove(vis_file);
+}
+
+TEST(imager_read_coords, station_coords_uniform)
+{
+    check_image("FFT", "Uniform");
+}
+
+TEST(imager_read_coords, station_coords_wprojection)
+{
+    check_image("W-projection", "Natural");
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "mem/oskar_mem.h"
+
+#include <cmath>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static oskar_Imager* create_imager(int prec, const char* image_type,
+        int num_channels, int snapshots, int* status)
+{
+    oskar_Imager* im = oskar_imager_create(prec, status);
+    oskar_imager_set_algorithm(im, "FFT", status);
+    oskar_imager_set_channel_snapshots(im, snapshots);
+    oskar_imager_set_image_type(im, image_type, status);
+    oskar_imager_set_fov(im, 2.0);
+    oskar_imager_set_size(im, 128, status);
+    oskar_imager_set_uv_filter_min(im, 20.0);
+    oskar_imager_set_vis_frequency(im, 100e6, 10e6, num_channels);
+    oskar_imager_set_vis_phase_centre(im, 0.0, 60.0);
+    return im;
+}
+
+// Checks the planes against those gridded one at a time. The image type
+// must be "Linear", or a single linear polarisation at the given index.
+static void check_update_planes(int prec, const char* image_type,
+        int pol_offset, int snapshots, double tol, int num_threads)
+{
+    int status = 0;
+    const int num_rows = 3000, num_channels = 3, num_pols = 4;
+    const double c0 = 299792458.0;
+
+    // Generate visibilities for all channels and polarisations.
+    oskar_Mem* uu = oskar_mem_create(prec, OSKAR_CPU, num_rows, &status);
+    oskar_Mem* vv = oskar_mem_create(prec, OSKAR_CPU, num_rows, &status);
+    oskar_Mem* ww = oskar_mem_create(prec, OSKAR_CPU, num_rows, &status);
+    oskar_Mem* amps = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_rows * num_channels * num_pols, &status);
+    oskar_Mem* weight = oskar_mem_create(prec, OSKAR_CPU,
+            num_rows * num_pols, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 100.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 100.0, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 10.0, &status);
+    oskar_mem_random_gaussian(amps, 12, 13, 14, 15, 1.0, &status);
+    oskar_mem_random_uniform(weight, 16, 17, 18, 19, &status);
+
+    // Grid all the planes in one call.
+    oskar_Imager* im = create_imager(prec, image_type, num_channels,
+            snapshots, &status);
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_imager_update(im, num_rows, 0, num_channels - 1, num_pols,
+            uu, vv, ww, amps, weight, 0, &status);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    ASSERT_EQ(0, status);
+    const int num_im_pols = pol_offset < 0 ? 4 : 1;
+    const int num_im_channels = snapshots ? num_channels : 1;
+    const int num_planes = num_im_channels * num_im_pols;
+    std::vector<oskar_Mem*> grids(num_planes, (oskar_Mem*) 0);
+    oskar_imager_finalise(im, 0, 0, num_planes, &grids[0], &status);
+    ASSERT_EQ(0, status);
+
+    // Grid each plane separately, for reference.
+    oskar_Imager* ref = create_imager(prec, image_type, num_channels,
+            snapshots, &status);
+    const int grid_size = oskar_imager_plane_size(ref);
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    const size_t max_num_vis = (size_t) num_rows * num_channels;
+    oskar_Mem* u_c = oskar_mem_create(prec, OSKAR_CPU, max_num_vis, &status);
+    oskar_Mem* v_c = oskar_mem_create(prec, OSKAR_CPU, max_num_vis, &status);
+    oskar_Mem* w_c = oskar_mem_create(prec, OSKAR_CPU, max_num_vis, &status);
+    oskar_Mem* vis_c = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            max_num_vis, &status);
+    oskar_Mem* weight_c = oskar_mem_create(prec, OSKAR_CPU,
+            max_num_vis, &status);
+    oskar_Mem* plane = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_cells, &status);
+    for (int i_chan = 0; i_chan < num_im_channels; ++i_chan)
+    {
+        for (int p = 0; p < num_im_pols; ++p)
+        {
+            // Select the data for this plane, and apply the UV filter.
+            const int pol = pol_offset < 0 ? p : pol_offset;
+            const int c_start = snapshots ? i_chan : 0;
+            const int c_end = snapshots ? i_chan : num_channels - 1;
+            size_t n = 0;
+            for (int c = c_start; c <= c_end; ++c)
+            {
+                const double scale = (100e6 + c * 10e6) / c0;
+                for (int r = 0; r < num_rows; ++r)
+                {
+                    const size_t i = num_pols * (num_channels * r + c) + pol;
+                    if (prec == OSKAR_DOUBLE)
+                    {
+                        const double u = oskar_mem_double(uu, &status)[r] *
+                                scale;
+                        const double v = oskar_mem_double(vv, &status)[r] *
+                                scale;
+                        if (u * u + v * v < 400.0) continue;
+                        oskar_mem_double(u_c, &status)[n] = u;
+                        oskar_mem_double(v_c, &status)[n] = v;
+                        oskar_mem_double2(vis_c, &status)[n] =
+                                oskar_mem_double2(amps, &status)[i];
+                        oskar_mem_double(weight_c, &status)[n] =
+                                oskar_mem_double(weight, &status)[
+                                num_pols * r + pol];
+                    }
+                    else
+                    {
+                        const float s = (float) scale;
+                        const float u = oskar_mem_float(uu, &status)[r] * s;
+                        const float v = oskar_mem_float(vv, &status)[r] * s;
+                        if (u * u + v * v < 400.0) continue;
+                        oskar_mem_float(u_c, &status)[n] = u;
+                        oskar_mem_float(v_c, &status)[n] = v;
+                        oskar_mem_float2(vis_c, &status)[n] =
+                                oskar_mem_float2(amps, &status)[i];
+                        oskar_mem_float(weight_c, &status)[n] =
+                                oskar_mem_float(weight, &status)[
+                                num_pols * r + pol];
+                    }
+                    n++;
+                }
+            }
+            ASSERT_GT(n, 0u);
+            ASSERT_LT(n, max_num_vis);
+
+            // Grid and normalise the reference plane.
+            double plane_norm = 0.0;
+            oskar_mem_clear_contents(plane, &status);
+            oskar_imager_update_plane(ref, n, u_c, v_c, w_c, vis_c, weight_c,
+                    0, plane, &plane_norm, 0, &status);
+            ASSERT_EQ(0, status);
+            oskar_mem_scale_real(plane, 1.0 / plane_norm,
+                    0, num_cells, &status);
+
+            // Check both real and imaginary parts of the complex grids.
+            oskar_Mem* grid_re = oskar_mem_create_alias_from_raw(
+                    oskar_mem_void(grids[i_chan * num_im_pols + p]),
+                    prec, OSKAR_CPU, 2 * num_cells, &status);
+            oskar_Mem* plane_re = oskar_mem_create_alias_from_raw(
+                    oskar_mem_void(plane), prec, OSKAR_CPU, 2 * num_cells,
+                    &status);
+            double max_err = 0.0, avg_err = 0.0;
+            oskar_mem_evaluate_relative_error(grid_re, plane_re, 0, &max_err,
+                    &avg_err, 0, &status);
+            EXPECT_LT(max_err, tol);
+            oskar_mem_free(grid_re, &status);
+            oskar_mem_free(plane_re, &status);
+        }
+    }
+    ASSERT_EQ(0, status);
+    for (int i = 0; i < num_planes; ++i)
+        oskar_mem_free(grids[i], &status);
+    oskar_mem_free(u_c, &status);
+    oskar_mem_free(v_c, &status);
+    oskar_mem_free(w_c, &status);
+    oskar_mem_free(vis_c, &status);
+    oskar_mem_free(weight_c, &status);
+    oskar_mem_free(plane, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amps, &status);
+    oskar_mem_free(weight, &status);
+    oskar_imager_free(im, &status);
+    oskar_imager_free(ref, &status);
+}
+
+TEST(imager_update_planes, linear_double)
+{
+    check_update_planes(OSKAR_DOUBLE, "Linear", -1, 1, 1e-12, 1);
+    check_update_planes(OSKAR_DOUBLE, "Linear", -1, 1, 1e-12, 3);
+    check_update_planes(OSKAR_DOUBLE, "Linear", -1, 1, 1e-12, 4);
+}
+
+TEST(imager_update_planes, linear_single)
+{
+    check_update_planes(OSKAR_SINGLE, "Linear", -1, 1, 1e-5, 1);
+    check_update_planes(OSKAR_SINGLE, "Linear", -1, 1, 1e-5, 3);
+    check_update_planes(OSKAR_SINGLE, "Linear", -1, 1, 1e-5, 4);
+}
+
+TEST(imager_update_planes, yy_double)
+{
+    check_update_planes(OSKAR_DOUBLE, "YY", 3, 1, 1e-12, 4);
+}
+
+TEST(imager_update_planes, synthesis_double)
+{
+    check_update_planes(OSKAR_DOUBLE, "Linear", -1, 0, 1e-12, 1);
+}
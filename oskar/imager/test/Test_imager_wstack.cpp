@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "imager/oskar_imager.h"
+#include "mem/oskar_mem.h"
+
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Makes a wide-field image of a few point sources using the given algorithm,
+// passing the visibilities to the imager in the given number of blocks.
+static oskar_Mem* make_image(int prec, const char* algorithm,
+        int num_threads, int image_size = 128, int num_vis = 4000,
+        int num_blocks = 1)
+{
+    int status = 0;
+    const double uv_sigma = 30.0 * image_size / 128.0;
+    const double fov_deg = 30.0;
+    const double src_l[] = {0.0, 0.18, -0.12, 0.05};
+    const double src_m[] = {0.0, 0.10, 0.17, -0.2};
+
+    // Generate visibilities with large W values, on a single channel.
+    oskar_Mem* uu = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* vv = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* ww = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_vis, &status);
+    oskar_Mem* amps = oskar_mem_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_vis, &status);
+    oskar_Mem* weight = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_vis, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, uv_sigma, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, uv_sigma, &status);
+    oskar_mem_random_gaussian(ww, 8, 9, 10, 11, 60.0, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_vis, &status);
+    const double* u = oskar_mem_double_const(uu, &status);
+    const double* v = oskar_mem_double_const(vv, &status);
+    const double* w = oskar_mem_double_const(ww, &status);
+    double* a = oskar_mem_double(amps, &status);
+    for (int i = 0; i < num_vis; ++i)
+    {
+        a[2 * i] = a[2 * i + 1] = 0.0;
+        for (int s = 0; s < 4; ++s)
+        {
+            const double l = src_l[s], m = src_m[s];
+            const double n = sqrt(1.0 - l * l - m * m);
+            const double phase = -2.0 * M_PI *
+                    (u[i] * l + v[i] * m + w[i] * (n - 1.0));
+            a[2 * i] += cos(phase);
+            a[2 * i + 1] += sin(phase);
+        }
+    }
+
+    // Make the image.
+    oskar_Imager* im = oskar_imager_create(prec, &status);
+    oskar_imager_set_algorithm(im, algorithm, &status);
+    oskar_imager_set_fov(im, fov_deg);
+    oskar_imager_set_size(im, image_size, &status);
+    oskar_imager_set_vis_frequency(im, 100e6, 0.0, 1);
+    oskar_imager_set_vis_phase_centre(im, 0.0, 60.0);
+    oskar_imager_set_coords_only(im, 1);
+    oskar_imager_update(im, num_vis, 0, 0, 1, uu, vv, ww, amps, weight,
+            0, &status);
+    oskar_imager_set_coords_only(im, 0);
+    const int block_size = num_vis / num_blocks;
+    for (int b = 0; b < num_blocks; ++b)
+    {
+        const size_t offset = (size_t) b * block_size;
+        oskar_Mem* bu = oskar_mem_create_alias(uu, offset, block_size, &status);
+        oskar_Mem* bv = oskar_mem_create_alias(vv, offset, block_size, &status);
+        oskar_Mem* bw = oskar_mem_create_alias(ww, offset, block_size, &status);
+        oskar_Mem* ba = oskar_mem_create_alias(amps, offset, block_size,
+                &status);
+        oskar_Mem* bh = oskar_mem_create_alias(weight, offset, block_size,
+                &status);
+        oskar_imager_update(im, block_size, 0, 0, 1, bu, bv, bw, ba, bh,
+                0, &status);
+        oskar_mem_free(bu, &status);
+        oskar_mem_free(bv, &status);
+        oskar_mem_free(bw, &status);
+        oskar_mem_free(ba, &status);
+        oskar_mem_free(bh, &status);
+    }
+    oskar_Mem* images[] = {0};
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_imager_finalise(im, 1, images, 0, 0, &status);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    EXPECT_EQ(0, status);
+    oskar_Mem* image = oskar_mem_convert_precision(images[0],
+            OSKAR_DOUBLE, &status);
+    oskar_mem_free(images[0], &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+    oskar_mem_free(amps, &status);
+    oskar_mem_free(weight, &status);
+    oskar_imager_free(im, &status);
+    return image;
+}
+
+static void check_wstack(int prec, int image_size = 128, int num_vis = 4000,
+        int num_blocks = 1)
+{
+    int status = 0;
+    oskar_Mem* ref = make_image(prec, "DFT 3D", 1,
+            image_size, num_vis, num_blocks);
+    oskar_Mem* fft = make_image(prec, "FFT", 1,
+            image_size, num_vis, num_blocks);
+    oskar_Mem* ws_1 = make_image(prec, "W-stacking", 1,
+            image_size, num_vis, num_blocks);
+    oskar_Mem* ws_4 = make_image(prec, "W-stacking", 4,
+            image_size, num_vis, num_blocks);
+
+    // W-stacking must correct most of the error from ignoring W.
+    // Pixels far from the sources are small, so use the mean relative error.
+    double avg_fft = 0.0, avg_ws = 0.0;
+    oskar_mem_evaluate_relative_error(fft, ref, 0, 0, &avg_fft, 0, &status);
+    oskar_mem_evaluate_relative_error(ws_1, ref, 0, 0, &avg_ws, 0, &status);
+    EXPECT_LT(avg_ws, 0.3 * avg_fft);
+    EXPECT_LT(avg_ws, 0.12);
+
+    // The result must not depend on the number of threads.
+    EXPECT_EQ(0, oskar_mem_different(ws_1, ws_4, 0, &status));
+    EXPECT_EQ(0, status);
+    oskar_mem_free(ref, &status);
+    oskar_mem_free(fft, &status);
+    oskar_mem_free(ws_1, &status);
+    oskar_mem_free(ws_4, &status);
+}
+
+TEST(imager_wstack, matches_dft_double)
+{
+    check_wstack(OSKAR_DOUBLE);
+}
+
+TEST(imager_wstack, matches_dft_single)
+{
+    check_wstack(OSKAR_SINGLE);
+}
+
+// Use more visibilities than grid cells, so that the buffered
+// visibilities are flushed into the plane before it is finalised.
+TEST(imager_wstack, matches_dft_when_flushed)
+{
+    check_wstack(OSKAR_DOUBLE, 64, 10000, 5);
+}
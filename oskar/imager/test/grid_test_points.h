@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_GRID_TEST_POINTS_H_
+#define OSKAR_GRID_TEST_POINTS_H_
+
+#include "mem/oskar_mem.h"
+
+#include <cmath>
+#include <cstddef>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Random points shared by the gridder tests.
+// Points are concentrated near the centre, and some are off the grid.
+struct GridTestPoints
+{
+    enum { GRID_SIZE = 512, NUM_POINTS = 100000 };
+    oskar_Mem *uu, *vv, *vis, *weight;
+    double cell_size_rad;
+
+    GridTestPoints(int prec, int* status)
+    {
+        uu = oskar_mem_create(prec, OSKAR_CPU, NUM_POINTS, status);
+        vv = oskar_mem_create(prec, OSKAR_CPU, NUM_POINTS, status);
+        vis = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+                NUM_POINTS, status);
+        weight = oskar_mem_create(prec, OSKAR_CPU, NUM_POINTS, status);
+        oskar_mem_random_gaussian(uu, 0, 1, 2, 3, 2000.0, status);
+        oskar_mem_random_gaussian(vv, 4, 5, 6, 7, 2000.0, status);
+        oskar_mem_random_gaussian(vis, 8, 9, 10, 11, 1.0, status);
+        oskar_mem_random_uniform(weight, 12, 13, 14, 15, status);
+        cell_size_rad = 4.0 * M_PI / 180.0 / GRID_SIZE;
+    }
+
+    ~GridTestPoints()
+    {
+        int status = 0;
+        oskar_mem_free(uu, &status);
+        oskar_mem_free(vv, &status);
+        oskar_mem_free(vis, &status);
+        oskar_mem_free(weight, &status);
+    }
+};
+
+// Calls chunk(start, n, &skipped) for consecutive chunks of the test points
+// using the given number of threads, and returns the total number skipped.
+// If chunk_size is not zero, the points are passed in chunks of that size,
+// which uses the serial loops for small chunks.
+template <typename Chunk>
+static size_t grid_test_run_chunks(int num_threads, size_t chunk_size,
+        Chunk& chunk)
+{
+    const size_t num_points = GridTestPoints::NUM_POINTS;
+    size_t num_skipped = 0;
+    if (chunk_size == 0) chunk_size = num_points;
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    for (size_t start = 0; start < num_points; start += chunk_size)
+    {
+        size_t skipped = 0;
+        const size_t n = (start + chunk_size > num_points) ?
+                num_points - start : chunk_size;
+        chunk(start, n, &skipped);
+        num_skipped += skipped;
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    return num_skipped;
+}
+
+#endif /* OSKAR_GRID_TEST_POINTS_H_ */
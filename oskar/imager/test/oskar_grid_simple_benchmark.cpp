@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "imager/oskar_grid_functions_spheroidal.h"
+#include "imager/oskar_grid_simple.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Returns the largest difference between the grids,
+// relative to the largest value in the reference grid.
+static double max_diff(const oskar_Mem* grid, const oskar_Mem* ref,
+        int* status)
+{
+    double max_abs = 0.0, max_diff = 0.0;
+    oskar_Mem* a = oskar_mem_convert_precision(grid, OSKAR_DOUBLE, status);
+    oskar_Mem* b = oskar_mem_convert_precision(ref, OSKAR_DOUBLE, status);
+    const double* a_ = oskar_mem_double_const(a, status);
+    const double* b_ = oskar_mem_double_const(b, status);
+    const size_t n = 2 * oskar_mem_length(ref);
+    for (size_t i = 0; i < n && !*status; ++i)
+    {
+        if (fabs(b_[i]) > max_abs) max_abs = fabs(b_[i]);
+        if (fabs(a_[i] - b_[i]) > max_diff) max_diff = fabs(a_[i] - b_[i]);
+    }
+    oskar_mem_free(a, status);
+    oskar_mem_free(b, status);
+    return max_abs > 0.0 ? max_diff / max_abs : 0.0;
+}
+
+// Grids the visibilities using the given number of threads,
+// and returns the elapsed time. If chunk_size is not zero, the visibilities
+// are passed to the gridder in chunks of that size, so small chunks use
+// the serial loop.
+static double run(int num_threads, size_t chunk_size, int support,
+        int oversample, const oskar_Mem* conv_func, const oskar_Mem* uu,
+        const oskar_Mem* vv, const oskar_Mem* vis, const oskar_Mem* weight,
+        double cell_size_rad, int grid_size, oskar_Mem* grid, int* status)
+{
+    double norm = 0.0;
+    size_t num_skipped = 0;
+    const size_t num_points = oskar_mem_length(uu);
+    if (chunk_size == 0) chunk_size = num_points;
+    oskar_mem_clear_contents(grid, status);
+    if (*status) return 0.0;
+#ifdef _OPENMP
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    for (size_t start = 0; start < num_points; start += chunk_size)
+    {
+        const size_t n = (start + chunk_size > num_points) ?
+                num_points - start : chunk_size;
+        if (oskar_mem_precision(grid) == OSKAR_DOUBLE)
+            oskar_grid_simple_d(support, oversample,
+                    oskar_mem_double_const(conv_func, status), n,
+                    oskar_mem_double_const(uu, status) + start,
+                    oskar_mem_double_const(vv, status) + start,
+                    oskar_mem_double_const(vis, status) + 2 * start,
+                    oskar_mem_double_const(weight, status) + start,
+                    cell_size_rad, grid_size, &num_skipped, &norm,
+                    oskar_mem_double(grid, status));
+        else
+            oskar_grid_simple_f(support, oversample,
+                    oskar_mem_float_const(conv_func, status), n,
+                    oskar_mem_float_const(uu, status) + start,
+                    oskar_mem_float_const(vv, status) + start,
+                    oskar_mem_float_const(vis, status) + 2 * start,
+                    oskar_mem_float_const(weight, status) + start,
+                    (float) cell_size_rad, grid_size, &num_skipped, &norm,
+                    oskar_mem_float(grid, status));
+    }
+    const double t = oskar_timer_elapsed(tmr);
+    oskar_timer_free(tmr);
+    return t;
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_grid_simple_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-n", "Number of visibilities", 1, "4000000", false);
+    opt.add_flag("-g", "Grid size", 1, "4096", false);
+    opt.add_flag("-s", "Convolution function support", 1, "3", false);
+    opt.add_flag("-o", "Convolution function oversample", 1, "100", false);
+    opt.add_flag("-t", "Maximum number of threads (0 = all)", 1, "0", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0, max_threads = 1;
+    const int prec = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int num_points = opt.get_int("-n");
+    const int grid_size = opt.get_int("-g");
+    const int support = opt.get_int("-s");
+    const int oversample = opt.get_int("-o");
+    const double cell_size_rad = 4.0 * M_PI / 180.0 / grid_size;
+#ifdef _OPENMP
+    max_threads = omp_get_max_threads();
+#endif
+    if (opt.get_int("-t") > 0) max_threads = opt.get_int("-t");
+
+    // Create the convolution function.
+    std::vector<double> fn(oversample * (support + 1));
+    oskar_grid_convolution_function_spheroidal(support, oversample, &fn[0]);
+    oskar_Mem* conv_func = oskar_mem_create_alias_from_raw(&fn[0],
+            OSKAR_DOUBLE, OSKAR_CPU, fn.size(), &status);
+    oskar_Mem* conv_func_prec = oskar_mem_convert_precision(conv_func, prec,
+            &status);
+
+    // Create visibility data, concentrated towards the centre of the grid.
+    oskar_Mem* uu = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_Mem* vv = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_Mem* vis = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* weight = oskar_mem_create(prec, OSKAR_CPU, num_points, &status);
+    oskar_mem_random_gaussian(uu, 0, 1, 2, 3, grid_size * 2.0, &status);
+    oskar_mem_random_gaussian(vv, 4, 5, 6, 7, grid_size * 2.0, &status);
+    oskar_mem_random_gaussian(vis, 8, 9, 10, 11, 1.0, &status);
+    oskar_mem_set_value_real(weight, 1.0, 0, num_points, &status);
+    oskar_Mem* grid = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            (size_t) grid_size * grid_size, &status);
+    oskar_Mem* grid_serial = oskar_mem_create(prec | OSKAR_COMPLEX, OSKAR_CPU,
+            (size_t) grid_size * grid_size, &status);
+
+    // Time the serial loop and the tiled gridder.
+    printf("Gridding %d visibilities (%s precision) onto %d x %d grid, "
+            "support %d\n", num_points,
+            prec == OSKAR_DOUBLE ? "double" : "single",
+            grid_size, grid_size, support);
+    const double t_serial = run(1, 8192, support, oversample, conv_func_prec,
+            uu, vv, vis, weight, cell_size_rad, grid_size, grid_serial,
+            &status);
+    printf("Serial loop       : %8.3f s  %12.4g vis/s\n", t_serial,
+            num_points / t_serial);
+    for (int n = 1; n <= max_threads && !status; n *= 2)
+    {
+        const double t = run(n, 0, support, oversample, conv_func_prec,
+                uu, vv, vis, weight, cell_size_rad, grid_size, grid,
+                &status);
+        printf("Tiled, %3d threads: %8.3f s  %12.4g vis/s  speed-up %5.2f  "
+                "max diff %.3g\n", n, t, num_points / t, t_serial / t,
+                max_diff(grid, grid_serial, &status));
+    }
+
+    oskar_mem_free(conv_func, &status);
+    oskar_mem_free(conv_func_prec, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(vis, &status);
+    oskar_mem_free(weight, &status);
+    oskar_mem_free(grid, &status);
+    oskar_mem_free(grid_serial, &status);
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "imager/oskar_grid_wproj2.h"
+#include "imager/oskar_grid_wproj_sort.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Visibility data, in input order or in sorted order.
+template <typename FP>
+struct VisData
+{
+    std::vector<FP> uu, vv, ww, vis, weight;
+    VisData(size_t n) : uu(n), vv(n), ww(n), vis(2 * n), weight(n) {}
+};
+
+static void grid(int num_w_planes, const std::vector<int>& support,
+        int oversample, const std::vector<int>& kernel_start,
+        const std::vector<double>& kernels, const VisData<double>& d,
+        double cell_size_rad, double w_scale, int grid_size,
+        size_t* num_skipped, double* norm, std::vector<double>& g)
+{
+    oskar_grid_wproj2_d(num_w_planes, &support[0], oversample,
+            &kernel_start[0], &kernels[0], d.uu.size(), &d.uu[0], &d.vv[0],
+            &d.ww[0], &d.vis[0], &d.weight[0], cell_size_rad, w_scale,
+            grid_size, num_skipped, norm, &g[0]);
+}
+
+static void grid(int num_w_planes, const std::vector<int>& support,
+        int oversample, const std::vector<int>& kernel_start,
+        const std::vector<float>& kernels, const VisData<float>& d,
+        double cell_size_rad, double w_scale, int grid_size,
+        size_t* num_skipped, double* norm, std::vector<float>& g)
+{
+    oskar_grid_wproj2_f(num_w_planes, &support[0], oversample,
+            &kernel_start[0], &kernels[0], d.uu.size(), &d.uu[0], &d.vv[0],
+            &d.ww[0], &d.vis[0], &d.weight[0], (float) cell_size_rad,
+            (float) w_scale, grid_size, num_skipped, norm, &g[0]);
+}
+
+static void sort(int num_w_planes, const VisData<double>& d,
+        double cell_size_rad, double w_scale, int grid_size,
+        std::vector<size_t>& order, int* status)
+{
+    oskar_grid_wproj_sort_d(num_w_planes, d.uu.size(), &d.uu[0], &d.vv[0],
+            &d.ww[0], cell_size_rad, w_scale, grid_size, &order[0], status);
+}
+
+static void sort(int num_w_planes, const VisData<float>& d,
+        double cell_size_rad, double w_scale, int grid_size,
+        std::vector<size_t>& order, int* status)
+{
+    oskar_grid_wproj_sort_f(num_w_planes, d.uu.size(), &d.uu[0], &d.vv[0],
+            &d.ww[0], (float) cell_size_rad, (float) w_scale, grid_size,
+            &order[0], status);
+}
+
+template <typename FP>
+static int benchmark(int num_points, int grid_size, int num_w_planes,
+        int max_support, int oversample)
+{
+    int status = 0;
+    const double w_max = 5000.0;
+    const double w_scale = pow(num_w_planes - 1, 2) / w_max;
+    const double cell_size_rad = 4.0 * M_PI / 180.0 / grid_size;
+    const double uv_sigma = grid_size / (4.0 * grid_size * cell_size_rad);
+
+    // Create W-kernels with the compact layout, with support increasing
+    // with W, filled with arbitrary values.
+    const int oversample_h = oversample / 2;
+    std::vector<int> support(num_w_planes), kernel_start(num_w_planes);
+    size_t size = 0;
+    for (int w = 0; w < num_w_planes; ++w)
+    {
+        support[w] = 3 + (max_support - 3) * w / (num_w_planes > 1 ?
+                num_w_planes - 1 : 1);
+        const int conv_len = 2 * support[w] + 1;
+        kernel_start[w] = (int) size;
+        size += (size_t) (oversample_h + 1) *
+                (oversample_h * conv_len + 1) * conv_len;
+    }
+    std::vector<FP> kernels(2 * size);
+    for (size_t i = 0; i < kernels.size(); ++i)
+        kernels[i] = (FP) (1.0 / (1.0 + (double) (i % 97)));
+
+    // Create visibility data in random order.
+    VisData<FP> d(num_points), s(num_points);
+    const int type = sizeof(FP) == sizeof(double) ? OSKAR_DOUBLE :
+            OSKAR_SINGLE;
+    oskar_Mem* tmp = oskar_mem_create(type, OSKAR_CPU, num_points, &status);
+    FP* t = (FP*) oskar_mem_void(tmp);
+    oskar_mem_random_gaussian(tmp, 0, 1, 2, 3, uv_sigma, &status);
+    d.uu.assign(t, t + num_points);
+    oskar_mem_random_gaussian(tmp, 4, 5, 6, 7, uv_sigma, &status);
+    d.vv.assign(t, t + num_points);
+    oskar_mem_random_gaussian(tmp, 8, 9, 10, 11, w_max / 3.0, &status);
+    d.ww.assign(t, t + num_points);
+    oskar_mem_free(tmp, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        d.vis[2 * i] = (FP) 1;
+        d.vis[2 * i + 1] = (FP) 0;
+        d.weight[i] = (FP) 1;
+    }
+
+    printf("Gridding %d visibilities (%s precision) onto %d x %d grid, "
+            "%d W-planes, support 3 to %d\n", num_points,
+            type == OSKAR_DOUBLE ? "double" : "single", grid_size, grid_size,
+            num_w_planes, max_support);
+    const size_t num_cells = (size_t) grid_size * grid_size;
+    std::vector<FP> grid0(2 * num_cells, 0), grid1(2 * num_cells, 0);
+    size_t num_skipped = 0;
+    double norm[2] = {0.0, 0.0};
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+
+    // Grid in input order.
+    oskar_timer_start(tmr);
+    grid(num_w_planes, support, oversample, kernel_start, kernels, d,
+            cell_size_rad, w_scale, grid_size, &num_skipped, &norm[0], grid0);
+    const double t_unsorted = oskar_timer_elapsed(tmr);
+
+    // Sort, gather and grid in sorted order.
+    std::vector<size_t> order(num_points);
+    oskar_timer_start(tmr);
+    sort(num_w_planes, d, cell_size_rad, w_scale, grid_size, order, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        const size_t j = order[i];
+        s.uu[i] = d.uu[j];
+        s.vv[i] = d.vv[j];
+        s.ww[i] = d.ww[j];
+        s.vis[2 * i] = d.vis[2 * j];
+        s.vis[2 * i + 1] = d.vis[2 * j + 1];
+        s.weight[i] = d.weight[j];
+    }
+    const double t_sort = oskar_timer_elapsed(tmr);
+    oskar_timer_start(tmr);
+    grid(num_w_planes, support, oversample, kernel_start, kernels, s,
+            cell_size_rad, w_scale, grid_size, &num_skipped, &norm[1], grid1);
+    const double t_sorted = oskar_timer_elapsed(tmr);
+    oskar_timer_free(tmr);
+
+    double max_abs = 0.0, max_diff = 0.0;
+    for (size_t i = 0; i < 2 * num_cells; ++i)
+    {
+        const double a = (double) grid0[i], b = (double) grid1[i];
+        if (fabs(a) > max_abs) max_abs = fabs(a);
+        if (fabs(a - b) > max_diff) max_diff = fabs(a - b);
+    }
+    printf("Input order   : %8.3f s  %12.4g vis/s\n", t_unsorted,
+            num_points / t_unsorted);
+    printf("Sort + gather : %8.3f s\n", t_sort);
+    printf("Sorted order  : %8.3f s  %12.4g vis/s  speed-up %5.2f "
+            "(%5.2f including sort)  max diff %.3g\n", t_sorted,
+            num_points / t_sorted, t_unsorted / t_sorted,
+            t_unsorted / (t_sorted + t_sort),
+            max_abs > 0.0 ? max_diff / max_abs : 0.0);
+    if (status)
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+    return status;
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_grid_wproj_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-n", "Number of visibilities", 1, "2000000", false);
+    opt.add_flag("-g", "Grid size", 1, "8192", false);
+    opt.add_flag("-w", "Number of W-projection planes", 1, "64", false);
+    opt.add_flag("-s", "Largest W-kernel support", 1, "20", false);
+    opt.add_flag("-o", "W-kernel oversample", 1, "4", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    const int num_points = opt.get_int("-n");
+    const int grid_size = opt.get_int("-g");
+    const int num_w_planes = opt.get_int("-w");
+    const int max_support = opt.get_int("-s");
+    const int oversample = opt.get_int("-o");
+    const int status = opt.is_set("-sp") ?
+            benchmark<float>(num_points, grid_size, num_w_planes,
+                    max_support, oversample) :
+            benchmark<double>(num_points, grid_size, num_w_planes,
+                    max_support, oversample);
+    return status ? EXIT_FAILURE : EXIT_SUCCESS;
+}
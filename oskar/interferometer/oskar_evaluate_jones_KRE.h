@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_EVALUATE_JONES_KRE_H_
+#define OSKAR_EVALUATE_JONES_KRE_H_
+
+/**
+ * @file oskar_evaluate_jones_KRE.h
+ */
+
+#include <oskar_global.h>
+#include <interferometer/oskar_jones.h>
+#include <sky/oskar_sky.h>
+#include <telescope/oskar_telescope.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates the joined Jones term J = K * (E * R) for a tile of sources.
+ *
+ * @details
+ * This function evaluates the interferometer phase (K) and, optionally,
+ * the parallactic angle rotation (R) for a contiguous range of sources,
+ * and joins them with a pre-computed station beam (E) in a single pass.
+ *
+ * The result is the same as calling oskar_evaluate_jones_R(),
+ * oskar_evaluate_jones_K() and oskar_jones_join() on separate full-size
+ * arrays, but only the joined output for the requested sources is
+ * written to memory, so the output can be kept small enough to remain
+ * in cache for the correlator.
+ *
+ * Sources are read from \p sky and \p E starting at \p offset_in, and the
+ * output is written from the start of \p J, using the number of sources
+ * in \p J as the stride between stations.
+ *
+ * The R term can only be applied if the Jones matrices are fully polarised.
+ *
+ * This function is currently only available for data in CPU memory.
+ *
+ * @param[out] J                 Output set of joined Jones matrices.
+ * @param[in]  num_sources       The number of sources to evaluate.
+ * @param[in]  offset_in         Index of the first source in \p sky and \p E.
+ * @param[in]  E                 Input station beam Jones matrices.
+ * @param[in]  apply_R           If set, apply the parallactic angle rotation.
+ * @param[in]  sky               Sky model.
+ * @param[in]  tel               Telescope model.
+ * @param[in]  u                 Station u coordinates, in metres.
+ * @param[in]  v                 Station v coordinates, in metres.
+ * @param[in]  w                 Station w coordinates, in metres.
+ * @param[in]  gast              Greenwich apparent sidereal time, in radians.
+ * @param[in]  frequency_hz      The current observing frequency, in Hz.
+ * @param[in]  source_min_jy     Minimum allowed Stokes I value (exclusive).
+ * @param[in]  source_max_jy     Maximum allowed Stokes I value (inclusive).
+ * @param[in]  ignore_w_components If set, ignore station w coordinate values.
+ * @param[in,out] status         Status return code.
+ */
+OSKAR_EXPORT
+void oskar_evaluate_jones_KRE(oskar_Jones* J, int num_sources, int offset_in,
+        const oskar_Jones* E, int apply_R, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, double gast, double frequency_hz,
+        double source_min_jy, double source_max_jy, int ignore_w_components,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_EVALUATE_JONES_KRE_H_ */
@@ -37,18 +37,42 @@
 #include <interferometer/oskar_jones.h>
 #include <telescope/oskar_telescope.h>
 #include <sky/oskar_sky.h>
-#include <interferometer/oskar_WorkJonesZ.h>
 #include <settings/old/oskar_Settings_old.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * @brief
+ * Evaluates the ionospheric phase (Z-Jones) for all stations and sources.
+ *
+ * @details
+ * The pierce point through the TID screen, the TEC value there, and the
+ * resulting phase term are evaluated for every station and source
+ * together, using multiple threads.
+ *
+ * Sources below the minimum elevation given in the settings are
+ * assigned a unit Jones scalar.
+ *
+ * The computation is done on the CPU, and the results are copied
+ * to the memory location of \p Z if required.
+ *
+ * @param[out] Z             Z-Jones scalars (complex, with sky precision).
+ * @param[in] num_sources    Number of sources to evaluate.
+ * @param[in] sky            Sky model (direction cosines relative to the
+ *                           sky reference position).
+ * @param[in] telescope      Telescope model.
+ * @param[in] settings       Ionosphere settings, including TID screen.
+ * @param[in] gast           Greenwich apparent sidereal time, in radians.
+ * @param[in] frequency_hz   Observing frequency, in Hz.
+ * @param[in,out] status     Status return code.
+ */
 OSKAR_EXPORT
-void oskar_evaluate_jones_Z(oskar_Jones* Z, const oskar_Sky* sky,
-        const oskar_Telescope* telescope,
+void oskar_evaluate_jones_Z(oskar_Jones* Z, int num_sources,
+        const oskar_Sky* sky, const oskar_Telescope* telescope,
         const oskar_SettingsIonosphere* settings, double gast,
-        double frequency_hz, oskar_WorkJonesZ* work, int* status);
+        double frequency_hz, int* status);
 
 #ifdef __cplusplus
 }
@@ -65,6 +65,11 @@ OSKAR_EXPORT
 void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
         int value);
 
+OSKAR_EXPORT
+void oskar_interferometer_set_ionosphere(oskar_Interferometer* h,
+        int enable, double min_elevation_deg, double TEC0,
+        int num_tid_files, const char* const* tid_files, int* status);
+
 OSKAR_EXPORT
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value);
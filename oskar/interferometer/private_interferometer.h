@@ -11,6 +11,7 @@
 #include <log/oskar_log.h>
 #include <mem/oskar_mem.h>
 #include <ms/oskar_measurement_set.h>
+#include <settings/old/oskar_Settings_old.h>
 #include <sky/oskar_sky.h>
 #include <telescope/oskar_telescope.h>
 #include <utility/oskar_thread.h>
@@ -25,11 +26,12 @@ struct DeviceData
     oskar_VisBlock* vis_block_cpu[2]; /* On host, for copy back & write. */
 
     /* Device memory. */
-    int previous_chunk_index;
+    int previous_chunk_index, max_sources_per_tile;
     oskar_VisBlock* vis_block;  /* Device memory block. */
     oskar_Mem *u, *v, *w;
     oskar_Sky* chunk;           /* The unmodified sky chunk being processed. */
     oskar_Sky* chunk_clip;      /* Copy of the chunk after horizon clipping. */
+    oskar_Sky* chunk_tile;      /* Tile of sources being correlated (CPU). */
     oskar_Telescope* tel;       /* Telescope model, created as a copy. */
     oskar_Jones *J, *R, *E, *K, *Z;
     oskar_StationWork* station_work;
@@ -42,6 +44,7 @@ struct DeviceData
     oskar_Timer* tmr_join;      /* Time spent combining Jones matrices. */
     oskar_Timer* tmr_E;         /* Time spent evaluating E-Jones. */
     oskar_Timer* tmr_K;         /* Time spent evaluating K-Jones. */
+    oskar_Timer* tmr_Z;         /* Time spent evaluating Z-Jones. */
 };
 typedef struct DeviceData DeviceData;
 
@@ -57,6 +60,7 @@ struct oskar_Interferometer
     double freq_start_hz, freq_inc_hz, time_start_mjd_utc, time_inc_sec;
     double source_min_jy, source_max_jy;
     char correlation_type, *vis_name, *ms_name, *settings_path;
+    oskar_SettingsIonosphere ionosphere;
 
     /* State. */
     int init_sky, work_unit_index;
@@ -69,6 +73,13 @@ struct oskar_Interferometer
     oskar_Sky** sky_chunks;
     oskar_Telescope* tel;
 
+    /* Station (u,v,w) coordinates and GAST for all times in a block.
+     * These are computed once per block and shared by all compute devices.
+     * Two sets are kept, as the previous block is written while the
+     * current one is simulated. */
+    int coords_block_index[2];
+    oskar_Mem *station_u[2], *station_v[2], *station_w[2], *gast[2];
+
     /* Output data and file handles. */
     oskar_VisHeader* header;
     oskar_MeasurementSet* ms;
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "interferometer/oskar_evaluate_jones_KRE.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-station parameters used by the kernels. */
+enum { PAR_U, PAR_V, PAR_W, PAR_LST, PAR_COS_LAT, PAR_SIN_LAT, NUM_PAR };
+
+/*
+ * Evaluates the K phase, which is zero if the source is filtered out.
+ * The parallactic angle rotation is evaluated without trigonometric
+ * functions of the angle itself, by normalising its tangent components.
+ */
+#define OSKAR_KRE_PHASE(FP) \
+    const int s = i / num_sources, j = i - s * num_sources, g = offset_in + j; \
+    const FP* p = st_par + s * NUM_PAR; \
+    FP k_re = (FP) 0, k_im = (FP) 0; \
+    if (filter[g] > filter_min && filter[g] <= filter_max) \
+    { \
+        FP phase = p[PAR_U] * l[g] + p[PAR_V] * m[g]; \
+        if (!ignore_w_components) phase += p[PAR_W] * (n[g] - (FP) 1); \
+        phase *= wavenumber; \
+        SINCOS(phase, k_im, k_re); \
+    }
+
+#define OSKAR_JONES_KRE_MATRIX(NAME, FP, FP4c) \
+static void NAME(const int num_sources, const int num_stations, \
+        const int offset_in, const int stride_E, const FP4c* E, \
+        const int apply_R, const FP* ra, const FP* dec, \
+        const FP* l, const FP* m, const FP* n, const FP* filter, \
+        const FP filter_min, const FP filter_max, \
+        const int ignore_w_components, const FP wavenumber, \
+        const FP* st_par, const int stride_J, FP4c* J) \
+{ \
+    int i; \
+    const int num = num_sources * num_stations; \
+    DO_PRAGMA(omp parallel for private(i)) \
+    for (i = 0; i < num; ++i) \
+    { \
+        FP4c e, out; \
+        OSKAR_KRE_PHASE(FP) \
+        e = E[s * stride_E + g]; \
+        if (apply_R) \
+        { \
+            FP sin_ha, cos_ha, sin_dec, cos_dec, c = (FP) 1, t = (FP) 0; \
+            const FP ha = p[PAR_LST] - ra[g]; \
+            SINCOS(ha, sin_ha, cos_ha); \
+            SINCOS(dec[g], sin_dec, cos_dec); \
+            const FP y = p[PAR_COS_LAT] * sin_ha; \
+            const FP x = p[PAR_SIN_LAT] * cos_dec - \
+                    p[PAR_COS_LAT] * sin_dec * cos_ha; \
+            const FP r = sqrt(x * x + y * y); \
+            if (r > (FP) 0) { c = x / r; t = y / r; } \
+            /* E * R, where R = [c, -t; t, c]. */ \
+            out.a.x = e.a.x * c + e.b.x * t; out.a.y = e.a.y * c + e.b.y * t; \
+            out.b.x = e.b.x * c - e.a.x * t; out.b.y = e.b.y * c - e.a.y * t; \
+            out.c.x = e.c.x * c + e.d.x * t; out.c.y = e.c.y * c + e.d.y * t; \
+            out.d.x = e.d.x * c - e.c.x * t; out.d.y = e.d.y * c - e.c.y * t; \
+            e = out; \
+        } \
+        /* K * (E * R). */ \
+        out.a.x = k_re * e.a.x - k_im * e.a.y; \
+        out.a.y = k_re * e.a.y + k_im * e.a.x; \
+        out.b.x = k_re * e.b.x - k_im * e.b.y; \
+        out.b.y = k_re * e.b.y + k_im * e.b.x; \
+        out.c.x = k_re * e.c.x - k_im * e.c.y; \
+        out.c.y = k_re * e.c.y + k_im * e.c.x; \
+        out.d.x = k_re * e.d.x - k_im * e.d.y; \
+        out.d.y = k_re * e.d.y + k_im * e.d.x; \
+        J[s * stride_J + j] = out; \
+    } \
+}
+
+#define OSKAR_JONES_KRE_SCALAR(NAME, FP, FP2) \
+static void NAME(const int num_sources, const int num_stations, \
+        const int offset_in, const int stride_E, const FP2* E, \
+        const FP* l, const FP* m, const FP* n, const FP* filter, \
+        const FP filter_min, const FP filter_max, \
+        const int ignore_w_components, const FP wavenumber, \
+        const FP* st_par, const int stride_J, FP2* J) \
+{ \
+    int i; \
+    const int num = num_sources * num_stations; \
+    DO_PRAGMA(omp parallel for private(i)) \
+    for (i = 0; i < num; ++i) \
+    { \
+        FP2 e, out; \
+        OSKAR_KRE_PHASE(FP) \
+        e = E[s * stride_E + g]; \
+        out.x = k_re * e.x - k_im * e.y; \
+        out.y = k_re * e.y + k_im * e.x; \
+        J[s * stride_J + j] = out; \
+    } \
+}
+
+OSKAR_JONES_KRE_MATRIX(jones_KRE_matrix_float, float, float4c)
+OSKAR_JONES_KRE_MATRIX(jones_KRE_matrix_double, double, double4c)
+OSKAR_JONES_KRE_SCALAR(jones_KRE_scalar_float, float, float2)
+OSKAR_JONES_KRE_SCALAR(jones_KRE_scalar_double, double, double2)
+
+#define STATION_PARAMS(FP) \
+    FP* st_par = (FP*) calloc(NUM_PAR * num_stations, sizeof(FP)); \
+    const FP* u_ = (const FP*) oskar_mem_void_const(u); \
+    const FP* v_ = (const FP*) oskar_mem_void_const(v); \
+    const FP* w_ = (const FP*) oskar_mem_void_const(w); \
+    for (i = 0; i < num_stations; ++i) \
+    { \
+        const oskar_Station* st = oskar_telescope_station_const(tel, \
+                oskar_telescope_allow_station_beam_duplication(tel) ? 0 : i); \
+        FP* p = st_par + i * NUM_PAR; \
+        p[PAR_U] = u_[i]; \
+        p[PAR_V] = v_[i]; \
+        p[PAR_W] = w_[i]; \
+        p[PAR_LST] = (FP) (gast + oskar_station_lon_rad(st)); \
+        p[PAR_COS_LAT] = (FP) cos(oskar_station_lat_rad(st)); \
+        p[PAR_SIN_LAT] = (FP) sin(oskar_station_lat_rad(st)); \
+    }
+
+void oskar_evaluate_jones_KRE(oskar_Jones* J, int num_sources, int offset_in,
+        const oskar_Jones* E, int apply_R, const oskar_Sky* sky,
+        const oskar_Telescope* tel, const oskar_Mem* u, const oskar_Mem* v,
+        const oskar_Mem* w, double gast, double frequency_hz,
+        double source_min_jy, double source_max_jy, int ignore_w_components,
+        int* status)
+{
+    int i;
+    if (*status) return;
+    const int type = oskar_jones_type(J);
+    const int precision = oskar_type_precision(type);
+    const int num_stations = oskar_jones_num_stations(J);
+    const int stride_J = oskar_jones_num_sources(J);
+    const int stride_E = oskar_jones_num_sources(E);
+    const double wavenumber = 2.0 * M_PI * frequency_hz / 299792458.0;
+    if (oskar_jones_type(E) != type || oskar_sky_precision(sky) != precision ||
+            oskar_mem_type(u) != precision ||
+            oskar_mem_type(v) != precision ||
+            oskar_mem_type(w) != precision)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (apply_R && !oskar_type_is_matrix(type))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (num_sources > stride_J || offset_in + num_sources > stride_E ||
+            offset_in + num_sources > oskar_sky_num_sources(sky) ||
+            oskar_jones_num_stations(E) != num_stations ||
+            oskar_telescope_num_stations(tel) != num_stations ||
+            (int) oskar_mem_length(u) < num_stations)
+    {
+        *status = OSKAR_ERR_DIMENSION_MISMATCH;
+        return;
+    }
+    if (oskar_jones_mem_location(J) != OSKAR_CPU ||
+            oskar_jones_mem_location(E) != OSKAR_CPU ||
+            oskar_sky_mem_location(sky) != OSKAR_CPU ||
+            oskar_mem_location(u) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    const void* ra = oskar_mem_void_const(oskar_sky_ra_rad_const(sky));
+    const void* dec = oskar_mem_void_const(oskar_sky_dec_rad_const(sky));
+    const void* l = oskar_mem_void_const(oskar_sky_l_const(sky));
+    const void* m = oskar_mem_void_const(oskar_sky_m_const(sky));
+    const void* n = oskar_mem_void_const(oskar_sky_n_const(sky));
+    const void* src_I = oskar_mem_void_const(oskar_sky_I_const(sky));
+    const void* in = oskar_mem_void_const(oskar_jones_mem_const(E));
+    void* out = oskar_mem_void(oskar_jones_mem(J));
+    if (precision == OSKAR_DOUBLE)
+    {
+        STATION_PARAMS(double)
+        if (oskar_type_is_matrix(type))
+            jones_KRE_matrix_double(num_sources, num_stations, offset_in,
+                    stride_E, (const double4c*) in, apply_R,
+                    (const double*) ra, (const double*) dec,
+                    (const double*) l, (const double*) m, (const double*) n,
+                    (const double*) src_I, source_min_jy, source_max_jy,
+                    ignore_w_components, wavenumber, st_par,
+                    stride_J, (double4c*) out);
+        else
+            jones_KRE_scalar_double(num_sources, num_stations, offset_in,
+                    stride_E, (const double2*) in,
+                    (const double*) l, (const double*) m, (const double*) n,
+                    (const double*) src_I, source_min_jy, source_max_jy,
+                    ignore_w_components, wavenumber, st_par,
+                    stride_J, (double2*) out);
+        free(st_par);
+    }
+    else if (precision == OSKAR_SINGLE)
+    {
+        STATION_PARAMS(float)
+        if (oskar_type_is_matrix(type))
+            jones_KRE_matrix_float(num_sources, num_stations, offset_in,
+                    stride_E, (const float4c*) in, apply_R,
+                    (const float*) ra, (const float*) dec,
+                    (const float*) l, (const float*) m, (const float*) n,
+                    (const float*) src_I, (float) source_min_jy,
+                    (float) source_max_jy, ignore_w_components,
+                    (float) wavenumber, st_par,
+                    stride_J, (float4c*) out);
+        else
+            jones_KRE_scalar_float(num_sources, num_stations, offset_in,
+                    stride_E, (const float2*) in,
+                    (const float*) l, (const float*) m, (const float*) n,
+                    (const float*) src_I, (float) source_min_jy,
+                    (float) source_max_jy, ignore_w_components,
+                    (float) wavenumber, st_par,
+                    stride_J, (float2*) out);
+        free(st_par);
+    }
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
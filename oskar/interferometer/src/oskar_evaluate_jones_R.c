@@ -109,6 +109,7 @@ void oskar_evaluate_jones_R(oskar_Jones* R, int num_sources,
         else
         {
             size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+            static int handle[2]; /* Kernel handles, cached on first launch. */
             const char* k = 0;
             const int is_dbl = (precision == OSKAR_DOUBLE);
             switch (type)
@@ -121,6 +122,8 @@ void oskar_evaluate_jones_R(oskar_Jones* R, int num_sources,
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
                 return;
             }
+            const int h = oskar_device_kernel_handle_cached(
+                    &handle[is_dbl], k);
             oskar_device_check_local_size(location, 0, local_size);
             global_size[0] = oskar_device_global_size(
                     (size_t) num_sources, local_size[0]);
@@ -137,7 +140,8 @@ void oskar_evaluate_jones_R(oskar_Jones* R, int num_sources,
                     {INT_SZ, &offset_out},
                     {PTR_SZ, oskar_mem_buffer(oskar_jones_mem(R))}
             };
-            oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+            oskar_device_launch_kernel_handle(h, location, 1,
+                    local_size, global_size,
                     sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
         }
     }
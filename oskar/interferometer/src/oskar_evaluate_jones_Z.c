@@ -28,42 +28,108 @@
 
 #include "interferometer/oskar_evaluate_jones_Z.h"
 
-#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
 #include "convert/oskar_convert_offset_ecef_to_ecef.h"
-#include "telescope/station/oskar_evaluate_pierce_points.h"
+#include "convert/private_convert_ecef_to_geodetic_spherical_inline.h"
+#include "math/oskar_cmath.h"
 #include "sky/oskar_evaluate_tec_tid.h"
+#include "telescope/station/define_evaluate_pierce_points.h"
+#include "utility/oskar_kernel_macros.h"
+#include "utility/oskar_vector_types.h"
 
-#include <math.h>
-#include <stdio.h>
+#include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-static void oskar_evaluate_TEC(oskar_WorkJonesZ* work, int num_pp,
-        const oskar_SettingsIonosphere* settings,
-        double gast, int* status);
+/* Indices of per-station parameters used by the kernel. */
+enum {
+    PAR_ST_X, PAR_ST_Y, PAR_ST_Z, PAR_SIN_L, PAR_COS_L, PAR_SIN_B, PAR_COS_B,
+    PAR_NORM_XYZ, PAR_R_SCREEN, PAR_SIN_HA0, PAR_COS_HA0, PAR_SIN_LAT,
+    PAR_COS_LAT, NUM_PAR
+};
 
-static void evaluate_station_ECEF_coords(
-        double* station_x, double* station_y, double* station_z,
-        int stationID, const oskar_Telescope* telescope);
+/*
+ * Evaluates the Z-Jones term for all stations and sources.
+ *
+ * Each TID component uses four parameters:
+ * (amplitude * TEC0, k * cos(theta), k * sin(theta), k * v * t),
+ * where k = 2 pi / wavelength.
+ * As in oskar_evaluate_tec_tid(), TEC0 is added once for each component.
+ */
+#define OSKAR_JONES_Z(NAME, FP, FP2) \
+static void NAME(const int num_sources, const int num_stations, \
+        const FP* l, const FP* m, const FP* n, \
+        const FP sin_dec0, const FP cos_dec0, const double* st_par, \
+        const int num_comp, const double* comp, const double TEC0, \
+        const FP h_screen, const FP sin_min_el, const double phase_scale, \
+        const int stride_out, FP2* out) \
+{ \
+    int i; \
+    const int num = num_sources * num_stations; \
+    DO_PRAGMA(omp parallel for private(i)) \
+    for (i = 0; i < num; ++i) \
+    { \
+        int c; \
+        FP x, y, z, t, pp_lon, pp_lat, pp_sec; \
+        double tec = 0.0, phase, sin_phase, cos_phase; \
+        const int s = i / num_sources, j = i - s * num_sources; \
+        const double* p = st_par + s * NUM_PAR; \
+        const FP sin_ha0 = (FP) p[PAR_SIN_HA0], cos_ha0 = (FP) p[PAR_COS_HA0]; \
+        const FP sin_lat = (FP) p[PAR_SIN_LAT], cos_lat = (FP) p[PAR_COS_LAT]; \
+        const FP l_ = l[j], m_ = m[j], n_ = n[j]; \
+        FP2* Z = out + s * stride_out + j; \
+        Z->x = (FP) 1; Z->y = (FP) 0; \
+        \
+        /* Convert relative direction to the station ENU frame. */ \
+        x = l_ * cos_ha0 + m_ * sin_ha0 * sin_dec0 - n_ * sin_ha0 * cos_dec0; \
+        t = sin_lat * cos_ha0; \
+        y = -l_ * sin_lat * sin_ha0 + m_ * (cos_lat * cos_dec0 + t * sin_dec0) \
+                + n_ * (cos_lat * sin_dec0 - t * cos_dec0); \
+        t = cos_lat * cos_ha0; \
+        z = l_ * cos_lat * sin_ha0 + m_ * (sin_lat * cos_dec0 - t * sin_dec0) \
+                + n_ * (sin_lat * sin_dec0 + t * cos_dec0); \
+        \
+        /* No phase is applied below the minimum elevation. */ \
+        if (z < sin_min_el) continue; \
+        OSKAR_PIERCE_POINT(FP, x, y, z, \
+                (FP) p[PAR_ST_X], (FP) p[PAR_ST_Y], (FP) p[PAR_ST_Z], \
+                (FP) p[PAR_SIN_L], (FP) p[PAR_COS_L], \
+                (FP) p[PAR_SIN_B], (FP) p[PAR_COS_B], \
+                (FP) p[PAR_NORM_XYZ], (FP) p[PAR_R_SCREEN], h_screen, \
+                pp_lon, pp_lat, pp_sec) \
+        \
+        /* Sum the TEC from all TID components. */ \
+        for (c = 0; c < num_comp; ++c) \
+        { \
+            const double* q = comp + 4 * c; \
+            tec += pp_sec * q[0] * (cos(q[1] * pp_lon - q[3]) + \
+                    cos(q[2] * pp_lat - q[3])) + TEC0; \
+        } \
+        \
+        /* Z phase == exp(i * lambda * 25 * tec) */ \
+        phase = phase_scale * tec; \
+        SINCOS(phase, sin_phase, cos_phase); \
+        Z->x = (FP) cos_phase; \
+        Z->y = (FP) sin_phase; \
+    } \
+}
 
-static void evaluate_jones_Z_station(double wavelength,
-        const oskar_Mem* TEC, const oskar_Mem* hor_z,
-        double min_elevation, int num_pp,
-        int offset_out, oskar_Mem* out, int* status);
+OSKAR_JONES_Z(evaluate_jones_Z_float, float, float2)
+OSKAR_JONES_Z(evaluate_jones_Z_double, double, double2)
 
-void oskar_evaluate_jones_Z(oskar_Jones* Z, const oskar_Sky* sky,
-        const oskar_Telescope* telescope,
+static void station_ecef_coords(const oskar_Telescope* telescope,
+        int station, double* x, double* y, double* z);
+
+void oskar_evaluate_jones_Z(oskar_Jones* Z, int num_sources,
+        const oskar_Sky* sky, const oskar_Telescope* telescope,
         const oskar_SettingsIonosphere* settings, double gast,
-        double frequency_hz, oskar_WorkJonesZ* work, int* status)
+        double frequency_hz, int* status)
 {
-    int i, num_sources, num_stations;
-    /* Station position in ECEF frame */
-    double station_x, station_y, station_z, wavelength;
-    oskar_Sky* sky_cpu; /* Copy of the sky model on the CPU */
-
-    /* Check if safe to proceed. */
+    int i, num_comp = 0;
+    double h_screen = 0.0, *st_par = 0, *comp = 0;
+    oskar_Mem *l_cpu = 0, *m_cpu = 0, *n_cpu = 0, *out_cpu = 0;
+    const oskar_Mem *l, *m, *n;
     if (*status) return;
 
     /* Check data types. */
@@ -75,201 +141,137 @@ void oskar_evaluate_jones_Z(oskar_Jones* Z, const oskar_Sky* sky,
         return;
     }
 
-    /* For now, this function requires data is on the CPU .. check this. */
-
-    /* Resize the work array (if needed) */
-    num_stations = oskar_telescope_num_stations(telescope);
-    num_sources = oskar_sky_num_sources(sky);
-    oskar_work_jones_z_resize(work, num_sources, status);
-
-    /* Copy the sky model to the CPU. */
-    sky_cpu = oskar_sky_create_copy(sky, OSKAR_CPU, status);
-
-    wavelength = 299792458.0 / frequency_hz;
-
-    /* Evaluate the ionospheric phase screen for each station at each
-     * source pierce point. */
-    for (i = 0; i < num_stations; ++i)
-    {
-        double last, lon, lat;
-        const oskar_Station* station;
-        station = oskar_telescope_station_const(telescope, i);
-        lon = oskar_station_lon_rad(station);
-        lat = oskar_station_lat_rad(station);
-        last = gast + lon;
-
-        /* Evaluate horizontal x,y,z source positions (for which to evaluate
-         * pierce points) */
-        oskar_convert_relative_directions_to_enu_directions(0, 0, 0, num_sources,
-                oskar_sky_l_const(sky_cpu), oskar_sky_m_const(sky_cpu),
-                oskar_sky_n_const(sky_cpu), last - oskar_sky_reference_ra_rad(sky_cpu),
-                oskar_sky_reference_dec_rad(sky_cpu), lat,
-                0, work->hor_x, work->hor_y, work->hor_z, status);
-
-        /* Obtain station coordinates in the ECEF frame. */
-        evaluate_station_ECEF_coords(&station_x, &station_y, &station_z, i,
-                telescope);
-
-        /* Obtain the pierce points. */
-        /* FIXME(BM) this is current hard-coded to TID height screen 0
-         * this fix is only needed to support multiple screen heights. */
-        oskar_evaluate_pierce_points(work->pp_lon, work->pp_lat,
-                work->pp_rel_path, station_x, station_y,
-                station_z, settings->TID[0].height_km * 1000., num_sources,
-                work->hor_x, work->hor_y, work->hor_z, status);
-
-        /* Evaluate TEC values for the pierce points */
-        oskar_evaluate_TEC(work, num_sources, settings, gast, status);
-
-        /* Populate the Jones matrix with ionospheric phase */
-        const int offset_out = i * oskar_jones_num_sources(Z);
-        evaluate_jones_Z_station(wavelength,
-                work->total_TEC, work->hor_z, settings->min_elevation,
-                num_sources, offset_out, oskar_jones_mem(Z), status);
-    }
-
-    oskar_sky_free(sky_cpu, status);
-}
-
-
-/* Evaluate the TEC value for each pierce point - note: at the moment this is
- * just the accumulation of one or more TID screens.
- * TODO convert this to a stand-alone function.
- */
-static void oskar_evaluate_TEC(oskar_WorkJonesZ* work, int num_pp,
-        const oskar_SettingsIonosphere* settings,
-        double gast, int* status)
-{
-    int i;
-
-    /* FIXME(BM) For now limit number of screens to 1, this can be removed
-     * if a TEC model which is valid for multiple screens is implemented
-     */
+    /* Only a single TID screen is currently supported. */
     if (settings->num_TID_screens > 1)
+    {
         *status = OSKAR_ERR_INVALID_ARGUMENT;
-
-    oskar_mem_clear_contents(work->total_TEC, status);
-
-    /* Loop over TID screens to evaluate TEC values */
-    for (i = 0; i < settings->num_TID_screens; ++i)
+        return;
+    }
+    if (settings->num_TID_screens == 1)
     {
-        oskar_mem_clear_contents(work->screen_TEC, status);
-
-        /* Evaluate TEC values for the screen */
-        oskar_evaluate_tec_tid(work->screen_TEC, num_pp, work->pp_lon,
-                work->pp_lat, work->pp_rel_path, settings->TEC0,
-                &settings->TID[i], gast);
-
-        /* Accumulate into total TEC */
-        /* FIXME(BM) addition is not physical for more than one TEC screen in
-         * the way TIDs are currently evaluated as TEC0 is added into both
-         * screens.
-         */
-        oskar_mem_add(work->total_TEC, work->total_TEC, work->screen_TEC,
-                0, 0, 0, oskar_mem_length(work->total_TEC), status);
+        const oskar_SettingsTIDscreen* TID = &settings->TID[0];
+        const double earth_radius = OSKAR_TID_EARTH_RADIUS_KM;
+        const double time = gast * 86400.0;
+        h_screen = TID->height_km * 1000.0;
+        num_comp = TID->num_components;
+        comp = (double*) calloc(4 * (num_comp > 0 ? num_comp : 1),
+                sizeof(double));
+        for (i = 0; i < num_comp; ++i)
+        {
+            /* Convert wavelength from km to radians and speed from
+             * km/h to rad/s. */
+            const double w = TID->wavelength[i] /
+                    (earth_radius + TID->height_km);
+            const double v = (TID->speed[i] /
+                    (earth_radius + TID->height_km)) / 3600.0;
+            const double th = TID->theta[i] * M_PI / 180.0;
+            const double k = 2.0 * M_PI / w;
+            comp[4 * i + 0] = TID->amp[i] * settings->TEC0;
+            comp[4 * i + 1] = k * cos(th);
+            comp[4 * i + 2] = k * sin(th);
+            comp[4 * i + 3] = k * v * time;
+        }
     }
-}
-
 
-static void evaluate_station_ECEF_coords(
-        double* station_x, double* station_y, double* station_z,
-        int stationID, const oskar_Telescope* telescope)
-{
-    double st_x, st_y, st_z;
-    double lon, lat, alt;
-    const oskar_Station* station;
-    const void *x_, *y_, *z_;
-
-    x_ = oskar_mem_void_const(
-            oskar_telescope_station_true_offset_ecef_metres_const(telescope, 0));
-    y_ = oskar_mem_void_const(
-            oskar_telescope_station_true_offset_ecef_metres_const(telescope, 1));
-    z_ = oskar_mem_void_const(
-            oskar_telescope_station_true_offset_ecef_metres_const(telescope, 2));
-    station = oskar_telescope_station_const(telescope, stationID);
-    lon = oskar_station_lon_rad(station);
-    lat = oskar_station_lat_rad(station);
-    alt = oskar_station_alt_metres(station);
+    /* Evaluate per-station parameters. */
+    const int num_stations = oskar_telescope_num_stations(telescope);
+    const double ra0 = oskar_sky_reference_ra_rad(sky);
+    const double dec0 = oskar_sky_reference_dec_rad(sky);
+    st_par = (double*) calloc(NUM_PAR * num_stations, sizeof(double));
+    for (i = 0; i < num_stations; ++i)
+    {
+        double x, y, z, lon, lat, alt, *p = st_par + i * NUM_PAR;
+        const oskar_Station* station =
+                oskar_telescope_station_const(telescope, i);
+        const double ha0 = gast + oskar_station_lon_rad(station) - ra0;
+        station_ecef_coords(telescope, i, &x, &y, &z);
+        oskar_convert_ecef_to_geodetic_spherical_inline_d(x, y, z,
+                &lon, &lat, &alt);
+        const double norm_xyz = sqrt(x * x + y * y + z * z);
+        p[PAR_ST_X] = x;
+        p[PAR_ST_Y] = y;
+        p[PAR_ST_Z] = z;
+        p[PAR_SIN_L] = sin(lon);
+        p[PAR_COS_L] = cos(lon);
+        p[PAR_SIN_B] = sin(lat);
+        p[PAR_COS_B] = cos(lat);
+        p[PAR_NORM_XYZ] = norm_xyz;
+        p[PAR_R_SCREEN] = h_screen + norm_xyz - alt;
+        p[PAR_SIN_HA0] = sin(ha0);
+        p[PAR_COS_HA0] = cos(ha0);
+        p[PAR_SIN_LAT] = sin(oskar_station_lat_rad(station));
+        p[PAR_COS_LAT] = cos(oskar_station_lat_rad(station));
+    }
 
-    if (oskar_mem_type(
-            oskar_telescope_station_true_offset_ecef_metres_const(telescope, 0)) ==
-            OSKAR_DOUBLE)
+    /* Get source directions and output array in CPU memory. */
+    l = oskar_sky_l_const(sky);
+    m = oskar_sky_m_const(sky);
+    n = oskar_sky_n_const(sky);
+    if (oskar_mem_location(l) != OSKAR_CPU)
     {
-        st_x = ((const double*)x_)[stationID];
-        st_y = ((const double*)y_)[stationID];
-        st_z = ((const double*)z_)[stationID];
+        l = l_cpu = oskar_mem_create_copy(l, OSKAR_CPU, status);
+        m = m_cpu = oskar_mem_create_copy(m, OSKAR_CPU, status);
+        n = n_cpu = oskar_mem_create_copy(n, OSKAR_CPU, status);
     }
-    else
+    oskar_Mem* out = oskar_jones_mem(Z);
+    if (oskar_mem_location(out) != OSKAR_CPU)
+        out = out_cpu = oskar_mem_create(oskar_mem_type(out), OSKAR_CPU,
+                oskar_mem_length(out), status);
+
+    /* Evaluate the ionospheric phase for all stations and sources. */
+    const double sin_min_el = sin(settings->min_elevation);
+    const double phase_scale = (299792458.0 / frequency_hz) * 25.0;
+    const int stride_out = oskar_jones_num_sources(Z);
+    if (!*status)
     {
-        st_x = (double)((const float*)x_)[stationID];
-        st_y = (double)((const float*)y_)[stationID];
-        st_z = (double)((const float*)z_)[stationID];
+        if (type == OSKAR_DOUBLE)
+            evaluate_jones_Z_double(num_sources, num_stations,
+                    oskar_mem_double_const(l, status),
+                    oskar_mem_double_const(m, status),
+                    oskar_mem_double_const(n, status),
+                    sin(dec0), cos(dec0), st_par, num_comp, comp,
+                    settings->TEC0, h_screen, sin_min_el, phase_scale,
+                    stride_out, oskar_mem_double2(out, status));
+        else
+            evaluate_jones_Z_float(num_sources, num_stations,
+                    oskar_mem_float_const(l, status),
+                    oskar_mem_float_const(m, status),
+                    oskar_mem_float_const(n, status),
+                    (float) sin(dec0), (float) cos(dec0), st_par, num_comp,
+                    comp, settings->TEC0, (float) h_screen,
+                    (float) sin_min_el, phase_scale,
+                    stride_out, oskar_mem_float2(out, status));
     }
-
-    oskar_convert_offset_ecef_to_ecef(1, &st_x, &st_y, &st_z, lon, lat, alt,
-            station_x, station_y, station_z);
+    if (out_cpu)
+        oskar_mem_copy(oskar_jones_mem(Z), out_cpu, status);
+
+    /* Clean up. */
+    oskar_mem_free(l_cpu, status);
+    oskar_mem_free(m_cpu, status);
+    oskar_mem_free(n_cpu, status);
+    oskar_mem_free(out_cpu, status);
+    free(st_par);
+    free(comp);
 }
 
-static void evaluate_jones_Z_station(double wavelength,
-        const oskar_Mem* TEC, const oskar_Mem* hor_z,
-        double min_elevation, int num_pp,
-        int offset_out, oskar_Mem* out, int* status)
+static void station_ecef_coords(const oskar_Telescope* telescope,
+        int station, double* x, double* y, double* z)
 {
-    int i, type;
-    double arg;
-
-    /* Check if safe to proceed. */
-    if (*status) return;
-
-    type = oskar_mem_type(out);
-    if (type == OSKAR_DOUBLE_COMPLEX)
-    {
-        double2* Z_ = oskar_mem_double2(out, status) + offset_out;
-        for (i = 0; i < num_pp; ++i)
-        {
-            /* Initialise as an unit scalar Z = (1 + 0i) i.e. no phase change */
-            Z_[i].x = 1.0;
-            Z_[i].y = 0.0;
-
-            /* If the pierce point is below the minimum specified elevation
-             * don't evaluate a phase */
-            if (asin((oskar_mem_double_const(hor_z, status))[i]) <
-                    min_elevation)
-                continue;
-
-            arg = wavelength * 25. * oskar_mem_double_const(TEC, status)[i];
-
-            /* Z phase == exp(i * lambda * 25 * tec) */
-            Z_[i].x = cos(arg);
-            Z_[i].y = sin(arg);
-        }
-    }
-    else if (type == OSKAR_SINGLE_COMPLEX)
-    {
-        float2* Z_ = oskar_mem_float2(out, status) + offset_out;
-        for (i = 0; i < num_pp; ++i)
-        {
-            /* Initialise as an unit scalar Z = (1 + 0i) i.e. no phase change */
-            Z_[i].x = 1.0;
-            Z_[i].y = 0.0;
-
-            /* If the pierce point is below the minimum specified elevation
-             * don't evaluate a phase */
-            if (asin((oskar_mem_float_const(hor_z, status))[i]) <
-                    min_elevation)
-                continue;
-
-            arg = wavelength * 25. * oskar_mem_float_const(TEC, status)[i];
-
-            /* Z phase == exp(i * lambda * 25 * tec) */
-            Z_[i].x = cos(arg);
-            Z_[i].y = sin(arg);
-        }
-    }
-    else
-    {
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
-    }
+    double st_x, st_y, st_z;
+    const oskar_Station* s = oskar_telescope_station_const(telescope, station);
+    const oskar_Mem* x_ =
+            oskar_telescope_station_true_offset_ecef_metres_const(telescope, 0);
+    const oskar_Mem* y_ =
+            oskar_telescope_station_true_offset_ecef_metres_const(telescope, 1);
+    const oskar_Mem* z_ =
+            oskar_telescope_station_true_offset_ecef_metres_const(telescope, 2);
+    int status = 0;
+    st_x = oskar_mem_get_element(x_, station, &status);
+    st_y = oskar_mem_get_element(y_, station, &status);
+    st_z = oskar_mem_get_element(z_, station, &status);
+    oskar_convert_offset_ecef_to_ecef(1, &st_x, &st_y, &st_z,
+            oskar_station_lon_rad(s), oskar_station_lat_rad(s),
+            oskar_station_alt_metres(s), x, y, z);
 }
 
 #ifdef __cplusplus
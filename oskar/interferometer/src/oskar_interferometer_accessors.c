@@ -9,6 +9,8 @@
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_settings_load_tid_parameter_file.h"
 #include "utility/oskar_get_num_procs.h"
 #include "utility/oskar_device.h"
 
@@ -129,6 +131,42 @@ void oskar_interferometer_set_ignore_w_components(oskar_Interferometer* h,
     h->ignore_w_components = value;
 }
 
+void oskar_interferometer_set_ionosphere(oskar_Interferometer* h,
+        int enable, double min_elevation_deg, double TEC0,
+        int num_tid_files, const char* const* tid_files, int* status)
+{
+    int i;
+    oskar_SettingsIonosphere* s = &h->ionosphere;
+    for (i = 0; i < s->num_TID_screens; ++i)
+    {
+        free(s->TID[i].amp);
+        free(s->TID[i].speed);
+        free(s->TID[i].theta);
+        free(s->TID[i].wavelength);
+    }
+    free(s->TID);
+    s->TID = 0;
+    s->num_TID_screens = 0;
+    s->enable = enable;
+    s->min_elevation = min_elevation_deg * M_PI / 180.0;
+    s->TEC0 = TEC0;
+    if (!enable || num_tid_files <= 0) return;
+    s->TID = (oskar_SettingsTIDscreen*) calloc(num_tid_files,
+            sizeof(oskar_SettingsTIDscreen));
+    for (i = 0; i < num_tid_files; ++i)
+    {
+        oskar_settings_load_tid_parameter_file(&s->TID[i],
+                tid_files[i], status);
+        s->num_TID_screens++;
+        if (*status)
+        {
+            oskar_log_error(h->log, "Unable to load TID parameter file '%s'.",
+                    tid_files[i]);
+            break;
+        }
+    }
+}
+
 void oskar_interferometer_set_max_sources_per_chunk(oskar_Interferometer* h,
         int value)
 {
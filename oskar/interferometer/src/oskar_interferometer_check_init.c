@@ -15,6 +15,9 @@
 extern "C" {
 #endif
 
+/* Target size of the joined Jones matrices for one tile of sources. */
+#define TILE_BYTES 524288
+
 static void set_up_device_data(oskar_Interferometer* h, int* status);
 static void set_up_vis_header(oskar_Interferometer* h, int* status);
 
@@ -189,8 +192,17 @@ static void* init_device(void* arg)
         d->tmr_clip      = oskar_timer_create(dev_loc);
         d->tmr_E         = oskar_timer_create(dev_loc);
         d->tmr_K         = oskar_timer_create(dev_loc);
+        d->tmr_Z         = oskar_timer_create(dev_loc);
         d->tmr_join      = oskar_timer_create(dev_loc);
         d->tmr_correlate = oskar_timer_create(dev_loc);
+        oskar_timer_set_name(d->tmr_compute, "Compute");
+        oskar_timer_set_name(d->tmr_copy, "Copy");
+        oskar_timer_set_name(d->tmr_clip, "Horizon clip");
+        oskar_timer_set_name(d->tmr_E, "Jones E");
+        oskar_timer_set_name(d->tmr_K, "Jones K");
+        oskar_timer_set_name(d->tmr_Z, "Jones Z");
+        oskar_timer_set_name(d->tmr_join, "Jones join");
+        oskar_timer_set_name(d->tmr_correlate, "Correlate");
     }
 
     /* Visibility blocks. */
@@ -216,15 +228,31 @@ static void* init_device(void* arg)
         d->chunk = oskar_sky_create(h->prec, dev_loc, num_src, status);
         d->chunk_clip = oskar_sky_create(h->prec, dev_loc, num_src, status);
         d->tel = oskar_telescope_create_copy(h->tel, dev_loc, status);
-        d->J = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
-                status);
-        d->R = oskar_type_is_matrix(vistype) ? oskar_jones_create(vistype,
-                dev_loc, num_stations, num_src, status) : 0;
         d->E = oskar_jones_create(vistype, dev_loc, num_stations, num_src,
                 status);
-        d->K = oskar_jones_create(complx, dev_loc, num_stations, num_src,
-                status);
-        d->Z = 0;
+        if (dev_loc == OSKAR_CPU)
+        {
+            /* On the CPU, K and R are joined with E a tile at a time,
+             * and the tile size is chosen so that J stays in cache. */
+            d->max_sources_per_tile = (int) (TILE_BYTES /
+                    (num_stations * oskar_mem_element_size(vistype)));
+            if (d->max_sources_per_tile < 64)
+                d->max_sources_per_tile = 64;
+            d->J = oskar_jones_create(vistype, dev_loc, num_stations,
+                    d->max_sources_per_tile, status);
+            d->chunk_tile = oskar_sky_create(h->prec, dev_loc, 0, status);
+        }
+        else
+        {
+            d->J = oskar_jones_create(vistype, dev_loc, num_stations,
+                    num_src, status);
+            d->R = oskar_type_is_matrix(vistype) ? oskar_jones_create(
+                    vistype, dev_loc, num_stations, num_src, status) : 0;
+            d->K = oskar_jones_create(complx, dev_loc, num_stations,
+                    num_src, status);
+        }
+        d->Z = h->ionosphere.enable ? oskar_jones_create(complx, dev_loc,
+                num_stations, num_src, status) : 0;
         d->station_work = oskar_station_work_create(h->prec, dev_loc, status);
         oskar_station_work_set_tec_screen_common_params(d->station_work,
                 oskar_telescope_ionosphere_screen_type(d->tel),
@@ -16,15 +16,25 @@ extern "C" {
 
 oskar_Interferometer* oskar_interferometer_create(int precision, int* status)
 {
+    int i;
     oskar_Interferometer* h = 0;
     h = (oskar_Interferometer*) calloc(1, sizeof(oskar_Interferometer));
     h->prec      = precision;
     h->tmr_sim   = oskar_timer_create(OSKAR_TIMER_NATIVE);
     h->tmr_write = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_set_name(h->tmr_write, "Write block");
     h->temp      = oskar_mem_create(precision, OSKAR_CPU, 0, status);
     h->mutex     = oskar_mutex_create();
     h->barrier   = oskar_barrier_create(0);
     h->log       = oskar_log_create(OSKAR_LOG_MESSAGE, OSKAR_LOG_WARNING);
+    for (i = 0; i < 2; ++i)
+    {
+        h->coords_block_index[i] = -1;
+        h->station_u[i] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+        h->station_v[i] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+        h->station_w[i] = oskar_mem_create(precision, OSKAR_CPU, 0, status);
+        h->gast[i] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    }
 
     /* Get number of devices available, and device location. */
     oskar_device_set_require_double_precision(precision == OSKAR_DOUBLE);
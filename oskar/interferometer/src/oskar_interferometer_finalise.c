@@ -126,7 +126,8 @@ static void record_timing(oskar_Interferometer* h)
 {
     /* Obtain component times. */
     int i;
-    double t_copy = 0., t_clip = 0., t_E = 0., t_K = 0., t_join = 0.;
+    double t_copy = 0., t_clip = 0., t_E = 0., t_K = 0., t_Z = 0.;
+    double t_join = 0.;
     double t_correlate = 0., t_compute = 0., t_components = 0.;
     double *compute_times;
     compute_times = (double*) calloc(h->num_devices, sizeof(double));
@@ -138,10 +139,12 @@ static void record_timing(oskar_Interferometer* h)
         t_join += oskar_timer_elapsed(h->d[i].tmr_join);
         t_E += oskar_timer_elapsed(h->d[i].tmr_E);
         t_K += oskar_timer_elapsed(h->d[i].tmr_K);
+        t_Z += oskar_timer_elapsed(h->d[i].tmr_Z);
         t_correlate += oskar_timer_elapsed(h->d[i].tmr_correlate);
         t_compute += compute_times[i];
     }
-    t_components = t_copy + t_clip + t_E + t_K + t_join + t_correlate;
+    t_components = t_copy + t_clip + t_E + t_K + t_Z + t_join +
+            t_correlate;
 
     /* Record time taken. */
     oskar_log_section(h->log, 'M', "Simulation timing");
@@ -161,6 +164,9 @@ static void record_timing(oskar_Interferometer* h)
             (t_E / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones K", "%4.1f%%",
             (t_K / t_compute) * 100.0);
+    if (t_Z > 0.0)
+        oskar_log_value(h->log, 'M', 1, "Jones Z", "%4.1f%%",
+                (t_Z / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones join", "%4.1f%%",
             (t_join / t_compute) * 100.0);
     oskar_log_value(h->log, 'M', 1, "Jones correlate", "%4.1f%%",
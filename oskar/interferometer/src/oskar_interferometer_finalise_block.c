@@ -16,6 +16,8 @@
 extern "C" {
 #endif
 
+static int can_reuse_block_coords(const oskar_Interferometer* h,
+        const oskar_VisBlock* b, int block_index, int* status);
 static unsigned int disp_width(unsigned int v);
 
 oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
@@ -55,20 +57,45 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
         x = oskar_telescope_station_measured_offset_ecef_metres_const(h->tel, 0);
         y = oskar_telescope_station_measured_offset_ecef_metres_const(h->tel, 1);
         z = oskar_telescope_station_measured_offset_ecef_metres_const(h->tel, 2);
-        oskar_convert_ecef_to_uvw(
-                oskar_telescope_num_stations(h->tel), x, y, z,
-                oskar_telescope_phase_centre_ra_rad(h->tel),
-                oskar_telescope_phase_centre_dec_rad(h->tel),
-                oskar_vis_block_num_times(b0),
-                oskar_vis_header_time_start_mjd_utc(h->header),
-                oskar_vis_header_time_inc_sec(h->header) / 86400.0,
-                oskar_vis_block_start_time_index(b0), h->ignore_w_components,
-                oskar_vis_block_station_uvw_metres(b0, 0),
-                oskar_vis_block_station_uvw_metres(b0, 1),
-                oskar_vis_block_station_uvw_metres(b0, 2),
-                oskar_vis_block_baseline_uvw_metres(b0, 0),
-                oskar_vis_block_baseline_uvw_metres(b0, 1),
-                oskar_vis_block_baseline_uvw_metres(b0, 2), status);
+        if (can_reuse_block_coords(h, b0, block_index, status))
+        {
+            /* Station coordinates were already evaluated for the simulation:
+             * copy them and only convert to baseline coordinates here. */
+            int dim;
+            const int i_coords = block_index % 2;
+            const int num_times = oskar_vis_block_num_times(b0);
+            const int num = num_times * oskar_vis_block_num_stations(b0);
+            const oskar_Mem* src[] = {h->station_u[i_coords],
+                    h->station_v[i_coords], h->station_w[i_coords]};
+            for (dim = 0; dim < 3; ++dim)
+            {
+                oskar_Mem* dst = oskar_vis_block_station_uvw_metres(b0, dim);
+                oskar_mem_ensure(oskar_vis_block_baseline_uvw_metres(b0, dim),
+                        num_times * oskar_vis_block_num_baselines(b0), status);
+                oskar_mem_ensure(dst, num, status);
+                if (dim == 2 && h->ignore_w_components)
+                    oskar_mem_clear_contents(dst, status);
+                else
+                    oskar_mem_copy_contents(dst, src[dim], 0, 0, num, status);
+            }
+            oskar_vis_block_station_to_baseline_coords(b0, status);
+        }
+        else
+            oskar_convert_ecef_to_uvw(
+                    oskar_telescope_num_stations(h->tel), x, y, z,
+                    oskar_telescope_phase_centre_ra_rad(h->tel),
+                    oskar_telescope_phase_centre_dec_rad(h->tel),
+                    oskar_vis_block_num_times(b0),
+                    oskar_vis_header_time_start_mjd_utc(h->header),
+                    oskar_vis_header_time_inc_sec(h->header) / 86400.0,
+                    oskar_vis_block_start_time_index(b0),
+                    h->ignore_w_components,
+                    oskar_vis_block_station_uvw_metres(b0, 0),
+                    oskar_vis_block_station_uvw_metres(b0, 1),
+                    oskar_vis_block_station_uvw_metres(b0, 2),
+                    oskar_vis_block_baseline_uvw_metres(b0, 0),
+                    oskar_vis_block_baseline_uvw_metres(b0, 1),
+                    oskar_vis_block_baseline_uvw_metres(b0, 2), status);
     }
 
     /* Add uncorrelated system noise to the combined visibilities. */
@@ -91,6 +118,35 @@ oskar_VisBlock* oskar_interferometer_finalise_block(oskar_Interferometer* h,
     return b0;
 }
 
+/* The station coordinates used for the simulation can be written out
+ * if they were evaluated for this block and the measured station
+ * positions are the same as the true ones. */
+static int can_reuse_block_coords(const oskar_Interferometer* h,
+        const oskar_VisBlock* b, int block_index, int* status)
+{
+    int i;
+    const int i_coords = block_index % 2;
+    const size_t num_stations = (size_t) oskar_telescope_num_stations(h->tel);
+    if (h->coords_block_index[i_coords] != block_index ||
+            oskar_vis_block_num_stations(b) != (int) num_stations ||
+            oskar_mem_type(h->station_u[i_coords]) != oskar_mem_type(
+                    oskar_vis_block_station_uvw_metres_const(b, 0)))
+        return 0;
+    for (i = 0; i < 3; ++i)
+    {
+        const oskar_Mem *true_offset, *measured_offset;
+        true_offset = oskar_telescope_station_true_offset_ecef_metres_const(
+                h->tel, i);
+        measured_offset =
+                oskar_telescope_station_measured_offset_ecef_metres_const(
+                        h->tel, i);
+        if (oskar_mem_different(true_offset, measured_offset,
+                num_stations, status))
+            return 0;
+    }
+    return 1;
+}
+
 static unsigned int disp_width(unsigned int v)
 {
     return (v >= 100000u) ? 6 : (v >= 10000u) ? 5 : (v >= 1000u) ? 4 :
@@ -22,7 +22,15 @@ void oskar_interferometer_free(oskar_Interferometer* h, int* status)
     for (i = 0; i < h->num_sky_chunks; ++i)
         oskar_sky_free(h->sky_chunks[i], status);
     oskar_telescope_free(h->tel, status);
+    oskar_interferometer_set_ionosphere(h, 0, 0.0, 0.0, 0, 0, status);
     oskar_mem_free(h->temp, status);
+    for (i = 0; i < 2; ++i)
+    {
+        oskar_mem_free(h->station_u[i], status);
+        oskar_mem_free(h->station_v[i], status);
+        oskar_mem_free(h->station_w[i], status);
+        oskar_mem_free(h->gast[i], status);
+    }
     oskar_timer_free(h->tmr_sim);
     oskar_timer_free(h->tmr_write);
     oskar_mutex_free(h->mutex);
@@ -52,6 +60,7 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_timer_free(d->tmr_clip);
         oskar_timer_free(d->tmr_E);
         oskar_timer_free(d->tmr_K);
+        oskar_timer_free(d->tmr_Z);
         oskar_timer_free(d->tmr_join);
         oskar_timer_free(d->tmr_correlate);
         oskar_vis_block_free(d->vis_block_cpu[0], status);
@@ -62,12 +71,14 @@ void oskar_interferometer_free_device_data(oskar_Interferometer* h, int* status)
         oskar_mem_free(d->w, status);
         oskar_sky_free(d->chunk, status);
         oskar_sky_free(d->chunk_clip, status);
+        oskar_sky_free(d->chunk_tile, status);
         oskar_telescope_free(d->tel, status);
         oskar_station_work_free(d->station_work, status);
         oskar_jones_free(d->J, status);
         oskar_jones_free(d->E, status);
         oskar_jones_free(d->K, status);
         oskar_jones_free(d->R, status);
+        oskar_jones_free(d->Z, status);
         memset(d, 0, sizeof(DeviceData));
     }
 }
@@ -83,6 +94,7 @@ void oskar_interferometer_reset_cache(oskar_Interferometer* h, int* status)
     h->vis = 0;
     h->header = 0;
     h->ms = 0;
+    h->coords_block_index[0] = h->coords_block_index[1] = -1;
 }
 
 #ifdef __cplusplus
@@ -4,9 +4,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
+#include "utility/oskar_trace.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -41,6 +43,7 @@ static void* run_blocks(void* arg)
     omp_set_nested(0);
     omp_set_num_threads(1);
 #endif
+    oskar_trace_set_thread(thread_id, device_id);
 
     /* Loop over visibility blocks, running simulation and file
      * writing one block at a time. Simulation and file output are overlapped
@@ -56,6 +59,7 @@ static void* run_blocks(void* arg)
      * simply writes the last block.
      */
     const int num_blocks = oskar_interferometer_num_vis_blocks(h);
+    oskar_mem_pool_scope_begin();
     for (b = 0; b < num_blocks + 1; ++b)
     {
         if ((thread_id > 0 || num_threads == 1) && b < num_blocks)
@@ -63,7 +67,9 @@ static void* run_blocks(void* arg)
         if (thread_id == 0 && b > 0)
         {
             oskar_VisBlock* block;
+            oskar_trace_begin("Finalise block");
             block = oskar_interferometer_finalise_block(h, b - 1, status);
+            oskar_trace_end("Finalise block");
             oskar_interferometer_write_block(h, block, b - 1, status);
         }
 
@@ -75,6 +81,7 @@ static void* run_blocks(void* arg)
         /* Barrier 2: Synchronise before moving to the next block. */
         oskar_barrier_wait(h->barrier);
     }
+    oskar_mem_pool_scope_end();
     return 0;
 }
 
@@ -119,6 +126,10 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
         args[i].status = status;
     }
 
+    /* Record trace events if required. */
+    const char* trace_file = getenv("OSKAR_TRACE_FILE");
+    if (trace_file && strlen(trace_file) > 0) oskar_trace_start();
+
     /* Start the worker threads. */
     oskar_interferometer_reset_work_unit_index(h);
     for (i = 0; i < num_threads; ++i)
@@ -133,6 +144,20 @@ void oskar_interferometer_run(oskar_Interferometer* h, int* status)
     free(threads);
     free(args);
 
+    /* Write the trace file. */
+    if (oskar_trace_enabled())
+    {
+        int trace_status = 0;
+        oskar_trace_stop();
+        oskar_trace_write(trace_file, &trace_status);
+        if (trace_status)
+            oskar_log_warning(h->log, "Unable to write trace file '%s'.",
+                    trace_file);
+        else
+            oskar_log_message(h->log, 'M', 0, "Trace written to '%s'.",
+                    trace_file);
+    }
+
     /* Finalise. */
     oskar_interferometer_finalise(h, status);
 }
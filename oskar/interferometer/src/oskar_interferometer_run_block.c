@@ -6,7 +6,7 @@
 #include "interferometer/private_interferometer.h"
 #include "interferometer/oskar_interferometer.h"
 
-#include "convert/oskar_convert_ecef_to_station_uvw.h"
+#include "convert/oskar_convert_ecef_to_uvw.h"
 #include "convert/oskar_convert_mjd_to_gast_fast.h"
 #include "correlate/oskar_auto_correlate.h"
 #include "correlate/oskar_cross_correlate.h"
@@ -14,15 +14,22 @@
 #include "interferometer/oskar_evaluate_jones_Z.h"
 #include "interferometer/oskar_evaluate_jones_E.h"
 #include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_evaluate_jones_KRE.h"
 #include "utility/oskar_device.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+static void set_block_coords(oskar_Interferometer* h, int block_index,
+        int time_index_start, int num_times, int* status);
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
-        oskar_Sky* sky, int channel_index_block, int time_index_block,
-        int channel_index_simulation, int time_index_simulation, int* status);
+        oskar_Sky* sky, int i_coords, int channel_index_block,
+        int time_index_block, int channel_index_simulation,
+        int time_index_simulation, int* status);
+static void correlate_tiles(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, double gast, double frequency, int offset,
+        int* status);
 static unsigned int disp_width(unsigned int v);
 
 void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
@@ -59,8 +66,6 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
             h->max_channels_per_block;
     const int i_block_chan = block_index % num_blocks_chan;
     const int i_block_time = block_index / num_blocks_chan;
-    const double obs_start_mjd = h->time_start_mjd_utc;
-    const double dt_dump_days = h->time_inc_sec / 86400.0;
     chan_index_start = i_block_chan * h->max_channels_per_block;
     chan_index_end = chan_index_start + h->max_channels_per_block - 1;
     time_index_start = i_block_time * h->max_times_per_block;
@@ -71,6 +76,12 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         chan_index_end = total_chans - 1;
     const int num_times_block = 1 + time_index_end - time_index_start;
     const int num_chans_block = 1 + chan_index_end - chan_index_start;
+    const int i_coords = block_index % 2;
+
+    /* Evaluate station (u,v,w) coordinates for the block, if not done yet. */
+    set_block_coords(h, block_index, time_index_start, num_times_block,
+            status);
+    const double* gast = oskar_mem_double_const(h->gast[i_coords], status);
 
     /* Set the size of the block. */
     oskar_vis_block_resize(d->vis_block, num_times_block, num_chans_block,
@@ -107,12 +118,9 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
         /* Apply horizon clip if required. */
         if (h->apply_horizon_clip)
         {
-            double gast, mjd;
-            mjd = obs_start_mjd + dt_dump_days * (sim_time_idx + 0.5);
-            gast = oskar_convert_mjd_to_gast_fast(mjd);
             oskar_timer_resume(d->tmr_clip);
-            oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel, gast,
-                    d->station_work, status);
+            oskar_sky_horizon_clip(d->chunk_clip, d->chunk, d->tel,
+                    gast[i_time], d->station_work, status);
             oskar_timer_pause(d->tmr_clip);
         }
 
@@ -129,7 +137,7 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
                     disp_width(total_chans), sim_chan_idx + 1, total_chans,
                     device_id, oskar_sky_num_sources(sky));
             oskar_mutex_unlock(h->mutex);
-            sim_baselines(h, d, sky, i_channel, i_time,
+            sim_baselines(h, d, sky, i_coords, i_channel, i_time,
                     sim_chan_idx, sim_time_idx, status);
         }
         d->previous_chunk_index = i_chunk;
@@ -144,13 +152,47 @@ void oskar_interferometer_run_block(oskar_Interferometer* h, int block_index,
 }
 
 
+static void set_block_coords(oskar_Interferometer* h, int block_index,
+        int time_index_start, int num_times, int* status)
+{
+    int i;
+    const int i_coords = block_index % 2;
+
+    /* Only the first compute device to get here does the work. */
+    oskar_mutex_lock(h->mutex);
+    if (h->coords_block_index[i_coords] != block_index && !*status)
+    {
+        const double dt_dump_days = h->time_inc_sec / 86400.0;
+        const double t_start = h->time_start_mjd_utc;
+        const oskar_Mem *x, *y, *z;
+        x = oskar_telescope_station_true_offset_ecef_metres_const(h->tel, 0);
+        y = oskar_telescope_station_true_offset_ecef_metres_const(h->tel, 1);
+        z = oskar_telescope_station_true_offset_ecef_metres_const(h->tel, 2);
+        oskar_mem_ensure(h->gast[i_coords], num_times, status);
+        double* gast = oskar_mem_double(h->gast[i_coords], status);
+        for (i = 0; i < num_times && !*status; ++i)
+            gast[i] = oskar_convert_mjd_to_gast_fast(
+                    t_start + dt_dump_days * (time_index_start + i + 0.5));
+        oskar_convert_ecef_to_uvw(oskar_telescope_num_stations(h->tel),
+                x, y, z,
+                oskar_telescope_phase_centre_ra_rad(h->tel),
+                oskar_telescope_phase_centre_dec_rad(h->tel), num_times,
+                t_start, dt_dump_days, time_index_start, 0,
+                h->station_u[i_coords], h->station_v[i_coords],
+                h->station_w[i_coords], 0, 0, 0, status);
+        if (!*status) h->coords_block_index[i_coords] = block_index;
+    }
+    oskar_mutex_unlock(h->mutex);
+}
+
+
 static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
-        oskar_Sky* sky, int channel_index_block, int time_index_block,
-        int channel_index_simulation, int time_index_simulation, int* status)
+        oskar_Sky* sky, int i_coords, int channel_index_block,
+        int time_index_block, int channel_index_simulation,
+        int time_index_simulation, int* status)
 {
     int num_baselines, num_stations, num_src, num_times_block, num_chans_block;
-    double dt_dump_days, t_start, t_dump, gast, frequency, ra0, dec0;
-    const oskar_Mem *x, *y, *z;
+    double gast, frequency;
 
     /* Get dimensions. */
     num_baselines   = oskar_telescope_num_baselines(d->tel);
@@ -167,32 +209,32 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
         return;
 
     /* Get the time and frequency of the visibility slice being simulated. */
-    dt_dump_days = h->time_inc_sec / 86400.0;
-    t_start = h->time_start_mjd_utc;
-    t_dump = t_start + dt_dump_days * (time_index_simulation + 0.5);
-    gast = oskar_convert_mjd_to_gast_fast(t_dump);
+    gast = oskar_mem_double_const(h->gast[i_coords], status)[time_index_block];
     frequency = h->freq_start_hz + channel_index_simulation * h->freq_inc_hz;
 
     /* Scale source fluxes with spectral index and rotation measure. */
     oskar_sky_scale_flux_with_frequency(sky, frequency, status);
 
-    /* Evaluate station u,v,w coordinates. */
-    ra0 = oskar_telescope_phase_centre_ra_rad(d->tel);
-    dec0 = oskar_telescope_phase_centre_dec_rad(d->tel);
-    x = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 0);
-    y = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 1);
-    z = oskar_telescope_station_true_offset_ecef_metres_const(d->tel, 2);
-    oskar_convert_ecef_to_station_uvw(num_stations, x, y, z, ra0, dec0, gast,
-            0, 0, d->u, d->v, d->w, status);
+    /* Copy station u,v,w coordinates for this time from the block. */
+    const int offset_coords = time_index_block * num_stations;
+    oskar_mem_copy_contents(d->u, h->station_u[i_coords], 0, offset_coords,
+            num_stations, status);
+    oskar_mem_copy_contents(d->v, h->station_v[i_coords], 0, offset_coords,
+            num_stations, status);
+    oskar_mem_copy_contents(d->w, h->station_w[i_coords], 0, offset_coords,
+            num_stations, status);
 
     /* Set dimensions of Jones matrices. */
     if (d->R)
         oskar_jones_set_size(d->R, num_stations, num_src, status);
     if (d->Z)
         oskar_jones_set_size(d->Z, num_stations, num_src, status);
-    oskar_jones_set_size(d->J, num_stations, num_src, status);
+    if (d->K)
+    {
+        oskar_jones_set_size(d->J, num_stations, num_src, status);
+        oskar_jones_set_size(d->K, num_stations, num_src, status);
+    }
     oskar_jones_set_size(d->E, num_stations, num_src, status);
-    oskar_jones_set_size(d->K, num_stations, num_src, status);
 
     /* Evaluate station beam (Jones E: may be matrix). */
     oskar_timer_resume(d->tmr_E);
@@ -201,19 +243,28 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
             gast, frequency, d->station_work, time_index_simulation, status);
     oskar_timer_pause(d->tmr_E);
 
-#if 0
     /* Evaluate ionospheric phase (Jones Z: scalar) and join with Jones E.
      * NOTE this is currently only a CPU implementation. */
     if (d->Z)
     {
+        oskar_timer_resume(d->tmr_Z);
         oskar_evaluate_jones_Z(d->Z, num_src, sky, d->tel,
-                &settings->ionosphere, gast, frequency, &(d->workJonesZ),
-                status);
+                &h->ionosphere, gast, frequency, status);
+        oskar_timer_pause(d->tmr_Z);
         oskar_timer_resume(d->tmr_join);
         oskar_jones_join(d->E, d->Z, d->E, status);
         oskar_timer_pause(d->tmr_join);
     }
-#endif
+
+    /* Calculate output offset. */
+    const int offset = num_chans_block * time_index_block + channel_index_block;
+
+    /* On the CPU, join and correlate the remaining terms a tile at a time. */
+    if (!d->K)
+    {
+        correlate_tiles(h, d, sky, gast, frequency, offset, status);
+        return;
+    }
 
     /* Evaluate parallactic angle (Jones R: matrix), and join with Jones Z*E.
      * TODO Move this into station beam evaluation instead. */
@@ -242,8 +293,6 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
     oskar_jones_join(d->J, d->K, d->R ? d->R : d->E, status);
     oskar_timer_pause(d->tmr_join);
 
-    /* Calculate output offset. */
-    const int offset = num_chans_block * time_index_block + channel_index_block;
     oskar_timer_resume(d->tmr_correlate);
 
     /* Auto-correlate for this time and channel. */
@@ -260,6 +309,53 @@ static void sim_baselines(oskar_Interferometer* h, DeviceData* d,
 }
 
 
+static void correlate_tiles(oskar_Interferometer* h, DeviceData* d,
+        oskar_Sky* sky, double gast, double frequency, int offset,
+        int* status)
+{
+    int start;
+    const int num_baselines = oskar_telescope_num_baselines(d->tel);
+    const int num_stations = oskar_telescope_num_stations(d->tel);
+    const int num_src = oskar_sky_num_sources(sky);
+    const int apply_R = oskar_type_is_matrix(oskar_jones_type(d->E));
+    const int tile_size = d->max_sources_per_tile;
+    oskar_sky_set_use_extended(d->chunk_tile, oskar_sky_use_extended(sky));
+    for (start = 0; start < num_src; start += tile_size)
+    {
+        const int n = (num_src - start < tile_size) ?
+                num_src - start : tile_size;
+
+        /* Copy source data for the tile. */
+        oskar_timer_resume(d->tmr_join);
+        if (oskar_sky_num_sources(d->chunk_tile) != n)
+            oskar_sky_resize(d->chunk_tile, n, status);
+        oskar_sky_copy_contents(d->chunk_tile, sky, 0, start, n, status);
+        oskar_jones_set_size(d->J, num_stations, n, status);
+        oskar_timer_pause(d->tmr_join);
+
+        /* Evaluate Jones R and K, and join with Jones Z*E for the tile. */
+        oskar_timer_resume(d->tmr_K);
+        oskar_evaluate_jones_KRE(d->J, n, start, d->E, apply_R, sky, d->tel,
+                d->u, d->v, d->w, gast, frequency,
+                h->source_min_jy, h->source_max_jy, h->ignore_w_components,
+                status);
+        oskar_timer_pause(d->tmr_K);
+
+        /* Correlate the tile. */
+        oskar_timer_resume(d->tmr_correlate);
+        if (oskar_vis_block_has_auto_correlations(d->vis_block))
+            oskar_auto_correlate(n, d->J, d->chunk_tile,
+                    num_stations * offset,
+                    oskar_vis_block_auto_correlations(d->vis_block), status);
+        if (oskar_vis_block_has_cross_correlations(d->vis_block))
+            oskar_cross_correlate(n, d->J, d->chunk_tile, d->tel,
+                    d->u, d->v, d->w, gast, frequency, num_baselines * offset,
+                    oskar_vis_block_cross_correlations(d->vis_block), status);
+        oskar_timer_pause(d->tmr_correlate);
+    }
+}
+
+
 static unsigned int disp_width(unsigned int v)
 {
     return (v >= 100000u) ? 6 : (v >= 10000u) ? 5 : (v >= 1000u) ? 4 :
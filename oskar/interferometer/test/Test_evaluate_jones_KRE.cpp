@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "interferometer/oskar_evaluate_jones_K.h"
+#include "interferometer/oskar_evaluate_jones_KRE.h"
+#include "interferometer/oskar_evaluate_jones_R.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdlib>
+
+static void run_test(int type, int matrix, double tol)
+{
+    int status = 0;
+    const int num_sources = 1000, num_stations = 17, num_tile = 300;
+    const int jones_type = type | OSKAR_COMPLEX | (matrix ? OSKAR_MATRIX : 0);
+    const double gast = 0.8, frequency_hz = 150e6;
+    const double ra0 = 1.2, dec0 = -0.5;
+
+    /* Set up the sky model, telescope model and station beams. */
+    oskar_Sky* sky = oskar_sky_create(type, OSKAR_CPU, num_sources, &status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        const double r = 0.6 * (i + 0.5) / num_sources, a = 2.39996 * i;
+        oskar_sky_set_source(sky, i, ra0 + r * cos(a), dec0 + r * sin(a),
+                (i % 10) * 0.3, 0.0, 0.0, 0.0, 100e6, 0.0, 0.0,
+                0.0, 0.0, 0.0, &status);
+    }
+    oskar_sky_evaluate_relative_directions(sky, ra0, dec0, &status);
+    oskar_Telescope* tel = oskar_telescope_create(type, OSKAR_CPU,
+            num_stations, &status);
+    oskar_Mem* u = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* v = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    oskar_Mem* w = oskar_mem_create(type, OSKAR_CPU, num_stations, &status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_station_set_position(oskar_telescope_station(tel, i),
+                0.3 + 0.01 * i, -0.4 - 0.02 * i, 0.0, 0.0, 0.0, 0.0);
+        oskar_mem_set_element_real(u, i, 100.0 * i, &status);
+        oskar_mem_set_element_real(v, i, -70.0 * i, &status);
+        oskar_mem_set_element_real(w, i, 3.0 * i, &status);
+    }
+    oskar_Jones* E = oskar_jones_create(jones_type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    srand(1);
+    oskar_mem_random_range(oskar_jones_mem(E), -1.0, 1.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    /* Reference: separate full-size R, K and join. */
+    oskar_Jones* K = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* J_ref = oskar_jones_create(jones_type, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* R = 0;
+    if (matrix)
+    {
+        R = oskar_jones_create(jones_type, OSKAR_CPU,
+                num_stations, num_sources, &status);
+        oskar_evaluate_jones_R(R, num_sources, oskar_sky_ra_rad_const(sky),
+                oskar_sky_dec_rad_const(sky), tel, gast, &status);
+        oskar_jones_join(R, E, R, &status);
+    }
+    oskar_evaluate_jones_K(K, num_sources, oskar_sky_l_const(sky),
+            oskar_sky_m_const(sky), oskar_sky_n_const(sky), u, v, w,
+            frequency_hz, oskar_sky_I_const(sky), 0.5, 2.0, 0, &status);
+    oskar_jones_join(J_ref, K, matrix ? R : E, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    /* Fused evaluation, a tile at a time. */
+    oskar_Jones* J = oskar_jones_create(jones_type, OSKAR_CPU,
+            num_stations, num_tile, &status);
+    const int n_per_st = oskar_type_is_matrix(jones_type) ? 8 : 2;
+    for (int start = 0; start < num_sources; start += num_tile)
+    {
+        const int n = (num_sources - start < num_tile) ?
+                num_sources - start : num_tile;
+        oskar_jones_set_size(J, num_stations, n, &status);
+        oskar_evaluate_jones_KRE(J, n, start, E, matrix, sky, tel, u, v, w,
+                gast, frequency_hz, 0.5, 2.0, 0, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        for (int s = 0; s < num_stations; ++s)
+        {
+            for (int i = 0; i < n * n_per_st; ++i)
+            {
+                const size_t idx = (size_t) (s * n) * n_per_st + i;
+                const size_t idx_ref =
+                        (size_t) (s * num_sources + start) * n_per_st + i;
+                if (type == OSKAR_DOUBLE)
+                {
+                    const double* a = oskar_mem_double_const(
+                            oskar_jones_mem_const(J), &status);
+                    const double* b = oskar_mem_double_const(
+                            oskar_jones_mem_const(J_ref), &status);
+                    EXPECT_NEAR(b[idx_ref], a[idx], tol);
+                }
+                else
+                {
+                    const float* a = oskar_mem_float_const(
+                            oskar_jones_mem_const(J), &status);
+                    const float* b = oskar_mem_float_const(
+                            oskar_jones_mem_const(J_ref), &status);
+                    EXPECT_NEAR(b[idx_ref], a[idx], tol);
+                }
+            }
+        }
+    }
+
+    oskar_jones_free(E, &status);
+    oskar_jones_free(K, &status);
+    oskar_jones_free(R, &status);
+    oskar_jones_free(J, &status);
+    oskar_jones_free(J_ref, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+}
+
+TEST(evaluate_jones_KRE, matrix_double)
+{
+    run_test(OSKAR_DOUBLE, 1, 1e-10);
+}
+
+TEST(evaluate_jones_KRE, matrix_single)
+{
+    run_test(OSKAR_SINGLE, 1, 1e-4);
+}
+
+TEST(evaluate_jones_KRE, scalar_double)
+{
+    run_test(OSKAR_DOUBLE, 0, 1e-10);
+}
+
+TEST(evaluate_jones_KRE, scalar_single)
+{
+    run_test(OSKAR_SINGLE, 0, 1e-4);
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "convert/oskar_convert_ecef_to_geodetic_spherical.h"
+#include "convert/oskar_convert_offset_ecef_to_ecef.h"
+#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
+#include "interferometer/oskar_evaluate_jones_Z.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_evaluate_tec_tid.h"
+#include "telescope/station/oskar_evaluate_pierce_points.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdlib>
+#include <cstring>
+
+/* Scalar pierce point evaluation, as used by the original Z-Jones code. */
+static void pierce_points_ref(int num, const double* hor_x,
+        const double* hor_y, const double* hor_z, double screen_height_m,
+        double st_x, double st_y, double st_z,
+        double* pp_lon, double* pp_lat, double* pp_sec)
+{
+    double lon, lat, alt;
+    oskar_convert_ecef_to_geodetic_spherical(1, &st_x, &st_y, &st_z,
+            &lon, &lat, &alt);
+    const double sin_l = sin(lon), cos_l = cos(lon);
+    const double sin_b = sin(lat), cos_b = cos(lat);
+    const double norm_xyz = sqrt(st_x * st_x + st_y * st_y + st_z * st_z);
+    const double r = screen_height_m + norm_xyz - alt;
+    for (int i = 0; i < num; ++i)
+    {
+        double scale, x = hor_x[i], y = hor_y[i], z = hor_z[i];
+        if (fabs(z - 1.0) > 1.0e-10)
+        {
+            const double el = asin(z), cos_el = cos(el);
+            const double alpha_prime = asin((cos_el * norm_xyz) / r);
+            const double sin_beta = sin(((M_PI/2) - el) - alpha_prime);
+            pp_sec[i] = 1.0 / cos(alpha_prime);
+            scale = r * sin_beta / cos_el;
+        }
+        else
+        {
+            pp_sec[i] = 1.0;
+            scale = screen_height_m;
+        }
+        const double dx = -x * sin_l - y * sin_b * cos_l + z * cos_b * cos_l;
+        const double dy =  x * cos_l - y * sin_b * sin_l + z * cos_b * sin_l;
+        const double dz =  y * cos_b + z * sin_b;
+        x = st_x + dx * scale;
+        y = st_y + dy * scale;
+        z = st_z + dz * scale;
+        pp_lon[i] = atan2(y, x);
+        pp_lat[i] = atan2(z, sqrt(x*x + y*y));
+    }
+}
+
+/* Per-station reference evaluation of Z-Jones. */
+static void jones_Z_ref(oskar_Jones* Z, const oskar_Sky* sky,
+        const oskar_Telescope* tel, oskar_SettingsIonosphere* settings,
+        double gast, double frequency_hz, int* status)
+{
+    const int num_sources = oskar_sky_num_sources(sky);
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const double wavelength = 299792458.0 / frequency_hz;
+    oskar_Mem *hor_x, *hor_y, *hor_z, *pp_lon, *pp_lat, *pp_sec, *tec;
+    hor_x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    hor_y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    hor_z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    pp_lon = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    pp_lat = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    pp_sec = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    tec = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    double2* z_ = oskar_mem_double2(oskar_jones_mem(Z), status);
+    for (int s = 0; s < num_stations; ++s)
+    {
+        const oskar_Station* st = oskar_telescope_station_const(tel, s);
+        double x, y, z, st_x, st_y, st_z;
+        x = oskar_mem_get_element(
+                oskar_telescope_station_true_offset_ecef_metres_const(tel, 0),
+                s, status);
+        y = oskar_mem_get_element(
+                oskar_telescope_station_true_offset_ecef_metres_const(tel, 1),
+                s, status);
+        z = oskar_mem_get_element(
+                oskar_telescope_station_true_offset_ecef_metres_const(tel, 2),
+                s, status);
+        oskar_convert_offset_ecef_to_ecef(1, &x, &y, &z,
+                oskar_station_lon_rad(st), oskar_station_lat_rad(st),
+                oskar_station_alt_metres(st), &st_x, &st_y, &st_z);
+        oskar_convert_relative_directions_to_enu_directions(0, 0, 0,
+                num_sources, oskar_sky_l_const(sky), oskar_sky_m_const(sky),
+                oskar_sky_n_const(sky), gast + oskar_station_lon_rad(st) -
+                oskar_sky_reference_ra_rad(sky),
+                oskar_sky_reference_dec_rad(sky), oskar_station_lat_rad(st),
+                0, hor_x, hor_y, hor_z, status);
+        pierce_points_ref(num_sources, oskar_mem_double(hor_x, status),
+                oskar_mem_double(hor_y, status),
+                oskar_mem_double(hor_z, status),
+                settings->TID[0].height_km * 1000.0, st_x, st_y, st_z,
+                oskar_mem_double(pp_lon, status),
+                oskar_mem_double(pp_lat, status),
+                oskar_mem_double(pp_sec, status));
+        oskar_mem_clear_contents(tec, status);
+        oskar_evaluate_tec_tid(tec, num_sources, pp_lon, pp_lat, pp_sec,
+                settings->TEC0, &settings->TID[0], gast);
+        const double* t_ = oskar_mem_double_const(tec, status);
+        const double* el_ = oskar_mem_double_const(hor_z, status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            double2* out = z_ + s * num_sources + i;
+            out->x = 1.0;
+            out->y = 0.0;
+            if (asin(el_[i]) < settings->min_elevation) continue;
+            out->x = cos(wavelength * 25. * t_[i]);
+            out->y = sin(wavelength * 25. * t_[i]);
+        }
+    }
+    oskar_mem_free(hor_x, status);
+    oskar_mem_free(hor_y, status);
+    oskar_mem_free(hor_z, status);
+    oskar_mem_free(pp_lon, status);
+    oskar_mem_free(pp_lat, status);
+    oskar_mem_free(pp_sec, status);
+    oskar_mem_free(tec, status);
+}
+
+static oskar_Telescope* create_telescope(int type, int num_stations,
+        int* status)
+{
+    oskar_Mem *x, *y, *z, *err;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, status);
+    err = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, status);
+    oskar_mem_clear_contents(err, status);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_mem_set_element_real(x, i, 2000.0 * cos(0.7 * i) * i, status);
+        oskar_mem_set_element_real(y, i, 1500.0 * sin(0.7 * i) * i, status);
+        oskar_mem_set_element_real(z, i, 0.3 * i, status);
+    }
+    oskar_Telescope* tel = oskar_telescope_create(type, OSKAR_CPU, 0, status);
+    oskar_telescope_set_station_coords_enu(tel, 116.6 * M_PI / 180.0,
+            -26.7 * M_PI / 180.0, 300.0, num_stations, x, y, z,
+            err, err, err, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(z, status);
+    oskar_mem_free(err, status);
+    return tel;
+}
+
+static oskar_Sky* create_sky(int type, int num_sources, int* status)
+{
+    const double ra0 = 30.0 * M_PI / 180.0, dec0 = -40.0 * M_PI / 180.0;
+    oskar_Sky* sky = oskar_sky_create(type, OSKAR_CPU, num_sources, status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        /* Spread sources over a wide field, including some near the horizon
+         * to exercise the elevation cut. */
+        const double r = 70.0 * M_PI / 180.0 * (i + 0.5) / num_sources;
+        const double a = 2.39996 * i;
+        oskar_sky_set_source(sky, i, ra0 + r * cos(a) / cos(dec0),
+                dec0 + r * sin(a), 1.0, 0.0, 0.0, 0.0, 100e6, 0.0, 0.0,
+                0.0, 0.0, 0.0, status);
+    }
+    oskar_sky_evaluate_relative_directions(sky, ra0, dec0, status);
+    return sky;
+}
+
+static void set_ionosphere(oskar_SettingsIonosphere* s)
+{
+    static double amp[] = {0.1, 0.05};
+    static double wavelength[] = {200.0, 80.0};
+    static double speed[] = {300.0, 150.0};
+    static double theta[] = {30.0, 110.0};
+    static oskar_SettingsTIDscreen tid;
+    tid.height_km = 300.0;
+    tid.num_components = 2;
+    tid.amp = amp;
+    tid.wavelength = wavelength;
+    tid.speed = speed;
+    tid.theta = theta;
+    memset(s, 0, sizeof(oskar_SettingsIonosphere));
+    s->enable = 1;
+    s->min_elevation = 10.0 * M_PI / 180.0;
+    s->TEC0 = 1.0;
+    s->num_TID_screens = 1;
+    s->TID = &tid;
+}
+
+TEST(evaluate_jones_Z, pierce_points)
+{
+    int status = 0;
+    const int num = 500;
+    const double st_x = -2565000.0, st_y = 5085000.0, st_z = -2861000.0;
+    oskar_Mem *hor[3], *out_d[3], *out_f[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        hor[k] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num, &status);
+        out_d[k] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num, &status);
+        out_f[k] = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, num, &status);
+    }
+    double* x = oskar_mem_double(hor[0], &status);
+    double* y = oskar_mem_double(hor[1], &status);
+    double* z = oskar_mem_double(hor[2], &status);
+    for (int i = 0; i < num; ++i)
+    {
+        const double el = M_PI / 2.0 * i / (num - 1);
+        const double az = 0.37 * i;
+        x[i] = cos(el) * sin(az);
+        y[i] = cos(el) * cos(az);
+        z[i] = sin(el);
+    }
+    z[num - 1] = 1.0; x[num - 1] = y[num - 1] = 0.0;
+    double *ref_lon, *ref_lat, *ref_sec;
+    ref_lon = (double*) calloc(num, sizeof(double));
+    ref_lat = (double*) calloc(num, sizeof(double));
+    ref_sec = (double*) calloc(num, sizeof(double));
+    pierce_points_ref(num, x, y, z, 300e3, st_x, st_y, st_z,
+            ref_lon, ref_lat, ref_sec);
+
+    /* Double precision. */
+    oskar_evaluate_pierce_points(out_d[0], out_d[1], out_d[2],
+            st_x, st_y, st_z, 300e3, num, hor[0], hor[1], hor[2], &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* lon = oskar_mem_double_const(out_d[0], &status);
+    const double* lat = oskar_mem_double_const(out_d[1], &status);
+    const double* sec = oskar_mem_double_const(out_d[2], &status);
+    for (int i = 1; i < num; ++i)
+    {
+        EXPECT_NEAR(ref_lon[i], lon[i], 1e-9);
+        EXPECT_NEAR(ref_lat[i], lat[i], 1e-9);
+        EXPECT_NEAR(ref_sec[i], sec[i], 1e-9);
+    }
+
+    /* Single precision. */
+    oskar_Mem* hor_f[3];
+    for (int k = 0; k < 3; ++k)
+        hor_f[k] = oskar_mem_convert_precision(hor[k], OSKAR_SINGLE, &status);
+    oskar_evaluate_pierce_points(out_f[0], out_f[1], out_f[2],
+            st_x, st_y, st_z, 300e3, num, hor_f[0], hor_f[1], hor_f[2],
+            &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const float* lon_f = oskar_mem_float_const(out_f[0], &status);
+    const float* lat_f = oskar_mem_float_const(out_f[1], &status);
+    for (int i = 1; i < num; ++i)
+    {
+        EXPECT_NEAR(ref_lon[i], lon_f[i], 1e-3);
+        EXPECT_NEAR(ref_lat[i], lat_f[i], 1e-3);
+    }
+
+    for (int k = 0; k < 3; ++k)
+    {
+        oskar_mem_free(hor[k], &status);
+        oskar_mem_free(hor_f[k], &status);
+        oskar_mem_free(out_d[k], &status);
+        oskar_mem_free(out_f[k], &status);
+    }
+    free(ref_lon);
+    free(ref_lat);
+    free(ref_sec);
+}
+
+TEST(evaluate_jones_Z, against_reference)
+{
+    int status = 0;
+    const int num_sources = 400, num_stations = 20;
+    const double gast = 1.234, frequency_hz = 120e6;
+    oskar_SettingsIonosphere settings;
+    set_ionosphere(&settings);
+
+    /* Double precision against the per-station reference. */
+    oskar_Telescope* tel = create_telescope(OSKAR_DOUBLE,
+            num_stations, &status);
+    oskar_Sky* sky = create_sky(OSKAR_DOUBLE, num_sources, &status);
+    oskar_Jones* Z = oskar_jones_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* Z_ref = oskar_jones_create(OSKAR_DOUBLE_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    oskar_evaluate_jones_Z(Z, num_sources, sky, tel, &settings,
+            gast, frequency_hz, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    jones_Z_ref(Z_ref, sky, tel, &settings, gast, frequency_hz, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double2* z_d = oskar_mem_double2_const(oskar_jones_mem(Z), &status);
+    const double2* z_r =
+            oskar_mem_double2_const(oskar_jones_mem(Z_ref), &status);
+    int num_unit = 0;
+    for (int i = 0; i < num_sources * num_stations; ++i)
+    {
+        EXPECT_NEAR(z_r[i].x, z_d[i].x, 1e-6);
+        EXPECT_NEAR(z_r[i].y, z_d[i].y, 1e-6);
+        if (z_r[i].x == 1.0 && z_r[i].y == 0.0) num_unit++;
+    }
+    EXPECT_GT(num_unit, 0);
+    EXPECT_LT(num_unit, num_sources * num_stations);
+
+    /* Single precision against double precision. */
+    oskar_Telescope* tel_f = create_telescope(OSKAR_SINGLE,
+            num_stations, &status);
+    oskar_Sky* sky_f = create_sky(OSKAR_SINGLE, num_sources, &status);
+    oskar_Jones* Z_f = oskar_jones_create(OSKAR_SINGLE_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_evaluate_jones_Z(Z_f, num_sources, sky_f, tel_f, &settings,
+            gast, frequency_hz, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const float2* z_f = oskar_mem_float2_const(oskar_jones_mem(Z_f), &status);
+    for (int i = 0; i < num_sources * num_stations; ++i)
+    {
+        /* Skip points right at the elevation cut. */
+        if ((z_f[i].x == 1.0f) != (z_d[i].x == 1.0)) continue;
+        EXPECT_NEAR(z_d[i].x, z_f[i].x, 5e-2);
+        EXPECT_NEAR(z_d[i].y, z_f[i].y, 5e-2);
+    }
+
+    oskar_jones_free(Z, &status);
+    oskar_jones_free(Z_ref, &status);
+    oskar_jones_free(Z_f, &status);
+    oskar_sky_free(sky, &status);
+    oskar_sky_free(sky_f, &status);
+    oskar_telescope_free(tel, &status);
+    oskar_telescope_free(tel_f, &status);
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "convert/oskar_convert_offset_ecef_to_ecef.h"
+#include "convert/oskar_convert_relative_directions_to_enu_directions.h"
+#include "interferometer/oskar_evaluate_jones_Z.h"
+#include "math/oskar_cmath.h"
+#include "sky/oskar_evaluate_tec_tid.h"
+#include "telescope/station/oskar_evaluate_pierce_points.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+// Evaluates Z-Jones one station at a time, using separate passes for the
+// direction conversion, pierce points, TEC and phase.
+static void jones_Z_per_station(oskar_Jones* Z, const oskar_Sky* sky,
+        const oskar_Telescope* tel, oskar_SettingsIonosphere* settings,
+        double gast, double frequency_hz, int* status)
+{
+    const int type = oskar_sky_precision(sky);
+    const int num_sources = oskar_sky_num_sources(sky);
+    const int num_stations = oskar_telescope_num_stations(tel);
+    const double wavelength = 299792458.0 / frequency_hz;
+    oskar_Mem *hor_x, *hor_y, *hor_z, *pp_lon, *pp_lat, *pp_sec, *tec;
+    oskar_Mem *pp_lon_d, *pp_lat_d, *pp_sec_d;
+    hor_x = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    hor_y = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    hor_z = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    pp_lon = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    pp_lat = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    pp_sec = oskar_mem_create(type, OSKAR_CPU, num_sources, status);
+    tec = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_sources, status);
+    for (int s = 0; s < num_stations && !*status; ++s)
+    {
+        const oskar_Station* st = oskar_telescope_station_const(tel, s);
+        double x, y, z, st_x, st_y, st_z;
+        x = oskar_mem_get_element(
+                oskar_telescope_station_true_offset_ecef_metres_const(tel, 0),
+                s, status);
+        y = oskar_mem_get_element(
+                oskar_telescope_station_true_offset_ecef_metres_const(tel, 1),
+                s, status);
+        z = oskar_mem_get_element(
+                oskar_telescope_station_true_offset_ecef_metres_const(tel, 2),
+                s, status);
+        oskar_convert_offset_ecef_to_ecef(1, &x, &y, &z,
+                oskar_station_lon_rad(st), oskar_station_lat_rad(st),
+                oskar_station_alt_metres(st), &st_x, &st_y, &st_z);
+        oskar_convert_relative_directions_to_enu_directions(0, 0, 0,
+                num_sources, oskar_sky_l_const(sky), oskar_sky_m_const(sky),
+                oskar_sky_n_const(sky), gast + oskar_station_lon_rad(st) -
+                oskar_sky_reference_ra_rad(sky),
+                oskar_sky_reference_dec_rad(sky), oskar_station_lat_rad(st),
+                0, hor_x, hor_y, hor_z, status);
+        oskar_evaluate_pierce_points(pp_lon, pp_lat, pp_sec,
+                st_x, st_y, st_z, settings->TID[0].height_km * 1000.0,
+                num_sources, hor_x, hor_y, hor_z, status);
+        pp_lon_d = oskar_mem_convert_precision(pp_lon, OSKAR_DOUBLE, status);
+        pp_lat_d = oskar_mem_convert_precision(pp_lat, OSKAR_DOUBLE, status);
+        pp_sec_d = oskar_mem_convert_precision(pp_sec, OSKAR_DOUBLE, status);
+        oskar_mem_clear_contents(tec, status);
+        oskar_evaluate_tec_tid(tec, num_sources, pp_lon_d, pp_lat_d, pp_sec_d,
+                settings->TEC0, &settings->TID[0], gast);
+        oskar_mem_free(pp_lon_d, status);
+        oskar_mem_free(pp_lat_d, status);
+        oskar_mem_free(pp_sec_d, status);
+        const double* t_ = oskar_mem_double_const(tec, status);
+        for (int i = 0; i < num_sources; ++i)
+        {
+            const double el = asin(oskar_mem_get_element(hor_z, i, status));
+            double re = 1.0, im = 0.0;
+            if (el >= settings->min_elevation)
+            {
+                re = cos(wavelength * 25. * t_[i]);
+                im = sin(wavelength * 25. * t_[i]);
+            }
+            if (type == OSKAR_DOUBLE)
+            {
+                double2* out = oskar_mem_double2(oskar_jones_mem(Z), status);
+                out[s * num_sources + i].x = re;
+                out[s * num_sources + i].y = im;
+            }
+            else
+            {
+                float2* out = oskar_mem_float2(oskar_jones_mem(Z), status);
+                out[s * num_sources + i].x = (float) re;
+                out[s * num_sources + i].y = (float) im;
+            }
+        }
+    }
+    oskar_mem_free(hor_x, status);
+    oskar_mem_free(hor_y, status);
+    oskar_mem_free(hor_z, status);
+    oskar_mem_free(pp_lon, status);
+    oskar_mem_free(pp_lat, status);
+    oskar_mem_free(pp_sec, status);
+    oskar_mem_free(tec, status);
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_jones_Z_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-nst", "Number of stations.", 1, "256", false);
+    opt.add_flag("-nsrc", "Number of sources.", 1, "4096", false);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-n", "Number of iterations", 1, "1", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const int num_stations = opt.get_int("-nst");
+    const int num_sources = opt.get_int("-nsrc");
+    const int niter = opt.get_int("-n");
+    const int type = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const double gast = 1.234, frequency_hz = 120e6;
+    const double ra0 = 30.0 * M_PI / 180.0, dec0 = -40.0 * M_PI / 180.0;
+
+    // Ionosphere with a single TID screen.
+    double amp[] = {0.1, 0.05}, wavelength[] = {200.0, 80.0};
+    double speed[] = {300.0, 150.0}, theta[] = {30.0, 110.0};
+    oskar_SettingsTIDscreen tid;
+    tid.height_km = 300.0;
+    tid.num_components = 2;
+    tid.amp = amp;
+    tid.wavelength = wavelength;
+    tid.speed = speed;
+    tid.theta = theta;
+    oskar_SettingsIonosphere settings;
+    settings.enable = 1;
+    settings.min_elevation = 10.0 * M_PI / 180.0;
+    settings.TEC0 = 1.0;
+    settings.num_TID_screens = 1;
+    settings.TID = &tid;
+
+    // Telescope and sky model.
+    oskar_Mem *x, *y, *z, *err;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+    err = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_stations, &status);
+    oskar_mem_clear_contents(z, &status);
+    oskar_mem_clear_contents(err, &status);
+    srand(2);
+    oskar_mem_random_range(x, -20e3, 20e3, &status);
+    oskar_mem_random_range(y, -20e3, 20e3, &status);
+    oskar_Telescope* tel = oskar_telescope_create(type, OSKAR_CPU, 0, &status);
+    oskar_telescope_set_station_coords_enu(tel, 116.6 * M_PI / 180.0,
+            -26.7 * M_PI / 180.0, 300.0, num_stations, x, y, z,
+            err, err, err, &status);
+    oskar_Sky* sky = oskar_sky_create(type, OSKAR_CPU, num_sources, &status);
+    for (int i = 0; i < num_sources; ++i)
+    {
+        const double r = 60.0 * M_PI / 180.0 * (i + 0.5) / num_sources;
+        const double a = 2.39996 * i;
+        oskar_sky_set_source(sky, i, ra0 + r * cos(a) / cos(dec0),
+                dec0 + r * sin(a), 1.0, 0.0, 0.0, 0.0, 100e6, 0.0, 0.0,
+                0.0, 0.0, 0.0, &status);
+    }
+    oskar_sky_evaluate_relative_directions(sky, ra0, dec0, &status);
+    oskar_Jones* Z = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+    oskar_Jones* Z_ref = oskar_jones_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_stations, num_sources, &status);
+
+    // Time the per-station evaluation.
+    oskar_Timer* timer = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(timer);
+    for (int j = 0; j < niter; ++j)
+        jones_Z_per_station(Z_ref, sky, tel, &settings,
+                gast, frequency_hz, &status);
+    const double time_ref = oskar_timer_elapsed(timer) / niter;
+
+    // Time the fused evaluation.
+    oskar_timer_start(timer);
+    for (int j = 0; j < niter; ++j)
+        oskar_evaluate_jones_Z(Z, num_sources, sky, tel, &settings,
+                gast, frequency_hz, &status);
+    const double time_fused = oskar_timer_elapsed(timer) / niter;
+
+    // Compare results.
+    double min_err = 0.0, max_err = 0.0, avg_err = 0.0, std_err = 0.0;
+    oskar_mem_evaluate_relative_error(oskar_jones_mem(Z),
+            oskar_jones_mem(Z_ref), &min_err, &max_err, &avg_err, &std_err,
+            &status);
+    oskar_timer_free(timer);
+    oskar_jones_free(Z, &status);
+    oskar_jones_free(Z_ref, &status);
+    oskar_sky_free(sky, &status);
+    oskar_telescope_free(tel, &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(z, &status);
+    oskar_mem_free(err, &status);
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    printf("Stations: %d, sources: %d\n", num_stations, num_sources);
+    printf("Per-station Z-Jones:         %.4f sec\n", time_ref);
+    printf("Fused Z-Jones:               %.4f sec\n", time_fused);
+    printf("Average relative difference: %.3e\n", avg_err);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_DFT_C2R_SEPARABLE_H_
+#define OSKAR_DFT_C2R_SEPARABLE_H_
+
+/**
+ * @file oskar_dft_c2r_separable.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Function to perform a 2D complex-to-real DFT onto a regular output grid.
+ *
+ * @details
+ * Computes the same result as a 2D call to oskar_dft_c2r(), but for
+ * output points that lie on a regular grid described by separate
+ * x- and y-axis coordinates.
+ *
+ * As the phase term factorises into a product of x- and y-phasors,
+ * these are tabulated once per input point for each axis,
+ * and the output is formed as a blocked matrix product, avoiding a
+ * trigonometric function evaluation for every input and output pair.
+ *
+ * The fastest-varying dimension in the output array is along x, so the
+ * output array has num_x * num_y elements.
+ *
+ * The phasor tables are held in the supplied work array, which is resized
+ * if necessary, so it can be reused across calls.
+ *
+ * This function is currently only available for data in CPU memory.
+ *
+ * @param[in] num_in       Number of input points.
+ * @param[in] wavenumber   Wavenumber (2 pi / wavelength).
+ * @param[in] x_in         Array of input x positions.
+ * @param[in] y_in         Array of input y positions.
+ * @param[in] data_in      Array of complex input data.
+ * @param[in] weight_in    Array of input data weights.
+ * @param[in] num_x        Number of output points along the x-axis.
+ * @param[in] x_out        Array of output x-axis positions (length num_x).
+ * @param[in] num_y        Number of output points along the y-axis.
+ * @param[in] y_out        Array of output y-axis positions (length num_y).
+ * @param[out] output      Array of computed output points.
+ * @param[in,out] work     Work array for the phasor tables.
+ * @param[in,out] status   Status return code.
+ */
+OSKAR_EXPORT
+void oskar_dft_c2r_separable(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* data_in,
+        const oskar_Mem* weight_in,
+        int num_x,
+        const oskar_Mem* x_out,
+        int num_y,
+        const oskar_Mem* y_out,
+        oskar_Mem* output,
+        oskar_Mem* work,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_DFT_C2R_SEPARABLE_H_ */
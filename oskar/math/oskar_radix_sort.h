@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_RADIX_SORT_H_
+#define OSKAR_RADIX_SORT_H_
+
+/**
+ * @file oskar_radix_sort.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Finds the sorted order of an array of unsigned integer keys.
+ *
+ * @details
+ * Returns the indices of the \p keys in ascending key order, using a
+ * least-significant-digit radix sort with 8-bit digits. Only the digits
+ * needed to represent the largest key are sorted, so compact keys are
+ * cheaper to sort.
+ *
+ * The sort is stable, so elements with equal keys stay in their input
+ * order, and the result does not depend on the number of threads used.
+ *
+ * @param[in]  num     Number of keys.
+ * @param[in]  keys    Keys to sort.
+ * @param[out] order   Index of each element in the sorted order.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_radix_sort(size_t num, const unsigned int* keys, size_t* order,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_RADIX_SORT_H_ */
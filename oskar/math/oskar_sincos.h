@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SINCOS_H_
+#define OSKAR_SINCOS_H_
+
+/**
+ * @file oskar_sincos.h
+ */
+
+#include <oskar_global.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The argument is reduced to r in [-pi/4, pi/4] by subtracting the nearest
+ * multiple k of pi/2, in three parts (Cody-Waite), and sin(r) and cos(r)
+ * are evaluated using the minimax polynomials from fdlibm (double) and
+ * Cephes (single). The quadrant is then selected without branches, so
+ * loops over the *_kernel functions can be vectorised by the compiler.
+ *
+ * The first two parts of pi/2 have 33 significant bits, so the reduction
+ * is exact for |x| up to OSKAR_SINCOS_MAX_ARG. Larger arguments, and
+ * infinities or NaNs, are passed to the C library instead.
+ *
+ * Maximum errors against correctly rounded results, measured over
+ * |x| <= OSKAR_SINCOS_MAX_ARG:
+ *     double: 2.5 ulp (1.5 ulp for |x| <= 100).
+ *     single: 2 ulp.
+ */
+#define OSKAR_SINCOS_MAX_ARG 1.0e6
+
+#define OSKAR_SINCOS_2_OVER_PI 6.36619772367581382433e-01
+#define OSKAR_SINCOS_PIO2_1 1.57079632673412561417e+00
+#define OSKAR_SINCOS_PIO2_2 6.07710050630396597660e-11
+#define OSKAR_SINCOS_PIO2_3 2.02226624879595063154e-21
+#define OSKAR_SINCOS_ROUND 6755399441055744.0 /* 1.5 * 2^52 */
+
+/* Reduces x to r in [-pi/4, pi/4], returning the quadrant of x in the
+ * lowest two bits of the result. */
+OSKAR_INLINE
+uint64_t oskar_sincos_reduce(const double x, double* r)
+{
+    uint64_t q;
+    const double kd = x * OSKAR_SINCOS_2_OVER_PI + OSKAR_SINCOS_ROUND;
+    const double k = kd - OSKAR_SINCOS_ROUND;
+    *r = ((x - k * OSKAR_SINCOS_PIO2_1) - k * OSKAR_SINCOS_PIO2_2) -
+            k * OSKAR_SINCOS_PIO2_3;
+    memcpy(&q, &kd, sizeof(q)); /* k is in the low bits of the mantissa. */
+    return q;
+}
+
+/**
+ * @brief Evaluates sin(x) and cos(x) in double precision, without branches.
+ *
+ * @details
+ * The result is only valid for |x| <= OSKAR_SINCOS_MAX_ARG.
+ */
+OSKAR_INLINE
+void oskar_sincos_kernel_d(const double x, double* s, double* c)
+{
+    double r;
+    uint64_t sin_b, cos_b, a, b;
+    const uint64_t q = oskar_sincos_reduce(x, &r);
+    const double z = r * r;
+    const double ps = -1.66666666666666324348e-01 + z * (
+            8.33333333332248946124e-03 + z * (
+            -1.98412698298579493134e-04 + z * (
+            2.75573137070700676789e-06 + z * (
+            -2.50507602534068634195e-08 + z *
+            1.58969099521155010221e-10))));
+    const double pc = 4.16666666666666019037e-02 + z * (
+            -1.38888888888741095749e-03 + z * (
+            2.48015872894767294178e-05 + z * (
+            -2.75573143513906633035e-07 + z * (
+            2.08757232129817482790e-09 + z *
+            -1.13596475577881948265e-11))));
+    const double hz = 0.5 * z, w = 1.0 - hz;
+    const double sin_r = r + r * z * ps;
+    const double cos_r = w + (((1.0 - w) - hz) + z * z * pc);
+
+    /* Swap and negate using bit operations, which vectorise in all
+     * instruction sets, unlike selects between doubles. */
+    const uint64_t swap = (uint64_t) 0 - (q & 1);
+    memcpy(&sin_b, &sin_r, sizeof(sin_b));
+    memcpy(&cos_b, &cos_r, sizeof(cos_b));
+    a = ((cos_b & swap) | (sin_b & ~swap)) ^ ((q & 2) << 62);
+    b = ((sin_b & swap) | (cos_b & ~swap)) ^ (((q + 1) & 2) << 62);
+    memcpy(s, &a, sizeof(a));
+    memcpy(c, &b, sizeof(b));
+}
+
+/**
+ * @brief Evaluates sin(x) and cos(x) in single precision, without branches.
+ *
+ * @details
+ * The argument is reduced in double precision.
+ * The result is only valid for |x| <= OSKAR_SINCOS_MAX_ARG.
+ */
+OSKAR_INLINE
+void oskar_sincos_kernel_f(const float x, float* s, float* c)
+{
+    double r_d;
+    const int q = (int) oskar_sincos_reduce((double) x, &r_d);
+    const float r = (float) r_d;
+    const float z = r * r;
+    const float sin_r = r + r * z * (-1.6666654611e-1f + z * (
+            8.3321608736e-3f + z * -1.9515295891e-4f));
+    const float cos_r = 1.0f - 0.5f * z + z * z * (4.166664568298827e-2f +
+            z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+    const float a = (q & 1) ? cos_r : sin_r;
+    const float b = (q & 1) ? sin_r : cos_r;
+    *s = (q & 2) ? -a : a;
+    *c = ((q + 1) & 2) ? -b : b;
+}
+
+/**
+ * @brief Evaluates sin(x) and cos(x) in double precision.
+ */
+OSKAR_INLINE
+void oskar_sincos_d(const double x, double* s, double* c)
+{
+    if (fabs(x) <= OSKAR_SINCOS_MAX_ARG)
+        oskar_sincos_kernel_d(x, s, c);
+    else
+    {
+        *s = sin(x);
+        *c = cos(x);
+    }
+}
+
+/**
+ * @brief Evaluates sin(x) and cos(x) in single precision.
+ */
+OSKAR_INLINE
+void oskar_sincos_f(const float x, float* s, float* c)
+{
+    if (fabs(x) <= OSKAR_SINCOS_MAX_ARG)
+        oskar_sincos_kernel_f(x, s, c);
+    else
+    {
+        *s = (float) sin(x);
+        *c = (float) cos(x);
+    }
+}
+
+/**
+ * @brief Evaluates sin(x) and cos(x) for an array of values.
+ *
+ * @details
+ * Evaluates the sine and cosine of each of the \p num values in \p x.
+ * The values are processed in blocks that the compiler can vectorise,
+ * on the calling thread.
+ *
+ * @param[in]  num  Number of values.
+ * @param[in]  x    Input values, in radians.
+ * @param[out] s    Sine of each value.
+ * @param[out] c    Cosine of each value.
+ */
+OSKAR_EXPORT
+void oskar_sincos_array_d(size_t num, const double* x, double* s, double* c);
+
+/**
+ * @brief Evaluates sin(x) and cos(x) for an array of values.
+ *
+ * @details
+ * Single precision version of oskar_sincos_array_d().
+ *
+ * @param[in]  num  Number of values.
+ * @param[in]  x    Input values, in radians.
+ * @param[out] s    Sine of each value.
+ * @param[out] c    Cosine of each value.
+ */
+OSKAR_EXPORT
+void oskar_sincos_array_f(size_t num, const float* x, float* s, float* c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SINCOS_H_ */
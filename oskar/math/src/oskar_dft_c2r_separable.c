@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/oskar_dft_c2r_separable.h"
+#include "math/oskar_cmath.h"
+#include "utility/oskar_kernel_macros.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of input points used to fill the phasor tables at once. */
+#define IN_CHUNK 64
+
+/* Output tile dimensions for the accumulation stage. */
+#define TILE_X 256
+#define TILE_Y 8
+
+/*
+ * out[y][x] += Re(sum_k (w_k * d_k * exp(-i x_k x)) * exp(-i y_k y))
+ * The x-phasors include the data and weights, so the accumulation is
+ * two real matrix products on the phasor tables.
+ */
+#define OSKAR_DFT_C2R_SEPARABLE(NAME, FP, FP2) \
+static void NAME(const int num_in, const FP wavenumber, const FP* x_in, \
+        const FP* y_in, const FP2* data_in, const FP* weight_in, \
+        const int num_x, const FP* x_out, const int num_y, const FP* y_out, \
+        FP* table, FP* output) \
+{ \
+    int i, start; \
+    FP *ax_re = table, *ax_im = ax_re + IN_CHUNK * num_x; \
+    FP *by_re = ax_im + IN_CHUNK * num_x, *by_im = by_re + IN_CHUNK * num_y; \
+    const int num_tiles_x = (num_x + TILE_X - 1) / TILE_X; \
+    const int num_tiles_y = (num_y + TILE_Y - 1) / TILE_Y; \
+    const int num_tiles = num_tiles_x * num_tiles_y; \
+    DO_PRAGMA(omp parallel for private(i)) \
+    for (i = 0; i < num_x * num_y; ++i) output[i] = (FP) 0; \
+    for (start = 0; start < num_in; start += IN_CHUNK) \
+    { \
+        int k, t; \
+        const int chunk = (num_in - start < IN_CHUNK) ? \
+                num_in - start : IN_CHUNK; \
+        DO_PRAGMA(omp parallel for private(k)) \
+        for (k = 0; k < chunk; ++k) \
+        { \
+            int j; \
+            const int g = start + k; \
+            const FP w = weight_in[g]; \
+            const FP d_re = w * data_in[g].x, d_im = w * data_in[g].y; \
+            const FP u = wavenumber * x_in[g], v = wavenumber * y_in[g]; \
+            FP *a_re = ax_re + k * num_x, *a_im = ax_im + k * num_x; \
+            FP *b_re = by_re + k * num_y, *b_im = by_im + k * num_y; \
+            for (j = 0; j < num_x; ++j) \
+            { \
+                const FP phase = -u * x_out[j]; \
+                FP c, s; \
+                SINCOS(phase, s, c); \
+                a_re[j] = d_re * c - d_im * s; \
+                a_im[j] = d_re * s + d_im * c; \
+            } \
+            for (j = 0; j < num_y; ++j) \
+            { \
+                const FP phase = -v * y_out[j]; \
+                SINCOS(phase, b_im[j], b_re[j]); \
+            } \
+        } \
+        DO_PRAGMA(omp parallel for private(t) schedule(dynamic)) \
+        for (t = 0; t < num_tiles; ++t) \
+        { \
+            int iy, ix, kk; \
+            const int x0 = (t % num_tiles_x) * TILE_X; \
+            const int y0 = (t / num_tiles_x) * TILE_Y; \
+            const int nx = (num_x - x0 < TILE_X) ? num_x - x0 : TILE_X; \
+            const int ny = (num_y - y0 < TILE_Y) ? num_y - y0 : TILE_Y; \
+            for (kk = 0; kk < chunk; ++kk) \
+            { \
+                const FP* a_re = ax_re + kk * num_x + x0; \
+                const FP* a_im = ax_im + kk * num_x + x0; \
+                for (iy = 0; iy < ny; ++iy) \
+                { \
+                    const FP b_re = by_re[kk * num_y + y0 + iy]; \
+                    const FP b_im = by_im[kk * num_y + y0 + iy]; \
+                    FP* out = output + (y0 + iy) * num_x + x0; \
+                    for (ix = 0; ix < nx; ++ix) \
+                        out[ix] += b_re * a_re[ix] - b_im * a_im[ix]; \
+                } \
+            } \
+        } \
+    } \
+}
+
+OSKAR_DFT_C2R_SEPARABLE(dft_c2r_separable_float, float, float2)
+OSKAR_DFT_C2R_SEPARABLE(dft_c2r_separable_double, double, double2)
+
+void oskar_dft_c2r_separable(
+        int num_in,
+        double wavenumber,
+        const oskar_Mem* x_in,
+        const oskar_Mem* y_in,
+        const oskar_Mem* data_in,
+        const oskar_Mem* weight_in,
+        int num_x,
+        const oskar_Mem* x_out,
+        int num_y,
+        const oskar_Mem* y_out,
+        oskar_Mem* output,
+        oskar_Mem* work,
+        int* status)
+{
+    if (*status) return;
+    const int type = oskar_mem_precision(output);
+    if (!oskar_mem_is_complex(data_in) ||
+            oskar_mem_is_complex(output) ||
+            oskar_mem_is_complex(weight_in) ||
+            oskar_mem_is_matrix(weight_in))
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    if (oskar_mem_location(output) != OSKAR_CPU ||
+            oskar_mem_location(data_in) != OSKAR_CPU ||
+            oskar_mem_location(weight_in) != OSKAR_CPU ||
+            oskar_mem_location(x_in) != OSKAR_CPU ||
+            oskar_mem_location(y_in) != OSKAR_CPU ||
+            oskar_mem_location(x_out) != OSKAR_CPU ||
+            oskar_mem_location(y_out) != OSKAR_CPU ||
+            oskar_mem_location(work) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if (oskar_mem_precision(data_in) != type ||
+            oskar_mem_precision(weight_in) != type ||
+            oskar_mem_type(x_in) != type ||
+            oskar_mem_type(y_in) != type ||
+            oskar_mem_type(x_out) != type ||
+            oskar_mem_type(y_out) != type ||
+            oskar_mem_type(work) != type)
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    oskar_mem_ensure(output, (size_t) num_x * (size_t) num_y, status);
+    oskar_mem_ensure(work,
+            2 * IN_CHUNK * ((size_t) num_x + (size_t) num_y), status);
+    if (*status) return;
+    if (type == OSKAR_DOUBLE)
+        dft_c2r_separable_double(num_in, wavenumber,
+                oskar_mem_double_const(x_in, status),
+                oskar_mem_double_const(y_in, status),
+                oskar_mem_double2_const(data_in, status),
+                oskar_mem_double_const(weight_in, status),
+                num_x, oskar_mem_double_const(x_out, status),
+                num_y, oskar_mem_double_const(y_out, status),
+                oskar_mem_double(work, status),
+                oskar_mem_double(output, status));
+    else if (type == OSKAR_SINGLE)
+        dft_c2r_separable_float(num_in, (float) wavenumber,
+                oskar_mem_float_const(x_in, status),
+                oskar_mem_float_const(y_in, status),
+                oskar_mem_float2_const(data_in, status),
+                oskar_mem_float_const(weight_in, status),
+                num_x, oskar_mem_float_const(x_out, status),
+                num_y, oskar_mem_float_const(y_out, status),
+                oskar_mem_float(work, status),
+                oskar_mem_float(output, status));
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
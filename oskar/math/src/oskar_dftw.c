@@ -267,13 +267,15 @@ void oskar_dftw(
     else
     {
         size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        static int handle[8]; /* Kernel handles, cached on first launch. */
         const void* np = 0;
         const char* k = 0;
         int max_in_chunk;
         float wavenumber_f = (float) wavenumber;
 
         /* Select the kernel. */
-        switch (is_dbl * DBL | is_3d * D3 | is_matrix * MAT)
+        const int id = is_dbl * DBL | is_3d * D3 | is_matrix * MAT;
+        switch (id)
         {
         case D2 | FLT:       k = "dftw_c2c_2d_float";  break;
         case D2 | DBL:       k = "dftw_c2c_2d_double"; break;
@@ -287,6 +289,7 @@ void oskar_dftw(
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(&handle[id], k);
         if (oskar_device_is_nv(location))
             local_size[0] = (size_t) get_block_size(num_out);
         oskar_device_check_local_size(location, 0, local_size);
@@ -327,7 +330,8 @@ void oskar_dftw(
                         is_dbl ? (void*)&norm_factor : (void*)&norm_factor_f},
                 {INT_SZ, &max_in_chunk}
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args,
                 sizeof(arg_size_local) / sizeof(size_t), arg_size_local,
                 status);
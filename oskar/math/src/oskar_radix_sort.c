@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/oskar_radix_sort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RADIX_BITS 8
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_MIN_PER_THREAD 16384
+
+/*
+ * Each pass counts the digits in a contiguous range of the input per thread,
+ * then scatters each range to its place in the output. The output offsets
+ * for a digit are ordered by thread, so each pass is stable.
+ */
+void oskar_radix_sort(size_t num, const unsigned int* keys, size_t* order,
+        int* status)
+{
+    size_t i, *hist = 0, *tmp_order = 0;
+    unsigned int max_key = 0, *tmp_keys = 0;
+    int num_passes = 0, num_threads = 1;
+    if (*status || num == 0) return;
+
+    /* Find the number of digits to sort. */
+    for (i = 0; i < num; ++i) if (keys[i] > max_key) max_key = keys[i];
+    while (num_passes < (int) sizeof(unsigned int) &&
+            (max_key >> (RADIX_BITS * num_passes)) != 0) num_passes++;
+    if (num_passes == 0)
+    {
+        for (i = 0; i < num; ++i) order[i] = i;
+        return;
+    }
+
+    /* Allocate scratch space. */
+#ifdef _OPENMP
+    num_threads = omp_get_max_threads();
+    if ((size_t) num_threads > num / RADIX_MIN_PER_THREAD)
+        num_threads = (int) (num / RADIX_MIN_PER_THREAD);
+    if (num_threads < 1) num_threads = 1;
+#endif
+    hist = (size_t*) malloc(num_threads * RADIX_SIZE * sizeof(size_t));
+    if (num_passes > 1)
+    {
+        tmp_keys = (unsigned int*) malloc(2 * num * sizeof(unsigned int));
+        tmp_order = (size_t*) malloc(num * sizeof(size_t));
+    }
+    if (!hist || (num_passes > 1 && (!tmp_keys || !tmp_order)))
+    {
+        free(hist);
+        free(tmp_keys);
+        free(tmp_order);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+
+#pragma omp parallel num_threads(num_threads)
+    {
+        int pass, t = 0, nt = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        const size_t start = num * t / nt, end = num * (t + 1) / nt;
+        size_t* RESTRICT h = hist + t * RADIX_SIZE;
+        for (pass = 0; pass < num_passes; ++pass)
+        {
+            size_t j;
+            const int shift = RADIX_BITS * pass;
+            const int last = (pass == num_passes - 1);
+
+            /* The last pass always writes to the output order array. */
+            const unsigned int* RESTRICT src_k = (pass == 0) ?
+                    keys : tmp_keys + ((pass - 1) & 1) * num;
+            unsigned int* RESTRICT dst_k = last ?
+                    0 : tmp_keys + (pass & 1) * num;
+            const size_t* RESTRICT src_o = (pass == 0) ? 0 :
+                    (((num_passes - pass) & 1) ? tmp_order : order);
+            size_t* RESTRICT dst_o = ((num_passes - 1 - pass) & 1) ?
+                    tmp_order : order;
+
+            /* Count the digits in this thread's range. */
+            memset(h, 0, RADIX_SIZE * sizeof(size_t));
+            for (j = start; j < end; ++j)
+                h[(src_k[j] >> shift) & (RADIX_SIZE - 1)]++;
+#pragma omp barrier
+
+            /* Convert the counts to output offsets. */
+#pragma omp single
+            {
+                int d, k;
+                size_t offset = 0;
+                for (d = 0; d < RADIX_SIZE; ++d)
+                {
+                    for (k = 0; k < nt; ++k)
+                    {
+                        const size_t count = hist[k * RADIX_SIZE + d];
+                        hist[k * RADIX_SIZE + d] = offset;
+                        offset += count;
+                    }
+                }
+            }
+
+            /* Scatter this thread's range. */
+            for (j = start; j < end; ++j)
+            {
+                const unsigned int key = src_k[j];
+                const size_t p = h[(key >> shift) & (RADIX_SIZE - 1)]++;
+                if (!last) dst_k[p] = key;
+                dst_o[p] = src_o ? src_o[j] : j;
+            }
+#pragma omp barrier
+        }
+    }
+    free(hist);
+    free(tmp_keys);
+    free(tmp_order);
+}
+
+#ifdef __cplusplus
+}
+#endif
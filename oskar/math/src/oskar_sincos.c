@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "math/oskar_sincos.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The kernel loop has no branches, so it can be vectorised. Any arguments
+ * out of range are then evaluated again using the C library. */
+#define SINCOS_ARRAY(NAME, FP, KERNEL) \
+void NAME(size_t num, const FP* x, FP* s, FP* c) \
+{ \
+    size_t i; \
+    const FP* RESTRICT x_ = x; \
+    FP* RESTRICT s_ = s; \
+    FP* RESTRICT c_ = c; \
+    for (i = 0; i < num; ++i) KERNEL(x_[i], &s_[i], &c_[i]); \
+    for (i = 0; i < num; ++i) \
+    { \
+        if (!(fabs(x_[i]) <= OSKAR_SINCOS_MAX_ARG)) \
+        { \
+            s_[i] = (FP) sin(x_[i]); \
+            c_[i] = (FP) cos(x_[i]); \
+        } \
+    } \
+}
+
+SINCOS_ARRAY(oskar_sincos_array_d, double, oskar_sincos_kernel_d)
+SINCOS_ARRAY(oskar_sincos_array_f, float, oskar_sincos_kernel_f)
+
+#ifdef __cplusplus
+}
+#endif
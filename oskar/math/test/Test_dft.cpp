@@ -30,6 +30,7 @@
 
 #include "math/oskar_cmath.h"
 #include "math/oskar_dft_c2r.h"
+#include "math/oskar_dft_c2r_separable.h"
 #include "math/oskar_evaluate_image_lmn_grid.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_get_error_string.h"
@@ -150,3 +151,65 @@ TEST(dft, c2r)
     oskar_mem_free(v, &status);
     oskar_mem_free(w, &status);
 }
+
+TEST(dft, c2r_separable)
+{
+    int status = 0, side = 65;
+    const int type = OSKAR_DOUBLE;
+    const size_t num_pixels = side * side;
+    const int num_baselines = 1000;
+    const double wavenumber = 2.0 * M_PI;
+    const double fov = 4.0 * M_PI / 180.0;
+    oskar_Mem *l = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *m = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *n = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *l_axis = oskar_mem_create(type, OSKAR_CPU, side, &status);
+    oskar_Mem *m_axis = oskar_mem_create(type, OSKAR_CPU, side, &status);
+    oskar_Mem *u = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+    oskar_Mem *v = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+    oskar_Mem *amp = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU,
+            num_baselines, &status);
+    oskar_Mem *wt = oskar_mem_create(type, OSKAR_CPU, num_baselines, &status);
+    oskar_Mem *out1 = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *out2 = oskar_mem_create(type, OSKAR_CPU, num_pixels, &status);
+    oskar_Mem *work = oskar_mem_create(type, OSKAR_CPU, 0, &status);
+
+    /* Generate input data. */
+    oskar_evaluate_image_lmn_grid(side, side, fov, fov, 0, l, m, n, &status);
+    oskar_mem_random_range(u, -1000., 1000., &status);
+    oskar_mem_random_range(v, -1000., 1000., &status);
+    oskar_mem_random_range(amp, -1., 1., &status);
+    oskar_mem_random_range(wt, 0.5, 1., &status);
+    ASSERT_EQ(0, status);
+    const double* l_ = oskar_mem_double_const(l, &status);
+    const double* m_ = oskar_mem_double_const(m, &status);
+    for (int i = 0; i < side; ++i)
+    {
+        oskar_mem_double(l_axis, &status)[i] = l_[(side / 2) * side + i];
+        oskar_mem_double(m_axis, &status)[i] = m_[i * side + side / 2];
+    }
+
+    /* Compare with the general DFT. */
+    oskar_dft_c2r(num_baselines, wavenumber, u, v, 0, amp, wt,
+            (int) num_pixels, l, m, 0, out1, &status);
+    oskar_dft_c2r_separable(num_baselines, wavenumber, u, v, amp, wt,
+            side, l_axis, side, m_axis, out2, work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* p1 = oskar_mem_double_const(out1, &status);
+    const double* p2 = oskar_mem_double_const(out2, &status);
+    for (size_t i = 0; i < num_pixels; ++i)
+        EXPECT_NEAR(p1[i], p2[i], 1e-9 * num_baselines);
+
+    oskar_mem_free(l, &status);
+    oskar_mem_free(m, &status);
+    oskar_mem_free(n, &status);
+    oskar_mem_free(l_axis, &status);
+    oskar_mem_free(m_axis, &status);
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(amp, &status);
+    oskar_mem_free(wt, &status);
+    oskar_mem_free(out1, &status);
+    oskar_mem_free(out2, &status);
+    oskar_mem_free(work, &status);
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_radix_sort.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+struct CompareKeys
+{
+    const std::vector<unsigned int>& keys;
+    CompareKeys(const std::vector<unsigned int>& k) : keys(k) {}
+    bool operator()(size_t a, size_t b) const { return keys[a] < keys[b]; }
+};
+
+static void check_sort(size_t num, unsigned int max_key, int num_threads)
+{
+    int status = 0;
+    std::vector<unsigned int> keys(num);
+    std::vector<size_t> order(num), ref(num);
+    srand(1);
+    for (size_t i = 0; i < num; ++i)
+    {
+        keys[i] = (unsigned int) rand() ^ ((unsigned int) rand() << 16);
+        if (max_key < 0xFFFFFFFFu) keys[i] %= (max_key + 1);
+        ref[i] = i;
+    }
+    std::stable_sort(ref.begin(), ref.end(), CompareKeys(keys));
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_radix_sort(num, &keys[0], &order[0], &status);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(ref == order) << "max_key = " << max_key;
+}
+
+TEST(radix_sort, stable)
+{
+    // Keys needing from zero to four passes, in a single chunk
+    // and in several chunks.
+    const unsigned int max_key[] = {0, 1, 200, 60000, 5000000, 0xFFFFFFFFu};
+    for (int k = 0; k < 6; ++k)
+    {
+        check_sort(1000, max_key[k], 1);
+        check_sort(100003, max_key[k], 1);
+        check_sort(100003, max_key[k], 4);
+    }
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_sincos.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// Returns the error in x, in units in the last place of the reference value.
+static double ulp_error_d(double x, long double ref)
+{
+    const double r = (double) ref;
+    const double ulp = nextafter(fabs(r), DBL_MAX) - fabs(r);
+    return (double) (fabsl((long double) x - ref) / ulp);
+}
+
+static double ulp_error_f(float x, double ref)
+{
+    const float r = (float) ref;
+    const float ulp = nextafterf(fabsf(r), FLT_MAX) - fabsf(r);
+    return fabs((double) x - ref) / ulp;
+}
+
+static std::vector<double> test_values(size_t num, double max_arg)
+{
+    std::vector<double> x(num);
+    srand(1);
+    for (size_t i = 0; i < num; ++i)
+        x[i] = max_arg * (2.0 * rand() / (double) RAND_MAX - 1.0);
+    return x;
+}
+
+static void check_d(double max_arg, double max_ulp)
+{
+    double max_err = 0.0;
+    const std::vector<double> x = test_values(1000000, max_arg);
+    const size_t num = x.size();
+    std::vector<double> s(num), c(num);
+    oskar_sincos_array_d(num, &x[0], &s[0], &c[0]);
+    for (size_t i = 0; i < num; ++i)
+    {
+        double s1 = 0.0, c1 = 0.0;
+        const double err_s = ulp_error_d(s[i], sinl((long double) x[i]));
+        const double err_c = ulp_error_d(c[i], cosl((long double) x[i]));
+        if (err_s > max_err) max_err = err_s;
+        if (err_c > max_err) max_err = err_c;
+        oskar_sincos_d(x[i], &s1, &c1);
+        ASSERT_EQ(s[i], s1);
+        ASSERT_EQ(c[i], c1);
+    }
+    printf("Max error (double, |x| <= %g): %.3f ulp\n", max_arg, max_err);
+    EXPECT_LT(max_err, max_ulp);
+}
+
+static void check_f(double max_arg, double max_ulp)
+{
+    double max_err = 0.0;
+    const std::vector<double> x_d = test_values(1000000, max_arg);
+    const size_t num = x_d.size();
+    std::vector<float> x(x_d.begin(), x_d.end()), s(num), c(num);
+    oskar_sincos_array_f(num, &x[0], &s[0], &c[0]);
+    for (size_t i = 0; i < num; ++i)
+    {
+        float s1 = 0.0f, c1 = 0.0f;
+        const double err_s = ulp_error_f(s[i], sin((double) x[i]));
+        const double err_c = ulp_error_f(c[i], cos((double) x[i]));
+        if (err_s > max_err) max_err = err_s;
+        if (err_c > max_err) max_err = err_c;
+        oskar_sincos_f(x[i], &s1, &c1);
+        ASSERT_EQ(s[i], s1);
+        ASSERT_EQ(c[i], c1);
+    }
+    printf("Max error (single, |x| <= %g): %.3f ulp\n", max_arg, max_err);
+    EXPECT_LT(max_err, max_ulp);
+}
+
+TEST(sincos, accuracy_double)
+{
+    check_d(M_PI, 1.5);
+    check_d(100.0, 1.5);
+    check_d(OSKAR_SINCOS_MAX_ARG, 2.5);
+}
+
+TEST(sincos, accuracy_single)
+{
+    check_f(M_PI, 2.0);
+    check_f(100.0, 2.0);
+    check_f(OSKAR_SINCOS_MAX_ARG, 2.0);
+}
+
+TEST(sincos, special_values)
+{
+    // Quadrant boundaries, large and non-finite arguments.
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double x[] = {0.0, -0.0, M_PI / 2.0, M_PI, -M_PI, 3.0 * M_PI / 2.0,
+            2.0 * M_PI, 1e-300, OSKAR_SINCOS_MAX_ARG, -OSKAR_SINCOS_MAX_ARG,
+            2e6, -1e10, 1e300, inf, -inf, nan};
+    const size_t num = sizeof(x) / sizeof(double);
+    std::vector<double> s(num), c(num);
+    std::vector<float> x_f(x, x + num), s_f(num), c_f(num);
+    oskar_sincos_array_d(num, x, &s[0], &c[0]);
+    oskar_sincos_array_f(num, &x_f[0], &s_f[0], &c_f[0]);
+    for (size_t i = 0; i < num; ++i)
+    {
+        if (std::isfinite(x[i]))
+        {
+            EXPECT_NEAR(sin(x[i]), s[i], 1e-15) << "x = " << x[i];
+            EXPECT_NEAR(cos(x[i]), c[i], 1e-15) << "x = " << x[i];
+        }
+        else
+        {
+            EXPECT_TRUE(std::isnan(s[i])) << "x = " << x[i];
+            EXPECT_TRUE(std::isnan(c[i])) << "x = " << x[i];
+        }
+        if (std::isfinite(x_f[i]))
+        {
+            EXPECT_NEAR(sin((double) x_f[i]), s_f[i], 1e-7) << "x = " << x[i];
+            EXPECT_NEAR(cos((double) x_f[i]), c_f[i], 1e-7) << "x = " << x[i];
+        }
+        else
+        {
+            EXPECT_TRUE(std::isnan(s_f[i])) << "x = " << x[i];
+            EXPECT_TRUE(std::isnan(c_f[i])) << "x = " << x[i];
+        }
+    }
+}
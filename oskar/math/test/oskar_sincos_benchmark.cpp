@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "math/oskar_sincos.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Evaluates sin and cos of each value using the C library,
+// and returns the elapsed time.
+template <typename FP>
+static double run_libm(const std::vector<FP>& x, std::vector<FP>& s,
+        std::vector<FP>& c)
+{
+    const size_t num = x.size();
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    for (size_t i = 0; i < num; ++i)
+    {
+        s[i] = std::sin(x[i]);
+        c[i] = std::cos(x[i]);
+    }
+    const double t = oskar_timer_elapsed(tmr);
+    oskar_timer_free(tmr);
+    return t;
+}
+
+static void sincos_array(const std::vector<double>& x,
+        std::vector<double>& s, std::vector<double>& c)
+{
+    oskar_sincos_array_d(x.size(), &x[0], &s[0], &c[0]);
+}
+
+static void sincos_array(const std::vector<float>& x,
+        std::vector<float>& s, std::vector<float>& c)
+{
+    oskar_sincos_array_f(x.size(), &x[0], &s[0], &c[0]);
+}
+
+// Evaluates sin and cos of each value using oskar_sincos_array_*(),
+// and returns the elapsed time.
+template <typename FP>
+static double run_oskar(const std::vector<FP>& x, std::vector<FP>& s,
+        std::vector<FP>& c)
+{
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    sincos_array(x, s, c);
+    const double t = oskar_timer_elapsed(tmr);
+    oskar_timer_free(tmr);
+    return t;
+}
+
+template <typename FP>
+static void benchmark(int num, double max_arg, int num_iter)
+{
+    std::vector<FP> x(num), s(num), c(num), s_ref(num), c_ref(num);
+    srand(1);
+    for (int i = 0; i < num; ++i)
+        x[i] = (FP) (max_arg * (2.0 * rand() / (double) RAND_MAX - 1.0));
+    double t_libm = 0.0, t_oskar = 0.0, max_diff = 0.0;
+    for (int i = 0; i < num_iter; ++i)
+    {
+        t_libm += run_libm(x, s_ref, c_ref);
+        t_oskar += run_oskar(x, s, c);
+    }
+    for (int i = 0; i < num; ++i)
+    {
+        const double ds = std::fabs((double) s[i] - (double) s_ref[i]);
+        const double dc = std::fabs((double) c[i] - (double) c_ref[i]);
+        if (ds > max_diff) max_diff = ds;
+        if (dc > max_diff) max_diff = dc;
+    }
+    const double n = (double) num * num_iter;
+    printf("|x| <= %-8g libm: %12.4g /s  oskar_sincos: %12.4g /s  "
+            "speed-up %5.2f  max diff %.3g\n", max_arg, n / t_libm,
+            n / t_oskar, t_libm / t_oskar, max_diff);
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_sincos_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-n", "Number of values", 1, "1000000", false);
+    opt.add_flag("-i", "Number of iterations", 1, "10", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    const bool single = opt.is_set("-sp");
+    const int num = opt.get_int("-n");
+    const int num_iter = opt.get_int("-i");
+    const double max_arg[] = {M_PI, 1e3, OSKAR_SINCOS_MAX_ARG};
+    printf("Evaluating sin and cos of %d values (%s precision), "
+            "%d iterations\n", num, single ? "single" : "double", num_iter);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (single)
+            benchmark<float>(num, max_arg[i], num_iter);
+        else
+            benchmark<double>(num, max_arg[i], num_iter);
+    }
+    return EXIT_SUCCESS;
+}
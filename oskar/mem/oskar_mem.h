@@ -91,6 +91,7 @@ enum OSKAR_MEM_LOCATION
 #include <mem/oskar_mem_load_ascii.h>
 #include <mem/oskar_mem_multiply.h>
 #include <mem/oskar_mem_normalise.h>
+#include <mem/oskar_mem_pool.h>
 #include <mem/oskar_mem_random_gaussian.h>
 #include <mem/oskar_mem_random_range.h>
 #include <mem/oskar_mem_random_uniform.h>
@@ -106,6 +107,7 @@ enum OSKAR_MEM_LOCATION
 #include <mem/oskar_mem_set_element.h>
 #include <mem/oskar_mem_set_value_real.h>
 #include <mem/oskar_mem_stats.h>
+#include <mem/oskar_mem_sum.h>
 #include <mem/oskar_mem_write_fits_cube.h>
 #include <mem/oskar_mem_write_healpix_fits.h>
 
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_MEM_POOL_H_
+#define OSKAR_MEM_POOL_H_
+
+/**
+ * @file oskar_mem_pool.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Starts a memory pool scope on the calling thread.
+ *
+ * @details
+ * While a scope is active, CPU memory released by oskar_mem_free() or
+ * oskar_mem_realloc() on the calling thread is not returned to the system,
+ * but is kept in a free list for the thread, sorted into power-of-two
+ * size classes. New CPU allocations made by oskar_mem_create() and
+ * oskar_mem_realloc() on the same thread are then taken from the free list
+ * where possible, avoiding repeated allocation of (and page faults in)
+ * the same temporary buffers.
+ * Arrays larger than 64 MiB are not pooled, and are always allocated
+ * at their exact size.
+ *
+ * Memory is cleared before it is reused, so the contents of the arrays
+ * are the same as without the pool.
+ *
+ * Scopes may be nested. Memory held by the pool is released when
+ * the outermost scope on the thread ends.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_scope_begin(void);
+
+/**
+ * @brief
+ * Ends a memory pool scope on the calling thread.
+ *
+ * @details
+ * Ends a scope started by oskar_mem_pool_scope_begin().
+ * If this is the outermost scope, all memory held in the free list
+ * for the calling thread is returned to the system.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_scope_end(void);
+
+/**
+ * @brief
+ * Returns counters for CPU memory allocated by oskar_Mem structures.
+ *
+ * @details
+ * Counters are accumulated over all threads since the library was loaded.
+ * Any of the pointers may be NULL if the value is not required.
+ *
+ * @param[out] num_allocs   Number of allocations made from the system.
+ * @param[out] num_reused   Number of allocations taken from the pool.
+ * @param[out] bytes_in_use Bytes currently allocated and in use.
+ * @param[out] bytes_peak   Peak number of bytes in use.
+ * @param[out] bytes_cached Bytes currently held in the pool for reuse.
+ */
+OSKAR_EXPORT
+void oskar_mem_pool_counters(size_t* num_allocs, size_t* num_reused,
+        size_t* bytes_in_use, size_t* bytes_peak, size_t* bytes_cached);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_MEM_SUM_H_
+#define OSKAR_MEM_SUM_H_
+
+/**
+ * @file oskar_mem_sum.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Element-wise sum of a set of arrays.
+ *
+ * @details
+ * Sums the first \p num_elements elements of each of the \p num_in arrays
+ * in \p in, storing the result in \p out.
+ *
+ * On the CPU, the arrays are processed in cache-sized blocks using
+ * multiple threads, so each block of the output is written only once.
+ * The inputs are always added in the order given, so the result does not
+ * depend on the number of threads, and is the same as that of repeated
+ * calls to oskar_mem_add().
+ *
+ * The output array may be the same as the first input array,
+ * but not any of the others.
+ * All arrays must be of the same data type.
+ *
+ * @param[out]     out          Output array.
+ * @param[in]      num_in       Number of input arrays.
+ * @param[in]      in           Array of pointers to the input arrays.
+ * @param[in]      num_elements Number of elements to sum.
+ * @param[in,out]  status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mem_sum(oskar_Mem* out, int num_in, const oskar_Mem* const* in,
+        size_t num_elements, int* status);
+
+/**
+ * @brief In-place pairwise (tree) sum of a set of arrays.
+ *
+ * @details
+ * Sums the first \p num_elements elements of each of the \p num arrays
+ * in \p arrays, leaving the result in the first array.
+ * The contents of the other arrays are overwritten.
+ *
+ * Pairs of arrays are added in log2(num) passes. The pairs in each pass
+ * are independent, so they are processed concurrently on the CPU.
+ * This needs no extra memory, and usually has a smaller rounding error
+ * than oskar_mem_sum(), but the order of the sums is different.
+ *
+ * All arrays must be of the same data type and in the same location.
+ *
+ * @param[in]      num          Number of arrays.
+ * @param[in,out]  arrays       Array of pointers to the arrays to sum.
+ * @param[in]      num_elements Number of elements to sum.
+ * @param[in,out]  status       Status return code.
+ */
+OSKAR_EXPORT
+void oskar_mem_sum_tree(int num, oskar_Mem* const* arrays,
+        size_t num_elements, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_MEM_SUM_H_ */
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_MEM_LOOP_H_
+#define OSKAR_PRIVATE_MEM_LOOP_H_
+
+#include "utility/oskar_kernel_macros.h"
+
+/*
+ * Number of elements processed in one chunk by the CPU loops.
+ * Arrays no longer than this are processed serially, as the cost of
+ * starting the threads would be larger than the work.
+ */
+#define OSKAR_MEM_CHUNK_SIZE 32768
+
+#define OSKAR_MEM_NUM_CHUNKS(N) \
+    ((int) (((N) + OSKAR_MEM_CHUNK_SIZE - 1) / OSKAR_MEM_CHUNK_SIZE))
+
+/*
+ * Loops over fixed-size chunks of an array of N elements in parallel.
+ * The element range [START, END) of each chunk is available in the body,
+ * which should contain a simple inner loop that can be vectorised.
+ * Since the chunk boundaries do not depend on the number of threads,
+ * any per-chunk results can be combined in a fixed order afterwards.
+ */
+#define OSKAR_MEM_LOOP_CHUNKS(N, START, END) {\
+    int c_;\
+    const int num_chunks_ = OSKAR_MEM_NUM_CHUNKS(N);\
+    DO_PRAGMA(omp parallel for private(c_) if(num_chunks_ > 1))\
+    for (c_ = 0; c_ < num_chunks_; ++c_) {\
+        const size_t START = (size_t) c_ * OSKAR_MEM_CHUNK_SIZE;\
+        const size_t END = (START + OSKAR_MEM_CHUNK_SIZE < (size_t) (N)) ?\
+                START + OSKAR_MEM_CHUNK_SIZE : (size_t) (N);\
+
+#define OSKAR_MEM_LOOP_CHUNKS_END }}
+
+#endif /* include guard */
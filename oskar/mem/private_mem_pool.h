@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_PRIVATE_MEM_POOL_H_
+#define OSKAR_PRIVATE_MEM_POOL_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Allocates a block of CPU memory, which is cleared to zero.
+ * Returns NULL if the memory could not be allocated.
+ */
+void* oskar_mem_pool_alloc(size_t bytes);
+
+/*
+ * Resizes a block of CPU memory allocated by oskar_mem_pool_alloc(),
+ * keeping its contents. Any new memory beyond old_bytes is cleared to zero.
+ * Returns NULL if the memory could not be allocated, in which case
+ * the original block is unchanged.
+ */
+void* oskar_mem_pool_realloc(void* ptr, size_t old_bytes, size_t new_bytes);
+
+/*
+ * Releases a block of CPU memory allocated by oskar_mem_pool_alloc(),
+ * either to the pool for the calling thread or to the system.
+ */
+void oskar_mem_pool_release(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -27,6 +27,7 @@
  */
 
 #include "mem/oskar_mem.h"
+#include "mem/private_mem_loop.h"
 #include "utility/oskar_device.h"
 #include <stdlib.h>
 
@@ -76,28 +77,32 @@ void oskar_mem_add(
     if (oskar_mem_is_complex(in2))   offset_in2 *= 2;
     if (location == OSKAR_CPU)
     {
-        size_t i;
         if (precision == OSKAR_DOUBLE)
         {
-            double *c = oskar_mem_double(out, status);
-            const double *a = oskar_mem_double_const(a_, status);
-            const double *b = oskar_mem_double_const(b_, status);
-            for (i = 0; i < num_elements; ++i)
-                c[i + offset_out] = a[i + offset_in1] + b[i + offset_in2];
+            double *c = oskar_mem_double(out, status) + offset_out;
+            const double *a = oskar_mem_double_const(a_, status) + offset_in1;
+            const double *b = oskar_mem_double_const(b_, status) + offset_in2;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) c[i] = a[i] + b[i];
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else if (precision == OSKAR_SINGLE)
         {
-            float *c = oskar_mem_float(out, status);
-            const float *a = oskar_mem_float_const(a_, status);
-            const float *b = oskar_mem_float_const(b_, status);
-            for (i = 0; i < num_elements; ++i)
-                c[i + offset_out] = a[i + offset_in1] + b[i + offset_in2];
+            float *c = oskar_mem_float(out, status) + offset_out;
+            const float *a = oskar_mem_float_const(a_, status) + offset_in1;
+            const float *b = oskar_mem_float_const(b_, status) + offset_in2;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) c[i] = a[i] + b[i];
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else
             *status = OSKAR_ERR_BAD_DATA_TYPE;
     }
     else
     {
+        static int handle[2]; /* Kernel handles, cached on first launch. */
         size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
         const unsigned int off_a = (unsigned int) offset_in1;
         const unsigned int off_b = (unsigned int) offset_in2;
@@ -111,6 +116,8 @@ void oskar_mem_add(
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(
+                &handle[precision == OSKAR_DOUBLE], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = oskar_device_global_size(num_elements, local_size[0]);
         const oskar_Arg args[] = {
@@ -122,7 +129,8 @@ void oskar_mem_add(
                 {PTR_SZ, oskar_mem_buffer_const(b_)},
                 {PTR_SZ, oskar_mem_buffer(out)}
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 
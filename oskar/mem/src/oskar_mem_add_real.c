@@ -27,6 +27,7 @@
  */
 
 #include "mem/oskar_mem.h"
+#include "mem/private_mem_loop.h"
 #include <stdlib.h>
 
 #ifdef __cplusplus
@@ -35,7 +36,7 @@ extern "C" {
 
 void oskar_mem_add_real(oskar_Mem* mem, double val, int* status)
 {
-    size_t i, num_elements;
+    size_t num_elements;
     if (*status) return;
     const int precision = oskar_mem_precision(mem);
     const int location = oskar_mem_location(mem);
@@ -52,12 +53,18 @@ void oskar_mem_add_real(oskar_Mem* mem, double val, int* status)
         if (precision == OSKAR_DOUBLE)
         {
             double2 *t = oskar_mem_double2(mem, status);
-            for (i = 0; i < num_elements; ++i) t[i].x += val;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) t[i].x += val;
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else if (precision == OSKAR_SINGLE)
         {
             float2 *t = oskar_mem_float2(mem, status);
-            for (i = 0; i < num_elements; ++i) t[i].x += val;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) t[i].x += val;
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else
             *status = OSKAR_ERR_BAD_DATA_TYPE;
@@ -67,12 +74,18 @@ void oskar_mem_add_real(oskar_Mem* mem, double val, int* status)
         if (precision == OSKAR_DOUBLE)
         {
             double *t = oskar_mem_double(mem, status);
-            for (i = 0; i < num_elements; ++i) t[i] += val;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) t[i] += val;
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else if (precision == OSKAR_SINGLE)
         {
             float *t = oskar_mem_float(mem, status);
-            for (i = 0; i < num_elements; ++i) t[i] += val;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) t[i] += val;
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else
             *status = OSKAR_ERR_BAD_DATA_TYPE;
@@ -27,6 +27,7 @@
  */
 
 #include "mem/oskar_mem.h"
+#include "mem/private_mem_loop.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,7 +39,7 @@ oskar_Mem* oskar_mem_convert_precision(const oskar_Mem* input,
     oskar_Mem *output = 0, *in_temp = 0;
     const oskar_Mem *in = 0;
     int input_precision, type;
-    size_t num_elements, i;
+    size_t num_elements;
 
     /* Check if safe to proceed. */
     if (*status) return 0;
@@ -85,10 +86,10 @@ oskar_Mem* oskar_mem_convert_precision(const oskar_Mem* input,
         double* dst_;
         src_ = oskar_mem_float_const(in, status);
         dst_ = oskar_mem_double(output, status);
-        for (i = 0; i < num_elements; ++i)
-        {
-            dst_[i] = src_[i];
-        }
+        OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+        size_t i;
+        for (i = start; i < end; ++i) dst_[i] = src_[i];
+        OSKAR_MEM_LOOP_CHUNKS_END
     }
     else if (input_precision == OSKAR_DOUBLE &&
             output_precision == OSKAR_SINGLE)
@@ -97,10 +98,10 @@ oskar_Mem* oskar_mem_convert_precision(const oskar_Mem* input,
         float* dst_;
         src_ = oskar_mem_double_const(in, status);
         dst_ = oskar_mem_float(output, status);
-        for (i = 0; i < num_elements; ++i)
-        {
-            dst_[i] = src_[i];
-        }
+        OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+        size_t i;
+        for (i = start; i < end; ++i) dst_[i] = (float) src_[i];
+        OSKAR_MEM_LOOP_CHUNKS_END
     }
     else
     {
@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 #include "utility/oskar_device.h"
 
 #include <stdlib.h>
@@ -76,17 +77,14 @@ oskar_Mem* oskar_mem_create(int type, int location, size_t num_elements,
     mem->num_elements = num_elements;
     if (location == OSKAR_CPU)
     {
-        /* Allocate host memory. */
-        mem->data = calloc(bytes, 1);
+        /* Allocate host memory, which is cleared to zero.
+         * This is taken from the memory pool if possible. */
+        mem->data = oskar_mem_pool_alloc(bytes);
         if (mem->data == NULL)
         {
             *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
             return mem;
         }
-        /* The memset() call forces the allocation
-         * to actually happen by touching the whole block.
-         * This makes subsequent copies much faster. */
-        memset(mem->data, 0, bytes);
     }
     else if (location == OSKAR_GPU)
     {
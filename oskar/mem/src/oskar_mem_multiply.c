@@ -29,6 +29,7 @@
 #include "math/define_multiply.h"
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_loop.h"
 #include "mem/define_mem_multiply.h"
 #include "utility/oskar_device.h"
 #include "utility/oskar_kernel_macros.h"
@@ -56,6 +57,14 @@ OSKAR_MEM_MUL_CM_M( M_CAT(mem_mul_cm_m_, double), double2, double4c)
 OSKAR_MEM_MUL_MC_M( M_CAT(mem_mul_mc_m_, double), double2, double4c)
 OSKAR_MEM_MUL_MM_M( M_CAT(mem_mul_mm_m_, double), double2, double4c)
 
+/* Calls a CPU kernel for each chunk of the arrays in parallel. */
+#define MUL_CPU(NAME, TA, TB, TC) \
+    OSKAR_MEM_LOOP_CHUNKS(n, start, end) \
+    NAME(off_a + (unsigned int) start, off_b + (unsigned int) start, \
+            off_c + (unsigned int) start, (unsigned int) (end - start), \
+            (const TA*)a, (const TB*)b, (TC*)c); \
+    OSKAR_MEM_LOOP_CHUNKS_END
+
 void oskar_mem_multiply(
         oskar_Mem* out,
         const oskar_Mem* in1,
@@ -97,28 +106,22 @@ void oskar_mem_multiply(
             switch (out->type)
             {
             case OSKAR_DOUBLE:
-                mem_mul_rr_r_double(off_a, off_b, off_c, n,
-                        (const double*)a, (const double*)b, (double*)c);
+                MUL_CPU(mem_mul_rr_r_double, double, double, double)
                 break;
             case OSKAR_DOUBLE_COMPLEX:
-                mem_mul_cc_c_double(off_a, off_b, off_c, n,
-                        (const double2*)a, (const double2*)b, (double2*)c);
+                MUL_CPU(mem_mul_cc_c_double, double2, double2, double2)
                 break;
             case OSKAR_DOUBLE_COMPLEX_MATRIX:
-                mem_mul_mm_m_double(off_a, off_b, off_c, n,
-                        (const double4c*)a, (const double4c*)b, (double4c*)c);
+                MUL_CPU(mem_mul_mm_m_double, double4c, double4c, double4c)
                 break;
             case OSKAR_SINGLE:
-                mem_mul_rr_r_float(off_a, off_b, off_c, n,
-                        (const float*)a, (const float*)b, (float*)c);
+                MUL_CPU(mem_mul_rr_r_float, float, float, float)
                 break;
             case OSKAR_SINGLE_COMPLEX:
-                mem_mul_cc_c_float(off_a, off_b, off_c, n,
-                        (const float2*)a, (const float2*)b, (float2*)c);
+                MUL_CPU(mem_mul_cc_c_float, float2, float2, float2)
                 break;
             case OSKAR_SINGLE_COMPLEX_MATRIX:
-                mem_mul_mm_m_float(off_a, off_b, off_c, n,
-                        (const float4c*)a, (const float4c*)b, (float4c*)c);
+                MUL_CPU(mem_mul_mm_m_float, float4c, float4c, float4c)
                 break;
             default:
                 *status = OSKAR_ERR_BAD_DATA_TYPE;
@@ -135,21 +138,17 @@ void oskar_mem_multiply(
                 {
                 case OSKAR_DOUBLE_COMPLEX:
                     if (in2->type == in1->type)
-                        mem_mul_cc_m_double(off_a, off_b, off_c, n,
-                                (const double2*)a, (const double2*)b,
-                                (double4c*)c);
+                        MUL_CPU(mem_mul_cc_m_double, double2, double2, double4c)
                     else if (in2->type == out->type)
-                        mem_mul_cm_m_double(off_a, off_b, off_c, n,
-                                (const double2*)a, (const double4c*)b,
-                                (double4c*)c);
+                        MUL_CPU(mem_mul_cm_m_double,
+                                double2, double4c, double4c)
                     else
                         *status = OSKAR_ERR_TYPE_MISMATCH;
                     break;
                 case OSKAR_DOUBLE_COMPLEX_MATRIX:
                     if (in2->type == OSKAR_DOUBLE_COMPLEX)
-                        mem_mul_mc_m_double(off_a, off_b, off_c, n,
-                                (const double4c*)a, (const double2*)b,
-                                (double4c*)c);
+                        MUL_CPU(mem_mul_mc_m_double,
+                                double4c, double2, double4c)
                     else
                         *status = OSKAR_ERR_TYPE_MISMATCH;
                     break;
@@ -165,21 +164,15 @@ void oskar_mem_multiply(
                 {
                 case OSKAR_SINGLE_COMPLEX:
                     if (in2->type == in1->type)
-                        mem_mul_cc_m_float(off_a, off_b, off_c, n,
-                                (const float2*)a, (const float2*)b,
-                                (float4c*)c);
+                        MUL_CPU(mem_mul_cc_m_float, float2, float2, float4c)
                     else if (in2->type == out->type)
-                        mem_mul_cm_m_float(off_a, off_b, off_c, n,
-                                (const float2*)a, (const float4c*)b,
-                                (float4c*)c);
+                        MUL_CPU(mem_mul_cm_m_float, float2, float4c, float4c)
                     else
                         *status = OSKAR_ERR_TYPE_MISMATCH;
                     break;
                 case OSKAR_SINGLE_COMPLEX_MATRIX:
                     if (in2->type == OSKAR_SINGLE_COMPLEX)
-                        mem_mul_mc_m_float(off_a, off_b, off_c, n,
-                                (const float4c*)a, (const float2*)b,
-                                (float4c*)c);
+                        MUL_CPU(mem_mul_mc_m_float, float4c, float2, float4c)
                     else
                         *status = OSKAR_ERR_TYPE_MISMATCH;
                     break;
@@ -197,6 +190,7 @@ void oskar_mem_multiply(
     }
     else
     {
+        static int handle[12]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         /* Check if types are all the same. */
         if (out->type == in1->type && out->type == in2->type)
@@ -273,6 +267,14 @@ void oskar_mem_multiply(
         }
         if (!*status)
         {
+            /* Find the cached handle from the types, as for the name. */
+            const int is_dbl = oskar_type_is_double(out->type);
+            const int id = (out->type == in1->type && out->type == in2->type) ?
+                    3 * is_dbl + (oskar_type_is_matrix(out->type) ? 2 :
+                            oskar_type_is_complex(out->type)) :
+                    6 + 3 * is_dbl + (oskar_type_is_matrix(in1->type) ? 2 :
+                            oskar_type_is_matrix(in2->type));
+            const int h = oskar_device_kernel_handle_cached(&handle[id], k);
             size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
             oskar_device_check_local_size(location, 0, local_size);
             global_size[0] = oskar_device_global_size(
@@ -286,7 +288,8 @@ void oskar_mem_multiply(
                     {PTR_SZ, oskar_mem_buffer_const(b_)},
                     {PTR_SZ, oskar_mem_buffer(out)}
             };
-            oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+            oskar_device_launch_kernel_handle(h, location, 1,
+                    local_size, global_size,
                     sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
         }
     }
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "mem/oskar_mem_pool.h"
+#include "mem/private_mem_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <windows.h>
+#define THREAD_LOCAL __declspec(thread)
+#define ATOMIC_ADD(VAR, VAL) \
+    InterlockedExchangeAdd64((volatile LONG64*) &VAR, (LONG64) (VAL))
+#define ATOMIC_SUB(VAR, VAL) \
+    InterlockedExchangeAdd64((volatile LONG64*) &VAR, -(LONG64) (VAL))
+#define ATOMIC_LOAD(VAR) \
+    ((size_t) InterlockedCompareExchange64((volatile LONG64*) &VAR, 0, 0))
+#define ATOMIC_CAS(VAR, OLD, NEW) \
+    (InterlockedCompareExchange64((volatile LONG64*) &VAR, \
+            (LONG64) (NEW), (LONG64) (OLD)) == (LONG64) (OLD))
+#else
+#define THREAD_LOCAL __thread
+#define ATOMIC_ADD(VAR, VAL) __atomic_fetch_add(&VAR, VAL, __ATOMIC_RELAXED)
+#define ATOMIC_SUB(VAR, VAL) __atomic_fetch_sub(&VAR, VAL, __ATOMIC_RELAXED)
+#define ATOMIC_LOAD(VAR) __atomic_load_n(&VAR, __ATOMIC_RELAXED)
+#define ATOMIC_CAS(VAR, OLD, NEW) __atomic_compare_exchange_n(&VAR, &OLD, \
+        NEW, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Blocks smaller than this are never pooled. */
+#define MIN_POOL_BYTES ((size_t) 4096)
+
+#define NUM_CLASSES (8 * sizeof(size_t))
+
+/* Blocks larger than this are never pooled, and are allocated at their
+ * exact size, so large arrays are not inflated by rounding up. */
+#define MAX_POOL_BYTES ((size_t) 1 << 26)
+
+/* Maximum number of bytes held in the free list of each thread. */
+#define MAX_CACHED_BYTES ((size_t) 1 << 30)
+
+/* Header stored before each block. Padded to keep data aligned. */
+typedef union Block Block;
+union Block
+{
+    struct
+    {
+        size_t capacity; /* Usable size of the block, in bytes. */
+        Block* next;     /* Next block in the free list. */
+    } h;
+    char pad[64];
+};
+
+/* Free lists for the current thread, indexed by size class. */
+static THREAD_LOCAL Block* free_list[NUM_CLASSES];
+static THREAD_LOCAL size_t thread_cached_bytes = 0;
+static THREAD_LOCAL int scope_depth = 0;
+
+/* Counters, for all threads. */
+static size_t num_allocs = 0, num_reused = 0;
+static size_t bytes_in_use = 0, bytes_peak = 0, bytes_cached = 0;
+
+static int floor_log2(size_t x)
+{
+    int k = 0;
+    while (x >>= 1) ++k;
+    return k;
+}
+
+static int ceil_log2(size_t x)
+{
+    const int k = floor_log2(x);
+    return ((size_t) 1 << k) < x ? k + 1 : k;
+}
+
+static void add_in_use(size_t bytes)
+{
+    size_t peak = ATOMIC_LOAD(bytes_peak);
+    const size_t current = ATOMIC_ADD(bytes_in_use, bytes) + bytes;
+    while (current > peak && !ATOMIC_CAS(bytes_peak, peak, current))
+        peak = ATOMIC_LOAD(bytes_peak);
+}
+
+/* Returns a block with at least the given capacity. Not cleared. */
+static Block* get_block(size_t bytes)
+{
+    Block* b = 0;
+    size_t capacity = bytes;
+    if (scope_depth > 0 && bytes >= MIN_POOL_BYTES && bytes <= MAX_POOL_BYTES)
+    {
+        /* Any block in the list for the class is large enough. */
+        const int k = ceil_log2(bytes);
+        if (free_list[k])
+        {
+            b = free_list[k];
+            free_list[k] = b->h.next;
+            thread_cached_bytes -= b->h.capacity;
+            ATOMIC_SUB(bytes_cached, b->h.capacity);
+            ATOMIC_ADD(num_reused, 1);
+            add_in_use(b->h.capacity);
+            return b;
+        }
+
+        /* Round up, so the block can be reused for the whole class. */
+        capacity = (size_t) 1 << k;
+    }
+    b = (Block*) malloc(sizeof(Block) + capacity);
+    if (!b) return 0;
+    b->h.capacity = capacity;
+    b->h.next = 0;
+    ATOMIC_ADD(num_allocs, 1);
+    add_in_use(capacity);
+    return b;
+}
+
+static void put_block(Block* b)
+{
+    const size_t capacity = b->h.capacity;
+    ATOMIC_SUB(bytes_in_use, capacity);
+    if (scope_depth > 0 && capacity >= MIN_POOL_BYTES &&
+            capacity <= MAX_POOL_BYTES &&
+            thread_cached_bytes + capacity <= MAX_CACHED_BYTES)
+    {
+        /* The block can be used for any request up to its class size. */
+        const int k = floor_log2(capacity);
+        b->h.next = free_list[k];
+        free_list[k] = b;
+        thread_cached_bytes += capacity;
+        ATOMIC_ADD(bytes_cached, capacity);
+    }
+    else
+        free(b);
+}
+
+void* oskar_mem_pool_alloc(size_t bytes)
+{
+    Block* b = get_block(bytes);
+    if (!b) return 0;
+
+    /* Touch the whole block, so subsequent copies are faster. */
+    memset(b + 1, 0, bytes);
+    return b + 1;
+}
+
+void* oskar_mem_pool_realloc(void* ptr, size_t old_bytes, size_t new_bytes)
+{
+    Block *b, *b_new;
+    if (!ptr) return oskar_mem_pool_alloc(new_bytes);
+    b = ((Block*) ptr) - 1;
+
+    /* Resize in place if the block is large enough,
+     * unless it would waste a lot of memory outside a pool scope. */
+    if (new_bytes <= b->h.capacity &&
+            (scope_depth > 0 || new_bytes >= b->h.capacity / 2))
+    {
+        if (new_bytes > old_bytes)
+            memset((char*) ptr + old_bytes, 0, new_bytes - old_bytes);
+        return ptr;
+    }
+
+    /* Outside a pool scope, let the system resize the block. */
+    if (scope_depth == 0)
+    {
+        const size_t old_capacity = b->h.capacity;
+        b_new = (Block*) realloc(b, sizeof(Block) + new_bytes);
+        if (!b_new) return 0;
+        b_new->h.capacity = new_bytes;
+        ATOMIC_SUB(bytes_in_use, old_capacity);
+        add_in_use(new_bytes);
+        if (new_bytes > old_bytes)
+            memset((char*) (b_new + 1) + old_bytes, 0, new_bytes - old_bytes);
+        return b_new + 1;
+    }
+
+    /* Otherwise, move the contents to a new block from the pool. */
+    b_new = get_block(new_bytes);
+    if (!b_new) return 0;
+    memcpy(b_new + 1, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+    if (new_bytes > old_bytes)
+        memset((char*) (b_new + 1) + old_bytes, 0, new_bytes - old_bytes);
+    put_block(b);
+    return b_new + 1;
+}
+
+void oskar_mem_pool_release(void* ptr)
+{
+    if (ptr) put_block(((Block*) ptr) - 1);
+}
+
+void oskar_mem_pool_scope_begin(void)
+{
+    scope_depth++;
+}
+
+void oskar_mem_pool_scope_end(void)
+{
+    size_t k;
+    if (scope_depth == 0 || --scope_depth > 0) return;
+    for (k = 0; k < NUM_CLASSES; ++k)
+    {
+        while (free_list[k])
+        {
+            Block* b = free_list[k];
+            free_list[k] = b->h.next;
+            ATOMIC_SUB(bytes_cached, b->h.capacity);
+            free(b);
+        }
+    }
+    thread_cached_bytes = 0;
+}
+
+void oskar_mem_pool_counters(size_t* allocs, size_t* reused,
+        size_t* in_use, size_t* peak, size_t* cached)
+{
+    if (allocs) *allocs = ATOMIC_LOAD(num_allocs);
+    if (reused) *reused = ATOMIC_LOAD(num_reused);
+    if (in_use) *in_use = ATOMIC_LOAD(bytes_in_use);
+    if (peak) *peak = ATOMIC_LOAD(bytes_peak);
+    if (cached) *cached = ATOMIC_LOAD(bytes_cached);
+}
+
+#ifdef __cplusplus
+}
+#endif
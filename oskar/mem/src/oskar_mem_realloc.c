@@ -32,6 +32,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_pool.h"
 #include "utility/oskar_device.h"
 
 #include <string.h>
@@ -70,20 +71,23 @@ void oskar_mem_realloc(oskar_Mem* mem, size_t num_elements, int* status)
     /* Check memory location. */
     if (mem->location == OSKAR_CPU)
     {
-        /* Reallocate the memory. */
-        void* mem_new = realloc(mem->data, new_size);
-        if (!mem_new && (new_size > 0))
+        /* Reallocate the memory.
+         * The new memory is initialised if it's larger than the old block. */
+        void* mem_new = 0;
+        if (new_size > 0)
         {
-            *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
-            return;
+            mem_new = oskar_mem_pool_realloc(mem->data, old_size, new_size);
+            if (!mem_new)
+            {
+                *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+                return;
+            }
         }
-
-        /* Initialise the new memory if it's larger than the old block. */
-        if (new_size > old_size)
-            memset((char*)mem_new + old_size, 0, new_size - old_size);
+        else
+            oskar_mem_pool_release(mem->data);
 
         /* Set the new meta-data. */
-        mem->data = (new_size > 0) ? mem_new : 0;
+        mem->data = mem_new;
         mem->num_elements = num_elements;
     }
     else if (mem->location == OSKAR_GPU)
@@ -28,6 +28,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_loop.h"
 #include "utility/oskar_device.h"
 
 #ifdef __cplusplus
@@ -51,22 +52,28 @@ void oskar_mem_scale_real(oskar_Mem* mem, double value,
     }
     if (location == OSKAR_CPU)
     {
-        size_t i;
         if (precision == OSKAR_SINGLE)
         {
             float *aa = ((float*) mem->data) + offset;
             const float value_f = (float) value;
-            for (i = 0; i < num_elements; ++i) aa[i] *= value_f;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) aa[i] *= value_f;
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else if (precision == OSKAR_DOUBLE)
         {
             double *aa = ((double*) mem->data) + offset;
-            for (i = 0; i < num_elements; ++i) aa[i] *= value;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) aa[i] *= value;
+            OSKAR_MEM_LOOP_CHUNKS_END
         }
         else *status = OSKAR_ERR_BAD_DATA_TYPE;
     }
     else
     {
+        static int handle[2]; /* Kernel handles, cached on first launch. */
         size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
         const unsigned int n = (unsigned int) num_elements;
         const unsigned int off = (unsigned int) offset;
@@ -80,6 +87,8 @@ void oskar_mem_scale_real(oskar_Mem* mem, double value,
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(
+                &handle[is_dbl], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = oskar_device_global_size(num_elements, local_size[0]);
         const oskar_Arg args[] = {
@@ -89,7 +98,8 @@ void oskar_mem_scale_real(oskar_Mem* mem, double value,
                         (const void*)&value : (const void*)&value_f},
                 {PTR_SZ, oskar_mem_buffer(mem)}
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 }
@@ -28,6 +28,7 @@
 
 #include "mem/oskar_mem.h"
 #include "mem/private_mem.h"
+#include "mem/private_mem_loop.h"
 #include "utility/oskar_device.h"
 
 #ifdef __cplusplus
@@ -37,7 +38,6 @@ extern "C" {
 void oskar_mem_set_value_real(oskar_Mem* mem, double value,
         size_t offset, size_t num_elements, int* status)
 {
-    size_t i;
     if (*status) return;
     const int type = mem->type;
     const int location = mem->location;
@@ -50,18 +50,24 @@ void oskar_mem_set_value_real(oskar_Mem* mem, double value,
         {
             double *v;
             v = (double*)(mem->data) + offset;
-            for (i = 0; i < num_elements; ++i) v[i] = value;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) v[i] = value;
+            OSKAR_MEM_LOOP_CHUNKS_END
             return;
         }
         case OSKAR_DOUBLE_COMPLEX:
         {
             double2 *v;
             v = (double2*)(mem->data) + offset;
-            for (i = 0; i < num_elements; ++i)
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i)
             {
                 v[i].x = value;
                 v[i].y = 0.0;
             }
+            OSKAR_MEM_LOOP_CHUNKS_END
             return;
         }
         case OSKAR_DOUBLE_COMPLEX_MATRIX:
@@ -73,25 +79,34 @@ void oskar_mem_set_value_real(oskar_Mem* mem, double value,
             d.b.x = d.b.y = 0.0;
             d.c.x = d.c.y = 0.0;
             d.d.x = value; d.d.y = 0.0;
-            for (i = 0; i < num_elements; ++i) v[i] = d;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) v[i] = d;
+            OSKAR_MEM_LOOP_CHUNKS_END
             return;
         }
         case OSKAR_SINGLE:
         {
             float *v;
             v = (float*)(mem->data) + offset;
-            for (i = 0; i < num_elements; ++i) v[i] = value_f;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) v[i] = value_f;
+            OSKAR_MEM_LOOP_CHUNKS_END
             return;
         }
         case OSKAR_SINGLE_COMPLEX:
         {
             float2 *v;
             v = (float2*)(mem->data) + offset;
-            for (i = 0; i < num_elements; ++i)
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i)
             {
                 v[i].x = value_f;
                 v[i].y = 0.0f;
             }
+            OSKAR_MEM_LOOP_CHUNKS_END
             return;
         }
         case OSKAR_SINGLE_COMPLEX_MATRIX:
@@ -103,7 +118,10 @@ void oskar_mem_set_value_real(oskar_Mem* mem, double value,
             d.b.x = d.b.y = 0.0f;
             d.c.x = d.c.y = 0.0f;
             d.d.x = value_f; d.d.y = 0.0f;
-            for (i = 0; i < num_elements; ++i) v[i] = d;
+            OSKAR_MEM_LOOP_CHUNKS(num_elements, start, end)
+            size_t i;
+            for (i = start; i < end; ++i) v[i] = d;
+            OSKAR_MEM_LOOP_CHUNKS_END
             return;
         }
         default:
@@ -27,41 +27,54 @@
  */
 
 #include "mem/oskar_mem.h"
+#include "mem/private_mem_loop.h"
 
 #include <math.h>
 #include <float.h>
+#include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Statistics for one chunk of the array. */
+typedef struct
+{
+    double min, max, mean, m2;
+    size_t n;
+} ChunkStats;
+
 /* Macro to update running statistics for mean and standard deviation using
  * the method of Donald Knuth in "The Art of Computer Programming"
  * vol 2, 3rd edition, page 232 */
-#define RUNNING_STATS_KNUTH \
-    if (max && val > *max) \
-        *max = val; \
-    if (min && val < *min) \
-        *min = val; \
-    if (i == 0) \
+#define CHUNK_STATS_KNUTH(FP) \
+static void chunk_stats_ ## FP(const FP* data, size_t start, size_t end, \
+        ChunkStats* st) \
+{ \
+    size_t i; \
+    double mean = 0.0, m2 = 0.0, min = DBL_MAX, max = -DBL_MAX; \
+    for (i = start; i < end; ++i) \
     { \
-        old_m = new_m = val; \
-        old_s = 0.0; \
+        const double val = (double) data[i]; \
+        const double delta = val - mean; \
+        if (val > max) max = val; \
+        if (val < min) min = val; \
+        mean += delta / (i - start + 1); \
+        m2 += delta * (val - mean); \
     } \
-    else \
-    { \
-        new_m = old_m + (val - old_m) / (i + 1); \
-        new_s = old_s + (val - old_m) * (val - new_m); \
-        old_m = new_m; \
-        old_s = new_s; \
-    }
+    st->min = min; st->max = max; st->mean = mean; st->m2 = m2; \
+    st->n = end - start; \
+}
+
+CHUNK_STATS_KNUTH(float)
+CHUNK_STATS_KNUTH(double)
 
 void oskar_mem_stats(const oskar_Mem* mem, size_t n, double* min, double* max,
         double* mean, double* std_dev, int* status)
 {
-    int type;
-    size_t i;
-    double old_m = 0.0, new_m = 0.0, old_s = 0.0, new_s = 0.0;
+    int c, type;
+    size_t count = 0;
+    double mean_ = 0.0, m2 = 0.0, min_ = DBL_MAX, max_ = -DBL_MAX;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -75,50 +88,50 @@ void oskar_mem_stats(const oskar_Mem* mem, size_t n, double* min, double* max,
 
     /* Check that the data type is single or double precision scalar. */
     type = oskar_mem_type(mem);
-    if (oskar_type_is_complex(type) || oskar_type_is_matrix(type))
+    if (type != OSKAR_SINGLE && type != OSKAR_DOUBLE)
     {
         *status = OSKAR_ERR_BAD_DATA_TYPE;
         return;
     }
 
-    /* Initialise outputs. */
-    if (max) *max = -DBL_MAX;
-    if (min) *min = DBL_MAX;
-    if (mean) *mean = 0.0;
-    if (std_dev) *std_dev = 0.0;
-
-    /* Gather statistics. */
+    /* Gather statistics for each chunk. */
+    const int num_chunks = OSKAR_MEM_NUM_CHUNKS(n);
+    ChunkStats* st = (ChunkStats*) calloc(num_chunks + 1, sizeof(ChunkStats));
     if (type == OSKAR_SINGLE)
     {
-        double val;
-        const float *data;
-        data = oskar_mem_float_const(mem, status);
-        for (i = 0; i < n; ++i)
-        {
-            val = (double) data[i];
-            RUNNING_STATS_KNUTH
-        }
+        const float *data = oskar_mem_float_const(mem, status);
+        OSKAR_MEM_LOOP_CHUNKS(n, start, end)
+        chunk_stats_float(data, start, end, &st[start / OSKAR_MEM_CHUNK_SIZE]);
+        OSKAR_MEM_LOOP_CHUNKS_END
     }
-    else if (type == OSKAR_DOUBLE)
+    else
     {
-        double val;
-        const double *data;
-        data = oskar_mem_double_const(mem, status);
-        for (i = 0; i < n; ++i)
-        {
-            val = data[i];
-            RUNNING_STATS_KNUTH
-        }
+        const double *data = oskar_mem_double_const(mem, status);
+        OSKAR_MEM_LOOP_CHUNKS(n, start, end)
+        chunk_stats_double(data, start, end, &st[start / OSKAR_MEM_CHUNK_SIZE]);
+        OSKAR_MEM_LOOP_CHUNKS_END
     }
-    else
+
+    /* Combine the chunks in order, so the result is deterministic.
+     * See Chan, Golub & LeVeque (1979), "Updating formulae and a
+     * pairwise algorithm for computing sample variances". */
+    for (c = 0; c < num_chunks; ++c)
     {
-        *status = OSKAR_ERR_BAD_DATA_TYPE;
-        return;
+        const size_t total = count + st[c].n;
+        const double delta = st[c].mean - mean_;
+        if (st[c].max > max_) max_ = st[c].max;
+        if (st[c].min < min_) min_ = st[c].min;
+        mean_ += delta * ((double) st[c].n / total);
+        m2 += st[c].m2 + delta * delta * ((double) count * st[c].n / total);
+        count = total;
     }
+    free(st);
 
-    /* Set mean and population standard deviation. */
-    if (mean) *mean = new_m;
-    if (std_dev) *std_dev = (n > 0) ? sqrt(new_s / n) : 0.0;
+    /* Set outputs, using the population standard deviation. */
+    if (max) *max = max_;
+    if (min) *min = min_;
+    if (mean) *mean = mean_;
+    if (std_dev) *std_dev = (n > 0) ? sqrt(m2 / n) : 0.0;
 }
 
 #ifdef __cplusplus
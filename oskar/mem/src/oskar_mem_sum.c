@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "mem/oskar_mem.h"
+#include "mem/private_mem_loop.h"
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Each block of the output stays in cache while all inputs are added. */
+#define MEM_SUM_CPU(FP) {\
+    FP* out_ = (FP*) oskar_mem_void(out);\
+    OSKAR_MEM_LOOP_CHUNKS(n, start, end)\
+    int k;\
+    size_t j;\
+    const FP* in0 = (const FP*) oskar_mem_void_const(in[0]);\
+    if (in0 != out_) for (j = start; j < end; ++j) out_[j] = in0[j];\
+    for (k = 1; k < num_in; ++k) {\
+        const FP* RESTRICT in_k = (const FP*) oskar_mem_void_const(in[k]);\
+        FP* RESTRICT o = out_;\
+        for (j = start; j < end; ++j) o[j] += in_k[j];\
+    }\
+    OSKAR_MEM_LOOP_CHUNKS_END }
+
+/* All pairs and chunks in one pass of the tree are independent. */
+#define MEM_SUM_PAIRS_CPU(FP) {\
+    int i;\
+    const int num_chunks = OSKAR_MEM_NUM_CHUNKS(n);\
+    const int num_items = num_pairs * num_chunks;\
+    DO_PRAGMA(omp parallel for private(i) if(num_items > 1)) \
+    for (i = 0; i < num_items; ++i) {\
+        size_t j;\
+        const int pair = i / num_chunks;\
+        const size_t start = (size_t) (i % num_chunks) * OSKAR_MEM_CHUNK_SIZE;\
+        const size_t end = (start + OSKAR_MEM_CHUNK_SIZE < n) ?\
+                start + OSKAR_MEM_CHUNK_SIZE : n;\
+        FP* RESTRICT a = (FP*) oskar_mem_void(dst[pair]);\
+        const FP* RESTRICT b = (const FP*) oskar_mem_void_const(src[pair]);\
+        for (j = start; j < end; ++j) a[j] += b[j];\
+    }\
+    }
+
+static size_t num_reals(const oskar_Mem* mem, size_t num_elements)
+{
+    if (oskar_mem_is_matrix(mem)) num_elements *= 4;
+    if (oskar_mem_is_complex(mem)) num_elements *= 2;
+    return num_elements;
+}
+
+void oskar_mem_sum(oskar_Mem* out, int num_in, const oskar_Mem* const* in,
+        size_t num_elements, int* status)
+{
+    int k, all_cpu;
+    if (*status || num_in < 1 || num_elements == 0) return;
+    const int type = oskar_mem_type(out);
+    const int precision = oskar_mem_precision(out);
+    all_cpu = (oskar_mem_location(out) == OSKAR_CPU);
+    for (k = 0; k < num_in; ++k)
+    {
+        if (oskar_mem_type(in[k]) != type)
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        if (k > 0 && in[k] == out)
+        {
+            *status = OSKAR_ERR_INVALID_ARGUMENT;
+            return;
+        }
+        if (oskar_mem_location(in[k]) != OSKAR_CPU) all_cpu = 0;
+    }
+    if (all_cpu)
+    {
+        const size_t n = num_reals(out, num_elements);
+        if (precision == OSKAR_DOUBLE)
+            MEM_SUM_CPU(double)
+        else if (precision == OSKAR_SINGLE)
+            MEM_SUM_CPU(float)
+        else
+            *status = OSKAR_ERR_BAD_DATA_TYPE;
+    }
+    else
+    {
+        /* Use the device kernels to add each input in turn. */
+        if (in[0] != out)
+            oskar_mem_copy_contents(out, in[0], 0, 0, num_elements, status);
+        for (k = 1; k < num_in; ++k)
+            oskar_mem_add(out, out, in[k], 0, 0, 0, num_elements, status);
+    }
+}
+
+void oskar_mem_sum_tree(int num, oskar_Mem* const* arrays,
+        size_t num_elements, int* status)
+{
+    int k, stride, location;
+    oskar_Mem** dst = 0;
+    const oskar_Mem** src = 0;
+    if (*status || num < 2 || num_elements == 0) return;
+    const int type = oskar_mem_type(arrays[0]);
+    const int precision = oskar_mem_precision(arrays[0]);
+    location = oskar_mem_location(arrays[0]);
+    for (k = 1; k < num; ++k)
+    {
+        if (oskar_mem_type(arrays[k]) != type)
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        if (oskar_mem_location(arrays[k]) != location)
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+    }
+    if (precision != OSKAR_DOUBLE && precision != OSKAR_SINGLE)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+    dst = (oskar_Mem**) calloc(num, sizeof(oskar_Mem*));
+    src = (const oskar_Mem**) calloc(num, sizeof(oskar_Mem*));
+    if (!dst || !src)
+    {
+        free(dst);
+        free(src);
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    const size_t n = num_reals(arrays[0], num_elements);
+    for (stride = 1; stride < num && !*status; stride *= 2)
+    {
+        int num_pairs = 0;
+        for (k = 0; k + stride < num; k += 2 * stride)
+        {
+            dst[num_pairs] = arrays[k];
+            src[num_pairs] = arrays[k + stride];
+            num_pairs++;
+        }
+        if (location == OSKAR_CPU)
+        {
+            if (precision == OSKAR_DOUBLE)
+                MEM_SUM_PAIRS_CPU(double)
+            else
+                MEM_SUM_PAIRS_CPU(float)
+        }
+        else
+        {
+            for (k = 0; k < num_pairs; ++k)
+                oskar_mem_add(dst[k], dst[k], src[k], 0, 0, 0,
+                        num_elements, status);
+        }
+    }
+    free(dst);
+    free(src);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "utility/oskar_get_error_string.h"
+#include "mem/oskar_mem.h"
+
+TEST(Mem, pool_reuse)
+{
+    int status = 0;
+    size_t allocs0, reused0, allocs1, reused1, cached;
+    const size_t n = 5000;
+    oskar_mem_pool_scope_begin();
+    oskar_mem_pool_counters(&allocs0, &reused0, 0, 0, 0);
+    for (int k = 0; k < 10; ++k)
+    {
+        oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+                n - k, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+        // Check the array is cleared, even if the memory was reused.
+        double* p = oskar_mem_double(mem, &status);
+        for (size_t i = 0; i < n - k; ++i) ASSERT_EQ(0.0, p[i]);
+        for (size_t i = 0; i < n - k; ++i) p[i] = 1.0;
+        oskar_mem_free(mem, &status);
+    }
+    oskar_mem_pool_counters(&allocs1, &reused1, 0, 0, &cached);
+    EXPECT_GE(allocs1 - allocs0, 1u);
+    EXPECT_GE(reused1 - reused0, 9u);
+    EXPECT_GE(cached, n * sizeof(double));
+    oskar_mem_pool_scope_end();
+}
+
+TEST(Mem, pool_realloc)
+{
+    int status = 0;
+    const int n1 = 1000, n2 = 100000;
+    oskar_mem_pool_scope_begin();
+    oskar_Mem* mem = oskar_mem_create(OSKAR_INT, OSKAR_CPU, n1, &status);
+    int* p = oskar_mem_int(mem, &status);
+    for (int i = 0; i < n1; ++i) p[i] = i;
+
+    // Grow the array: contents must be kept, and new elements cleared.
+    oskar_mem_realloc(mem, n2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    p = oskar_mem_int(mem, &status);
+    for (int i = 0; i < n1; ++i) ASSERT_EQ(i, p[i]);
+    for (int i = n1; i < n2; ++i) ASSERT_EQ(0, p[i]);
+
+    // Shrink and grow again, leaving the pool scope in between.
+    oskar_mem_realloc(mem, 10, &status);
+    oskar_mem_pool_scope_end();
+    oskar_mem_realloc(mem, n1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    p = oskar_mem_int(mem, &status);
+    for (int i = 0; i < 10; ++i) ASSERT_EQ(i, p[i]);
+    for (int i = 10; i < n1; ++i) ASSERT_EQ(0, p[i]);
+    oskar_mem_free(mem, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
+
+TEST(Mem, pool_large_block_exact_size)
+{
+    int status = 0;
+    size_t allocs0, allocs1, in_use0, in_use1, cached0, cached1;
+    const size_t n = ((size_t) 1 << 23) + 1; // Just over 64 MiB of doubles.
+    oskar_mem_pool_scope_begin();
+    oskar_mem_pool_counters(&allocs0, 0, &in_use0, 0, &cached0);
+    oskar_Mem* mem = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // The block must not be rounded up to the next power of two.
+    oskar_mem_pool_counters(&allocs1, 0, &in_use1, 0, 0);
+    EXPECT_EQ(1u, allocs1 - allocs0);
+    EXPECT_EQ(n * sizeof(double), in_use1 - in_use0);
+
+    // The block must not be held in the pool once it is released.
+    oskar_mem_free(mem, &status);
+    oskar_mem_pool_counters(0, 0, 0, 0, &cached1);
+    EXPECT_EQ(cached0, cached1);
+    oskar_mem_pool_scope_end();
+}
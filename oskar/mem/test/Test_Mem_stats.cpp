@@ -61,3 +61,39 @@ TEST(Mem, stats)
     oskar_mem_free(values, &status);
 }
 
+
+TEST(Mem, stats_large)
+{
+    // Use an array long enough to be split into several chunks.
+    int status = 0;
+    const size_t n = 300001;
+    oskar_Mem* values = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, n, &status);
+    float *v = oskar_mem_float(values, &status);
+    for (size_t i = 0; i < n; ++i)
+        v[i] = (float) (1000.0 + sin(0.001 * i) + (i % 7));
+
+    // Two-pass reference values.
+    double sum = 0.0, sum_sq = 0.0, ref_min = v[0], ref_max = v[0];
+    for (size_t i = 0; i < n; ++i)
+    {
+        sum += v[i];
+        if (v[i] < ref_min) ref_min = v[i];
+        if (v[i] > ref_max) ref_max = v[i];
+    }
+    const double ref_mean = sum / n;
+    for (size_t i = 0; i < n; ++i)
+        sum_sq += (v[i] - ref_mean) * (v[i] - ref_mean);
+
+    // Check values are correct, and the same on repeated calls.
+    double min, max, mean, std_dev, min2, max2, mean2, std_dev2;
+    oskar_mem_stats(values, n, &min, &max, &mean, &std_dev, &status);
+    oskar_mem_stats(values, n, &min2, &max2, &mean2, &std_dev2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_DOUBLE_EQ(ref_min, min);
+    EXPECT_DOUBLE_EQ(ref_max, max);
+    EXPECT_NEAR(ref_mean, mean, 1e-9);
+    EXPECT_NEAR(sqrt(sum_sq / n), std_dev, 1e-9);
+    EXPECT_EQ(mean, mean2);
+    EXPECT_EQ(std_dev, std_dev2);
+    oskar_mem_free(values, &status);
+}
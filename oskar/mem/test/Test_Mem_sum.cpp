@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Spans several chunks of the CPU loops, with a partial last chunk.
+static const size_t num_elements = 100003;
+
+static std::vector<oskar_Mem*> create_inputs(int type, int num, int* status)
+{
+    std::vector<oskar_Mem*> in(num);
+    for (int k = 0; k < num; ++k)
+    {
+        in[k] = oskar_mem_create(type, OSKAR_CPU, num_elements, status);
+        oskar_mem_random_gaussian(in[k], k, 1, 2, 3, 1.0, status);
+    }
+    return in;
+}
+
+static bool same(const oskar_Mem* a, const oskar_Mem* b)
+{
+    const size_t bytes = num_elements * oskar_mem_element_size(
+            oskar_mem_type(a));
+    return !memcmp(oskar_mem_void_const(a), oskar_mem_void_const(b), bytes);
+}
+
+static void check_sum(int type, int num_threads)
+{
+    int status = 0;
+    const int num = 5;
+    std::vector<oskar_Mem*> in = create_inputs(type, num, &status);
+    oskar_Mem* out = oskar_mem_create(type, OSKAR_CPU, num_elements, &status);
+    oskar_Mem* ref = oskar_mem_create_copy(in[0], OSKAR_CPU, &status);
+    for (int k = 1; k < num; ++k)
+        oskar_mem_add(ref, ref, in[k], 0, 0, 0, num_elements, &status);
+
+    // Sum into a separate output array.
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(num_threads);
+#else
+    (void) num_threads;
+#endif
+    oskar_mem_sum(out, num, &in[0], num_elements, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(same(out, ref));
+
+    // Sum into the first input array.
+    oskar_mem_sum(in[0], num, &in[0], num_elements, &status);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(same(in[0], ref));
+
+    // Check that the output cannot be one of the other inputs.
+    oskar_mem_sum(in[1], num, &in[0], num_elements, &status);
+    EXPECT_EQ((int) OSKAR_ERR_INVALID_ARGUMENT, status);
+    status = 0;
+
+    for (int k = 0; k < num; ++k) oskar_mem_free(in[k], &status);
+    oskar_mem_free(out, &status);
+    oskar_mem_free(ref, &status);
+}
+
+TEST(Mem, sum_double_complex)
+{
+    check_sum(OSKAR_DOUBLE_COMPLEX, 1);
+    check_sum(OSKAR_DOUBLE_COMPLEX, 4);
+}
+
+TEST(Mem, sum_single)
+{
+    check_sum(OSKAR_SINGLE, 1);
+    check_sum(OSKAR_SINGLE, 4);
+}
+
+TEST(Mem, sum_tree)
+{
+    for (int num = 1; num <= 7; ++num)
+    {
+        int status = 0;
+        std::vector<oskar_Mem*> in = create_inputs(OSKAR_DOUBLE_COMPLEX,
+                num, &status);
+        oskar_Mem* ref = oskar_mem_create_copy(in[0], OSKAR_CPU, &status);
+        for (int k = 1; k < num; ++k)
+            oskar_mem_add(ref, ref, in[k], 0, 0, 0, num_elements, &status);
+        oskar_mem_sum_tree(num, &in[0], num_elements, &status);
+        ASSERT_EQ(0, status) << oskar_get_error_string(status);
+        const double* a = oskar_mem_double_const(in[0], &status);
+        const double* b = oskar_mem_double_const(ref, &status);
+        for (size_t i = 0; i < 2 * num_elements; ++i)
+            ASSERT_NEAR(b[i], a[i], 1e-12);
+        for (int k = 0; k < num; ++k) oskar_mem_free(in[k], &status);
+        oskar_mem_free(ref, &status);
+    }
+}
+
+TEST(Mem, sum_type_mismatch)
+{
+    int status = 0;
+    oskar_Mem* in[2];
+    in[0] = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_elements, &status);
+    in[1] = oskar_mem_create(OSKAR_SINGLE, OSKAR_CPU, num_elements, &status);
+    oskar_mem_sum(in[0], 2, in, num_elements, &status);
+    EXPECT_EQ((int) OSKAR_ERR_TYPE_MISMATCH, status);
+    status = 0;
+    oskar_mem_sum_tree(2, in, num_elements, &status);
+    EXPECT_EQ((int) OSKAR_ERR_TYPE_MISMATCH, status);
+    status = 0;
+    oskar_mem_free(in[0], &status);
+    oskar_mem_free(in[1], &status);
+}
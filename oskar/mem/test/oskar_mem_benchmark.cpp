@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+// Serial reference versions of the element-wise operations.
+template<typename FP>
+static void add_ref(size_t n, const FP* a, const FP* b, FP* c)
+{
+    for (size_t i = 0; i < n; ++i) c[i] = a[i] + b[i];
+}
+
+template<typename FP>
+static void multiply_ref(size_t n, const FP* a, const FP* b, FP* c)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        c[2*i]     = a[2*i] * b[2*i]   - a[2*i+1] * b[2*i+1];
+        c[2*i + 1] = a[2*i] * b[2*i+1] + a[2*i+1] * b[2*i];
+    }
+}
+
+template<typename FP>
+static void scale_ref(size_t n, FP* a, FP value)
+{
+    for (size_t i = 0; i < n; ++i) a[i] *= value;
+}
+
+static bool same(const oskar_Mem* a, const oskar_Mem* b)
+{
+    const size_t bytes = oskar_mem_length(a) * oskar_mem_element_size(
+            oskar_mem_type(a));
+    return !memcmp(oskar_mem_void_const(a), oskar_mem_void_const(b), bytes);
+}
+
+static void report(const char* name, size_t n, double t_ref, double t,
+        bool ok)
+{
+    if (t_ref > 0.0)
+        printf("%-24s %11lu  %10.6f  %10.6f  %6.2fx  %s\n", name,
+                (unsigned long) n, t_ref, t, t_ref / t, ok ? "same" : "DIFF");
+    else
+        printf("%-24s %11lu  %10s  %10.6f  %7s  %s\n", name,
+                (unsigned long) n, "-", t, "-", ok ? "ok" : "FAIL");
+}
+
+template<typename FP>
+static void run(int type, size_t n, int niter, int* status)
+{
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_Mem *a, *b, *c, *c_ref;
+    double t_ref = 0.0, t = 0.0;
+    a = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, n, status);
+    b = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, n, status);
+    c = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, n, status);
+    c_ref = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, n, status);
+    oskar_mem_random_range(a, -1.0, 1.0, status);
+    oskar_mem_random_range(b, -1.0, 1.0, status);
+    if (*status) return;
+    const FP* a_ = (const FP*) oskar_mem_void_const(a);
+    const FP* b_ = (const FP*) oskar_mem_void_const(b);
+    FP* c_ref_ = (FP*) oskar_mem_void(c_ref);
+
+    // Add (as real arrays of length 2n).
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k) add_ref(2 * n, a_, b_, c_ref_);
+    t_ref = oskar_timer_elapsed(tmr) / niter;
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k)
+        oskar_mem_add(c, a, b, 0, 0, 0, n, status);
+    t = oskar_timer_elapsed(tmr) / niter;
+    report("oskar_mem_add", n, t_ref, t, same(c, c_ref));
+
+    // Complex multiply.
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k) multiply_ref(n, a_, b_, c_ref_);
+    t_ref = oskar_timer_elapsed(tmr) / niter;
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k)
+        oskar_mem_multiply(c, a, b, 0, 0, 0, n, status);
+    t = oskar_timer_elapsed(tmr) / niter;
+    report("oskar_mem_multiply", n, t_ref, t, same(c, c_ref));
+
+    // Scale (a single iteration, to compare against the same input).
+    oskar_mem_copy(c, a, status);
+    oskar_mem_copy(c_ref, a, status);
+    oskar_timer_start(tmr);
+    scale_ref(2 * n, c_ref_, (FP) 1.5);
+    t_ref = oskar_timer_elapsed(tmr);
+    oskar_timer_start(tmr);
+    oskar_mem_scale_real(c, 1.5, 0, n, status);
+    t = oskar_timer_elapsed(tmr);
+    report("oskar_mem_scale_real", n, t_ref, t, same(c, c_ref));
+
+    // Operations without a reference implementation.
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k) oskar_mem_add_real(c, 1.0, status);
+    report("oskar_mem_add_real", n, 0.0,
+            oskar_timer_elapsed(tmr) / niter, !*status);
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k)
+        oskar_mem_set_value_real(c, 2.0, 0, n, status);
+    report("oskar_mem_set_value_real", n, 0.0,
+            oskar_timer_elapsed(tmr) / niter, !*status);
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k)
+    {
+        oskar_Mem* t = oskar_mem_convert_precision(a,
+                type == OSKAR_DOUBLE ? OSKAR_SINGLE : OSKAR_DOUBLE, status);
+        oskar_mem_free(t, status);
+    }
+    report("oskar_mem_convert_prec.", n, 0.0,
+            oskar_timer_elapsed(tmr) / niter, !*status);
+    double min1, max1, mean1, std1, min2, max2, mean2, std2;
+    oskar_Mem* a_real = oskar_mem_create(type, OSKAR_CPU, 2 * n, status);
+    memcpy(oskar_mem_void(a_real), a_, 2 * n * sizeof(FP));
+    oskar_timer_start(tmr);
+    for (int k = 0; k < niter; ++k)
+        oskar_mem_stats(a_real, 2 * n, &min1, &max1, &mean1, &std1, status);
+    t = oskar_timer_elapsed(tmr) / niter;
+    oskar_mem_stats(a_real, 2 * n, &min2, &max2, &mean2, &std2, status);
+    report("oskar_mem_stats", n, 0.0, t, min1 == min2 && max1 == max2 &&
+            mean1 == mean2 && std1 == std2);
+
+    oskar_mem_free(a_real, status);
+    oskar_mem_free(a, status);
+    oskar_mem_free(b, status);
+    oskar_mem_free(c, status);
+    oskar_mem_free(c_ref, status);
+    oskar_timer_free(tmr);
+}
+
+// Sums K grids of the given side length, as when merging grids from
+// several threads or devices.
+template<typename FP>
+static void run_sum(int type, int side, int num_grids, int niter,
+        int* status)
+{
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    const size_t n = (size_t) side * side;
+    oskar_Mem** in = (oskar_Mem**) calloc(num_grids, sizeof(oskar_Mem*));
+    oskar_Mem *out, *out_ref;
+    double t_ref = 0.0, t = 0.0;
+    for (int k = 0; k < num_grids; ++k)
+    {
+        in[k] = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, n, status);
+        oskar_mem_random_range(in[k], -1.0, 1.0, status);
+    }
+    out = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, n, status);
+    out_ref = oskar_mem_create(type | OSKAR_COMPLEX, OSKAR_CPU, n, status);
+    if (*status) return;
+    FP* out_ref_ = (FP*) oskar_mem_void(out_ref);
+
+    // Serial reference, adding each grid in turn.
+    oskar_timer_start(tmr);
+    for (int i = 0; i < niter; ++i)
+    {
+        memcpy(out_ref_, oskar_mem_void_const(in[0]), 2 * n * sizeof(FP));
+        for (int k = 1; k < num_grids; ++k)
+            add_ref(2 * n, (const FP*) out_ref_,
+                    (const FP*) oskar_mem_void_const(in[k]), out_ref_);
+    }
+    t_ref = oskar_timer_elapsed(tmr) / niter;
+
+    // Repeated calls to oskar_mem_add.
+    oskar_timer_start(tmr);
+    for (int i = 0; i < niter; ++i)
+    {
+        oskar_mem_copy_contents(out, in[0], 0, 0, n, status);
+        for (int k = 1; k < num_grids; ++k)
+            oskar_mem_add(out, out, in[k], 0, 0, 0, n, status);
+    }
+    t = oskar_timer_elapsed(tmr) / niter;
+    report("oskar_mem_add (loop)", n, t_ref, t, same(out, out_ref));
+
+    // Blocked sum of all grids.
+    oskar_timer_start(tmr);
+    for (int i = 0; i < niter; ++i)
+        oskar_mem_sum(out, num_grids, in, n, status);
+    t = oskar_timer_elapsed(tmr) / niter;
+    report("oskar_mem_sum", n, t_ref, t, same(out, out_ref));
+
+    // In-place tree sum (a single iteration, as it overwrites the input).
+    oskar_timer_start(tmr);
+    oskar_mem_sum_tree(num_grids, in, n, status);
+    report("oskar_mem_sum_tree", n, 0.0, oskar_timer_elapsed(tmr), !*status);
+
+    for (int k = 0; k < num_grids; ++k) oskar_mem_free(in[k], status);
+    free(in);
+    oskar_mem_free(out, status);
+    oskar_mem_free(out_ref, status);
+    oskar_timer_free(tmr);
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_mem_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-max", "Largest number of complex elements.", 1,
+            "16777216", false);
+    opt.add_flag("-sp", "Use single precision (default: double precision)");
+    opt.add_flag("-n", "Number of iterations", 1, "4", false);
+    opt.add_flag("-grids", "Number of grids to sum.", 1, "4", false);
+    opt.add_flag("-grid_max", "Largest grid side length to sum "
+            "(from 4096, doubling).", 1, "4096", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const size_t max_size = (size_t) opt.get_int("-max");
+    const int niter = opt.get_int("-n");
+    const int type = opt.is_set("-sp") ? OSKAR_SINGLE : OSKAR_DOUBLE;
+    const int num_grids = opt.get_int("-grids");
+    const int grid_max = opt.get_int("-grid_max");
+    printf("%-24s %11s  %10s  %10s  %7s\n", "Function", "Elements",
+            "Serial (s)", "Time (s)", "Speedup");
+    for (size_t n = 1024; n <= max_size && !status; n *= 16)
+    {
+        if (type == OSKAR_DOUBLE)
+            run<double>(type, n, niter, &status);
+        else
+            run<float>(type, n, niter, &status);
+    }
+    for (int side = 4096; side <= grid_max && !status; side *= 2)
+    {
+        if (type == OSKAR_DOUBLE)
+            run_sum<double>(type, side, num_grids, niter, &status);
+        else
+            run_sum<float>(type, side, num_grids, niter, &status);
+    }
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -27,7 +27,7 @@
  */
 
 #include "oskar_settings_load_ionosphere.h"
-#include "oskar_settings_load_tid_parameter_file.h"
+#include "sky/oskar_settings_load_tid_parameter_file.h"
 
 #include <cstring>
 #include <cstdlib>
@@ -37,6 +37,16 @@
 #include <settings/old/oskar_Settings_old.h>
 #include <mem/oskar_mem.h>
 
+/**
+ * @brief
+ * Radius of the Earth used by the TID model, in km.
+ *
+ * @details
+ * The TID wavelengths and speeds are converted to angles on a sphere
+ * of this radius plus the screen height.
+ */
+#define OSKAR_TID_EARTH_RADIUS_KM 6365.0
+
 #ifdef __cplusplus
 extern "C" {
 #endif
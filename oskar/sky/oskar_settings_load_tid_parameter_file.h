@@ -30,16 +30,17 @@
 #define OSKAR_SETTINGS_LOAD_TID_PARAMETER_FILE_H_
 
 /**
- * @file oskar_load_tid_parameter_file.h
+ * @file oskar_settings_load_tid_parameter_file.h
  */
 
 #include <oskar_global.h>
-#include <oskar_Settings_old.h>
+#include <settings/old/oskar_Settings_old.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+OSKAR_EXPORT
 void oskar_settings_load_tid_parameter_file(oskar_SettingsTIDscreen* settings,
         const char* filename, int* status);
 
@@ -45,7 +45,7 @@ void oskar_evaluate_tec_tid(oskar_Mem* tec, int num_directions,
     double pp_tec;
     double amp, w, th, v; /* TID parameters */
     double time;
-    double earth_radius = 6365.0; /* km -- FIXME */
+    const double earth_radius = OSKAR_TID_EARTH_RADIUS_KM;
     int status = 0;
 
     /* TODO check types, dimensions etc of memory */
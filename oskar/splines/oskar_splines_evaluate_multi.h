@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_SPLINES_EVALUATE_MULTI_H_
+#define OSKAR_SPLINES_EVALUATE_MULTI_H_
+
+/**
+ * @file oskar_splines_evaluate_multi.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Evaluates several surfaces fitted by splines at the same positions.
+ *
+ * @details
+ * This function evaluates a set of surfaces fitted by splines at the
+ * given positions, and is equivalent to calling oskar_splines_evaluate()
+ * for each one in turn, where the output from spline \p s is written
+ * at offset \p offset_out + \p s.
+ *
+ * If the data are in CPU memory, all surfaces are evaluated in a single
+ * pass over the points. Where consecutive surfaces use the same knots,
+ * the knot interval and the B-spline basis functions are found only once
+ * for each point and applied to each set of coefficients in turn.
+ *
+ * @param[in] num_splines Number of surfaces to evaluate.
+ * @param[in] splines     Array of pointers to spline data structures.
+ * @param[in] num_points  Number of positions.
+ * @param[in] x           List of x coordinates.
+ * @param[in] y           List of y coordinates.
+ * @param[in] stride_out  Stride between output values for each point.
+ * @param[in] offset_out  Offset of output value for the first surface.
+ * @param[out] output     Output values.
+ * @param[in,out] status  Status return code.
+ */
+OSKAR_EXPORT
+void oskar_splines_evaluate_multi(int num_splines,
+        const oskar_Splines* const* splines, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y, int stride_out,
+        int offset_out, oskar_Mem* output, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_SPLINES_EVALUATE_MULTI_H_ */
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "splines/define_dierckx_bispev_bicubic.h"
+#include "splines/oskar_splines.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of surfaces that can be evaluated together. */
+#define MAX_SPLINES 8
+
+/* Finds the knot interval containing the (clamped) coordinate. */
+#define FIND_INTERVAL(T, N, X, L) {\
+    const int nk1 = N - 4;\
+    if (X < T[3]) X = T[3];\
+    if (X > T[nk1]) X = T[nk1];\
+    L = 4; while (!(X < T[L] || L == nk1)) L++; }
+
+/* Evaluates the basis functions for all surfaces that share the knots. */
+#define EVALUATE_BASIS(FP, TX, NX, TY, NY, X, Y, W, L1) {\
+    int l, lx, ly;\
+    FP hh[3], wx[4], wy[4], x_ = X, y_ = Y;\
+    FIND_INTERVAL(TX, NX, x_, lx)\
+    FPBSPL(FP, TX, 3, x_, lx, wx)\
+    FIND_INTERVAL(TY, NY, y_, ly)\
+    FPBSPL(FP, TY, 3, y_, ly, wy)\
+    for (l = 0; l < 4; ++l) {\
+        W[4 * l + 0] = wx[l] * wy[0];\
+        W[4 * l + 1] = wx[l] * wy[1];\
+        W[4 * l + 2] = wx[l] * wy[2];\
+        W[4 * l + 3] = wx[l] * wy[3];\
+    }\
+    L1 = (lx - 4) * (NY - 4) + (ly - 4); }
+
+/* Applies the basis functions to a set of coefficients. */
+#define APPLY_BASIS(FP, C, NY, W, L1, OUT) {\
+    int l;\
+    FP t = (FP)0;\
+    const FP* cs = C + L1;\
+    for (l = 0; l < 4; ++l, cs += (NY - 4)) {\
+        t += cs[0] * W[4 * l + 0];\
+        t += cs[1] * W[4 * l + 1];\
+        t += cs[2] * W[4 * l + 2];\
+        t += cs[3] * W[4 * l + 3];\
+    }\
+    OUT = t; }
+
+static void splines_evaluate_multi_float(const int num_splines,
+        const float* const* tx, const int* nx,
+        const float* const* ty, const int* ny,
+        const float* const* c, const int* same_knots, const int n,
+        const float* x, const float* y, const int stride_out,
+        const int offset_out, float* z)
+{
+    int i;
+#pragma omp parallel for private(i)
+    for (i = 0; i < n; ++i)
+    {
+        int l1 = 0, s;
+        float w[16] = {0.0f};
+        float* out = z + i * stride_out + offset_out;
+        for (s = 0; s < num_splines; ++s)
+        {
+            if (!c[s])
+            {
+                out[s] = 0.0f;
+                continue;
+            }
+            if (!same_knots[s])
+                EVALUATE_BASIS(float, tx[s], nx[s], ty[s], ny[s],
+                        x[i], y[i], w, l1)
+            APPLY_BASIS(float, c[s], ny[s], w, l1, out[s])
+        }
+    }
+}
+
+static void splines_evaluate_multi_double(const int num_splines,
+        const double* const* tx, const int* nx,
+        const double* const* ty, const int* ny,
+        const double* const* c, const int* same_knots, const int n,
+        const double* x, const double* y, const int stride_out,
+        const int offset_out, double* z)
+{
+    int i;
+#pragma omp parallel for private(i)
+    for (i = 0; i < n; ++i)
+    {
+        int l1 = 0, s;
+        double w[16] = {0.0};
+        double* out = z + i * stride_out + offset_out;
+        for (s = 0; s < num_splines; ++s)
+        {
+            if (!c[s])
+            {
+                out[s] = 0.0;
+                continue;
+            }
+            if (!same_knots[s])
+                EVALUATE_BASIS(double, tx[s], nx[s], ty[s], ny[s],
+                        x[i], y[i], w, l1)
+            APPLY_BASIS(double, c[s], ny[s], w, l1, out[s])
+        }
+    }
+}
+
+/* Returns true if both splines use the same knots. */
+static int splines_share_knots(const oskar_Splines* a,
+        const oskar_Splines* b, int* status)
+{
+    const int nx = oskar_splines_num_knots_x_theta(a);
+    const int ny = oskar_splines_num_knots_y_phi(a);
+    if (!oskar_splines_have_coeffs(a) || !oskar_splines_have_coeffs(b))
+        return 0;
+    if (a == b) return 1;
+    if (oskar_splines_num_knots_x_theta(b) != nx ||
+            oskar_splines_num_knots_y_phi(b) != ny)
+        return 0;
+    return !oskar_mem_different(oskar_splines_knots_x_theta_const(a),
+            oskar_splines_knots_x_theta_const(b), nx, status) &&
+            !oskar_mem_different(oskar_splines_knots_y_phi_const(a),
+                    oskar_splines_knots_y_phi_const(b), ny, status);
+}
+
+void oskar_splines_evaluate_multi(int num_splines,
+        const oskar_Splines* const* splines, int num_points,
+        const oskar_Mem* x, const oskar_Mem* y, int stride_out,
+        int offset_out, oskar_Mem* output, int* status)
+{
+    int s, nx[MAX_SPLINES], ny[MAX_SPLINES], same_knots[MAX_SPLINES];
+    if (*status || num_splines <= 0) return;
+    const int type = oskar_mem_type(x);
+    const int location = oskar_mem_location(output);
+
+    /* Evaluate each surface separately if not using the CPU. */
+    if (location != OSKAR_CPU || num_splines > MAX_SPLINES)
+    {
+        for (s = 0; s < num_splines; ++s)
+            oskar_splines_evaluate(splines[s], num_points, x, y,
+                    stride_out, offset_out + s, output, status);
+        return;
+    }
+    if (type != oskar_mem_type(y))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    if (location != oskar_mem_location(x) ||
+            location != oskar_mem_location(y))
+    {
+        *status = OSKAR_ERR_LOCATION_MISMATCH;
+        return;
+    }
+
+    /* Find out which surfaces can reuse the basis functions of the
+     * previous one. */
+    for (s = 0; s < num_splines; ++s)
+    {
+        if (type != oskar_splines_precision(splines[s]))
+        {
+            *status = OSKAR_ERR_TYPE_MISMATCH;
+            return;
+        }
+        if (location != oskar_splines_mem_location(splines[s]))
+        {
+            *status = OSKAR_ERR_LOCATION_MISMATCH;
+            return;
+        }
+        nx[s] = oskar_splines_num_knots_x_theta(splines[s]);
+        ny[s] = oskar_splines_num_knots_y_phi(splines[s]);
+        same_knots[s] = (s > 0) &&
+                splines_share_knots(splines[s - 1], splines[s], status);
+    }
+    if (type == OSKAR_SINGLE)
+    {
+        const float *tx[MAX_SPLINES], *ty[MAX_SPLINES], *c[MAX_SPLINES];
+        for (s = 0; s < num_splines; ++s)
+        {
+            const int have_coeffs = oskar_splines_have_coeffs(splines[s]);
+            tx[s] = oskar_mem_float_const(
+                    oskar_splines_knots_x_theta_const(splines[s]), status);
+            ty[s] = oskar_mem_float_const(
+                    oskar_splines_knots_y_phi_const(splines[s]), status);
+            c[s] = have_coeffs ? oskar_mem_float_const(
+                    oskar_splines_coeff_const(splines[s]), status) : 0;
+        }
+        if (*status) return;
+        splines_evaluate_multi_float(num_splines, tx, nx, ty, ny, c,
+                same_knots, num_points, oskar_mem_float_const(x, status),
+                oskar_mem_float_const(y, status), stride_out, offset_out,
+                oskar_mem_float(output, status));
+    }
+    else if (type == OSKAR_DOUBLE)
+    {
+        const double *tx[MAX_SPLINES], *ty[MAX_SPLINES], *c[MAX_SPLINES];
+        for (s = 0; s < num_splines; ++s)
+        {
+            const int have_coeffs = oskar_splines_have_coeffs(splines[s]);
+            tx[s] = oskar_mem_double_const(
+                    oskar_splines_knots_x_theta_const(splines[s]), status);
+            ty[s] = oskar_mem_double_const(
+                    oskar_splines_knots_y_phi_const(splines[s]), status);
+            c[s] = have_coeffs ? oskar_mem_double_const(
+                    oskar_splines_coeff_const(splines[s]), status) : 0;
+        }
+        if (*status) return;
+        splines_evaluate_multi_double(num_splines, tx, nx, ty, ny, c,
+                same_knots, num_points, oskar_mem_double_const(x, status),
+                oskar_mem_double_const(y, status), stride_out, offset_out,
+                oskar_mem_double(output, status));
+    }
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "splines/oskar_splines.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdlib>
+
+static oskar_Splines* fit_surface(int num_x, int num_y, double a, double b,
+        int* status)
+{
+    const int n = num_x * num_y;
+    oskar_Mem *x, *y, *z, *w;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, status);
+    w = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, n, status);
+    double *x_ = oskar_mem_double(x, status), *y_ = oskar_mem_double(y, status);
+    double *z_ = oskar_mem_double(z, status), *w_ = oskar_mem_double(w, status);
+    for (int j = 0, i = 0; j < num_y; ++j)
+    {
+        for (int k = 0; k < num_x; ++k, ++i)
+        {
+            x_[i] = (double)k / (num_x - 1);
+            y_[i] = (double)j / (num_y - 1);
+            z_[i] = sin(a * x_[i]) * cos(b * y_[i]);
+            w_[i] = 1.0;
+        }
+    }
+    double err = 0.01;
+    oskar_Splines* s = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, status);
+    oskar_splines_fit(s, n, x_, y_, z_, w_, OSKAR_SPLINES_LINEAR, 1,
+            &err, 1.5, 1.0, 1e-14, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(z, status);
+    oskar_mem_free(w, status);
+    return s;
+}
+
+TEST(splines, evaluate_multi)
+{
+    int status = 0;
+    const int num_splines = 4, num_points = 1000;
+
+    // Fit two different surfaces, and make a copy of each with scaled
+    // coefficients so that some consecutive surfaces share knots.
+    oskar_Splines* splines[num_splines];
+    splines[0] = fit_surface(30, 25, 3.0, 2.0, &status);
+    splines[1] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_splines_copy(splines[1], splines[0], &status);
+    oskar_mem_scale_real(oskar_splines_coeff(splines[1]), -2.0,
+            0, oskar_mem_length(oskar_splines_coeff(splines[1])), &status);
+    splines[2] = fit_surface(20, 35, 1.0, 5.0, &status);
+    splines[3] = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, &status);
+    oskar_splines_copy(splines[3], splines[2], &status);
+    oskar_mem_scale_real(oskar_splines_coeff(splines[3]), 0.5,
+            0, oskar_mem_length(oskar_splines_coeff(splines[3])), &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Generate evaluation points, including some outside the fitted region.
+    oskar_Mem* x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double *x_ = oskar_mem_double(x, &status), *y_ = oskar_mem_double(y, &status);
+    srand(1);
+    for (int i = 0; i < num_points; ++i)
+    {
+        x_[i] = 1.1 * rand() / (double)RAND_MAX - 0.05;
+        y_[i] = 1.1 * rand() / (double)RAND_MAX - 0.05;
+    }
+
+    // Evaluate surfaces one at a time, and all together.
+    oskar_Mem* out1 = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points * num_splines, &status);
+    oskar_Mem* out2 = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points * num_splines, &status);
+    for (int s = 0; s < num_splines; ++s)
+        oskar_splines_evaluate(splines[s], num_points, x, y,
+                num_splines, s, out1, &status);
+    oskar_splines_evaluate_multi(num_splines, splines, num_points, x, y,
+            num_splines, 0, out2, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check results are consistent.
+    const double* a = oskar_mem_double_const(out1, &status);
+    const double* b = oskar_mem_double_const(out2, &status);
+    for (int i = 0; i < num_points * num_splines; ++i)
+        ASSERT_NEAR(a[i], b[i], 1e-12);
+
+    // Free memory.
+    for (int s = 0; s < num_splines; ++s)
+        oskar_splines_free(splines[s], &status);
+    oskar_mem_free(x, &status);
+    oskar_mem_free(y, &status);
+    oskar_mem_free(out1, &status);
+    oskar_mem_free(out2, &status);
+}
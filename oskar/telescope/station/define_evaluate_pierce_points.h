@@ -0,0 +1,36 @@
+/* Copyright (c) 2020, The OSKAR Developers. See LICENSE file. */
+
+/*
+ * Evaluates the pierce point through a thin screen for the direction
+ * X, Y, Z (unit vector in the station ENU frame).
+ *
+ * ST_X, ST_Y, ST_Z are the station ECEF coordinates, SIN_L, COS_L, SIN_B
+ * and COS_B are the sine and cosine of the station longitude and latitude,
+ * NORM_XYZ is the distance from the centre of the Earth to the station
+ * and R_SCREEN is the Earth radius plus the screen height.
+ *
+ * Using sin(el) = Z and cos(alpha_prime) = sqrt(1 - sin^2(alpha_prime)),
+ * only the final conversion to longitude and latitude needs atan2.
+ */
+#define OSKAR_PIERCE_POINT(FP, X, Y, Z, ST_X, ST_Y, ST_Z,\
+        SIN_L, COS_L, SIN_B, COS_B, NORM_XYZ, R_SCREEN, H_SCREEN,\
+        PP_LON, PP_LAT, PP_SEC) {\
+    FP scale_, px_, py_, pz_;\
+    if (Z < (FP)1 - (FP)1e-10) {\
+        const FP cos_el_ = sqrt((FP)1 - Z * Z);\
+        const FP sin_a_ = (cos_el_ * (NORM_XYZ)) / (R_SCREEN);\
+        const FP cos_a_ = sqrt((FP)1 - sin_a_ * sin_a_);\
+        PP_SEC = (FP)1 / cos_a_;\
+        scale_ = (R_SCREEN) * (cos_el_ * cos_a_ - Z * sin_a_) / cos_el_;\
+    } else {\
+        PP_SEC = (FP)1;\
+        scale_ = (H_SCREEN);\
+    }\
+    px_ = -X * SIN_L - Y * SIN_B * COS_L + Z * COS_B * COS_L;\
+    py_ =  X * COS_L - Y * SIN_B * SIN_L + Z * COS_B * SIN_L;\
+    pz_ =  Y * COS_B + Z * SIN_B;\
+    px_ = (ST_X) + px_ * scale_;\
+    py_ = (ST_Y) + py_ * scale_;\
+    pz_ = (ST_Z) + pz_ * scale_;\
+    PP_LON = atan2(py_, px_);\
+    PP_LAT = atan2(pz_, sqrt(px_ * px_ + py_ * py_));}
@@ -51,7 +51,8 @@ enum OSKAR_ELEMENT_TAGS
 {
     OSKAR_ELEMENT_TAG_SURFACE_TYPE = 1,
     OSKAR_ELEMENT_TAG_COORD_SYS = 2,
-    OSKAR_ELEMENT_TAG_MAX_RADIUS = 3
+    OSKAR_ELEMENT_TAG_MAX_RADIUS = 3,
+    OSKAR_ELEMENT_TAG_FIT_KEY = 4
 };
 
 enum OSKAR_ELEMENT_SURFACE_TYPE
@@ -90,6 +91,7 @@ enum OSKAR_ELEMENT_TAPER
 #include <telescope/station/element/oskar_element_create.h>
 #include <telescope/station/element/oskar_element_different.h>
 #include <telescope/station/element/oskar_element_evaluate.h>
+#include <telescope/station/element/oskar_element_fit_key.h>
 #include <telescope/station/element/oskar_element_free.h>
 #include <telescope/station/element/oskar_element_load.h>
 #include <telescope/station/element/oskar_element_load_cst.h>
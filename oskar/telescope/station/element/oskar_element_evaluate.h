@@ -62,6 +62,9 @@ extern "C" {
  * @param[in,out] theta     Pointer to work array for computing theta values.
  * @param[in,out] phi_x     Pointer to work array for computing phi values.
  * @param[in,out] phi_y     Pointer to work array for computing phi values.
+ * @param[in,out] sph_wave_work Work array for spherical wave coefficients
+ *                          interpolated in frequency. If NULL, the
+ *                          coefficients at the nearest frequency are used.
  * @param[in] offset_out    Start offset into output array.
  * @param[in,out] output    Pointer to output array.
  * @param[in,out] status    Status return code.
@@ -82,6 +85,7 @@ void oskar_element_evaluate(
         oskar_Mem* theta,
         oskar_Mem* phi_x,
         oskar_Mem* phi_y,
+        oskar_Mem* sph_wave_work,
         int offset_out,
         oskar_Mem* output,
         int* status);
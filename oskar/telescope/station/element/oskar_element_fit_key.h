@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_ELEMENT_FIT_KEY_H_
+#define OSKAR_ELEMENT_FIT_KEY_H_
+
+/**
+ * @file oskar_element_fit_key.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Returns a key that identifies an element pattern fit.
+ *
+ * @details
+ * The key combines a CRC-32C checksum of the input file with the fitting
+ * parameters and the library version, so that an existing fit can be
+ * reused if none of these have changed.
+ *
+ * The returned string must be deallocated using free() when no longer needed.
+ * NULL is returned if the input file cannot be read.
+ *
+ * @param[in] input_file           Path to the CST or scalar input file.
+ * @param[in] port                 Port number: 1 for X, 2 for Y, 0 for both
+ *                                 or for scalar data.
+ * @param[in] freq_hz              Frequency of the data, in Hz.
+ * @param[in] closeness            Target average fractional error.
+ * @param[in] closeness_inc        Factor by which to increase the error.
+ * @param[in] ignore_at_poles      If set, data at the poles are ignored.
+ * @param[in] ignore_below_horizon If set, data below the horizon are ignored.
+ */
+OSKAR_EXPORT
+char* oskar_element_fit_key(const char* input_file, int port, double freq_hz,
+        double closeness, double closeness_inc, int ignore_at_poles,
+        int ignore_below_horizon);
+
+/**
+ * @brief
+ * Returns true if an element fit file was written with the given key.
+ *
+ * @details
+ * Returns false if the file does not exist, does not contain a key,
+ * or if the key is NULL.
+ *
+ * @param[in] filename  Path to the element fit file.
+ * @param[in] key       Key returned by oskar_element_fit_key().
+ */
+OSKAR_EXPORT
+int oskar_element_fit_key_matches(const char* filename, const char* key);
+
+/**
+ * @brief
+ * Appends a fit key to an element fit file.
+ *
+ * @details
+ * Nothing is written if the key is NULL.
+ *
+ * @param[in] filename   Path to the element fit file.
+ * @param[in] key        Key returned by oskar_element_fit_key().
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_element_fit_key_write(const char* filename, const char* key,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_ELEMENT_FIT_KEY_H_ */
@@ -56,6 +56,7 @@ struct oskar_Element
     int coord_sys;
     double max_radius_rad;
     int num_freq;
+    int interpolate_freq; /* If set, interpolate coefficients in frequency. */
     double* freqs_hz; /* Array of frequencies in Hz. */
     oskar_Mem **filename_x, **filename_y, **filename_scalar;
 
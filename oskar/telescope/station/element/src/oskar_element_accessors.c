@@ -91,6 +91,11 @@ const double* oskar_element_freqs_hz_const(const oskar_Element* data)
     return data->freqs_hz;
 }
 
+int oskar_element_interpolate_freq(const oskar_Element* data)
+{
+    return data->interpolate_freq;
+}
+
 int oskar_element_is_isotropic(const oskar_Element* data)
 {
     return data->element_type == OSKAR_ELEMENT_TYPE_ISOTROPIC;
@@ -178,6 +183,11 @@ void oskar_element_set_cosine_power(oskar_Element* data, double value)
     data->cosine_power = value;
 }
 
+void oskar_element_set_interpolate_freq(oskar_Element* data, int value)
+{
+    data->interpolate_freq = value;
+}
+
 void oskar_element_set_dipole_length(oskar_Element* data, double value,
         const char* units, int* status)
 {
@@ -62,6 +62,7 @@ int oskar_element_different(const oskar_Element* a, const oskar_Element* b,
 
     /* Check frequency-dependent data. */
     if (a->num_freq != b->num_freq) return 1;
+    if (a->interpolate_freq != b->interpolate_freq) return 1;
     for (i = 0; i < b->num_freq; ++i)
     {
         if (a->freqs_hz[i] != b->freqs_hz[i]) return 1;
@@ -46,6 +46,12 @@
 extern "C" {
 #endif
 
+static void find_freq_bracket(double frequency_hz, int num_freq,
+        const double* freqs_hz, int* id0, int* id1, double* weight);
+static void interpolate_spherical_wave_coeff(const oskar_Element* model,
+        int id0, int id1, double weight, int* l_max, oskar_Mem* alpha,
+        int* status);
+
 void oskar_element_evaluate(
         const oskar_Element* model,
         int normalise,
@@ -61,6 +67,7 @@ void oskar_element_evaluate(
         oskar_Mem* theta,
         oskar_Mem* phi_x,
         oskar_Mem* phi_y,
+        oskar_Mem* sph_wave_work,
         int offset_out,
         oskar_Mem* output,
         int* status)
@@ -104,10 +111,25 @@ void oskar_element_evaluate(
     {
         if (oskar_element_has_spherical_wave_data(model, id))
         {
+            int id0 = id, id1 = id, l_max = model->l_max[id];
+            double weight = 0.0;
+            const oskar_Mem* alpha = model->sph_wave[id];
+            if (model->interpolate_freq)
+                find_freq_bracket(frequency_hz, model->num_freq,
+                        model->freqs_hz, &id0, &id1, &weight);
+            if (id0 != id1 &&
+                    oskar_element_has_spherical_wave_data(model, id0) &&
+                    oskar_element_has_spherical_wave_data(model, id1) &&
+                    model->common_phi_coords[id0] ==
+                            model->common_phi_coords[id1] && sph_wave_work)
+            {
+                interpolate_spherical_wave_coeff(model,
+                        id0, id1, weight, &l_max, sph_wave_work, status);
+                alpha = sph_wave_work;
+            }
             oskar_evaluate_spherical_wave_sum(num_points_norm, theta, phi_x,
-                    (model->common_phi_coords[id] ? phi_x : phi_y),
-                    model->l_max[id], model->sph_wave[id],
-                    offset_out, output, status);
+                    (model->common_phi_coords[id] ? phi_x : phi_y), l_max,
+                    alpha, offset_out, output, status);
         }
         else
         {
@@ -115,14 +137,11 @@ void oskar_element_evaluate(
             const int offset_out_cplx = offset_out * 4;
             if (oskar_element_has_x_spline_data(model, id))
             {
-                oskar_splines_evaluate(model->x_h_re[id], num_points_norm,
+                const oskar_Splines* splines[] = {
+                        model->x_h_re[id], model->x_h_im[id],
+                        model->x_v_re[id], model->x_v_im[id]};
+                oskar_splines_evaluate_multi(4, splines, num_points_norm,
                         theta, phi_x, 8, offset_out_real + 0, output, status);
-                oskar_splines_evaluate(model->x_h_im[id], num_points_norm,
-                        theta, phi_x, 8, offset_out_real + 1, output, status);
-                oskar_splines_evaluate(model->x_v_re[id], num_points_norm,
-                        theta, phi_x, 8, offset_out_real + 2, output, status);
-                oskar_splines_evaluate(model->x_v_im[id], num_points_norm,
-                        theta, phi_x, 8, offset_out_real + 3, output, status);
                 oskar_convert_ludwig3_to_theta_phi_components(num_points_norm,
                         phi_x, 4, offset_out_cplx + 0, output, status);
             }
@@ -133,14 +152,11 @@ void oskar_element_evaluate(
 
             if (oskar_element_has_y_spline_data(model, id))
             {
-                oskar_splines_evaluate(model->y_h_re[id], num_points_norm,
+                const oskar_Splines* splines[] = {
+                        model->y_h_re[id], model->y_h_im[id],
+                        model->y_v_re[id], model->y_v_im[id]};
+                oskar_splines_evaluate_multi(4, splines, num_points_norm,
                         theta, phi_y, 8, offset_out_real + 4, output, status);
-                oskar_splines_evaluate(model->y_h_im[id], num_points_norm,
-                        theta, phi_y, 8, offset_out_real + 5, output, status);
-                oskar_splines_evaluate(model->y_v_re[id], num_points_norm,
-                        theta, phi_y, 8, offset_out_real + 6, output, status);
-                oskar_splines_evaluate(model->y_v_im[id], num_points_norm,
-                        theta, phi_y, 8, offset_out_real + 7, output, status);
                 oskar_convert_ludwig3_to_theta_phi_components(num_points_norm,
                         phi_y, 4, offset_out_cplx + 2, output, status);
             }
@@ -157,10 +173,10 @@ void oskar_element_evaluate(
         const int offset_out_real = offset_out * 2;
         if (oskar_element_has_scalar_spline_data(model, id))
         {
-            oskar_splines_evaluate(model->scalar_re[id], num_points_norm,
+            const oskar_Splines* splines[] = {
+                    model->scalar_re[id], model->scalar_im[id]};
+            oskar_splines_evaluate_multi(2, splines, num_points_norm,
                     theta, phi_x, 2, offset_out_real + 0, output, status);
-            oskar_splines_evaluate(model->scalar_im[id], num_points_norm,
-                    theta, phi_x, 2, offset_out_real + 1, output, status);
         }
         else if (element_type == OSKAR_ELEMENT_TYPE_DIPOLE)
             oskar_evaluate_dipole_pattern(num_points_norm,
@@ -182,6 +198,58 @@ void oskar_element_evaluate(
                 model->gaussian_fwhm_rad, theta, offset_out, output, status);
 }
 
+/* Finds the nearest frequencies either side of the one given. */
+static void find_freq_bracket(double frequency_hz, int num_freq,
+        const double* freqs_hz, int* id0, int* id1, double* weight)
+{
+    int i, lo = -1, hi = -1;
+    for (i = 0; i < num_freq; ++i)
+    {
+        const double f = freqs_hz[i];
+        if (f <= frequency_hz && (lo < 0 || f > freqs_hz[lo])) lo = i;
+        if (f >= frequency_hz && (hi < 0 || f < freqs_hz[hi])) hi = i;
+    }
+    if (lo < 0) lo = hi;
+    if (hi < 0) hi = lo;
+    if (lo < 0) return;
+    *id0 = lo;
+    *id1 = hi;
+    *weight = (lo == hi) ? 0.0 :
+            (frequency_hz - freqs_hz[lo]) / (freqs_hz[hi] - freqs_hz[lo]);
+}
+
+/*
+ * Linearly interpolates the spherical wave coefficients between two
+ * frequencies. Coefficients are ordered by l, so a set with a smaller l_max
+ * is padded with zeros. The coefficients at the second frequency are
+ * scaled in the space after the result, so the work array is reused
+ * without any temporary allocations.
+ */
+static void interpolate_spherical_wave_coeff(const oskar_Element* model,
+        int id0, int id1, double weight, int* l_max, oskar_Mem* alpha,
+        int* status)
+{
+    const int l_max0 = model->l_max[id0], l_max1 = model->l_max[id1];
+    const size_t num0 = (size_t) ((l_max0 + 1) * (l_max0 + 1) - 1);
+    const size_t num1 = (size_t) ((l_max1 + 1) * (l_max1 + 1) - 1);
+    const size_t num = num0 > num1 ? num0 : num1;
+    *l_max = l_max0 > l_max1 ? l_max0 : l_max1;
+    if (oskar_mem_type(alpha) != oskar_mem_type(model->sph_wave[id0]))
+    {
+        *status = OSKAR_ERR_TYPE_MISMATCH;
+        return;
+    }
+    oskar_mem_ensure(alpha, num + num1, status);
+    if (num0 < num)
+        oskar_mem_clear_contents(alpha, status);
+    oskar_mem_copy_contents(alpha, model->sph_wave[id0], 0, 0, num0, status);
+    oskar_mem_copy_contents(alpha, model->sph_wave[id1], num, 0, num1,
+            status);
+    oskar_mem_scale_real(alpha, 1.0 - weight, 0, num0, status);
+    oskar_mem_scale_real(alpha, weight, num, num1, status);
+    oskar_mem_add(alpha, alpha, alpha, 0, 0, num, num1, status);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "binary/oskar_binary.h"
+#include "binary/oskar_crc.h"
+#include "telescope/station/element/oskar_element.h"
+#include "utility/oskar_file_exists.h"
+#include "oskar_version.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if __STDC_VERSION__ >= 199901L
+#define SNPRINTF(BUF, SIZE, FMT, ...) snprintf(BUF, SIZE, FMT, __VA_ARGS__);
+#else
+#define SNPRINTF(BUF, SIZE, FMT, ...) sprintf(BUF, FMT, __VA_ARGS__);
+#endif
+
+/* Large enough for the checksum, all parameters and the version number. */
+#define MAX_KEY_LEN 256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char* oskar_element_fit_key(const char* input_file, int port, double freq_hz,
+        double closeness, double closeness_inc, int ignore_at_poles,
+        int ignore_below_horizon)
+{
+    char buffer[4096], *key = 0;
+    size_t num_read = 0;
+    unsigned long crc = 0;
+    oskar_CRC* crc_data = 0;
+    FILE* file = 0;
+
+    /* Compute a checksum of the input file. */
+    file = fopen(input_file, "rb");
+    if (!file) return 0;
+    crc_data = oskar_crc_create(OSKAR_CRC_32C);
+    while ((num_read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        crc = oskar_crc_update(crc_data, crc, buffer, num_read);
+    oskar_crc_free(crc_data);
+    fclose(file);
+
+    /* Combine it with the fitting parameters and the version number. */
+    key = (char*) calloc(MAX_KEY_LEN, 1);
+    if (!key) return 0;
+    SNPRINTF(key, MAX_KEY_LEN, "crc32c=%lx;port=%d;freq=%.17g;err=%.17g;"
+            "err_inc=%.17g;ignore_at_pole=%d;ignore_below_horizon=%d;"
+            "version=%x", crc, port, freq_hz, closeness, closeness_inc,
+            ignore_at_poles, ignore_below_horizon, OSKAR_VERSION)
+    return key;
+}
+
+int oskar_element_fit_key_matches(const char* filename, const char* key)
+{
+    int status = 0, match = 0;
+    size_t size = 0;
+    char* stored = 0;
+    oskar_Binary* h = 0;
+    if (!key || !oskar_file_exists(filename)) return 0;
+    h = oskar_binary_create(filename, 'r', &status);
+    oskar_binary_query(h, OSKAR_CHAR, OSKAR_TAG_GROUP_ELEMENT_DATA,
+            OSKAR_ELEMENT_TAG_FIT_KEY, 0, &size, &status);
+    if (!status && size > 0)
+    {
+        stored = (char*) calloc(size + 1, 1);
+        oskar_binary_read(h, OSKAR_CHAR, OSKAR_TAG_GROUP_ELEMENT_DATA,
+                OSKAR_ELEMENT_TAG_FIT_KEY, 0, size, stored, &status);
+        match = !status && !strcmp(key, stored);
+        free(stored);
+    }
+    oskar_binary_free(h);
+    return match;
+}
+
+void oskar_element_fit_key_write(const char* filename, const char* key,
+        int* status)
+{
+    oskar_Binary* h = 0;
+    if (*status || !key) return;
+    h = oskar_binary_create(filename, 'a', status);
+    oskar_binary_write(h, OSKAR_CHAR, OSKAR_TAG_GROUP_ELEMENT_DATA,
+            OSKAR_ELEMENT_TAG_FIT_KEY, 0, strlen(key) + 1, key, status);
+    oskar_binary_free(h);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -43,10 +43,10 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Splines** splines_ptr, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status);
+static void fit_splines(int num_surfaces, oskar_Splines*** splines_ptr,
+        int n, oskar_Mem* theta, oskar_Mem* phi, oskar_Mem** data,
+        oskar_Mem* weight, double closeness, double closeness_inc,
+        const char** names, oskar_Log* log, int* status);
 
 void oskar_element_load_cst(oskar_Element* data,
         int port, double freq_hz, const char* filename,
@@ -247,14 +247,14 @@ void oskar_element_load_cst(oskar_Element* data,
     fclose(file);
 
     /* Fit splines to the surface data. */
-    fit_splines(data_h_re, n, theta, phi, h_re, weight,
-            closeness, closeness_inc, "H [real]", log, status);
-    fit_splines(data_h_im, n, theta, phi, h_im, weight,
-            closeness, closeness_inc, "H [imag]", log, status);
-    fit_splines(data_v_re, n, theta, phi, v_re, weight,
-            closeness, closeness_inc, "V [real]", log, status);
-    fit_splines(data_v_im, n, theta, phi, v_im, weight,
-            closeness, closeness_inc, "V [imag]", log, status);
+    {
+        oskar_Splines** surfaces[] = {data_h_re, data_h_im,
+                data_v_re, data_v_im};
+        oskar_Mem* values[] = {h_re, h_im, v_re, v_im};
+        const char* names[] = {"H [real]", "H [imag]", "V [real]", "V [imag]"};
+        fit_splines(4, surfaces, n, theta, phi, values, weight,
+                closeness, closeness_inc, names, log, status);
+    }
 
     /* Copy X to Y if both ports are the same. */
     if (port == 0)
@@ -288,30 +288,55 @@ void oskar_element_load_cst(oskar_Element* data,
 }
 
 
-static void fit_splines(oskar_Splines** splines_ptr, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
-        oskar_Log* log, int* status)
+static void fit_splines(int num_surfaces, oskar_Splines*** splines_ptr,
+        int n, oskar_Mem* theta, oskar_Mem* phi, oskar_Mem** data,
+        oskar_Mem* weight, double closeness, double closeness_inc,
+        const char** names, oskar_Log* log, int* status)
 {
-    double avg_frac_error;
+    int i, fit_status[4] = {0, 0, 0, 0};
+    double avg_frac_error[4];
     if (*status) return;
-    if (!*splines_ptr)
-        *splines_ptr = oskar_splines_create(OSKAR_DOUBLE, OSKAR_CPU, status);
-    oskar_Splines* splines = *splines_ptr;
+    if (num_surfaces > 4)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        if (!*splines_ptr[i])
+            *splines_ptr[i] = oskar_splines_create(
+                    OSKAR_DOUBLE, OSKAR_CPU, status);
+        avg_frac_error[i] = closeness; /* Copy the fitting parameter. */
+    }
+    double* theta_ = oskar_mem_double(theta, status);
+    double* phi_ = oskar_mem_double(phi, status);
+    const double* weight_ = oskar_mem_double_const(weight, status);
     if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_line(log, 'M', ' ');
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
+
+    /* The surfaces are independent, so fit them concurrently. */
+#pragma omp parallel for schedule(dynamic, 1)
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        oskar_splines_fit(*splines_ptr[i], n, theta_, phi_,
+                oskar_mem_double_const(data[i], &fit_status[i]), weight_,
+                OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_error[i],
+                closeness_inc, 1, 1e-14, &fit_status[i]);
+    }
+
+    /* Write to the log afterwards, as it is not thread-safe. */
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        const oskar_Splines* splines = *splines_ptr[i];
+        if (fit_status[i] && !*status) *status = fit_status[i];
+        oskar_log_line(log, 'M', ' ');
+        oskar_log_message(log, 'M', 0, "Fitted surface %s.", names[i]);
+        oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
+                "frac. error (s=%.2e).", avg_frac_error[i],
+                oskar_splines_smoothing_factor(splines));
+        oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = "
+                "(%d, %d).", oskar_splines_num_knots_x_theta(splines),
+                oskar_splines_num_knots_y_phi(splines));
+    }
 }
 
 #ifdef __cplusplus
@@ -44,9 +44,9 @@ extern "C" {
 
 #define DEG2RAD (M_PI/180.0)
 
-static void fit_splines(oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
+static void fit_splines(int num_surfaces, oskar_Splines** splines, int n,
+        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem** data, oskar_Mem* weight,
+        double closeness, double closeness_inc, const char** names,
         oskar_Log* log, int* status);
 
 void oskar_element_load_scalar(oskar_Element* data,
@@ -97,6 +97,13 @@ void oskar_element_load_scalar(oskar_Element* data,
     }
 
     /* Get pointers to surface data based on frequency index. */
+    if (!data->scalar_re[i])
+        data->scalar_re[i] = oskar_splines_create(type, OSKAR_CPU, status);
+    if (!data->scalar_im[i])
+        data->scalar_im[i] = oskar_splines_create(type, OSKAR_CPU, status);
+    if (!data->filename_scalar[i])
+        data->filename_scalar[i] = oskar_mem_create(OSKAR_CHAR,
+                OSKAR_CPU, 0, status);
     scalar_re = data->scalar_re[i];
     scalar_im = data->scalar_im[i];
 
@@ -177,10 +184,13 @@ void oskar_element_load_scalar(oskar_Element* data,
     fclose(file);
 
     /* Fit splines to the surface data. */
-    fit_splines(scalar_re, n, theta, phi, re, weight,
-            closeness, closeness_inc, "Scalar [real]", log, status);
-    fit_splines(scalar_im, n, theta, phi, im, weight,
-            closeness, closeness_inc, "Scalar [imag]", log, status);
+    {
+        oskar_Splines* surfaces[] = {scalar_re, scalar_im};
+        oskar_Mem* values[] = {re, im};
+        const char* names[] = {"Scalar [real]", "Scalar [imag]"};
+        fit_splines(2, surfaces, n, theta, phi, values, weight,
+                closeness, closeness_inc, names, log, status);
+    }
 
     /* Store the filename. */
     oskar_mem_append_raw(data->filename_scalar[i], filename, OSKAR_CHAR,
@@ -195,26 +205,49 @@ void oskar_element_load_scalar(oskar_Element* data,
 }
 
 
-static void fit_splines(oskar_Splines* splines, int n,
-        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem* data, oskar_Mem* weight,
-        double closeness, double closeness_inc, const char* name,
+static void fit_splines(int num_surfaces, oskar_Splines** splines, int n,
+        oskar_Mem* theta, oskar_Mem* phi, oskar_Mem** data, oskar_Mem* weight,
+        double closeness, double closeness_inc, const char** names,
         oskar_Log* log, int* status)
 {
-    double avg_frac_error;
+    int i, fit_status[2] = {0, 0};
+    double avg_frac_error[2];
+    if (*status) return;
+    if (num_surfaces > 2)
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    for (i = 0; i < num_surfaces; ++i)
+        avg_frac_error[i] = closeness; /* Copy the fitting parameter. */
+    double* theta_ = oskar_mem_double(theta, status);
+    double* phi_ = oskar_mem_double(phi, status);
+    const double* weight_ = oskar_mem_double_const(weight, status);
     if (*status) return;
-    avg_frac_error = closeness; /* Copy the fitting parameter. */
-    oskar_log_message(log, 'M', 0, "");
-    oskar_log_message(log, 'M', 0, "Fitting surface %s...", name);
-    oskar_splines_fit(splines, n, oskar_mem_double(theta, status),
-            oskar_mem_double(phi, status), oskar_mem_double_const(data, status),
-            oskar_mem_double_const(weight, status), OSKAR_SPLINES_SPHERICAL, 1,
-            &avg_frac_error, closeness_inc, 1, 1e-14, status);
-    oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
-            "frac. error (s=%.2e).", avg_frac_error,
-            oskar_splines_smoothing_factor(splines));
-    oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = (%d, %d).",
-            oskar_splines_num_knots_x_theta(splines),
-            oskar_splines_num_knots_y_phi(splines));
+
+    /* The surfaces are independent, so fit them concurrently. */
+#pragma omp parallel for schedule(dynamic, 1)
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        oskar_splines_fit(splines[i], n, theta_, phi_,
+                oskar_mem_double_const(data[i], &fit_status[i]), weight_,
+                OSKAR_SPLINES_SPHERICAL, 1, &avg_frac_error[i],
+                closeness_inc, 1, 1e-14, &fit_status[i]);
+    }
+
+    /* Write to the log afterwards, as it is not thread-safe. */
+    for (i = 0; i < num_surfaces; ++i)
+    {
+        if (fit_status[i] && !*status) *status = fit_status[i];
+        oskar_log_message(log, 'M', 0, "");
+        oskar_log_message(log, 'M', 0, "Fitted surface %s.", names[i]);
+        oskar_log_message(log, 'M', 1, "Surface fitted to %.4f average "
+                "frac. error (s=%.2e).", avg_frac_error[i],
+                oskar_splines_smoothing_factor(splines[i]));
+        oskar_log_message(log, 'M', 1, "Number of knots (theta, phi) = "
+                "(%d, %d).", oskar_splines_num_knots_x_theta(splines[i]),
+                oskar_splines_num_knots_y_phi(splines[i]));
+    }
 }
 
 #ifdef __cplusplus
@@ -106,6 +106,7 @@ void oskar_evaluate_dipole_pattern(int num_points, const oskar_Mem* theta,
     else
     {
         size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        static int handle[4]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         const int is_dbl = oskar_mem_is_double(pattern);
         switch (oskar_mem_type(pattern))
@@ -122,6 +123,8 @@ void oskar_evaluate_dipole_pattern(int num_points, const oskar_Mem* theta,
             *status = OSKAR_ERR_BAD_DATA_TYPE;
             return;
         }
+        const int h = oskar_device_kernel_handle_cached(
+                &handle[2 * oskar_mem_is_matrix(pattern) + is_dbl], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = oskar_device_global_size(
                 (size_t) num_points, local_size[0]);
@@ -141,7 +144,8 @@ void oskar_evaluate_dipole_pattern(int num_points, const oskar_Mem* theta,
                     {PTR_SZ, oskar_mem_buffer(pattern)},
                     {PTR_SZ, oskar_mem_buffer(pattern)}
             };
-            oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+            oskar_device_launch_kernel_handle(h, location, 1,
+                    local_size, global_size,
                     sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
         }
         else
@@ -158,7 +162,8 @@ void oskar_evaluate_dipole_pattern(int num_points, const oskar_Mem* theta,
                     {INT_SZ, &offset},
                     {PTR_SZ, oskar_mem_buffer(pattern)}
             };
-            oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+            oskar_device_launch_kernel_handle(h, location, 1,
+                    local_size, global_size,
                     sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
         }
     }
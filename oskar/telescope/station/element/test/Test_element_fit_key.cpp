@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_element.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+static void write_text_file(const char* filename, const char* text)
+{
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "%s", text);
+    fclose(file);
+}
+
+static char* key(const char* input_file, double closeness)
+{
+    return oskar_element_fit_key(input_file, 1, 100e6, closeness, 1.1, 0, 1);
+}
+
+TEST(element_fit_key, cache_hit_and_miss)
+{
+    int status = 0;
+    const char* input = "temp_test_element_fit_key_input.txt";
+    const char* output = "temp_test_element_fit_key_output.bin";
+    write_text_file(input, "0 0 1 1 0 1 0 0\n");
+    remove(output);
+
+    // No output file yet.
+    char* key_1 = key(input, 0.005);
+    ASSERT_TRUE(key_1 != NULL);
+    EXPECT_FALSE(oskar_element_fit_key_matches(output, key_1));
+
+    // Cache hit after writing the key.
+    oskar_element_fit_key_write(output, key_1, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_TRUE(oskar_element_fit_key_matches(output, key_1));
+    char* key_2 = key(input, 0.005);
+    EXPECT_STREQ(key_1, key_2);
+    EXPECT_TRUE(oskar_element_fit_key_matches(output, key_2));
+
+    // Cache miss if a fitting parameter changes.
+    char* key_3 = key(input, 0.01);
+    EXPECT_STRNE(key_1, key_3);
+    EXPECT_FALSE(oskar_element_fit_key_matches(output, key_3));
+
+    // Cache miss if the input file changes.
+    write_text_file(input, "0 0 1 1 0 2 0 0\n");
+    char* key_4 = key(input, 0.005);
+    EXPECT_STRNE(key_1, key_4);
+    EXPECT_FALSE(oskar_element_fit_key_matches(output, key_4));
+
+    // No key for a missing input file.
+    EXPECT_TRUE(key("temp_test_element_fit_key_missing.txt", 0.005) == NULL);
+    EXPECT_FALSE(oskar_element_fit_key_matches(output, NULL));
+
+    free(key_1);
+    free(key_2);
+    free(key_3);
+    free(key_4);
+    remove(input);
+    remove(output);
+}
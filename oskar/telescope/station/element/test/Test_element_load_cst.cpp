@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/private_element.h"
+#include "telescope/station/element/oskar_element.h"
+#include "splines/oskar_splines_evaluate.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdio>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define DEG2RAD (M_PI / 180.0)
+
+// Ludwig-3 components of an ideal X dipole.
+static double dipole_h(double theta, double phi)
+{
+    return cos(theta) * cos(phi) * cos(phi) + sin(phi) * sin(phi);
+}
+
+static double dipole_v(double theta, double phi)
+{
+    return (cos(theta) - 1.0) * cos(phi) * sin(phi);
+}
+
+// Writes the theta and phi components of an ideal X dipole in CST format.
+static void write_cst_file(const char* filename)
+{
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    fprintf(file, "Theta [deg.]  Phi [deg.]  Abs(Dir.)  Abs(Theta)  "
+            "Phase(Theta)  Abs(Phi)  Phase(Phi)  Ax.Ratio\n");
+    fprintf(file, "------------------------------------------------------\n");
+    for (int p = 0; p < 360; p += 5)
+    {
+        for (int t = 0; t <= 180; t += 5)
+        {
+            const double e_theta = cos(t * DEG2RAD) * cos(p * DEG2RAD);
+            const double e_phi = -sin(p * DEG2RAD);
+            fprintf(file, "%d %d 1.0 %.12f %d %.12f %d 0.0\n", t, p,
+                    fabs(e_theta), e_theta < 0.0 ? 180 : 0,
+                    fabs(e_phi), e_phi < 0.0 ? 180 : 0);
+        }
+    }
+    fclose(file);
+}
+
+static void load(oskar_Element* element, const char* filename, int* status)
+{
+    oskar_element_load_cst(element, 0, 100e6, filename, 0.005, 1.1, 0, 1,
+            0, status);
+}
+
+TEST(element_load_cst, fits_dipole)
+{
+    int status = 0;
+    const char* filename = "temp_test_element_load_cst.txt";
+    write_cst_file(filename);
+    oskar_Element* element = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+    load(element, filename, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(1, oskar_element_num_freq(element));
+    EXPECT_DOUBLE_EQ(100e6, oskar_element_freqs_hz_const(element)[0]);
+    EXPECT_TRUE(oskar_element_has_x_spline_data(element, 0));
+    EXPECT_TRUE(oskar_element_has_y_spline_data(element, 0));
+
+    // Check the fitted surfaces against the pattern above the horizon.
+    const int num_points = 200;
+    oskar_Mem* theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* phi = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* h = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    oskar_Mem* v = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_points, &status);
+    double* t_ = oskar_mem_double(theta, &status);
+    double* p_ = oskar_mem_double(phi, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        t_[i] = (2.0 + 83.0 * (i % 20) / 19.0) * DEG2RAD;
+        p_[i] = (7.0 + 35.0 * (i / 20)) * DEG2RAD;
+    }
+    oskar_splines_evaluate(element->x_h_re[0], num_points, theta, phi,
+            1, 0, h, &status);
+    oskar_splines_evaluate(element->x_v_re[0], num_points, theta, phi,
+            1, 0, v, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* h_ = oskar_mem_double_const(h, &status);
+    const double* v_ = oskar_mem_double_const(v, &status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        EXPECT_NEAR(dipole_h(t_[i], p_[i]), h_[i], 0.02);
+        EXPECT_NEAR(dipole_v(t_[i], p_[i]), v_[i], 0.02);
+    }
+    oskar_mem_free(theta, &status);
+    oskar_mem_free(phi, &status);
+    oskar_mem_free(h, &status);
+    oskar_mem_free(v, &status);
+    oskar_element_free(element, &status);
+    remove(filename);
+}
+
+TEST(element_load_cst, threads_match_serial)
+{
+#ifdef _OPENMP
+    int status = 0;
+    const char* filename = "temp_test_element_load_cst_threads.txt";
+    write_cst_file(filename);
+    oskar_Element* serial = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+    oskar_Element* threaded = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    load(serial, filename, &status);
+    omp_set_num_threads(4);
+    load(threaded, filename, &status);
+    omp_set_num_threads(max_threads);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Each surface must be fitted identically.
+    const oskar_Splines* a[] = {serial->x_h_re[0], serial->x_h_im[0],
+            serial->x_v_re[0], serial->x_v_im[0]};
+    const oskar_Splines* b[] = {threaded->x_h_re[0], threaded->x_h_im[0],
+            threaded->x_v_re[0], threaded->x_v_im[0]};
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(oskar_splines_num_knots_x_theta(a[i]),
+                oskar_splines_num_knots_x_theta(b[i]));
+        EXPECT_EQ(oskar_splines_num_knots_y_phi(a[i]),
+                oskar_splines_num_knots_y_phi(b[i]));
+        EXPECT_EQ(0, oskar_mem_different(oskar_splines_coeff_const(a[i]),
+                oskar_splines_coeff_const(b[i]), 0, &status));
+    }
+    oskar_element_free(serial, &status);
+    oskar_element_free(threaded, &status);
+    remove(filename);
+#endif
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_element.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdio>
+
+static void write_scalar_file(const char* filename, double scale)
+{
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    for (int p = 0; p < 360; p += 10)
+        for (int t = 0; t <= 90; t += 5)
+            fprintf(file, "%d %d %.12f 0.0\n", t, p,
+                    scale * cos(t * M_PI / 180.0));
+    fclose(file);
+}
+
+TEST(element_load_scalar, new_frequency)
+{
+    int status = 0;
+    const char* file1 = "temp_test_element_load_scalar_1.txt";
+    const char* file2 = "temp_test_element_load_scalar_2.txt";
+    write_scalar_file(file1, 1.0);
+    write_scalar_file(file2, 2.0);
+    oskar_Element* element = oskar_element_create(OSKAR_DOUBLE, OSKAR_CPU,
+            &status);
+
+    // Each frequency must get its own surfaces and filename.
+    oskar_element_load_scalar(element, 100e6, file1, 0.005, 1.1, 0, 0,
+            0, &status);
+    oskar_element_load_scalar(element, 200e6, file2, 0.005, 1.1, 0, 0,
+            0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_EQ(2, oskar_element_num_freq(element));
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_TRUE(oskar_element_has_scalar_spline_data(element, i));
+        EXPECT_STREQ(i == 0 ? file1 : file2, oskar_mem_char_const(
+                oskar_element_scalar_filename_const(element, i)));
+    }
+    oskar_element_free(element, &status);
+    remove(file1);
+    remove(file2);
+}
@@ -48,6 +48,9 @@ extern "C" {
  * which was developed by Maaijke Mevius and Ilse van Bemmel, and
  * can be found in the MeqTrees cattery repository.
  *
+ * Single and double precision data are supported, but all arrays
+ * must be in CPU memory.
+ *
  * Possible problems:
  * - Pierce points below the horizon are still evaluated.
  *
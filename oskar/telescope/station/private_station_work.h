@@ -45,6 +45,7 @@ struct oskar_StationWork
     oskar_Mem* theta_modified;   /* Real scalar. */
     oskar_Mem* phi_x;            /* Real scalar. */
     oskar_Mem* phi_y;            /* Real scalar. */
+    oskar_Mem* sph_wave_coeff;   /* Complex matrix. Element coefficients. */
     oskar_Mem* beam_out_scratch; /* Output scratch array. */
 
     /* TEC screen. */
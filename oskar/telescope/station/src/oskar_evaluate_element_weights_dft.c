@@ -94,6 +94,7 @@ void oskar_evaluate_element_weights_dft(int num_elements,
     else
     {
         size_t local_size[] = {256, 1, 1}, global_size[] = {1, 1, 1};
+        static int handle[2]; /* Kernel handles, cached on first launch. */
         const char* k = 0;
         const int is_dbl = oskar_mem_is_double(weights);
         if (type == OSKAR_DOUBLE_COMPLEX)
@@ -109,6 +110,8 @@ void oskar_evaluate_element_weights_dft(int num_elements,
         const float x1 = (float) x_beam;
         const float y1 = (float) y_beam;
         const float z1 = (float) z_beam;
+        const int h = oskar_device_kernel_handle_cached(
+                &handle[is_dbl], k);
         oskar_device_check_local_size(location, 0, local_size);
         global_size[0] = oskar_device_global_size(
                 (size_t) num_elements, local_size[0]);
@@ -128,7 +131,8 @@ void oskar_evaluate_element_weights_dft(int num_elements,
                         is_dbl ? (const void*)&z_beam : (const void*)&z1},
                 {PTR_SZ, oskar_mem_buffer(weights)}
         };
-        oskar_device_launch_kernel(k, location, 1, local_size, global_size,
+        oskar_device_launch_kernel_handle(h, location, 1,
+                local_size, global_size,
                 sizeof(args) / sizeof(oskar_Arg), args, 0, 0, status);
     }
 }
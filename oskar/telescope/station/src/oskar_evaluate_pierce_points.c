@@ -26,18 +26,35 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "telescope/station/define_evaluate_pierce_points.h"
 #include "telescope/station/oskar_evaluate_pierce_points.h"
 #include "convert/private_convert_ecef_to_geodetic_spherical_inline.h"
+#include "utility/oskar_kernel_macros.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void oskar_evaluate_pierce_points_d(int num_directions, const double* hor_x,
-        const double* hor_y, const double* hor_z, double* pp_lon_,
-        double* pp_lat_, double* rel_path_len_, double screen_height_m,
-        const double station_ecef_x, const double station_ecef_y,
-        const double station_ecef_z);
+#define OSKAR_EVALUATE_PIERCE_POINTS(NAME, FP) \
+static void NAME(const int num_directions, const FP* hor_x, \
+        const FP* hor_y, const FP* hor_z, const FP st_x, const FP st_y, \
+        const FP st_z, const FP sin_l, const FP cos_l, const FP sin_b, \
+        const FP cos_b, const FP norm_xyz, const FP r_screen, \
+        const FP h_screen, FP* pp_lon, FP* pp_lat, FP* pp_sec) \
+{ \
+    int i; \
+    DO_PRAGMA(omp parallel for private(i)) \
+    for (i = 0; i < num_directions; ++i) \
+    { \
+        const FP x = hor_x[i], y = hor_y[i], z = hor_z[i]; \
+        OSKAR_PIERCE_POINT(FP, x, y, z, st_x, st_y, st_z, \
+                sin_l, cos_l, sin_b, cos_b, norm_xyz, r_screen, h_screen, \
+                pp_lon[i], pp_lat[i], pp_sec[i]) \
+    } \
+}
+
+OSKAR_EVALUATE_PIERCE_POINTS(evaluate_pierce_points_float, float)
+OSKAR_EVALUATE_PIERCE_POINTS(evaluate_pierce_points_double, double)
 
 void oskar_evaluate_pierce_points(
         oskar_Mem* pierce_point_lon,
@@ -54,6 +71,7 @@ void oskar_evaluate_pierce_points(
         int* status)
 {
     int type, location;
+    double lon = 0.0, lat = 0.0, alt = 0.0;
 
     /* Check if safe to proceed. */
     if (*status) return;
@@ -93,146 +111,51 @@ void oskar_evaluate_pierce_points(
         *status = OSKAR_ERR_DIMENSION_MISMATCH;
         return;
     }
-
-    /* Switch on type. */
-    if (type == OSKAR_DOUBLE)
+    if (location != OSKAR_CPU)
     {
-        double *pp_lon_, *pp_lat_, *rel_path_len_;
-        const double *x_, *y_, *z_;
-        x_ = oskar_mem_double_const(hor_x, status);
-        y_ = oskar_mem_double_const(hor_y, status);
-        z_ = oskar_mem_double_const(hor_z, status);
-        pp_lon_ = oskar_mem_double(pierce_point_lon, status);
-        pp_lat_ = oskar_mem_double(pierce_point_lat, status);
-        rel_path_len_ = oskar_mem_double(relative_path_length, status);
-
-        if (location == OSKAR_CPU)
-        {
-            oskar_evaluate_pierce_points_d(num_directions, x_, y_, z_,
-                    pp_lon_, pp_lat_, rel_path_len_, screen_height_m,
-                    station_x_ecef, station_y_ecef, station_z_ecef);
-        }
-        else
-        {
-#ifdef OSKAR_HAVE_CUDA
-            *status = OSKAR_ERR_BAD_LOCATION;
-#else
-            *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
-#endif
-        }
-    }
-    else
-    {
-#if 0
-        float *pp_lon_, *pp_lat_, *rel_path_len_;
-        const float *x_, *y_, *z_;
-        x_ = oskar_mem_float_const(hor_x, status);
-        y_ = oskar_mem_float_const(hor_y, status);
-        z_ = oskar_mem_float_const(hor_z, status);
-        pp_lon_ = oskar_mem_float(pierce_point_lon, status);
-        pp_lat_ = oskar_mem_float(pierce_point_lat, status);
-        rel_path_len_ = oskar_mem_float(relative_path_length, status);
-#endif
-
-        if (location == OSKAR_CPU)
-        {
-            /* oskar_evaluate_pierce_points_f(num_directions, x_, y_, z_,
-                    pp_lon_, pp_lat_, rel_path_len_, screen_height_m,
-                    station_x_ecef, station_y_ecef, station_z_ecef); */
-            *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE; /* FIXME */
-        }
-        else
-        {
-#ifdef OSKAR_HAVE_CUDA
-            *status = OSKAR_ERR_BAD_LOCATION;
-#else
-            *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
-#endif
-        }
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
     }
-}
-
-void oskar_evaluate_pierce_points_d(int num_directions, const double* hor_x,
-        const double* hor_y, const double* hor_z, double* pp_lon_,
-        double* pp_lat_, double* rel_path_len_, double screen_height_m,
-        const double station_ecef_x, const double station_ecef_y,
-        const double station_ecef_z)
-{
-    int i;
-    double norm_xyz, earth_radius_plus_screen_height_m;
-    double cos_l, sin_l, cos_b, sin_b, station_lon, station_lat, station_alt;
 
     /* Get the station longitude and latitude from ECEF coordinates. */
-    oskar_convert_ecef_to_geodetic_spherical_inline_d(station_ecef_x,
-            station_ecef_y, station_ecef_z, &station_lon, &station_lat,
-            &station_alt);
-
-    /* Calculate sine and cosine of station longitude and latitude. */
-    sin_l = sin(station_lon);
-    cos_l = cos(station_lon);
-    sin_b = sin(station_lat);
-    cos_b = cos(station_lat);
+    oskar_convert_ecef_to_geodetic_spherical_inline_d(station_x_ecef,
+            station_y_ecef, station_z_ecef, &lon, &lat, &alt);
 
     /* Length of the vector from the centre of the Earth to the station. */
-    norm_xyz = sqrt(station_ecef_x * station_ecef_x +
-            station_ecef_y * station_ecef_y +
-            station_ecef_z * station_ecef_z);
+    const double norm_xyz = sqrt(station_x_ecef * station_x_ecef +
+            station_y_ecef * station_y_ecef +
+            station_z_ecef * station_z_ecef);
 
     /* Evaluate the Earth radius plus screen height at the station position. */
-    earth_radius_plus_screen_height_m =
-            screen_height_m + norm_xyz - station_alt;
-
-    /* Loop over directions to evaluate pierce points. */
-    for (i = 0; i < num_directions; ++i)
-    {
-        double pp_lon, pp_lat, pp_sec, scale, x, y, z;
-        double diff_ecef_x, diff_ecef_y, diff_ecef_z;
-
-        /* Unit vector describing the direction of the pierce point in the
-         * ENU frame. Vector from station to pierce point. */
-        x = hor_x[i];
-        y = hor_y[i];
-        z = hor_z[i];
-
-        /* Evaluate length of vector between station and pierce point. */
-        /* If the direction is directly towards the zenith we don't have to
-         * calculate anything, as the length is simply the screen height! */
-        if (fabs(z - 1.0) > 1.0e-10)
-        {
-            double el, cos_el, arg, alpha_prime, sin_beta;
-            el = asin(z);
-            cos_el = cos(el);
-            arg = (cos_el * norm_xyz) / earth_radius_plus_screen_height_m;
-            alpha_prime = asin(arg);
-            sin_beta = sin(((M_PI/2) - el) - alpha_prime);
-            pp_sec = 1.0 / cos(alpha_prime);
-            scale = earth_radius_plus_screen_height_m * sin_beta / cos_el;
-        }
-        else
-        {
-            pp_sec = 1.0;
-            scale = screen_height_m;
-        }
+    const double r_screen = screen_height_m + norm_xyz - alt;
 
-        /* Convert ENU unit vector to ECEF frame using rotation matrix. */
-        diff_ecef_x = -x * sin_l - y * sin_b * cos_l + z * cos_b * cos_l;
-        diff_ecef_y =  x * cos_l - y * sin_b * sin_l + z * cos_b * sin_l;
-        diff_ecef_z =  y * cos_b + z * sin_b;
-
-        /* Evaluate the pierce point in ECEF coordinates. */
-        x = station_ecef_x + diff_ecef_x * scale;
-        y = station_ecef_y + diff_ecef_y * scale;
-        z = station_ecef_z + diff_ecef_z * scale;
-
-        /* Convert ECEF coordinates to geocentric longitude and latitude. */
-        pp_lon = atan2(y, x);
-        pp_lat = atan2(z, sqrt(x*x + y*y));
-
-        /* Store data. */
-        pp_lon_[i] = pp_lon;
-        pp_lat_[i] = pp_lat;
-        rel_path_len_[i] = pp_sec;
-    }
+    /* Switch on type. */
+    if (type == OSKAR_DOUBLE)
+        evaluate_pierce_points_double(num_directions,
+                oskar_mem_double_const(hor_x, status),
+                oskar_mem_double_const(hor_y, status),
+                oskar_mem_double_const(hor_z, status),
+                station_x_ecef, station_y_ecef, station_z_ecef,
+                sin(lon), cos(lon), sin(lat), cos(lat),
+                norm_xyz, r_screen, screen_height_m,
+                oskar_mem_double(pierce_point_lon, status),
+                oskar_mem_double(pierce_point_lat, status),
+                oskar_mem_double(relative_path_length, status));
+    else if (type == OSKAR_SINGLE)
+        evaluate_pierce_points_float(num_directions,
+                oskar_mem_float_const(hor_x, status),
+                oskar_mem_float_const(hor_y, status),
+                oskar_mem_float_const(hor_z, status),
+                (float) station_x_ecef, (float) station_y_ecef,
+                (float) station_z_ecef,
+                (float) sin(lon), (float) cos(lon),
+                (float) sin(lat), (float) cos(lat),
+                (float) norm_xyz, (float) r_screen, (float) screen_height_m,
+                oskar_mem_float(pierce_point_lon, status),
+                oskar_mem_float(pierce_point_lat, status),
+                oskar_mem_float(relative_path_length, status));
+    else
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
 }
 
 #ifdef __cplusplus
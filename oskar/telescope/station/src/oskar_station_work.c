@@ -56,6 +56,8 @@ oskar_StationWork* oskar_station_work_create(int type,
     work->theta_modified = oskar_mem_create(type, location, 0, status);
     work->phi_x = oskar_mem_create(type, location, 0, status);
     work->phi_y = oskar_mem_create(type, location, 0, status);
+    work->sph_wave_coeff = oskar_mem_create(complex_type | OSKAR_MATRIX,
+            location, 0, status);
     work->enu_direction_x = oskar_mem_create(type, location, 0, status);
     work->enu_direction_y = oskar_mem_create(type, location, 0, status);
     work->enu_direction_z = oskar_mem_create(type, location, 0, status);
@@ -78,6 +80,7 @@ void oskar_station_work_free(oskar_StationWork* work, int* status)
     oskar_mem_free(work->theta_modified, status);
     oskar_mem_free(work->phi_x, status);
     oskar_mem_free(work->phi_y, status);
+    oskar_mem_free(work->sph_wave_coeff, status);
     oskar_mem_free(work->enu_direction_x, status);
     oskar_mem_free(work->enu_direction_y, status);
     oskar_mem_free(work->enu_direction_z, status);
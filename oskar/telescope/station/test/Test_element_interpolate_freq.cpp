@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "telescope/station/element/oskar_element.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static void write_coeff_file(const char* filename, double scale)
+{
+    FILE* file = fopen(filename, "w");
+    ASSERT_TRUE(file != NULL);
+    for (int l = 1; l <= 3; ++l)
+    {
+        for (int m = -l; m <= l; ++m)
+            fprintf(file, "%.6f ", scale * (0.1 * l + 0.01 * m + 0.3));
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+static void load_coeff(oskar_Element* element, const char* filename,
+        double freq_hz, int* status)
+{
+    int num_tmp = 0;
+    double* tmp = 0;
+    oskar_element_load_spherical_wave_coeff(element, filename, freq_hz,
+            &num_tmp, &tmp, status);
+    free(tmp);
+}
+
+static oskar_Mem* evaluate(const oskar_Element* element, double freq_hz,
+        oskar_Mem* work, int* status)
+{
+    const int num_points = 101;
+    oskar_Mem *x, *y, *z, *theta, *phi_x, *phi_y, *output;
+    x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, status);
+    y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, status);
+    z = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, num_points, status);
+    theta = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    phi_x = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    phi_y = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, status);
+    output = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX, OSKAR_CPU,
+            num_points, status);
+    double* x_ = oskar_mem_double(x, status);
+    double* y_ = oskar_mem_double(y, status);
+    double* z_ = oskar_mem_double(z, status);
+    for (int i = 0; i < num_points; ++i)
+    {
+        x_[i] = -0.9 + 1.8 * i / (num_points - 1);
+        y_[i] = 0.3 * x_[i];
+        z_[i] = sqrt(1.0 - x_[i] * x_[i] - y_[i] * y_[i]);
+    }
+    oskar_element_evaluate(element, 0, 0, M_PI / 2.0, 0.0, 0, num_points,
+            x, y, z, freq_hz, theta, phi_x, phi_y, work, 0, output, status);
+    oskar_mem_free(x, status);
+    oskar_mem_free(y, status);
+    oskar_mem_free(z, status);
+    oskar_mem_free(theta, status);
+    oskar_mem_free(phi_x, status);
+    oskar_mem_free(phi_y, status);
+    return output;
+}
+
+TEST(element_interpolate_freq, spherical_wave)
+{
+    int status = 0;
+    const char* file1 = "temp_test_element_interp_1_te_re.txt";
+    const char* file2 = "temp_test_element_interp_2_te_re.txt";
+    const char* file3 = "temp_test_element_interp_3_te_re.txt";
+    write_coeff_file(file1, 1.0);
+    write_coeff_file(file2, 3.0);
+    write_coeff_file(file3, 1.5);
+
+    /* Element with coefficients defined at two frequencies. */
+    oskar_Element* element = oskar_element_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    load_coeff(element, file1, 100e6, &status);
+    load_coeff(element, file2, 200e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    /* Reference element defined only at the interpolated frequency. */
+    oskar_Element* ref = oskar_element_create(OSKAR_DOUBLE,
+            OSKAR_CPU, &status);
+    load_coeff(ref, file3, 125e6, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    /* Work array for interpolated coefficients, reused for every call. */
+    oskar_Mem* work = oskar_mem_create(OSKAR_DOUBLE_COMPLEX_MATRIX,
+            OSKAR_CPU, 0, &status);
+
+    /* Without interpolation, the nearest frequency is used. */
+    oskar_Mem* out_nearest = evaluate(element, 125e6, work, &status);
+    oskar_Mem* out_low = evaluate(element, 100e6, work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    EXPECT_EQ(0, oskar_mem_different(out_nearest, out_low, 0, &status));
+
+    /* With interpolation, the coefficients are blended linearly. */
+    oskar_element_set_interpolate_freq(element, 1);
+    oskar_Mem* out_interp = evaluate(element, 125e6, work, &status);
+    oskar_Mem* out_ref = evaluate(ref, 125e6, work, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    const double* a = oskar_mem_double_const(out_interp, &status);
+    const double* b = oskar_mem_double_const(out_ref, &status);
+    const size_t num = 8 * oskar_mem_length(out_ref);
+    for (size_t i = 0; i < num; ++i)
+        EXPECT_NEAR(b[i], a[i], 1e-12);
+
+    /* Outside the defined range, the nearest frequency is still used. */
+    oskar_Mem* out_edge = evaluate(element, 90e6, work, &status);
+    EXPECT_EQ(0, oskar_mem_different(out_edge, out_low, 0, &status));
+
+    oskar_mem_free(out_nearest, &status);
+    oskar_mem_free(out_low, &status);
+    oskar_mem_free(out_interp, &status);
+    oskar_mem_free(out_ref, &status);
+    oskar_mem_free(out_edge, &status);
+    oskar_mem_free(work, &status);
+    oskar_element_free(element, &status);
+    oskar_element_free(ref, &status);
+    remove(file1);
+    remove(file2);
+    remove(file3);
+}
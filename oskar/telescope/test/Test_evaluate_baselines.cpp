@@ -117,3 +117,57 @@ TEST(evaluate_baselines, cpu_gpu)
 
     ASSERT_EQ(0, status) << oskar_get_error_string(status);
 }
+
+TEST(evaluate_baselines, offsets)
+{
+    int status = 0;
+    const int num_stations = 37, num_times = 3, type = OSKAR_SINGLE;
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    oskar_Mem *u, *v, *w, *uu, *vv, *ww;
+    u = oskar_mem_create(type, OSKAR_CPU, num_stations * num_times, &status);
+    v = oskar_mem_create(type, OSKAR_CPU, num_stations * num_times, &status);
+    w = oskar_mem_create(type, OSKAR_CPU, num_stations * num_times, &status);
+    uu = oskar_mem_create(type, OSKAR_CPU, num_baselines * num_times, &status);
+    vv = oskar_mem_create(type, OSKAR_CPU, num_baselines * num_times, &status);
+    ww = oskar_mem_create(type, OSKAR_CPU, num_baselines * num_times, &status);
+    float* u_ = oskar_mem_float(u, &status);
+    float* v_ = oskar_mem_float(v, &status);
+    float* w_ = oskar_mem_float(w, &status);
+    for (int i = 0; i < num_stations * num_times; ++i)
+    {
+        u_[i] = (float) (i * i % 101);
+        v_[i] = (float) (-3 * i);
+        w_[i] = (float) (i % 7);
+    }
+
+    // Convert each time separately, as done for a visibility block.
+    for (int t = 0; t < num_times; ++t)
+        oskar_convert_station_uvw_to_baseline_uvw(num_stations,
+                t * num_stations, u, v, w, t * num_baselines, uu, vv, ww,
+                &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check results are correct.
+    const float* uu_ = oskar_mem_float_const(uu, &status);
+    const float* vv_ = oskar_mem_float_const(vv, &status);
+    const float* ww_ = oskar_mem_float_const(ww, &status);
+    for (int t = 0, b = 0; t < num_times; ++t)
+    {
+        const int i = t * num_stations;
+        for (int s1 = 0; s1 < num_stations; ++s1)
+        {
+            for (int s2 = s1 + 1; s2 < num_stations; ++s2, ++b)
+            {
+                EXPECT_FLOAT_EQ(u_[i + s2] - u_[i + s1], uu_[b]);
+                EXPECT_FLOAT_EQ(v_[i + s2] - v_[i + s1], vv_[b]);
+                EXPECT_FLOAT_EQ(w_[i + s2] - w_[i + s1], ww_[b]);
+            }
+        }
+    }
+    oskar_mem_free(u, &status);
+    oskar_mem_free(v, &status);
+    oskar_mem_free(w, &status);
+    oskar_mem_free(uu, &status);
+    oskar_mem_free(vv, &status);
+    oskar_mem_free(ww, &status);
+}
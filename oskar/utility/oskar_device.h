@@ -188,6 +188,45 @@ int oskar_device_is_gpu(int location);
 OSKAR_EXPORT
 int oskar_device_is_nv(int location);
 
+/**
+ * @brief Returns a handle to a compute kernel.
+ *
+ * @details
+ * Returns a handle that can be passed to
+ * oskar_device_launch_kernel_handle() to launch the named kernel,
+ * avoiding the lookup by name on each launch.
+ *
+ * Handles do not depend on the device, and remain valid for the lifetime
+ * of the process, so they can be cached in a static variable at the
+ * call site using oskar_device_kernel_handle_cached(). The kernel does not
+ * need to exist when the handle is created: an error is reported only if
+ * a kernel is launched that does not exist.
+ *
+ * @param[in] name           Name of the kernel.
+ *
+ * @return A positive kernel handle, or 0 if the name is NULL.
+ */
+OSKAR_EXPORT
+int oskar_device_kernel_handle(const char* name);
+
+/**
+ * @brief Returns a handle to a compute kernel, cached in a variable.
+ *
+ * @details
+ * Returns the kernel handle stored in \p handle, first setting it using
+ * oskar_device_kernel_handle() if it is zero.
+ *
+ * This is intended for use with a static variable at the call site,
+ * and may be called from multiple threads at once.
+ *
+ * @param[in,out] handle     Variable holding the cached handle.
+ * @param[in] name           Name of the kernel.
+ *
+ * @return A positive kernel handle, or 0 if the name is NULL.
+ */
+OSKAR_EXPORT
+int oskar_device_kernel_handle_cached(int* handle, const char* name);
+
 /**
  * @brief Launches a compute kernel.
  *
@@ -211,6 +250,34 @@ void oskar_device_launch_kernel(const char* name, int location,
         size_t num_args, const oskar_Arg* arg,
         size_t num_local_args, const size_t* arg_size_local, int* status);
 
+/**
+ * @brief Launches a compute kernel using a kernel handle.
+ *
+ * @details
+ * Launches a compute kernel on the current CUDA or OpenCL device,
+ * using a handle returned by oskar_device_kernel_handle().
+ *
+ * The arguments are otherwise the same as for oskar_device_launch_kernel().
+ * Note that kernels for OSKAR_CPU are called directly, and do not use
+ * this function.
+ *
+ * @param[in] handle         Kernel handle.
+ * @param[in] location       Either OSKAR_GPU or OSKAR_CL.
+ * @param[in] num_dims       Number of kernel work group dimensions (up to 3).
+ * @param[in] local_size[3]  3D work group, or thread block size.
+ * @param[in] global_size[3] Total size of 3D grid. (Multiple of local size.)
+ * @param[in] num_args       Number of kernel arguments, excluding local memory.
+ * @param[in] args           Array of oskar_Arg kernel arguments.
+ * @param[in] num_local_args Number of local memory arguments.
+ * @param[in] arg_size_local Size of each local memory argument, in bytes.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_device_launch_kernel_handle(int handle, int location,
+        int num_dims, size_t local_size[3], size_t global_size[3],
+        size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local, int* status);
+
 /**
  * @brief Returns the name of the specified device.
  *
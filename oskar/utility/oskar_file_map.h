@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_FILE_MAP_H_
+#define OSKAR_FILE_MAP_H_
+
+/**
+ * @file oskar_file_map.h
+ */
+
+#include <oskar_global.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maps the contents of a file into memory, read-only.
+ *
+ * @details
+ * Maps the whole of the named file into the address space of the process,
+ * so that it can be read without copying it into a buffer first.
+ * Pages are read from disk only when they are accessed.
+ *
+ * The mapping is read-only, so the data must not be modified.
+ * It must be released using oskar_file_unmap().
+ *
+ * @param[in]  filename  Path of the file to map.
+ * @param[out] size      Size of the file in bytes.
+ *
+ * @return Returns a pointer to the start of the mapping,
+ *         or NULL if the file could not be mapped or is empty.
+ */
+OSKAR_EXPORT
+void* oskar_file_map(const char* filename, size_t* size);
+
+/**
+ * @brief Releases a mapping made by oskar_file_map().
+ *
+ * @param[in] ptr   Pointer returned by oskar_file_map().
+ * @param[in] size  Size of the mapping, as returned by oskar_file_map().
+ */
+OSKAR_EXPORT
+void oskar_file_unmap(void* ptr, size_t size);
+
+/**
+ * @brief Returns the size and modification time of a file or directory.
+ *
+ * @details
+ * For a directory, such as a Measurement Set, the sizes of all the files
+ * in the directory and its sub-directories are summed, and the latest
+ * modification time of any of them is returned.
+ *
+ * @param[in]  path   Path of the file or directory.
+ * @param[out] size   Total size in bytes.
+ * @param[out] mtime  Modification time, in seconds since the epoch.
+ *
+ * @return Returns true if the item exists, false if not.
+ */
+OSKAR_EXPORT
+int oskar_file_stat(const char* path, size_t* size, double* mtime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_FILE_MAP_H_ */
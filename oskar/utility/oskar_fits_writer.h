@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_FITS_WRITER_H_
+#define OSKAR_FITS_WRITER_H_
+
+/**
+ * @file oskar_fits_writer.h
+ */
+
+#include <oskar_global.h>
+#include <mem/oskar_mem.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct oskar_FitsWriter;
+#ifndef OSKAR_FITS_WRITER_TYPEDEF_
+#define OSKAR_FITS_WRITER_TYPEDEF_
+typedef struct oskar_FitsWriter oskar_FitsWriter;
+#endif
+
+/**
+ * @brief
+ * Takes over a new FITS image file to write its pixels directly.
+ *
+ * @details
+ * Takes over a FITS image file that has just been created using CFITSIO,
+ * and which has had its header written but no pixel data.
+ *
+ * The header of the primary HDU is copied from the CFITSIO handle,
+ * and the file is then rewritten with the same header, followed by a
+ * data unit of the full size given by the NAXISn keywords. The CFITSIO
+ * handle is released and set to NULL, also if an error occurs.
+ *
+ * Since the position of every pixel in the file is then known,
+ * oskar_fits_writer_write() can write blocks of pixels straight to
+ * their place in the file, from any number of threads at once, without
+ * going through the CFITSIO buffers. The file contents are the same as
+ * if the pixels had been written using fits_write_pix().
+ *
+ * Only single and double precision floating-point images
+ * (BITPIX = -32 or -64) are supported.
+ *
+ * @param[in,out] fits_file  Address of CFITSIO handle (fitsfile**).
+ * @param[in,out] status     Status return code.
+ *
+ * @return A handle to the writer.
+ */
+OSKAR_EXPORT
+oskar_FitsWriter* oskar_fits_writer_create(void* fits_file, int* status);
+
+/**
+ * @brief
+ * Writes a contiguous block of pixels to the file.
+ *
+ * @details
+ * Writes \p num_pixels values from \p data, starting at element \p offset,
+ * to consecutive pixels in the file starting at \p first_pix.
+ * The pixel coordinates in \p first_pix are one-based, as for
+ * fits_write_pix(), and there must be one for each image axis.
+ *
+ * The values in \p data are treated as real numbers of the precision of
+ * \p data, which must match that of the image, so complex arrays
+ * holding real images (for example, after trimming) may be written too.
+ *
+ * This function is thread-safe: blocks of pixels that do not overlap
+ * may be written concurrently, as long as each thread passes its own
+ * \p status variable.
+ *
+ * @param[in] h              Handle to writer.
+ * @param[in] first_pix      One-based coordinates of the first pixel.
+ * @param[in] num_pixels     Number of pixels to write.
+ * @param[in] data           Pixel values to write.
+ * @param[in] offset         Offset into \p data of the first value.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_fits_writer_write(oskar_FitsWriter* h, const long* first_pix,
+        size_t num_pixels, const oskar_Mem* data, size_t offset,
+        int* status);
+
+/**
+ * @brief
+ * Closes the file and frees the writer.
+ *
+ * @details
+ * Closes the file and frees the writer.
+ *
+ * If \p fits_file is not NULL, the file is reopened for read-write access
+ * using CFITSIO, and the new handle is returned in it, so that more header
+ * keywords can be written.
+ *
+ * @param[in] h              Handle to writer.
+ * @param[in,out] fits_file  If not NULL, address of CFITSIO handle to set.
+ * @param[in,out] status     Status return code.
+ */
+OSKAR_EXPORT
+void oskar_fits_writer_free(oskar_FitsWriter* h, void* fits_file,
+        int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSKAR_FITS_WRITER_H_ */
@@ -205,6 +205,7 @@
 #elif defined(__cplusplus) || defined(_MSC_VER)
 #include <cmath>
 #endif
+#include "math/oskar_sincos.h"
 
 #define ATOMIC_ADD_CAPTURE_double(ARRAY, IDX, VAL, OLD)\
     DO_PRAGMA(omp atomic capture) { OLD = ARRAY[IDX]; ARRAY[IDX] += VAL; }
@@ -250,7 +251,14 @@
 #define ROUND_float(X) (int)roundf(X)
 #define ROUND_double(X) (int)round(X)
 #define RSQRT(X) (1 / sqrt(X))
-#define SINCOS(X, S, C) S = sin(X); C = cos(X)
+#define SINCOS(X, S, C) do {\
+    if (sizeof(X) == sizeof(double)) {\
+        double s_, c_; oskar_sincos_d((double) (X), &s_, &c_);\
+        S = s_; C = c_;\
+    } else {\
+        float s_, c_; oskar_sincos_f((float) (X), &s_, &c_);\
+        S = s_; C = c_;\
+    } } while (0)
 #define THREADFENCE_BLOCK
 
 #endif
@@ -142,6 +142,22 @@ void oskar_timer_resume(oskar_Timer* timer);
 OSKAR_EXPORT
 void oskar_timer_restart(oskar_Timer* timer);
 
+/**
+ * @brief Sets the name of the timer, used for tracing.
+ *
+ * @details
+ * If a name is set, the regions between resuming and pausing the timer
+ * are recorded as trace events when tracing is enabled.
+ * See oskar_trace.h.
+ *
+ * The name is stored by pointer, so use a string literal.
+ *
+ * @param[in,out] timer Pointer to timer.
+ * @param[in] name      Name of the timed region.
+ */
+OSKAR_EXPORT
+void oskar_timer_set_name(oskar_Timer* timer, const char* name);
+
 /**
  * @brief Starts and resets the timer.
  *
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef OSKAR_TRACE_H_
+#define OSKAR_TRACE_H_
+
+/**
+ * @file oskar_trace.h
+ */
+
+#include <oskar_global.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief
+ * Starts recording trace events.
+ *
+ * @details
+ * Clears any previously recorded events and enables tracing.
+ * While tracing is enabled, each thread records begin and end events
+ * in its own buffer, so recording does not need any locks.
+ *
+ * This should not be called while other threads are recording events.
+ */
+OSKAR_EXPORT
+void oskar_trace_start(void);
+
+/**
+ * @brief
+ * Stops recording trace events.
+ *
+ * @details
+ * Disables tracing. Events already recorded are kept until the next
+ * call to oskar_trace_start().
+ */
+OSKAR_EXPORT
+void oskar_trace_stop(void);
+
+/**
+ * @brief
+ * Returns true if trace events are being recorded.
+ */
+OSKAR_EXPORT
+int oskar_trace_enabled(void);
+
+/**
+ * @brief
+ * Sets the thread and device IDs of the calling thread.
+ *
+ * @details
+ * The IDs are used to label the thread in the trace output.
+ * Use a negative device ID if the thread does not use a compute device.
+ *
+ * @param[in] thread_id  Thread index within its thread group.
+ * @param[in] device_id  Index of the compute device used by the thread.
+ */
+OSKAR_EXPORT
+void oskar_trace_set_thread(int thread_id, int device_id);
+
+/**
+ * @brief
+ * Records the start of a named region on the calling thread.
+ *
+ * @details
+ * Does nothing if tracing is not enabled.
+ * The name is stored by pointer, so it must remain valid until the trace
+ * has been written (use a string literal).
+ * Regions on each thread must be properly nested.
+ *
+ * @param[in] name  Name of the region.
+ */
+OSKAR_EXPORT
+void oskar_trace_begin(const char* name);
+
+/**
+ * @brief
+ * Records the end of a named region on the calling thread.
+ *
+ * @details
+ * Does nothing if tracing is not enabled.
+ *
+ * @param[in] name  Name of the region.
+ */
+OSKAR_EXPORT
+void oskar_trace_end(const char* name);
+
+/**
+ * @brief
+ * Writes recorded events to a file in Chrome trace-event JSON format.
+ *
+ * @details
+ * The file can be loaded in chrome://tracing or https://ui.perfetto.dev.
+ *
+ * This should not be called while other threads are recording events.
+ *
+ * @param[in] filename   Path of the file to write.
+ * @param[in,out] status Status return code.
+ */
+OSKAR_EXPORT
+void oskar_trace_write(const char* filename, int* status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* include guard */
@@ -52,6 +52,8 @@
 #include "utility/oskar_thread.h"
 
 #ifdef OSKAR_OS_WIN
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
 #define THREAD_LOCAL __declspec(thread)
 #else
 #define THREAD_LOCAL __thread
@@ -62,6 +64,7 @@ struct oskar_DeviceKernels
     std::string src;
 #ifdef OSKAR_HAVE_OPENCL
     std::map<std::string, cl_kernel> kernel;
+    std::vector<cl_kernel> kernel_by_handle; // Resolved from kernel map.
 #endif
     virtual ~oskar_DeviceKernels()
     {
@@ -79,6 +82,11 @@ static THREAD_LOCAL unsigned int current_platform_ = 0;
 static THREAD_LOCAL unsigned int current_device_ = 0;
 static std::vector<oskar_Device*> cl_devices_;
 static std::map<std::string, const void*> cuda_kernels_;
+#ifdef OSKAR_HAVE_CUDA
+static std::vector<const void*> cuda_kernel_by_handle_;
+#endif
+static std::deque<std::string> kernel_names_; // Indexed by kernel handle.
+static std::map<std::string, int> kernel_handles_;
 static int require_double_ = 1; // Set if double precision is required.
 
 struct LocalMutex
@@ -210,17 +218,70 @@ int oskar_device_is_nv(int location)
     return 0;
 }
 
-void oskar_device_launch_kernel(const char* name, int location,
+int oskar_device_kernel_handle(const char* name)
+{
+    int handle = 0;
+    if (!name) return 0;
+    mutex_.lock();
+    if (kernel_names_.empty()) kernel_names_.push_back(std::string());
+    const std::string key(name);
+    std::map<std::string, int>::const_iterator iter =
+            kernel_handles_.find(key);
+    if (iter != kernel_handles_.end())
+        handle = iter->second;
+    else
+    {
+        handle = (int) kernel_names_.size();
+        kernel_names_.push_back(key);
+        kernel_handles_.insert(make_pair(key, handle));
+    }
+    mutex_.unlock();
+    return handle;
+}
+
+int oskar_device_kernel_handle_cached(int* handle, const char* name)
+{
+    // A name always gives the same non-zero handle, so threads that race
+    // to set the handle all store the same value.
+#ifdef OSKAR_OS_WIN
+    int h = (int) InterlockedCompareExchange((volatile LONG*) handle, 0, 0);
+#else
+    int h = __atomic_load_n(handle, __ATOMIC_ACQUIRE);
+#endif
+    if (h) return h;
+    h = oskar_device_kernel_handle(name);
+#ifdef OSKAR_OS_WIN
+    InterlockedExchange((volatile LONG*) handle, (LONG) h);
+#else
+    __atomic_store_n(handle, h, __ATOMIC_RELEASE);
+#endif
+    return h;
+}
+
+#if defined(OSKAR_HAVE_CUDA) || defined(OSKAR_HAVE_OPENCL)
+// Returns the name of a kernel from its handle. Call with mutex locked.
+static const char* kernel_name(int handle)
+{
+    return (handle > 0 && handle < (int) kernel_names_.size()) ?
+            kernel_names_[handle].c_str() : "(unknown)";
+}
+#endif
+
+// Launches a kernel given either its handle or (if the handle is 0) its name.
+static void launch_kernel(int handle, const char* name, int location,
         int num_dims, size_t local_size[3], size_t global_size[3],
         size_t num_args, const oskar_Arg* arg,
         size_t num_local_args, const size_t* arg_size_local, int* status)
 {
-    if (*status) return;
-    if (!name)
-    {
-        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
-        return;
-    }
+#if !defined(OSKAR_HAVE_CUDA) && !defined(OSKAR_HAVE_OPENCL)
+    (void) handle;
+    (void) name;
+    (void) num_dims;
+    (void) num_args;
+    (void) arg;
+    (void) num_local_args;
+    (void) arg_size_local;
+#endif
     if (local_size[0] == 0) local_size[0] = 1;
     if (local_size[1] == 0) local_size[1] = 1;
     if (local_size[2] == 0) local_size[2] = 1;
@@ -258,17 +319,40 @@ void oskar_device_launch_kernel(const char* name, int location,
                 cuda_kernels_.insert(make_pair(key, kernels[i].second));
             }
         }
-        std::map<std::string, const void*>::iterator iter =
-                cuda_kernels_.find(std::string(name));
-        mutex_.unlock();
-        if (iter != cuda_kernels_.end())
-            *status = (int) cudaLaunchKernel(iter->second,
-                    num_blocks, num_threads, arg_, shared_mem, 0);
+        const void* func = 0;
+        if (handle > 0)
+        {
+            if (handle >= (int) cuda_kernel_by_handle_.size())
+            {
+                // Resolve any handles created since the last launch.
+                size_t i = cuda_kernel_by_handle_.size();
+                cuda_kernel_by_handle_.resize(kernel_names_.size(), 0);
+                for (; i < kernel_names_.size(); ++i)
+                {
+                    std::map<std::string, const void*>::const_iterator iter =
+                            cuda_kernels_.find(kernel_names_[i]);
+                    if (iter != cuda_kernels_.end())
+                        cuda_kernel_by_handle_[i] = iter->second;
+                }
+            }
+            if (handle < (int) cuda_kernel_by_handle_.size())
+                func = cuda_kernel_by_handle_[handle];
+            name = kernel_name(handle);
+        }
         else
         {
+            std::map<std::string, const void*>::const_iterator iter =
+                    cuda_kernels_.find(std::string(name));
+            if (iter != cuda_kernels_.end()) func = iter->second;
+        }
+        if (!func)
             oskar_log_error(0, "Kernel '%s' has not been registered.", name);
+        mutex_.unlock();
+        if (func)
+            *status = (int) cudaLaunchKernel(func,
+                    num_blocks, num_threads, arg_, shared_mem, 0);
+        else
             *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
-        }
 #else
         *status = OSKAR_ERR_CUDA_NOT_AVAILABLE;
 #endif
@@ -282,9 +366,33 @@ void oskar_device_launch_kernel(const char* name, int location,
         if (cl_devices_.size() == 0) oskar_device_init_cl();
         if (current_device_ >= cl_devices_.size()) return;
         oskar_Device* device = cl_devices_[current_device_];
-        std::map<std::string, cl_kernel>::iterator iter =
-                device->kern->kernel.find(name);
-        if (iter != device->kern->kernel.end()) k = iter->second;
+        if (handle > 0)
+        {
+            std::vector<cl_kernel>& kernels = device->kern->kernel_by_handle;
+            mutex_.lock();
+            if (handle >= (int) kernels.size())
+            {
+                // Resolve any handles created since the last launch.
+                i = kernels.size();
+                kernels.resize(kernel_names_.size(), 0);
+                for (; i < kernel_names_.size(); ++i)
+                {
+                    std::map<std::string, cl_kernel>::const_iterator iter =
+                            device->kern->kernel.find(kernel_names_[i]);
+                    if (iter != device->kern->kernel.end())
+                        kernels[i] = iter->second;
+                }
+            }
+            if (handle < (int) kernels.size()) k = kernels[handle];
+            name = kernel_name(handle);
+            mutex_.unlock();
+        }
+        else
+        {
+            std::map<std::string, cl_kernel>::iterator iter =
+                    device->kern->kernel.find(name);
+            if (iter != device->kern->kernel.end()) k = iter->second;
+        }
         if (!k)
         {
             oskar_log_error(0, "Kernel '%s' has not been registered.", name);
@@ -332,6 +440,36 @@ void oskar_device_launch_kernel(const char* name, int location,
         *status = OSKAR_ERR_BAD_LOCATION;
 }
 
+void oskar_device_launch_kernel(const char* name, int location,
+        int num_dims, size_t local_size[3], size_t global_size[3],
+        size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local, int* status)
+{
+    if (*status) return;
+    if (!name)
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        return;
+    }
+    launch_kernel(0, name, location, num_dims, local_size, global_size,
+            num_args, arg, num_local_args, arg_size_local, status);
+}
+
+void oskar_device_launch_kernel_handle(int handle, int location,
+        int num_dims, size_t local_size[3], size_t global_size[3],
+        size_t num_args, const oskar_Arg* arg,
+        size_t num_local_args, const size_t* arg_size_local, int* status)
+{
+    if (*status) return;
+    if (handle <= 0)
+    {
+        *status = OSKAR_ERR_FUNCTION_NOT_AVAILABLE;
+        return;
+    }
+    launch_kernel(handle, 0, location, num_dims, local_size, global_size,
+            num_args, arg, num_local_args, arg_size_local, status);
+}
+
 char* oskar_device_name(int location, int id)
 {
     char* name = 0;
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "utility/oskar_file_map.h"
+#include "utility/oskar_dir.h"
+
+#ifndef OSKAR_OS_WIN
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#else
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* oskar_file_map(const char* filename, size_t* size)
+{
+    void* ptr = 0;
+    *size = 0;
+    if (!filename || !*filename) return 0;
+#ifndef OSKAR_OS_WIN
+    struct stat s;
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+    if (!fstat(fd, &s) && S_ISREG(s.st_mode) && s.st_size > 0)
+    {
+        ptr = mmap(0, (size_t) s.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+            ptr = 0;
+        else
+            *size = (size_t) s.st_size;
+    }
+    close(fd);
+#else
+    LARGE_INTEGER file_size;
+    HANDLE map, file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+    {
+        map = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (map)
+        {
+            ptr = MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+            if (ptr) *size = (size_t) file_size.QuadPart;
+            CloseHandle(map);
+        }
+    }
+    CloseHandle(file);
+#endif
+    return ptr;
+}
+
+
+void oskar_file_unmap(void* ptr, size_t size)
+{
+    if (!ptr) return;
+#ifndef OSKAR_OS_WIN
+    munmap(ptr, size);
+#else
+    (void) size;
+    UnmapViewOfFile(ptr);
+#endif
+}
+
+
+int oskar_file_stat(const char* path, size_t* size, double* mtime)
+{
+    int i, num_items = 0;
+    char** items = 0;
+    *size = 0;
+    *mtime = 0.0;
+    if (!path || !*path) return 0;
+#ifndef OSKAR_OS_WIN
+    struct stat s;
+    if (stat(path, &s)) return 0;
+#ifdef OSKAR_OS_LINUX
+    *mtime = (double) s.st_mtim.tv_sec + 1e-9 * (double) s.st_mtim.tv_nsec;
+#else
+    *mtime = (double) s.st_mtime;
+#endif
+    if (!S_ISDIR(s.st_mode))
+    {
+        *size = (size_t) s.st_size;
+        return 1;
+    }
+#else
+    struct _stat64 s;
+    if (_stat64(path, &s)) return 0;
+    *mtime = (double) s.st_mtime;
+    if (!(s.st_mode & _S_IFDIR))
+    {
+        *size = (size_t) s.st_size;
+        return 1;
+    }
+#endif
+
+    /* Recurse into the directory. */
+    oskar_dir_items(path, 0, 1, 1, &num_items, &items);
+    for (i = 0; i < num_items; ++i)
+    {
+        size_t item_size = 0;
+        double item_mtime = 0.0;
+        char* item_path = oskar_dir_get_path(path, items[i]);
+        if (oskar_file_stat(item_path, &item_size, &item_mtime))
+        {
+            *size += item_size;
+            if (item_mtime > *mtime) *mtime = item_mtime;
+        }
+        free(item_path);
+        free(items[i]);
+    }
+    free(items);
+    return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
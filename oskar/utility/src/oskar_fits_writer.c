@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "utility/oskar_fits_writer.h"
+
+#include <fitsio.h>
+
+#ifndef OSKAR_OS_WIN
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#else
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FITS_BLOCK 2880
+#define FITS_CARD 80
+#define MAX_AXES 9
+
+/* Size of the buffer used to convert pixels to big-endian byte order. */
+#define SWAP_BUFFER_SIZE (1 << 20)
+
+struct oskar_FitsWriter
+{
+    char* filename;
+#ifndef OSKAR_OS_WIN
+    int fd;
+#else
+    HANDLE file;
+#endif
+    int naxis, bytes_per_pixel;
+    long long naxes[MAX_AXES], num_pixels, data_start;
+};
+
+static int write_bytes(oskar_FitsWriter* h, const char* buffer,
+        size_t num_bytes, long long pos)
+{
+    while (num_bytes > 0)
+    {
+#ifndef OSKAR_OS_WIN
+        const ssize_t n = pwrite(h->fd, buffer, num_bytes, (off_t) pos);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 1;
+#else
+        DWORD n = 0;
+        OVERLAPPED ov;
+        const DWORD len = num_bytes > 0x40000000 ?
+                0x40000000 : (DWORD) num_bytes;
+        memset(&ov, 0, sizeof(OVERLAPPED));
+        ov.Offset = (DWORD) (pos & 0xFFFFFFFF);
+        ov.OffsetHigh = (DWORD) (pos >> 32);
+        if (!WriteFile(h->file, buffer, len, &n, &ov) || n == 0) return 1;
+#endif
+        buffer += n;
+        num_bytes -= (size_t) n;
+        pos += (long long) n;
+    }
+    return 0;
+}
+
+static int is_little_endian(void)
+{
+    const int i = 1;
+    return *((const char*) &i) == 1;
+}
+
+/* Releases the CFITSIO handle. A non-zero status makes CFITSIO close
+ * the file without filling the whole data unit with zeros first. */
+static void release_fits_file(fitsfile** f)
+{
+    int fits_status = NO_CLOSE_ERROR;
+    fits_close_file(*f, &fits_status);
+    *f = 0;
+}
+
+static oskar_FitsWriter* create_failed(oskar_FitsWriter* h, fitsfile** f,
+        int error, int* status)
+{
+    *status = error;
+    if (*f) release_fits_file(f);
+    oskar_fits_writer_free(h, 0, status);
+    return 0;
+}
+
+oskar_FitsWriter* oskar_fits_writer_create(void* fits_file, int* status)
+{
+    int i, bitpix = 0, num_keys = 0, fits_status = 0;
+    LONGLONG naxes[MAX_AXES], head_start = 0, data_start = 0, data_end = 0;
+    long long data_size, end_pos;
+    char card[FLEN_CARD], filename[FLEN_FILENAME], *header = 0;
+    fitsfile** f = (fitsfile**) fits_file;
+    oskar_FitsWriter* h = 0;
+    if (*status) return 0;
+    if (!f || !*f)
+    {
+        *status = OSKAR_ERR_INVALID_ARGUMENT;
+        return 0;
+    }
+    h = (oskar_FitsWriter*) calloc(1, sizeof(oskar_FitsWriter));
+    if (!h) return create_failed(h, f, OSKAR_ERR_MEMORY_ALLOC_FAILURE, status);
+#ifndef OSKAR_OS_WIN
+    h->fd = -1;
+#else
+    h->file = INVALID_HANDLE_VALUE;
+#endif
+
+    /* Get the image dimensions and the position of the data unit. */
+    fits_get_img_paramll(*f, MAX_AXES, &bitpix, &h->naxis, naxes,
+            &fits_status);
+    fits_get_hdrspace(*f, &num_keys, 0, &fits_status);
+    fits_get_hduaddrll(*f, &head_start, &data_start, &data_end,
+            &fits_status);
+    fits_file_name(*f, filename, &fits_status);
+    if (fits_status || head_start != 0 ||
+            h->naxis < 0 || h->naxis > MAX_AXES ||
+            data_start < (LONGLONG) (num_keys + 1) * FITS_CARD)
+        return create_failed(h, f, OSKAR_ERR_FILE_IO, status);
+    if (bitpix != FLOAT_IMG && bitpix != DOUBLE_IMG)
+        return create_failed(h, f, OSKAR_ERR_BAD_DATA_TYPE, status);
+    h->bytes_per_pixel = abs(bitpix) / 8;
+    h->data_start = (long long) data_start;
+    h->num_pixels = h->naxis > 0 ? 1 : 0;
+    for (i = 0; i < h->naxis; ++i)
+    {
+        h->naxes[i] = (long long) naxes[i];
+        h->num_pixels *= h->naxes[i];
+    }
+    data_size = h->num_pixels * h->bytes_per_pixel;
+    data_size = FITS_BLOCK * ((data_size + FITS_BLOCK - 1) / FITS_BLOCK);
+    h->filename = (char*) calloc(1 + strlen(filename), 1);
+    if (!h->filename)
+        return create_failed(h, f, OSKAR_ERR_MEMORY_ALLOC_FAILURE, status);
+    strcpy(h->filename, filename);
+
+    /* Copy the header cards, placing the END card in the same place as
+     * CFITSIO: after the last card, or at the start of the last header
+     * block if space has been reserved for more cards. */
+    header = (char*) malloc((size_t) data_start);
+    if (!header)
+        return create_failed(h, f, OSKAR_ERR_MEMORY_ALLOC_FAILURE, status);
+    memset(header, ' ', (size_t) data_start);
+    for (i = 0; i < num_keys; ++i)
+    {
+        fits_read_record(*f, i + 1, card, &fits_status);
+        memcpy(header + i * FITS_CARD, card, strlen(card));
+    }
+    end_pos = (long long) num_keys * FITS_CARD;
+    if (end_pos < data_start - FITS_BLOCK) end_pos = data_start - FITS_BLOCK;
+    memcpy(header + end_pos, "END", 3);
+
+    /* Release the CFITSIO handle. */
+    release_fits_file(f);
+
+    /* Rewrite the file, with space for the data unit. */
+#ifndef OSKAR_OS_WIN
+    h->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fits_status || h->fd < 0 ||
+            write_bytes(h, header, (size_t) data_start, 0) ||
+            ftruncate(h->fd, (off_t) (data_start + data_size)))
+        *status = OSKAR_ERR_FILE_IO;
+#else
+    h->file = CreateFileA(filename, GENERIC_WRITE, FILE_SHARE_READ, NULL,
+            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fits_status || h->file == INVALID_HANDLE_VALUE ||
+            write_bytes(h, header, (size_t) data_start, 0))
+        *status = OSKAR_ERR_FILE_IO;
+    else
+    {
+        LARGE_INTEGER size;
+        size.QuadPart = data_start + data_size;
+        if (!SetFilePointerEx(h->file, size, NULL, FILE_BEGIN) ||
+                !SetEndOfFile(h->file))
+            *status = OSKAR_ERR_FILE_IO;
+    }
+#endif
+    free(header);
+    if (*status)
+    {
+        oskar_fits_writer_free(h, 0, status);
+        return 0;
+    }
+    return h;
+}
+
+void oskar_fits_writer_write(oskar_FitsWriter* h, const long* first_pix,
+        size_t num_pixels, const oskar_Mem* data, size_t offset,
+        int* status)
+{
+    int i;
+    long long index = 0, stride = 1;
+    size_t num_bytes, j, k;
+    const char* in;
+    char* buffer;
+    if (*status || num_pixels == 0) return;
+    if (oskar_mem_location(data) != OSKAR_CPU)
+    {
+        *status = OSKAR_ERR_BAD_LOCATION;
+        return;
+    }
+    if ((int) oskar_mem_element_size(oskar_mem_precision(data)) !=
+            h->bytes_per_pixel)
+    {
+        *status = OSKAR_ERR_BAD_DATA_TYPE;
+        return;
+    }
+
+    /* Find the index of the first pixel in the data unit. */
+    for (i = 0; i < h->naxis; ++i)
+    {
+        if (first_pix[i] < 1 || first_pix[i] > h->naxes[i])
+        {
+            *status = OSKAR_ERR_OUT_OF_RANGE;
+            return;
+        }
+        index += stride * (first_pix[i] - 1);
+        stride *= h->naxes[i];
+    }
+    if (index + (long long) num_pixels > h->num_pixels ||
+            (offset + num_pixels) * h->bytes_per_pixel > oskar_mem_length(
+            data) * oskar_mem_element_size(oskar_mem_type(data)))
+    {
+        *status = OSKAR_ERR_OUT_OF_RANGE;
+        return;
+    }
+    num_bytes = num_pixels * h->bytes_per_pixel;
+    in = (const char*) oskar_mem_void_const(data) +
+            offset * h->bytes_per_pixel;
+    index = h->data_start + index * h->bytes_per_pixel;
+
+    /* FITS data are big-endian, so swap the bytes first if required. */
+    if (!is_little_endian())
+    {
+        if (write_bytes(h, in, num_bytes, index))
+            *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    const size_t buffer_size = num_bytes < SWAP_BUFFER_SIZE ?
+            num_bytes : SWAP_BUFFER_SIZE;
+    buffer = (char*) malloc(buffer_size);
+    if (!buffer)
+    {
+        *status = OSKAR_ERR_MEMORY_ALLOC_FAILURE;
+        return;
+    }
+    for (j = 0; j < num_bytes; j += buffer_size)
+    {
+        const size_t block = (num_bytes - j) < buffer_size ?
+                (num_bytes - j) : buffer_size;
+        if (h->bytes_per_pixel == 8)
+        {
+            for (k = 0; k < block; k += 8)
+            {
+                const char* p = in + j + k;
+                char* b = buffer + k;
+                b[0] = p[7]; b[1] = p[6]; b[2] = p[5]; b[3] = p[4];
+                b[4] = p[3]; b[5] = p[2]; b[6] = p[1]; b[7] = p[0];
+            }
+        }
+        else
+        {
+            for (k = 0; k < block; k += 4)
+            {
+                const char* p = in + j + k;
+                char* b = buffer + k;
+                b[0] = p[3]; b[1] = p[2]; b[2] = p[1]; b[3] = p[0];
+            }
+        }
+        if (write_bytes(h, buffer, block, index + (long long) j))
+        {
+            *status = OSKAR_ERR_FILE_IO;
+            break;
+        }
+    }
+    free(buffer);
+}
+
+void oskar_fits_writer_free(oskar_FitsWriter* h, void* fits_file,
+        int* status)
+{
+    int fits_status = 0;
+    if (!h) return;
+#ifndef OSKAR_OS_WIN
+    if (h->fd >= 0 && close(h->fd) && !*status)
+        *status = OSKAR_ERR_FILE_IO;
+#else
+    if (h->file != INVALID_HANDLE_VALUE && !CloseHandle(h->file) && !*status)
+        *status = OSKAR_ERR_FILE_IO;
+#endif
+    if (fits_file && h->filename && !*status)
+    {
+        fits_open_file((fitsfile**) fits_file, h->filename, READWRITE,
+                &fits_status);
+        if (fits_status) *status = OSKAR_ERR_FILE_IO;
+    }
+    free(h->filename);
+    free(h);
+}
+
+#ifdef __cplusplus
+}
+#endif
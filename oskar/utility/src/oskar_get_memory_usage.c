@@ -27,6 +27,7 @@
  */
 
 #include "utility/oskar_get_memory_usage.h"
+#include "mem/oskar_mem_pool.h"
 
 #include <stdio.h>
 #include <stddef.h>
@@ -228,11 +229,14 @@ size_t oskar_get_memory_usage(void)
 void oskar_print_memory_info(void)
 {
     size_t totalSwapMem, freeSwapMem, totalPhysMem, freePhysMem, usedMem;
+    size_t num_allocs, num_reused, in_use, peak, cached;
     totalPhysMem = oskar_get_total_physical_memory();
     freePhysMem = oskar_get_free_physical_memory();
     totalSwapMem = oskar_get_total_swap_memory();
     freeSwapMem = oskar_get_free_swap_memory();
     usedMem = oskar_get_memory_usage();
+    oskar_mem_pool_counters(&num_allocs, &num_reused,
+            &in_use, &peak, &cached);
     printf("Memory used by current process: %lu MB\n",
            (unsigned long) (usedMem/(1024*1024)));
     printf("Free physical memory: %lu MB (of %lu MB)\n",
@@ -241,6 +245,12 @@ void oskar_print_memory_info(void)
     printf("Free swap memory: %lu MB (of %lu MB)\n",
             (unsigned long) (freeSwapMem/(1024*1024)),
             (unsigned long) (totalSwapMem/(1024*1024)));
+    printf("Host arrays: %lu MB in use (peak %lu MB), %lu MB pooled\n",
+            (unsigned long) (in_use/(1024*1024)),
+            (unsigned long) (peak/(1024*1024)),
+            (unsigned long) (cached/(1024*1024)));
+    printf("Host array allocations: %lu (%lu reused from pool)\n",
+            (unsigned long) num_allocs, (unsigned long) num_reused);
 }
 
 void oskar_log_mem(oskar_Log* log)
@@ -250,6 +260,9 @@ void oskar_log_mem(oskar_Log* log)
     const size_t mem_resident = oskar_get_memory_usage();
     const size_t mem_free = oskar_get_free_physical_memory();
     const size_t mem_used = mem_total - mem_free;
+    size_t num_allocs, num_reused, in_use, peak, cached;
+    oskar_mem_pool_counters(&num_allocs, &num_reused,
+            &in_use, &peak, &cached);
     oskar_log_message(log, 'M', 0,
             "System memory is %.1f%% (%.1f GB/%.1f GB) used.",
             100. * (double) mem_used / mem_total,
@@ -258,6 +271,14 @@ void oskar_log_mem(oskar_Log* log)
     oskar_log_message(log, 'M', 0,
             "System memory used by current process: %.1f MB.",
             (double) mem_resident / (1024. * 1024.));
+    oskar_log_message(log, 'M', 0,
+            "Host arrays: %.1f MB in use (peak %.1f MB), %.1f MB pooled.",
+            (double) in_use / (1024. * 1024.),
+            (double) peak / (1024. * 1024.),
+            (double) cached / (1024. * 1024.));
+    oskar_log_message(log, 'M', 0,
+            "Host array allocations: %lu (%lu reused from pool).",
+            (unsigned long) num_allocs, (unsigned long) num_reused);
 }
 
 #ifdef __cplusplus
@@ -27,6 +27,7 @@
  */
 
 #include "utility/oskar_thread.h"
+#include "utility/oskar_trace.h"
 #include <stdlib.h>
 
 #ifdef OSKAR_OS_WIN
@@ -90,6 +91,23 @@ void oskar_mutex_free(oskar_Mutex* mutex)
 
 void oskar_mutex_lock(oskar_Mutex* mutex)
 {
+    /* If tracing, record the time spent waiting for a contended lock. */
+    if (oskar_trace_enabled())
+    {
+#ifdef OSKAR_OS_WIN
+        if (TryEnterCriticalSection(&mutex->lock)) return;
+#else
+        if (!pthread_mutex_trylock(&mutex->lock)) return;
+#endif
+        oskar_trace_begin("Mutex wait");
+#ifdef OSKAR_OS_WIN
+        EnterCriticalSection(&mutex->lock);
+#else
+        pthread_mutex_lock(&mutex->lock);
+#endif
+        oskar_trace_end("Mutex wait");
+        return;
+    }
 #ifdef OSKAR_OS_WIN
     EnterCriticalSection(&mutex->lock);
 #else
@@ -281,6 +299,7 @@ void oskar_barrier_set_num_threads(oskar_Barrier* barrier, int num_threads)
 
 int oskar_barrier_wait(oskar_Barrier* barrier)
 {
+    oskar_trace_begin("Barrier wait");
     oskar_condition_lock(&barrier->var);
     {
         const unsigned int i = barrier->iter;
@@ -290,6 +309,7 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
             barrier->count = barrier->num_threads;
             oskar_condition_notify_all(&barrier->var);
             oskar_condition_unlock(&barrier->var);
+            oskar_trace_end("Barrier wait");
             return 1;
         }
         /* Release lock and block this thread until notified/woken. */
@@ -299,6 +319,7 @@ int oskar_barrier_wait(oskar_Barrier* barrier)
         } while (i == barrier->iter);
     }
     oskar_condition_unlock(&barrier->var);
+    oskar_trace_end("Barrier wait");
     return 0;
 }
 
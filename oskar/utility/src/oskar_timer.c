@@ -29,6 +29,7 @@
 #include "utility/oskar_device.h"
 #include "utility/oskar_timer.h"
 #include "utility/oskar_thread.h"
+#include "utility/oskar_trace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
@@ -59,6 +60,7 @@ extern "C" {
 struct oskar_Timer
 {
     oskar_Mutex* mutex;
+    const char* name; /* Name of region to trace, if not NULL. */
 #ifdef OSKAR_HAVE_CUDA
     cudaEvent_t start_cuda, end_cuda;
 #endif
@@ -188,10 +190,12 @@ void oskar_timer_pause(oskar_Timer* timer)
     if (timer->paused) return;
     (void)oskar_timer_elapsed(timer);
     timer->paused = 1;
+    if (timer->name) oskar_trace_end(timer->name);
 }
 
 void oskar_timer_reset(oskar_Timer* timer)
 {
+    if (timer->name && !timer->paused) oskar_trace_end(timer->name);
     oskar_mutex_lock(timer->mutex);
     timer->paused = 1;
     timer->start = 0.0;
@@ -207,6 +211,7 @@ void oskar_timer_resume(oskar_Timer* timer)
 
 void oskar_timer_restart(oskar_Timer* timer)
 {
+    if (timer->name && timer->paused) oskar_trace_begin(timer->name);
     timer->paused = 0;
 #ifdef OSKAR_HAVE_CUDA
     if (timer->type == OSKAR_TIMER_CUDA)
@@ -218,6 +223,11 @@ void oskar_timer_restart(oskar_Timer* timer)
     timer->start = oskar_get_wtime(timer);
 }
 
+void oskar_timer_set_name(oskar_Timer* timer, const char* name)
+{
+    timer->name = name;
+}
+
 void oskar_timer_start(oskar_Timer* timer)
 {
     timer->elapsed = 0.0;
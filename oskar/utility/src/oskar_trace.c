@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "utility/oskar_trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef OSKAR_OS_WIN
+#include <sys/time.h>
+#include <unistd.h>
+#define THREAD_LOCAL __thread
+#define ATOMIC_INC(VAR) __atomic_add_fetch(&VAR, 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_PUSH(HEAD, NODE) \
+    do { NODE->next = __atomic_load_n(&HEAD, __ATOMIC_ACQUIRE); } \
+    while (!__atomic_compare_exchange_n(&HEAD, &NODE->next, NODE, 0, \
+            __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+#else
+#include <windows.h>
+#define THREAD_LOCAL __declspec(thread)
+#define ATOMIC_INC(VAR) InterlockedIncrement((volatile LONG*) &VAR)
+#define ATOMIC_PUSH(HEAD, NODE) \
+    do { NODE->next = HEAD; } \
+    while (InterlockedCompareExchangePointer((PVOID volatile*) &HEAD, \
+            NODE, NODE->next) != NODE->next)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct TraceEvent TraceEvent;
+struct TraceEvent
+{
+    const char* name;
+    double ts; /* Microseconds since the trace started. */
+    char ph;   /* Event phase: 'B' or 'E'. */
+};
+
+typedef struct TraceBuffer TraceBuffer;
+struct TraceBuffer
+{
+    TraceBuffer* next;
+    TraceEvent* events;
+    int num_events, capacity, tid, thread_id, device_id;
+};
+
+/* Global state. */
+static volatile int enabled_ = 0;
+static int generation_ = 0, next_tid_ = 0;
+static double t0_ = 0.0;
+static TraceBuffer* buffers_ = 0;
+
+/* State for the calling thread. */
+static THREAD_LOCAL TraceBuffer* buffer_ = 0;
+static THREAD_LOCAL int buffer_generation_ = -1;
+static THREAD_LOCAL int thread_id_ = -1, device_id_ = -1;
+
+static double get_wtime(void)
+{
+#if defined(OSKAR_OS_WIN)
+    LARGE_INTEGER cntr, freq;
+    QueryPerformanceCounter(&cntr);
+    QueryPerformanceFrequency(&freq);
+    return (double)(cntr.QuadPart) / (double)(freq.QuadPart);
+#elif _POSIX_MONOTONIC_CLOCK > 0
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+#endif
+}
+
+static TraceBuffer* get_buffer(void)
+{
+    if (buffer_ && buffer_generation_ == generation_) return buffer_;
+    buffer_ = (TraceBuffer*) calloc(1, sizeof(TraceBuffer));
+    if (!buffer_) return 0;
+    buffer_generation_ = generation_;
+    buffer_->tid = ATOMIC_INC(next_tid_);
+    buffer_->thread_id = thread_id_;
+    buffer_->device_id = device_id_;
+    ATOMIC_PUSH(buffers_, buffer_);
+    return buffer_;
+}
+
+static void record(const char* name, char ph)
+{
+    const double ts = 1e6 * (get_wtime() - t0_);
+    TraceBuffer* b = get_buffer();
+    if (!b) return;
+    if (b->num_events == b->capacity)
+    {
+        const int capacity = b->capacity > 0 ? 2 * b->capacity : 1024;
+        TraceEvent* t = (TraceEvent*) realloc(b->events,
+                capacity * sizeof(TraceEvent));
+        if (!t) return;
+        b->events = t;
+        b->capacity = capacity;
+    }
+    b->events[b->num_events].name = name;
+    b->events[b->num_events].ts = ts;
+    b->events[b->num_events].ph = ph;
+    b->num_events++;
+}
+
+void oskar_trace_start(void)
+{
+    TraceBuffer* b = buffers_;
+    enabled_ = 0;
+    while (b)
+    {
+        TraceBuffer* next = b->next;
+        free(b->events);
+        free(b);
+        b = next;
+    }
+    buffers_ = 0;
+    generation_++;
+    next_tid_ = 0;
+    t0_ = get_wtime();
+    enabled_ = 1;
+}
+
+void oskar_trace_stop(void)
+{
+    enabled_ = 0;
+}
+
+int oskar_trace_enabled(void)
+{
+    return enabled_;
+}
+
+void oskar_trace_set_thread(int thread_id, int device_id)
+{
+    thread_id_ = thread_id;
+    device_id_ = device_id;
+    if (buffer_ && buffer_generation_ == generation_)
+    {
+        buffer_->thread_id = thread_id;
+        buffer_->device_id = device_id;
+    }
+}
+
+void oskar_trace_begin(const char* name)
+{
+    if (enabled_) record(name, 'B');
+}
+
+void oskar_trace_end(const char* name)
+{
+    if (enabled_) record(name, 'E');
+}
+
+static void write_string(FILE* file, const char* s)
+{
+    fputc('"', file);
+    for (; *s; ++s)
+    {
+        if (*s == '"' || *s == '\\') fputc('\\', file);
+        fputc(*s, file);
+    }
+    fputc('"', file);
+}
+
+void oskar_trace_write(const char* filename, int* status)
+{
+    int i, first = 1;
+    TraceBuffer* b;
+    FILE* file;
+    if (*status) return;
+    file = fopen(filename, "w");
+    if (!file)
+    {
+        *status = OSKAR_ERR_FILE_IO;
+        return;
+    }
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    for (b = buffers_; b; b = b->next)
+    {
+        /* Label the thread. */
+        fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", "
+                "\"pid\": 0, \"tid\": %d, \"args\": {\"name\": \"",
+                first ? "" : ",\n", b->tid);
+        if (b->thread_id < 0)
+            fprintf(file, "Thread %d", b->tid);
+        else
+            fprintf(file, "Thread %d", b->thread_id);
+        if (b->device_id >= 0)
+            fprintf(file, " (device %d)", b->device_id);
+        fprintf(file, "\"}}");
+        fprintf(file, ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", "
+                "\"pid\": 0, \"tid\": %d, \"args\": {\"sort_index\": %d}}",
+                b->tid, b->thread_id < 0 ? b->tid : b->thread_id);
+        first = 0;
+
+        /* Write the events. */
+        for (i = 0; i < b->num_events; ++i)
+        {
+            const TraceEvent* e = &b->events[i];
+            fprintf(file, ",\n{\"name\": ");
+            write_string(file, e->name ? e->name : "");
+            fprintf(file, ", \"ph\": \"%c\", \"ts\": %.3f, "
+                    "\"pid\": 0, \"tid\": %d", e->ph, e->ts, b->tid);
+            if (b->device_id >= 0)
+                fprintf(file, ", \"args\": {\"device\": %d}", b->device_id);
+            fprintf(file, "}");
+        }
+    }
+    fprintf(file, "\n]}\n");
+    if (fclose(file)) *status = OSKAR_ERR_FILE_IO;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <string>
+
+TEST(device, kernel_handle)
+{
+    // Handles must be stable, and distinct for different names.
+    const std::string name("mem_add_double");
+    const int h1 = oskar_device_kernel_handle("mem_add_double");
+    const int h2 = oskar_device_kernel_handle("mem_add_float");
+    EXPECT_GT(h1, 0);
+    EXPECT_GT(h2, 0);
+    EXPECT_NE(h1, h2);
+    EXPECT_EQ(h1, oskar_device_kernel_handle(name.c_str()));
+    EXPECT_EQ(0, oskar_device_kernel_handle(0));
+
+    // An invalid handle must not be launched.
+    int status = 0;
+    size_t local_size[] = {1, 1, 1}, global_size[] = {1, 1, 1};
+    oskar_device_launch_kernel_handle(0, OSKAR_GPU, 1,
+            local_size, global_size, 0, 0, 0, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_FUNCTION_NOT_AVAILABLE, status)
+            << oskar_get_error_string(status);
+}
+
+TEST(device, kernel_handle_cached)
+{
+    // Threads racing to cache a handle must all get the same one.
+    static int handle = 0;
+    const int expected = oskar_device_kernel_handle("mem_scale_real_float");
+    int num_wrong = 0;
+#pragma omp parallel for reduction(+:num_wrong)
+    for (int i = 0; i < 64; ++i)
+    {
+        if (oskar_device_kernel_handle_cached(&handle,
+                "mem_scale_real_float") != expected)
+            num_wrong++;
+    }
+    EXPECT_EQ(0, num_wrong);
+    EXPECT_EQ(expected, handle);
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "mem/oskar_mem.h"
+#include "utility/oskar_fits_writer.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <fitsio.h>
+#include <cstdio>
+#include <vector>
+
+// Creates a file in the same way as the imager, or (if reserve_keys is 0)
+// in the same way as the beam pattern generator, which updates the image
+// dimensions after writing the header.
+static fitsfile* create_file(const char* filename, int bitpix,
+        int num_axes, long* naxes, int reserve_keys, int* status)
+{
+    fitsfile* f = 0;
+    long naxes_dummy[] = {1, 1, 1};
+    remove(filename);
+    fits_create_file(&f, filename, status);
+    fits_create_img(f, bitpix, num_axes,
+            reserve_keys > 0 ? naxes : naxes_dummy, status);
+    if (reserve_keys > 0) fits_set_hdrsize(f, reserve_keys, status);
+    fits_write_key_str(f, "BUNIT", "JY/BEAM", "Brightness units", status);
+    fits_write_key_dbl(f, "CRVAL1", 12.5, 10, NULL, status);
+    if (reserve_keys == 0)
+    {
+        fits_update_key_lng(f, "NAXIS1", naxes[0], 0, status);
+        fits_update_key_lng(f, "NAXIS2", naxes[1], 0, status);
+        fits_update_key_lng(f, "NAXIS3", naxes[2], 0, status);
+    }
+    return f;
+}
+
+static void write_history(fitsfile* f, int num_lines, int* status)
+{
+    for (int i = 0; i < num_lines; ++i)
+    {
+        char line[64];
+        sprintf(line, "History line %d", i);
+        fits_write_history(f, line, status);
+    }
+    fits_close_file(f, status);
+}
+
+static std::vector<char> read_file(const char* filename)
+{
+    std::vector<char> data;
+    FILE* f = fopen(filename, "rb");
+    if (!f) return data;
+    fseek(f, 0, SEEK_END);
+    data.resize((size_t) ftell(f));
+    fseek(f, 0, SEEK_SET);
+    if (fread(&data[0], 1, data.size(), f) != data.size()) data.clear();
+    fclose(f);
+    return data;
+}
+
+static void check_writer(int type, int reserve_keys, int num_history)
+{
+    int status = 0;
+    const int width = 37, height = 29, num_planes = 5;
+    long naxes[] = {width, height, num_planes};
+    const int bitpix = (type == OSKAR_DOUBLE ? DOUBLE_IMG : FLOAT_IMG);
+    const int datatype = (type == OSKAR_DOUBLE ? TDOUBLE : TFLOAT);
+    const size_t num_pix = (size_t) width * height;
+    const char* name1 = "temp_test_fits_writer_cfitsio.fits";
+    const char* name2 = "temp_test_fits_writer.fits";
+    oskar_Mem* data = oskar_mem_create(type, OSKAR_CPU,
+            num_pix * num_planes, &status);
+    oskar_mem_random_gaussian(data, 1, 2, 3, 4, 1.0, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Write the planes using CFITSIO.
+    fitsfile* f = create_file(name1, bitpix, 3, naxes, reserve_keys, &status);
+    for (int p = 0; p < num_planes; ++p)
+    {
+        long firstpix[] = {1, 1, 1 + p};
+        fits_write_pix(f, datatype, firstpix, (long) num_pix,
+                (char*) oskar_mem_void(data) +
+                p * num_pix * oskar_mem_element_size(type), &status);
+    }
+    write_history(f, num_history, &status);
+    ASSERT_EQ(0, status);
+
+    // Write the same planes using the writer, in reverse order, in parallel,
+    // and in two parts each.
+    f = create_file(name2, bitpix, 3, naxes, reserve_keys, &status);
+    oskar_FitsWriter* w = oskar_fits_writer_create(&f, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(f == 0);
+#pragma omp parallel for
+    for (int p = num_planes - 1; p >= 0; --p)
+    {
+        const size_t half = num_pix / 2;
+        long first1[] = {1, 1, 1 + p};
+        long first2[] = {1 + (long) (half % width),
+                1 + (long) (half / width), 1 + p};
+        oskar_fits_writer_write(w, first2, num_pix - half, data,
+                p * num_pix + half, &status);
+        oskar_fits_writer_write(w, first1, half, data, p * num_pix, &status);
+    }
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check out-of-range writes are rejected.
+    long bad[] = {1, 1, num_planes + 1};
+    oskar_fits_writer_write(w, bad, 1, data, 0, &status);
+    EXPECT_EQ((int) OSKAR_ERR_OUT_OF_RANGE, status);
+    status = 0;
+    oskar_fits_writer_free(w, &f, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+    ASSERT_TRUE(f != 0);
+    write_history(f, num_history, &status);
+    ASSERT_EQ(0, status);
+
+    // Check the files are identical.
+    std::vector<char> file1 = read_file(name1), file2 = read_file(name2);
+    EXPECT_GT(file1.size(), num_pix * num_planes);
+    EXPECT_EQ(0u, file1.size() % 2880);
+    EXPECT_TRUE(file1 == file2);
+    remove(name1);
+    remove(name2);
+    oskar_mem_free(data, &status);
+}
+
+TEST(fits_writer, single_precision)
+{
+    check_writer(OSKAR_SINGLE, 0, 0);
+    check_writer(OSKAR_SINGLE, 160, 20);
+}
+
+TEST(fits_writer, double_precision)
+{
+    check_writer(OSKAR_DOUBLE, 0, 3);
+    check_writer(OSKAR_DOUBLE, 40, 100);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_thread.h"
+#include "utility/oskar_timer.h"
+#include "utility/oskar_trace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+static void* record_events(void* arg)
+{
+    oskar_Barrier* barrier = (oskar_Barrier*) arg;
+    oskar_trace_set_thread(1, 0);
+    oskar_trace_begin("Worker");
+    oskar_barrier_wait(barrier);
+    oskar_trace_end("Worker");
+    return 0;
+}
+
+static int count(const std::string& s, const std::string& sub)
+{
+    int n = 0;
+    for (size_t p = s.find(sub); p != std::string::npos; p = s.find(sub, p + 1))
+        ++n;
+    return n;
+}
+
+TEST(trace, write_events)
+{
+    int status = 0;
+    const char* filename = "temp_test_trace.json";
+    oskar_Barrier* barrier = oskar_barrier_create(2);
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_set_name(tmr, "Timer");
+
+    // Nothing should be recorded before tracing is started.
+    oskar_trace_begin("Not recorded");
+    oskar_trace_end("Not recorded");
+    oskar_trace_start();
+    EXPECT_TRUE(oskar_trace_enabled());
+    oskar_trace_set_thread(0, -1);
+    oskar_Thread* thread = oskar_thread_create(record_events, barrier, 0);
+    oskar_timer_resume(tmr);
+    oskar_barrier_wait(barrier);
+    oskar_timer_pause(tmr);
+    oskar_thread_join(thread);
+    oskar_thread_free(thread);
+    oskar_trace_stop();
+    EXPECT_FALSE(oskar_trace_enabled());
+    oskar_trace_write(filename, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check the file contents.
+    std::ifstream file(filename);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    const std::string s = ss.str();
+    EXPECT_EQ(0u, s.find("{\"displayTimeUnit\""));
+    EXPECT_EQ(0, count(s, "Not recorded"));
+    EXPECT_EQ(2, count(s, "\"thread_name\""));
+    EXPECT_EQ(1, count(s, "Thread 1 (device 0)"));
+    EXPECT_EQ(2, count(s, "\"Worker\""));
+    EXPECT_EQ(2, count(s, "\"Timer\""));
+    EXPECT_EQ(4, count(s, "\"Barrier wait\""));
+    EXPECT_EQ(count(s, "\"ph\": \"B\""), count(s, "\"ph\": \"E\""));
+    remove(filename);
+    oskar_timer_free(tmr);
+    oskar_barrier_free(barrier);
+}
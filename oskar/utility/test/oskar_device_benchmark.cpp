@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include "settings/oskar_option_parser.h"
+#include "mem/oskar_mem.h"
+#include "utility/oskar_device.h"
+#include "utility/oskar_get_error_string.h"
+#include "utility/oskar_timer.h"
+#include "oskar_version.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static void report(const char* name, int n, double t)
+{
+    printf("%-36s %10.3f us  %12.0f /s\n", name, 1e6 * t / n, n / t);
+}
+
+// Launches a tiny kernel repeatedly, either by name or by cached handle.
+static double launch(int location, int n, bool by_handle, oskar_Mem* a,
+        int* status)
+{
+    const char* name = "mem_scale_double";
+    const unsigned int off = 0, num = 1;
+    const double value = 1.0;
+    size_t local_size[] = {1, 1, 1}, global_size[] = {1, 1, 1};
+    const oskar_Arg args[] = {
+            {INT_SZ, &off},
+            {INT_SZ, &num},
+            {DBL_SZ, &value},
+            {PTR_SZ, oskar_mem_buffer(a)}
+    };
+    const size_t num_args = sizeof(args) / sizeof(oskar_Arg);
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+    oskar_timer_start(tmr);
+    for (int i = 0; i < n && !*status; ++i)
+    {
+        if (by_handle)
+        {
+            static int handle = 0;
+            if (!handle) handle = oskar_device_kernel_handle(name);
+            oskar_device_launch_kernel_handle(handle, location, 1,
+                    local_size, global_size, num_args, args, 0, 0, status);
+        }
+        else
+            oskar_device_launch_kernel(name, location, 1,
+                    local_size, global_size, num_args, args, 0, 0, status);
+    }
+    oskar_Mem* t_ = oskar_mem_create_copy(a, OSKAR_CPU, status); // Sync.
+    oskar_mem_free(t_, status);
+    const double t = oskar_timer_elapsed(tmr);
+    oskar_timer_free(tmr);
+    return t;
+}
+
+int main(int argc, char** argv)
+{
+    oskar::OptionParser opt("oskar_device_benchmark", OSKAR_VERSION_STR);
+    opt.add_flag("-g", "Run kernel launches on the GPU.");
+    opt.add_flag("-cl", "Run kernel launches using OpenCL.");
+    opt.add_flag("-n", "Number of launches", 1, "100000", false);
+    if (!opt.check_options(argc, argv))
+        return EXIT_FAILURE;
+
+    int status = 0;
+    const int n = opt.get_int("-n");
+    int location = OSKAR_CPU;
+    if (opt.is_set("-g")) location = OSKAR_GPU;
+    if (opt.is_set("-cl")) location = OSKAR_CL;
+    oskar_Timer* tmr = oskar_timer_create(OSKAR_TIMER_NATIVE);
+
+    // Cost of resolving a kernel handle by name.
+    oskar_timer_start(tmr);
+    for (int i = 0; i < n; ++i)
+        (void) oskar_device_kernel_handle("mem_scale_double");
+    report("Kernel handle lookup by name", n, oskar_timer_elapsed(tmr));
+
+    // Tiny operation on the CPU, which calls the kernel directly.
+    oskar_Mem* a = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 1, &status);
+    oskar_timer_start(tmr);
+    for (int i = 0; i < n; ++i) oskar_mem_scale_real(a, 1.0, 0, 1, &status);
+    report("oskar_mem_scale_real (CPU, 1 element)", n,
+            oskar_timer_elapsed(tmr));
+    oskar_mem_free(a, &status);
+
+    // Tiny kernel launches on the device.
+    if (location != OSKAR_CPU)
+    {
+        oskar_device_set(location, 0, &status);
+        a = oskar_mem_create(OSKAR_DOUBLE, location, 1, &status);
+        (void) launch(location, 10, false, a, &status); // Warm up.
+        const double t_name = launch(location, n, false, a, &status);
+        const double t_handle = launch(location, n, true, a, &status);
+        if (!status)
+        {
+            report("Kernel launch by name", n, t_name);
+            report("Kernel launch by handle", n, t_handle);
+        }
+        oskar_mem_free(a, &status);
+    }
+    oskar_timer_free(tmr);
+    if (status)
+    {
+        fprintf(stderr, "ERROR: benchmark failed with code %i: %s\n", status,
+                oskar_get_error_string(status));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
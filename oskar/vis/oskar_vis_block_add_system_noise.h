@@ -44,10 +44,15 @@ extern "C" {
 /**
  * @brief Add a random Gaussian noise component to the visibilities.
  *
+ * @details
+ * The random numbers used for each visibility depend only on its
+ * time, channel and baseline indices within the block, so the result is
+ * the same regardless of the number of threads used.
+ *
  * @param[in,out] vis             Visibility structure to which to add noise.
  * @param[in]     telescope       Telescope model in use.
  * @param[in]     block_index     Simulation time index for the block.
- * @param[in,out] station_work    Work buffer of length num_stations.
+ * @param[in,out] station_work    Work buffer, resized as needed.
  * @param[in,out] status          Status return code.
  */
 OSKAR_EXPORT
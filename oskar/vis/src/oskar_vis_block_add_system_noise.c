@@ -5,53 +5,172 @@
 
 #include "vis/private_vis_block.h"
 #include "vis/oskar_vis_block.h"
-#include "math/oskar_random_gaussian.h"
+#include "math/private_random_helpers.h"
 #include "math/oskar_find_closest_match.h"
+#include "utility/oskar_kernel_macros.h"
 #include <math.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-static void oskar_get_station_std_dev_for_channel(oskar_Mem* station_std_dev,
-        double frequency_hz, const oskar_Telescope* tel, int* status)
+/* Fills the station noise standard deviation table for all channels. */
+static void oskar_get_station_std_dev(oskar_Mem* station_std_dev,
+        int num_channels, int start_channel, double freq_start_hz,
+        double freq_inc_hz, const oskar_Telescope* tel, int* status)
 {
-    int i, j;
+    int c, i, j;
     const oskar_Mem *noise_freq, *noise_rms;
 
     /* Ensure output array is big enough. */
     const int num_stations = oskar_telescope_num_stations(tel);
-    oskar_mem_ensure(station_std_dev, num_stations, status);
+    oskar_mem_ensure(station_std_dev, num_channels * num_stations, status);
 
-    /* Loop over stations and get noise value standard deviation for each. */
+    /* Loop over stations and get noise value standard deviation for each.
+     * The table is stored with the channel dimension slowest varying. */
     for (i = 0; i < num_stations; ++i)
     {
         const oskar_Station* station = oskar_telescope_station_const(tel, i);
         if (!station) station = oskar_telescope_station_const(tel, 0);
         noise_freq = oskar_station_noise_freq_hz_const(station);
         noise_rms = oskar_station_noise_rms_jy_const(station);
-        j = oskar_find_closest_match(frequency_hz, noise_freq, status);
-        oskar_mem_copy_contents(station_std_dev, noise_rms, i, j, 1, status);
+        for (c = 0; c < num_channels; ++c)
+        {
+            const int channel_index = c + start_channel;
+            const double freq_hz = freq_start_hz + channel_index * freq_inc_hz;
+            j = oskar_find_closest_match(freq_hz, noise_freq, status);
+            oskar_mem_copy_contents(station_std_dev, noise_rms,
+                    c * num_stations + i, j, 1, status);
+        }
     }
 }
 
-/* Applies noise to data in a visibility block, for the given channel. */
+/*
+ * The random number counter for each visibility is derived directly from
+ * its (time, baseline) indices within the block, so that each row of
+ * baselines can be processed independently by any thread.
+ * The counters are the same as those that would be obtained by incrementing
+ * a single counter serially through the time, baseline and station
+ * dimensions (cross-correlations first, then auto-correlations),
+ * restarting from zero for each channel.
+ * Work is distributed over (time, channel, first station) rows.
+ */
+
+/* Generates two Gaussian random numbers from one counter. */
+#define GAUSSIAN_2(SEED, COUNTER, BLOCK, RND) {\
+        OSKAR_R123_GENERATE_2(SEED, COUNTER, BLOCK)\
+        oskar_box_muller_d(u.i[0], u.i[1], &RND[0], &RND[1]); }
+
+/* Generates eight Gaussian random numbers from two consecutive counters. */
+#define GAUSSIAN_8(SEED, COUNTER, BLOCK, RND) {\
+        OSKAR_R123_GENERATE_4(SEED, COUNTER, BLOCK, 0, 0)\
+        oskar_box_muller_d(u.i[0], u.i[1], &RND[0], &RND[1]);\
+        oskar_box_muller_d(u.i[2], u.i[3], &RND[2], &RND[3]); }\
+        {\
+        OSKAR_R123_GENERATE_4(SEED, COUNTER + 1, BLOCK, 0, 0)\
+        oskar_box_muller_d(u.i[0], u.i[1], &RND[4], &RND[5]);\
+        oskar_box_muller_d(u.i[2], u.i[3], &RND[6], &RND[7]); }
+
+/* Adds cross-correlation noise for one baseline. */
+#define ADD_CROSS_SCALAR(D, STD, RND) {\
+        const double std = (STD) * (1.0 / sqrt(2.0));\
+        D.x += std * RND[0];\
+        D.y += std * RND[1]; }
+
+#define ADD_CROSS_MATRIX(D, STD, RND) {\
+        const double std = (STD);\
+        D.a.x += std * RND[0];\
+        D.a.y += std * RND[1];\
+        D.b.x += std * RND[2];\
+        D.b.y += std * RND[3];\
+        D.c.x += std * RND[4];\
+        D.c.y += std * RND[5];\
+        D.d.x += std * RND[6];\
+        D.d.y += std * RND[7]; }
+
+/* Adds autocorrelation noise for one station. Phases are all zero after
+ * autocorrelation, so ignore the imaginary components. */
+#define ADD_AUTO_SCALAR(D, STD, SEFD_FACTOR, RND) {\
+        const double std = (STD);\
+        D.x += std * RND[0] + std * sqrt(2.0) * SEFD_FACTOR; }
+
+#define ADD_AUTO_MATRIX(D, STD, SEFD_FACTOR, RND) {\
+        const double std = (STD) * sqrt(2.0);\
+        const double mean = std * SEFD_FACTOR;\
+        D.a.x += std * RND[0] + mean;\
+        D.b.x += std * RND[1];\
+        D.b.y += std * RND[2];\
+        D.c.x += std * RND[3];\
+        D.c.y += std * RND[4];\
+        D.d.x += std * RND[5] + mean; }
+
+/* Scalar data use one counter per visibility, and matrix data use two. */
+#define APPLY_NOISE(NAME, FP, T, NUM_CTR, NUM_RND, GAUSSIAN, CROSS, AUTO)\
+static void NAME(const int num_times, const int num_channels,\
+        const int num_stations, const int have_autocorr,\
+        const int have_crosscorr, const FP* st_std,\
+        const unsigned int seed, const unsigned int block_idx,\
+        const double sefd_factor, T* acorr, T* xcorr)\
+{\
+    int r;\
+    const int num_rows = num_times * num_channels * num_stations;\
+    const int num_baselines = num_stations * (num_stations - 1) / 2;\
+    const unsigned int num_cross =\
+            have_crosscorr ? NUM_CTR * num_baselines : 0;\
+    const unsigned int stride =\
+            num_cross + (have_autocorr ? NUM_CTR * num_stations : 0);\
+    DO_PRAGMA(omp parallel for schedule(dynamic, 1))\
+    for (r = 0; r < num_rows; ++r)\
+    {\
+        int a2, b;\
+        double rnd[NUM_RND];\
+        const int a1 = r % num_stations;\
+        const int ch = (r / num_stations) % num_channels;\
+        const int t = r / (num_stations * num_channels);\
+        const FP* st = st_std + ch * num_stations;\
+        const unsigned int counter_start = (unsigned int)t * stride;\
+        if (have_crosscorr)\
+        {\
+            const int b_start = a1 * (2 * num_stations - a1 - 1) / 2;\
+            T* data = xcorr + num_baselines * (num_channels * t + ch);\
+            for (a2 = a1 + 1, b = b_start; a2 < num_stations; ++b, ++a2)\
+            {\
+                GAUSSIAN(seed, counter_start + NUM_CTR * b, block_idx, rnd)\
+                CROSS(data[b], sqrt(st[a1] * st[a2]), rnd)\
+            }\
+        }\
+        if (have_autocorr)\
+        {\
+            T* data = acorr + num_stations * (num_channels * t + ch);\
+            GAUSSIAN(seed, counter_start + num_cross + NUM_CTR * a1,\
+                    block_idx, rnd)\
+            AUTO(data[a1], st[a1], sefd_factor, rnd)\
+        }\
+    }\
+}
+
+APPLY_NOISE(apply_noise_float2, float, float2, 1, 2,
+        GAUSSIAN_2, ADD_CROSS_SCALAR, ADD_AUTO_SCALAR)
+APPLY_NOISE(apply_noise_double2, double, double2, 1, 2,
+        GAUSSIAN_2, ADD_CROSS_SCALAR, ADD_AUTO_SCALAR)
+APPLY_NOISE(apply_noise_float4c, float, float4c, 2, 8,
+        GAUSSIAN_8, ADD_CROSS_MATRIX, ADD_AUTO_MATRIX)
+APPLY_NOISE(apply_noise_double4c, double, double4c, 2, 8,
+        GAUSSIAN_8, ADD_CROSS_MATRIX, ADD_AUTO_MATRIX)
+
+/* Applies noise to all data in a visibility block. */
 static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
         const oskar_Mem* station_std_dev, unsigned int seed,
-        unsigned int block_idx, unsigned int channel_idx,
-        double channel_bandwidth_hz, double time_int_sec, int* status)
+        unsigned int block_idx, double channel_bandwidth_hz,
+        double time_int_sec, int* status)
 {
-    int a1, a2, block_start, b, c = 0, t;
     void *acorr_ptr, *xcorr_ptr;
-    double rnd[8];
-    const double inv_sqrt2 = 1.0 / sqrt(2.0);
 
     /* Get pointer to start of block, and block dimensions. */
     acorr_ptr = oskar_mem_void(oskar_vis_block_auto_correlations(vis));
     xcorr_ptr = oskar_mem_void(oskar_vis_block_cross_correlations(vis));
     const int have_autocorr  = oskar_vis_block_has_auto_correlations(vis);
     const int have_crosscorr = oskar_vis_block_has_cross_correlations(vis);
-    const int num_baselines  = oskar_vis_block_num_baselines(vis);
     const int num_channels   = oskar_vis_block_num_channels(vis);
     const int num_stations   = oskar_vis_block_num_stations(vis);
     const int num_times      = oskar_vis_block_num_times(vis);
@@ -69,195 +188,33 @@ static void oskar_vis_block_apply_noise(oskar_VisBlock* vis,
     switch (oskar_mem_type(oskar_vis_block_cross_correlations(vis)))
     {
     case OSKAR_SINGLE_COMPLEX:
-    {
-        const float* st_std;
-        float2* data;
-        st_std = oskar_mem_float_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
-        {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (float2*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                        const double std = sqrt(st_std[a1] * st_std[a2]) * inv_sqrt2;
-                        data[b].x += std * rnd[0];
-                        data[b].y += std * rnd[1];
-                    }
-                }
-            }
-
-            if (have_autocorr)
-            {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (float2*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                    const double std = st_std[a1];
-                    const double mean = sqrt(2.0)*st_std[a1];
-                    data[a1].x += std * rnd[0] + mean * sefd_factor;
-                }
-            }
-        }
+        apply_noise_float2(num_times, num_channels, num_stations,
+                have_autocorr, have_crosscorr,
+                oskar_mem_float_const(station_std_dev, status),
+                seed, block_idx, sefd_factor,
+                (float2*) acorr_ptr, (float2*) xcorr_ptr);
         break;
-    }
     case OSKAR_SINGLE_COMPLEX_MATRIX:
-    {
-        const float* st_std;
-        float4c* data;
-        st_std = oskar_mem_float_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
-        {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (float4c*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                        const double std = sqrt(st_std[a1] * st_std[a2]);
-                        data[b].a.x += std * rnd[0];
-                        data[b].a.y += std * rnd[1];
-                        data[b].b.x += std * rnd[2];
-                        data[b].b.y += std * rnd[3];
-                        data[b].c.x += std * rnd[4];
-                        data[b].c.y += std * rnd[5];
-                        data[b].d.x += std * rnd[6];
-                        data[b].d.y += std * rnd[7];
-                    }
-                }
-            }
-
-            if (have_autocorr)
-            {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (float4c*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                    const double std = st_std[a1] * sqrt(2.0);
-                    const double mean = std * sefd_factor;
-                    data[a1].a.x += std * rnd[0] + mean;
-                    data[a1].b.x += std * rnd[1];
-                    data[a1].b.y += std * rnd[2];
-                    data[a1].c.x += std * rnd[3];
-                    data[a1].c.y += std * rnd[4];
-                    data[a1].d.x += std * rnd[5] + mean;
-                }
-            }
-        }
+        apply_noise_float4c(num_times, num_channels, num_stations,
+                have_autocorr, have_crosscorr,
+                oskar_mem_float_const(station_std_dev, status),
+                seed, block_idx, sefd_factor,
+                (float4c*) acorr_ptr, (float4c*) xcorr_ptr);
         break;
-    }
     case OSKAR_DOUBLE_COMPLEX:
-    {
-        const double* st_std;
-        double2* data;
-        st_std = oskar_mem_double_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
-        {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (double2*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                        const double std = sqrt(st_std[a1] * st_std[a2]) * inv_sqrt2;
-                        data[b].x += std * rnd[0];
-                        data[b].y += std * rnd[1];
-                    }
-                }
-            }
-
-            if (have_autocorr)
-            {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (double2*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian2(seed, c++, block_idx, rnd);
-                    const double std  = st_std[a1];
-                    const double mean = st_std[a1] * sefd_factor * sqrt(2.0);
-                    data[a1].x += std * rnd[0] + mean;
-                }
-            }
-        }
+        apply_noise_double2(num_times, num_channels, num_stations,
+                have_autocorr, have_crosscorr,
+                oskar_mem_double_const(station_std_dev, status),
+                seed, block_idx, sefd_factor,
+                (double2*) acorr_ptr, (double2*) xcorr_ptr);
         break;
-    }
     case OSKAR_DOUBLE_COMPLEX_MATRIX:
-    {
-        const double* st_std;
-        double4c* data;
-        st_std = oskar_mem_double_const(station_std_dev, status);
-        for (t = 0; t < num_times; ++t)
-        {
-            if (have_crosscorr)
-            {
-                /* Cross-correlation noise. */
-                block_start = num_baselines * (num_channels * t + channel_idx);
-                data = (double4c*) xcorr_ptr + block_start;
-                for (a1 = 0, b = 0; a1 < num_stations; ++a1)
-                {
-                    for (a2 = a1 + 1; a2 < num_stations; ++b, ++a2)
-                    {
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                        oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd + 4);
-                        const double std = sqrt(st_std[a1] * st_std[a2]);
-                        data[b].a.x += std * rnd[0];
-                        data[b].a.y += std * rnd[1];
-                        data[b].b.x += std * rnd[2];
-                        data[b].b.y += std * rnd[3];
-                        data[b].c.x += std * rnd[4];
-                        data[b].c.y += std * rnd[5];
-                        data[b].d.x += std * rnd[6];
-                        data[b].d.y += std * rnd[7];
-                    }
-                }
-            }
-
-            if (have_autocorr)
-            {
-                /* Autocorrelation noise. Phases are all zero after
-                 * autocorrelation, so ignore the imaginary components. */
-                block_start = num_stations * (num_channels * t + channel_idx);
-                data = (double4c*) acorr_ptr + block_start;
-                for (a1 = 0; a1 < num_stations; ++a1)
-                {
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd);
-                    oskar_random_gaussian4(seed, c++, block_idx, 0, 0, rnd+4);
-                    const double std  = st_std[a1]*sqrt(2.0);
-                    const double mean = std * sefd_factor;
-                    data[a1].a.x += std * rnd[0] + mean;
-                    data[a1].b.x += std * rnd[1];
-                    data[a1].b.y += std * rnd[2];
-                    data[a1].c.x += std * rnd[3];
-                    data[a1].c.y += std * rnd[4];
-                    data[a1].d.x += std * rnd[5] + mean;
-                }
-            }
-        }
+        apply_noise_double4c(num_times, num_channels, num_stations,
+                have_autocorr, have_crosscorr,
+                oskar_mem_double_const(station_std_dev, status),
+                seed, block_idx, sefd_factor,
+                (double4c*) acorr_ptr, (double4c*) xcorr_ptr);
         break;
-    }
     };
 }
 
@@ -265,7 +222,7 @@ void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
         const oskar_VisHeader* header, const oskar_Telescope* telescope,
         unsigned int block_index, oskar_Mem* station_work, int* status)
 {
-    int c, num_channels, start_channel;
+    int num_channels, start_channel;
     unsigned int seed;
     double freq_start_hz, freq_inc_hz;
     double channel_bandwidth_hz, time_int_sec;
@@ -288,16 +245,14 @@ void oskar_vis_block_add_system_noise(oskar_VisBlock* vis,
     freq_start_hz        = oskar_vis_header_freq_start_hz(header);
     freq_inc_hz          = oskar_vis_header_freq_inc_hz(header);
 
-    /* Apply noise to each channel. */
-    for (c = 0; c < num_channels; ++c)
-    {
-        const int channel_index = c + start_channel;
-        const double freq_hz = freq_start_hz + channel_index * freq_inc_hz;
-        oskar_get_station_std_dev_for_channel(station_work, freq_hz,
-                telescope, status);
-        oskar_vis_block_apply_noise(vis, station_work, seed,
-                block_index, c, channel_bandwidth_hz, time_int_sec, status);
-    }
+    /* Look up the station noise levels for all channels in the block. */
+    oskar_get_station_std_dev(station_work, num_channels, start_channel,
+            freq_start_hz, freq_inc_hz, telescope, status);
+    if (*status) return;
+
+    /* Apply noise to all channels. */
+    oskar_vis_block_apply_noise(vis, station_work, seed,
+            block_index, channel_bandwidth_hz, time_int_sec, status);
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2020, The OSKAR Developers.
+ * See the LICENSE file at the top-level directory of this distribution.
+ */
+
+#include <gtest/gtest.h>
+
+#include "math/oskar_random_gaussian.h"
+#include "telescope/oskar_telescope.h"
+#include "vis/oskar_vis_header.h"
+#include "vis/oskar_vis_block.h"
+#include "utility/oskar_get_error_string.h"
+
+#include <cmath>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static void set_up_noise(oskar_Telescope* tel, int* status)
+{
+    const int num_stations = oskar_telescope_num_stations(tel);
+    for (int i = 0; i < num_stations; ++i)
+    {
+        oskar_Station* st = oskar_telescope_station(tel, i);
+        oskar_Mem* freq = oskar_station_noise_freq_hz(st);
+        oskar_Mem* rms = oskar_station_noise_rms_jy(st);
+        oskar_mem_realloc(freq, 3, status);
+        oskar_mem_realloc(rms, 3, status);
+        for (int j = 0; j < 3; ++j)
+        {
+            oskar_mem_double(freq, status)[j] = 100e6 + j * 20e6;
+            oskar_mem_double(rms, status)[j] = 1.0 + 0.1 * i + j;
+        }
+    }
+}
+
+static oskar_VisBlock* create_block(const oskar_VisHeader* hdr,
+        int* status)
+{
+    oskar_VisBlock* blk = oskar_vis_block_create_from_header(
+            OSKAR_CPU, hdr, status);
+    oskar_mem_clear_contents(oskar_vis_block_cross_correlations(blk), status);
+    oskar_mem_clear_contents(oskar_vis_block_auto_correlations(blk), status);
+    return blk;
+}
+
+TEST(vis_block_add_system_noise, thread_count_independent)
+{
+    int status = 0;
+    const int num_stations = 15, num_times = 6, num_channels = 4;
+    const int amp_type = OSKAR_DOUBLE_COMPLEX_MATRIX;
+    const unsigned int block_index = 3;
+
+    // Create the telescope model with noise levels for each station.
+    oskar_Telescope* tel = oskar_telescope_create(OSKAR_DOUBLE, OSKAR_CPU,
+            num_stations, &status);
+    oskar_telescope_set_enable_noise(tel, 1, 42);
+    set_up_noise(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Create the header.
+    oskar_VisHeader* hdr = oskar_vis_header_create(amp_type, OSKAR_DOUBLE,
+            num_times, num_times, num_channels, num_channels,
+            num_stations, 1, 1, &status);
+    oskar_vis_header_set_freq_start_hz(hdr, 100e6);
+    oskar_vis_header_set_freq_inc_hz(hdr, 10e6);
+    oskar_vis_header_set_channel_bandwidth_hz(hdr, 1e5);
+    oskar_vis_header_set_time_average_sec(hdr, 10.0);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Add noise using one thread, and using several threads.
+    oskar_Mem* work = oskar_mem_create(OSKAR_DOUBLE, OSKAR_CPU, 0, &status);
+    oskar_VisBlock* blk1 = create_block(hdr, &status);
+    oskar_VisBlock* blk2 = create_block(hdr, &status);
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif
+    oskar_vis_block_add_system_noise(blk1, hdr, tel, block_index, work,
+            &status);
+#ifdef _OPENMP
+    omp_set_num_threads(4);
+#endif
+    oskar_vis_block_add_system_noise(blk2, hdr, tel, block_index, work,
+            &status);
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+
+    // Check results are identical.
+    EXPECT_EQ(0, oskar_mem_different(
+            oskar_vis_block_cross_correlations(blk1),
+            oskar_vis_block_cross_correlations(blk2), 0, &status));
+    EXPECT_EQ(0, oskar_mem_different(
+            oskar_vis_block_auto_correlations(blk1),
+            oskar_vis_block_auto_correlations(blk2), 0, &status));
+
+    // Check against a serial reference, which uses a single counter
+    // incremented through time, baseline and station for each channel.
+    const double4c* xc = oskar_mem_double4c_const(
+            oskar_vis_block_cross_correlations(blk1), &status);
+    const double4c* ac = oskar_mem_double4c_const(
+            oskar_vis_block_auto_correlations(blk1), &status);
+    const int num_baselines = num_stations * (num_stations - 1) / 2;
+    for (int c = 0; c < num_channels; ++c)
+    {
+        const double* st = oskar_mem_double_const(work, &status) +
+                c * num_stations;
+        unsigned int counter = 0;
+        for (int t = 0; t < num_times; ++t)
+        {
+            for (int a1 = 0, b = 0; a1 < num_stations; ++a1)
+            {
+                for (int a2 = a1 + 1; a2 < num_stations; ++a2, ++b)
+                {
+                    double rnd[8];
+                    oskar_random_gaussian4(42, counter++, block_index,
+                            0, 0, rnd);
+                    oskar_random_gaussian4(42, counter++, block_index,
+                            0, 0, rnd + 4);
+                    const double std = sqrt(st[a1] * st[a2]);
+                    const int i = num_baselines * (num_channels * t + c) + b;
+                    ASSERT_EQ(std * rnd[0], xc[i].a.x);
+                    ASSERT_EQ(std * rnd[3], xc[i].b.y);
+                    ASSERT_EQ(std * rnd[7], xc[i].d.y);
+                }
+            }
+            for (int a1 = 0; a1 < num_stations; ++a1)
+            {
+                double rnd[8];
+                oskar_random_gaussian4(42, counter++, block_index,
+                        0, 0, rnd);
+                oskar_random_gaussian4(42, counter++, block_index,
+                        0, 0, rnd + 4);
+                const double std = st[a1] * sqrt(2.0);
+                const int i = num_stations * (num_channels * t + c) + a1;
+                ASSERT_EQ(std * rnd[1], ac[i].b.x);
+                ASSERT_EQ(std * rnd[4], ac[i].c.y);
+            }
+        }
+    }
+
+    // Free memory.
+    oskar_mem_free(work, &status);
+    oskar_vis_block_free(blk1, &status);
+    oskar_vis_block_free(blk2, &status);
+    oskar_vis_header_free(hdr, &status);
+    oskar_telescope_free(tel, &status);
+    ASSERT_EQ(0, status) << oskar_get_error_string(status);
+}
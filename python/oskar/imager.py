@@ -199,7 +199,8 @@ class Imager(object):
     @property
     def algorithm(self):
         """Returns or sets the algorithm used by the imager.
-        Currently one of 'FFT', 'DFT 2D', 'DFT 3D' or 'W-projection'.
+        Currently one of 'FFT', 'DFT 2D', 'DFT 3D', 'W-projection'
+        or 'W-stacking'.
 
         The default is 'FFT', which corresponds to basic but quick 2D gridding,
         ignoring baseline w-components.
@@ -219,6 +220,11 @@ class Imager(object):
         of image you are making, as an extra copy of the grid
         will be made by the FFT library.
 
+        'W-stacking' grids the visibilities onto a number of W-layers with a
+        small kernel, and applies the W-term to each layer in the image plane.
+        It runs only on the CPU, where it is usually faster than W-projection
+        for wide fields of view.
+
         Type
             str
         """
@@ -451,7 +457,7 @@ class Imager(object):
     @property
     def num_w_planes(self):
         """Returns or sets the number of W-projection planes to use,
-        if using W-projection.
+        if using W-projection, or the number of W-layers if using W-stacking.
 
         A number less than or equal to zero means 'automatic'.
 
@@ -631,7 +637,7 @@ class Imager(object):
     @property
     def wprojplanes(self):
         """Returns or sets the number of W-projection planes to use,
-        if using W-projection.
+        if using W-projection, or the number of W-layers if using W-stacking.
 
         A number less than or equal to zero means 'automatic'.
 
@@ -824,7 +830,8 @@ class Imager(object):
             return _imager_lib.run(self._capsule, return_images, return_grids)
         else:
             self.reset_cache()
-            if self.weighting == 'Uniform' or self.algorithm == 'W-projection':
+            if self.weighting == 'Uniform' or \
+                    self.algorithm in ('W-projection', 'W-stacking'):
                 self.set_coords_only(True)
                 self.update(uu, vv, ww, amps, weight, time_centroid,
                             start_channel, end_channel, num_pols)
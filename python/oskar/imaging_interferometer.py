@@ -94,7 +94,8 @@ class ImagingInterferometer(Interferometer):
         # Iterate imagers to find any with uniform weighting or W-projection.
         need_coords_first = False
         for im in self._imagers:
-            if im.weighting == 'Uniform' or im.algorithm == 'W-projection':
+            if im.weighting == 'Uniform' or \
+                    im.algorithm in ('W-projection', 'W-stacking'):
                 need_coords_first = True
 
         # Simulate coordinates first, if required.